@@ -0,0 +1,160 @@
+#include "benchmarkjob.h"
+#include "../utils/framestatistics.h"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+BenchmarkJob::BenchmarkJob ()
+  : parameter_space_mode(PARAMETER_SPACE_MODE::PARAMETER_SPACE_NONE)
+  , warmup_frames(10)
+  , frames(100)
+  , path_frames(300)
+  , min_time_ms(0.0)
+  , max_cv(FRAME_STATISTICS_DEFAULT_MAX_CV)
+  , output_filepath("bench_results.csv")
+{}
+
+BenchmarkJob::~BenchmarkJob ()
+{}
+
+bool BenchmarkJob::ReadJobFile (std::string filepath)
+{
+  std::ifstream f_job(filepath);
+  if (!f_job.is_open())
+  {
+    std::cout << "Error: Unable to read benchmark job file " << filepath << "." << std::endl;
+    return false;
+  }
+
+  bool parameter_space_set = false;
+  int n_line = 0;
+  std::string line;
+  while (std::getline(f_job, line))
+  {
+    n_line++;
+    line = Trim(line);
+    if (line.empty() || line[0] == '#') continue;
+
+    size_t end_keyword = line.find_first_of(" \t");
+    std::string keyword = line.substr(0, end_keyword);
+    std::string value = end_keyword == std::string::npos ? "" : Trim(line.substr(end_keyword));
+
+    std::istringstream s_value(value);
+    bool valid = !value.empty();
+    if (keyword == "renderer")
+    {
+      renderers.push_back(value);
+    }
+    else if (keyword == "dataset")
+    {
+      datasets.push_back(value);
+    }
+    else if (keyword == "transfer_function")
+    {
+      transfer_functions.push_back(value);
+    }
+    else if (keyword == "gradient")
+    {
+      gradients.push_back(value);
+    }
+    else if (keyword == "camera")
+    {
+      camera_states.push_back(value);
+    }
+    else if (keyword == "camera_path")
+    {
+      camera_paths.push_back(value);
+    }
+    else if (keyword == "resolution")
+    {
+      glm::ivec2 res;
+      s_value >> res.x >> res.y;
+      valid = !s_value.fail() && res.x > 0 && res.y > 0;
+      if (valid) resolutions.push_back(res);
+    }
+    else if (keyword == "range")
+    {
+      ParameterRange prange;
+      s_value >> prange.name >> prange.start >> prange.end >> prange.incr;
+      valid = !s_value.fail() && prange.start <= prange.end && prange.incr > 0.0;
+      if (valid) parameter_ranges.push_back(prange);
+    }
+    else if (keyword == "output")
+    {
+      output_filepath = value;
+    }
+    else if (keyword == "frames")
+    {
+      s_value >> frames;
+      valid = !s_value.fail() && frames > 0;
+    }
+    else if (keyword == "path_frames")
+    {
+      s_value >> path_frames;
+      valid = !s_value.fail() && path_frames > 1;
+    }
+    else if (keyword == "min_time")
+    {
+      s_value >> min_time_ms;
+      valid = !s_value.fail() && min_time_ms >= 0.0;
+    }
+    else if (keyword == "max_cv")
+    {
+      s_value >> max_cv;
+      valid = !s_value.fail() && max_cv > 0.0;
+    }
+    else if (keyword == "warmup")
+    {
+      s_value >> warmup_frames;
+      valid = !s_value.fail() && warmup_frames >= 0;
+    }
+    else if (keyword == "parameter_space")
+    {
+      parameter_space_set = true;
+      if (value == "none")        parameter_space_mode = PARAMETER_SPACE_MODE::PARAMETER_SPACE_NONE;
+      else if (value == "listed") parameter_space_mode = PARAMETER_SPACE_MODE::PARAMETER_SPACE_LISTED;
+      else if (value == "full")   parameter_space_mode = PARAMETER_SPACE_MODE::PARAMETER_SPACE_FULL;
+      else valid = false;
+    }
+    else
+    {
+      valid = false;
+    }
+
+    if (!valid)
+    {
+      std::cout << "Error: " << filepath << ":" << n_line << ": invalid line \"" << line << "\"." << std::endl;
+      return false;
+    }
+  }
+  f_job.close();
+
+  if (!parameter_space_set && !parameter_ranges.empty())
+    parameter_space_mode = PARAMETER_SPACE_MODE::PARAMETER_SPACE_LISTED;
+
+  if (renderers.empty() || datasets.empty())
+  {
+    std::cout << "Error: The benchmark job must list at least one renderer and one dataset." << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+int BenchmarkJob::GetNumberOfConfigurations ()
+{
+  return (int)renderers.size() * (int)datasets.size()
+       * (int)glm::max(gradients.size(), size_t(1))
+       * (int)glm::max(transfer_functions.size(), size_t(1))
+       * (int)glm::max(camera_states.size() + camera_paths.size(), size_t(1))
+       * (int)glm::max(resolutions.size(), size_t(1));
+}
+
+std::string BenchmarkJob::Trim (std::string str)
+{
+  size_t first = str.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos) return "";
+  size_t last = str.find_last_not_of(" \t\r\n");
+  return str.substr(first, last - first + 1);
+}
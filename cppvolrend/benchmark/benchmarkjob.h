@@ -0,0 +1,108 @@
+/**
+ * Job description of a headless benchmark run (cppvolrend_bench).
+ *
+ * The job file is read line by line, as "<keyword> <value>", where the
+ *   value is the rest of the line. Lines starting with '#' are comments.
+ *   Keywords that list items may be repeated, and the benchmark runs the
+ *   cross product of all listed items:
+ *
+ * renderer           <name or abbreviation of the volume renderer>
+ * dataset            <name of the dataset in #list_structured_datasets>
+ * transfer_function  <name of the transfer function in #list_transfer_functions>
+ * gradient           <name of the gradient type, DataManager::GetGradientName>
+ * camera             <name of the camera state in #list_camera_states>
+ * camera_path        <recorded camera path (.cpath), relative to the data folder>
+ * resolution         <width> <height>
+ * range              <parameter name> <start> <end> <step>
+ *
+ * and the single valued options:
+ *
+ * output             <results file (.csv), relative to the data folder>
+ * frames             <minimum number of measured frames per sample point>
+ * min_time           <minimum measured time per sample point, in milliseconds>
+ * warmup             <number of discarded frames before measuring>
+ * max_cv             <max coefficient of variation of a stable sample (e.g. 0.05)>
+ * parameter_space    none | listed | full
+ * path_frames        <number of frames a camera path is played in>
+ *
+ * A gradient precomputed in a texture and the gradients computed by the
+ *   shaders ("On the Fly (Ray Marching Shader)") are compared with one
+ *   "gradient" line each: the time to build the gradient texture is part of
+ *   the load time, and its size of the gpu memory columns.
+ *
+ * "range" overrides a dimension filled by BaseVolumeRenderer::FillParameterSpace.
+ *   With "parameter_space listed" (default if any range is given) only the
+ *   listed dimensions are swept, "full" sweeps all of them and "none" (default
+ *   otherwise) renders with the default parameters of each renderer.
+ *
+ * Frames are measured until both "frames" and "min_time" are reached, after
+ *   "warmup" frames rendered at each sample point (parameter changes may
+ *   rebuild shaders or pre-processed data). Samples with a higher variation
+ *   than "max_cv" are flagged as unstable (see utils/framestatistics.h).
+ *
+ * A camera path (volvis_utils/camerapath.h) is played in exactly "path_frames"
+ *   frames, evenly spaced in path time, after "warmup" frames at its first
+ *   keyframe; "frames" and "min_time" do not apply. Camera states and paths
+ *   are both iterated, the camera column of a path is "path:<file name>",
+ *   and the time of each frame is also written to "<output>_frames.csv".
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef BENCHMARK_JOB_H
+#define BENCHMARK_JOB_H
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class BenchmarkJob
+{
+public:
+  enum PARAMETER_SPACE_MODE : unsigned int {
+    PARAMETER_SPACE_NONE   = 0,
+    PARAMETER_SPACE_LISTED = 1,
+    PARAMETER_SPACE_FULL   = 2,
+  };
+
+  class ParameterRange
+  {
+  public:
+    std::string name;
+    double start, end, incr;
+  };
+
+  BenchmarkJob ();
+  ~BenchmarkJob ();
+
+  bool ReadJobFile (std::string filepath);
+
+  // Number of combinations of renderer, dataset, gradient, transfer function,
+  //   camera (state or path) and resolution (without the parameter space)
+  int GetNumberOfConfigurations ();
+
+  std::vector<std::string> renderers;
+  std::vector<std::string> datasets;
+  std::vector<std::string> transfer_functions;
+  std::vector<std::string> gradients;
+  std::vector<std::string> camera_states;
+  std::vector<std::string> camera_paths;
+  std::vector<glm::ivec2> resolutions;
+  std::vector<ParameterRange> parameter_ranges;
+
+  PARAMETER_SPACE_MODE parameter_space_mode;
+  int warmup_frames;
+  int frames;
+  int path_frames;
+  double min_time_ms;
+  double max_cv;
+  std::string output_filepath;
+
+protected:
+  static std::string Trim (std::string str);
+
+private:
+};
+
+#endif
@@ -0,0 +1,109 @@
+#include "benchmarkresults.h"
+
+#include <fstream>
+#include <iostream>
+
+BenchmarkResults::BenchmarkResults ()
+  : filepath("")
+{}
+
+BenchmarkResults::~BenchmarkResults ()
+{}
+
+bool BenchmarkResults::ReadFile (std::string _filepath)
+{
+  filepath = _filepath;
+  info.clear();
+  columns.clear();
+  rows.clear();
+
+  std::ifstream f_results(filepath);
+  if (!f_results.is_open())
+  {
+    std::cout << "Error: Unable to read results file " << filepath << "." << std::endl;
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(f_results, line))
+  {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.empty()) continue;
+
+    if (line[0] == '#')
+    {
+      size_t end_key = line.find(' ');
+      std::string key = line.substr(1, end_key == std::string::npos ? std::string::npos : end_key - 1);
+      info[key] = end_key == std::string::npos ? "" : line.substr(end_key + 1);
+    }
+    else if (columns.empty())
+    {
+      columns = ParseCsvLine(line);
+    }
+    else
+    {
+      std::vector<std::string> row = ParseCsvLine(line);
+      if (row.size() != columns.size())
+      {
+        std::cout << "Error: " << filepath << ": expected " << columns.size() << " values in line \"" << line << "\"." << std::endl;
+        return false;
+      }
+      rows.push_back(row);
+    }
+  }
+  f_results.close();
+
+  if (columns.empty())
+  {
+    std::cout << "Error: " << filepath << " has no csv header." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int BenchmarkResults::FindColumn (std::string name)
+{
+  for (int i = 0; i < columns.size(); i++)
+    if (columns[i] == name) return i;
+  return -1;
+}
+
+std::string BenchmarkResults::GetInfo (std::string key)
+{
+  std::map<std::string, std::string>::iterator it = info.find(key);
+  return it == info.end() ? "" : it->second;
+}
+
+std::vector<std::string> BenchmarkResults::ParseCsvLine (std::string line)
+{
+  std::vector<std::string> values;
+  std::string value = "";
+  bool quoted = false;
+  for (int i = 0; i < line.size(); i++)
+  {
+    char c = line[i];
+    if (quoted)
+    {
+      if (c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+      {
+        value.push_back('"');
+        i++;
+      }
+      else if (c == '"')
+        quoted = false;
+      else
+        value.push_back(c);
+    }
+    else if (c == '"')
+      quoted = true;
+    else if (c == ',')
+    {
+      values.push_back(value);
+      value = "";
+    }
+    else
+      value.push_back(c);
+  }
+  values.push_back(value);
+  return values;
+}
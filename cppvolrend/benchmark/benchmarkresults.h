@@ -0,0 +1,42 @@
+/**
+ * Results file read back for comparisons (see runinfo.h for the format).
+ *
+ * Files without "#key value" lines (written before the format version) are
+ *   also accepted, with an empty run info.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef BENCHMARK_RESULTS_H
+#define BENCHMARK_RESULTS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+class BenchmarkResults
+{
+public:
+  BenchmarkResults ();
+  ~BenchmarkResults ();
+
+  bool ReadFile (std::string filepath);
+
+  // Returns -1 if the column does not exist
+  int FindColumn (std::string name);
+  std::string GetInfo (std::string key);
+
+  // Splits a csv line, handling quoted fields ("" is an escaped quote)
+  static std::vector<std::string> ParseCsvLine (std::string line);
+
+  std::string filepath;
+  std::map<std::string, std::string> info;
+  std::vector<std::string> columns;
+  std::vector<std::vector<std::string>> rows;
+
+protected:
+
+private:
+};
+
+#endif
@@ -0,0 +1,573 @@
+#include "benchmarkrunner.h"
+
+#include "../volrenderbase.h"
+
+#include <gl_utils/framebufferobject.h>
+#include <gl_utils/gpumemoryregistry.h>
+#include <gl_utils/gpuprofiler.h>
+#include <gl_utils/tracer.h>
+
+#include "../utils/framestatistics.h"
+#include "runinfo.h"
+
+#include <algorithm>
+#include <iostream>
+#include <filesystem>
+#include <sstream>
+
+BenchmarkRunner::BenchmarkRunner ()
+  : m_path_to_data("")
+  , m_screen_fbo(0)
+  , m_screen_color_rbo(0)
+  , m_screen_depth_stencil_rbo(0)
+{
+  m_vtr_vr_methods.clear();
+}
+
+BenchmarkRunner::~BenchmarkRunner ()
+{
+  for (int i = (int)m_vtr_vr_methods.size() - 1; i >= 0; i--) delete m_vtr_vr_methods[i];
+  m_vtr_vr_methods.clear();
+
+  if (m_screen_fbo != 0)
+  {
+    gl::FrameBufferObject::SetScreenFramebuffer(0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &m_screen_fbo);
+    glDeleteRenderbuffers(1, &m_screen_color_rbo);
+    glDeleteRenderbuffers(1, &m_screen_depth_stencil_rbo);
+  }
+
+  gl::GPUProfiler::DestroyInstance();
+}
+
+void BenchmarkRunner::AddVolumeRenderer (BaseVolumeRenderer* volrend)
+{
+  volrend->SetExternalResources(&m_data_mgr, &m_rdr_parameters);
+  m_vtr_vr_methods.push_back(volrend);
+}
+
+void BenchmarkRunner::InitData (std::string path_to_data)
+{
+  m_path_to_data = path_to_data;
+
+  // Read Datasets and Transfer Functions from Data Manager
+  m_data_mgr.SetPathToData(m_path_to_data);
+  m_data_mgr.ReadData();
+
+  m_camera_state_list.ReadCameraStates(m_path_to_data + "#list_camera_states");
+  m_rdr_parameters.GetCamera()->SetData(m_camera_state_list.GetCameraState(0));
+
+  // Same light sources as the first list of the application
+  m_light_source_list.ReadLightSourceLists(m_path_to_data + "#list_light_sources");
+  m_rdr_parameters.EraseAllLightSources();
+  if (m_light_source_list.NumberOfLists() > 0)
+  {
+    for (int i = 0; i < m_light_source_list.GetList(0)->m_lightsources.size(); i++)
+      m_rdr_parameters.CreateNewLightSource(m_light_source_list.GetList(0)->m_lightsources[i]);
+  }
+}
+
+bool BenchmarkRunner::Run (BenchmarkJob* job)
+{
+  if (!OpenResultsFile(job->output_filepath))
+    return false;
+  if (!job->camera_paths.empty())
+  {
+    std::filesystem::path frames_filepath(job->output_filepath);
+    frames_filepath.replace_filename(frames_filepath.stem().string() + "_frames.csv");
+    if (!OpenFramesFile(frames_filepath.string()))
+      return false;
+  }
+  gl::GPUProfiler::Instance()->SetEnabled(true);
+
+  // Missing lists use the current state of the data manager and renderer
+  std::vector<std::string> gradients = job->gradients;
+  if (gradients.empty()) gradients.push_back(GetCurrentGradientName());
+  std::vector<std::string> transfer_functions = job->transfer_functions;
+  if (transfer_functions.empty()) transfer_functions.push_back(m_data_mgr.GetCurrentTransferFunctionName());
+  std::vector<std::string> camera_states = job->camera_states;
+  if (camera_states.empty() && job->camera_paths.empty())
+    camera_states.push_back(m_camera_state_list.GetCameraState(0)->cam_setup_name);
+  std::vector<glm::ivec2> resolutions = job->resolutions;
+  if (resolutions.empty()) resolutions.push_back(glm::ivec2(m_rdr_parameters.GetScreenWidth(), m_rdr_parameters.GetScreenHeight()));
+
+  printf("Started  -> Benchmark with %d configurations\n", job->GetNumberOfConfigurations());
+  bool all_evaluated = true;
+  int n_samples = 0;
+
+  std::vector<vis::CameraPath> camera_paths;
+  for (int i = 0; i < job->camera_paths.size(); i++)
+  {
+    vis::CameraPath path;
+    if (path.Read(GetOutputFilePath(job->camera_paths[i])))
+      camera_paths.push_back(path);
+    else
+      all_evaluated = false;
+  }
+
+  for (int i_dataset = 0; i_dataset < job->datasets.size(); i_dataset++)
+  {
+    std::chrono::steady_clock::time_point t_load = std::chrono::steady_clock::now();
+    if (!m_data_mgr.SetVolume(job->datasets[i_dataset]))
+    {
+      std::cout << "Error: Dataset \"" << job->datasets[i_dataset] << "\" not found." << std::endl;
+      all_evaluated = false;
+      continue;
+    }
+    double load_ms = GetElapsedMilliseconds(t_load);
+
+    for (int i_grad = 0; i_grad < gradients.size(); i_grad++)
+    {
+      // The gradient texture is part of the loaded data
+      std::chrono::steady_clock::time_point t_gradient = std::chrono::steady_clock::now();
+      if (!SetGradient(gradients[i_grad]))
+      {
+        std::cout << "Error: Gradient \"" << gradients[i_grad] << "\" not found." << std::endl;
+        all_evaluated = false;
+        continue;
+      }
+      double gradient_load_ms = load_ms + GetElapsedMilliseconds(t_gradient);
+
+      for (int i_tf = 0; i_tf < transfer_functions.size(); i_tf++)
+      {
+        if (!m_data_mgr.SetTransferFunction(transfer_functions[i_tf]))
+        {
+          std::cout << "Error: Transfer function \"" << transfer_functions[i_tf] << "\" not found." << std::endl;
+          all_evaluated = false;
+          continue;
+        }
+
+        for (int i_vr = 0; i_vr < job->renderers.size(); i_vr++)
+        {
+          BaseVolumeRenderer* volrend = FindVolumeRenderer(job->renderers[i_vr]);
+          if (volrend == nullptr || volrend->GetDataTypeSupport() != m_data_mgr.GetInputVolumeDataType())
+          {
+            std::cout << "Error: Renderer \"" << job->renderers[i_vr] << "\" not available for this dataset." << std::endl;
+            all_evaluated = false;
+            continue;
+          }
+
+          for (int i_res = 0; i_res < resolutions.size(); i_res++)
+          {
+            if (!SetScreenSize(resolutions[i_res].x, resolutions[i_res].y))
+            {
+              all_evaluated = false;
+              continue;
+            }
+
+            // Pre-processing of the renderer (SATs, light caches...) is part of the init time
+            std::chrono::steady_clock::time_point t_init = std::chrono::steady_clock::now();
+            bool built = false;
+            {
+              TRACE_SCOPE_DETAIL("InitRenderer", "render", volrend->GetName());
+              if (volrend->IsBuilt()) volrend->Clean();
+              built = volrend->Init(resolutions[i_res].x, resolutions[i_res].y);
+              glFinish();
+            }
+            double init_ms = GetElapsedMilliseconds(t_init);
+            if (!built)
+            {
+              std::cout << "Error: Unable to initialize renderer \"" << volrend->GetName() << "\"." << std::endl;
+              all_evaluated = false;
+              continue;
+            }
+
+            ParameterSpace pspace;
+            if (!SetupParameterSpace(job, volrend, &pspace))
+            {
+              all_evaluated = false;
+              volrend->Clean();
+              continue;
+            }
+
+            // Camera states first, then camera paths
+            for (int i_cam = 0; i_cam < camera_states.size() + camera_paths.size(); i_cam++)
+            {
+              vis::CameraPath* path = nullptr;
+              std::string camera_name;
+              vis::CameraData cam_data;
+              if (i_cam < camera_states.size())
+              {
+                camera_name = camera_states[i_cam];
+                vis::CameraData* state_data = FindCameraState(camera_name);
+                if (state_data == nullptr)
+                {
+                  std::cout << "Error: Camera state \"" << camera_name << "\" not found." << std::endl;
+                  all_evaluated = false;
+                  continue;
+                }
+                cam_data = *state_data;
+              }
+              else
+              {
+                path = &camera_paths[i_cam - camera_states.size()];
+                camera_name = "path:" + path->GetName();
+                cam_data = path->Evaluate(0.0);
+              }
+              m_rdr_parameters.GetCamera()->SetData(&cam_data);
+              m_rdr_parameters.GetCamera()->UpdateAspectRatio(float(resolutions[i_res].x), float(resolutions[i_res].y));
+
+              printf("  %s | %s | %s | %s | %s | %dx%d\n", volrend->GetName(), job->datasets[i_dataset].c_str(),
+                gradients[i_grad].c_str(), transfer_functions[i_tf].c_str(), camera_name.c_str(),
+                resolutions[i_res].x, resolutions[i_res].y);
+
+              // Without dimensions, a single sample with the default parameters
+              int sample = 0;
+              pspace.StartEvaluation();
+              do
+              {
+                std::vector<double> frame_times_ms;
+                if (path)
+                {
+                  MeasurePathFrames(job, volrend, path, &frame_times_ms);
+                  WritePathFrames(job, volrend, path, sample, frame_times_ms);
+                }
+                else
+                {
+                  MeasureFrames(job, volrend, &frame_times_ms);
+                }
+                WriteResult(job, volrend, camera_name, sample, &pspace, gradient_load_ms, init_ms, frame_times_ms);
+                sample++;
+                n_samples++;
+              } while (pspace.IncrEvaluation());
+              pspace.EndEvaluation();
+            }
+
+            volrend->Clean();
+          }
+        }
+      }
+    }
+  }
+
+  m_results_file.close();
+  if (m_frames_file.is_open()) m_frames_file.close();
+  printf("Finished -> Benchmark with %d sample points, results at %s\n", n_samples, job->output_filepath.c_str());
+
+  return all_evaluated;
+}
+
+BaseVolumeRenderer* BenchmarkRunner::FindVolumeRenderer (std::string name)
+{
+  for (int i = 0; i < m_vtr_vr_methods.size(); i++)
+  {
+    if (name.compare(m_vtr_vr_methods[i]->GetName()) == 0 ||
+        name.compare(m_vtr_vr_methods[i]->GetAbbreviationName()) == 0)
+      return m_vtr_vr_methods[i];
+  }
+  return nullptr;
+}
+
+bool BenchmarkRunner::SetGradient (std::string name)
+{
+  std::vector<std::string> g_list = m_data_mgr.GetGradientGenerationTypeStrList();
+  for (int i = 0; i < g_list.size(); i++)
+  {
+    if (name.compare(g_list[i]) == 0)
+    {
+      if (m_data_mgr.SetCurrentGradient(i))
+        m_data_mgr.UpdateStructuredGradientTexture();
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string BenchmarkRunner::GetCurrentGradientName ()
+{
+  int gradient_id = m_data_mgr.GetCurrentGradientGenerationTypeID();
+  if (gradient_id < 0) return "None";
+  return m_data_mgr.GetGradientGenerationTypeStrList()[gradient_id];
+}
+
+vis::CameraData* BenchmarkRunner::FindCameraState (std::string name)
+{
+  for (int i = 0; i < m_camera_state_list.NumberOfCameraStates(); i++)
+  {
+    if (name.compare(m_camera_state_list.GetCameraState(i)->cam_setup_name) == 0)
+      return m_camera_state_list.GetCameraState(i);
+  }
+  return nullptr;
+}
+
+bool BenchmarkRunner::SetupParameterSpace (BenchmarkJob* job, BaseVolumeRenderer* volrend, ParameterSpace* pspace)
+{
+  volrend->FillParameterSpace(*pspace);
+
+  if (job->parameter_space_mode == BenchmarkJob::PARAMETER_SPACE_MODE::PARAMETER_SPACE_NONE)
+  {
+    pspace->ClearParameterDimensions();
+    return true;
+  }
+
+  // Ranges of parameters that the renderer does not define are ignored,
+  //   since the job may list several renderers
+  std::vector<bool> listed(pspace->GetNumDimensions(), false);
+  for (int i = 0; i < job->parameter_ranges.size(); i++)
+  {
+    BenchmarkJob::ParameterRange& prange = job->parameter_ranges[i];
+    int idx = pspace->FindDimension(prange.name);
+    if (idx < 0) continue;
+
+    if (!pspace->GetDimension(idx)->SetRange(prange.start, prange.end, prange.incr))
+    {
+      std::cout << "Error: Invalid range for parameter \"" << prange.name << "\"." << std::endl;
+      return false;
+    }
+    listed[idx] = true;
+  }
+
+  if (job->parameter_space_mode == BenchmarkJob::PARAMETER_SPACE_MODE::PARAMETER_SPACE_LISTED)
+  {
+    for (int i = pspace->GetNumDimensions() - 1; i >= 0; i--)
+      if (!listed[i]) pspace->RemoveParameterDimension(i);
+  }
+
+  pspace->UpdateNumSamplePoints();
+  return true;
+}
+
+bool BenchmarkRunner::SetScreenSize (int w, int h)
+{
+  // The hidden window (if any) keeps its size: the frames are rendered into
+  //   m_screen_fbo, which the renderers also bind back after their own passes
+  if (m_screen_fbo == 0)
+  {
+    glGenFramebuffers(1, &m_screen_fbo);
+    glGenRenderbuffers(1, &m_screen_color_rbo);
+    glGenRenderbuffers(1, &m_screen_depth_stencil_rbo);
+  }
+  glBindRenderbuffer(GL_RENDERBUFFER, m_screen_color_rbo);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+  glBindRenderbuffer(GL_RENDERBUFFER, m_screen_depth_stencil_rbo);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+  glBindFramebuffer(GL_FRAMEBUFFER, m_screen_fbo);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_screen_color_rbo);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_screen_depth_stencil_rbo);
+  gl::FrameBufferObject::SetScreenFramebuffer(m_screen_fbo);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+  {
+    std::cout << "Error: Unable to create the " << w << "x" << h << " framebuffer." << std::endl;
+    return false;
+  }
+
+  glViewport(0, 0, w, h);
+  m_rdr_parameters.SetScreenSize(w, h);
+  m_rdr_parameters.GetCamera()->UpdateAspectRatio(float(w), float(h));
+  return true;
+}
+
+void BenchmarkRunner::RenderFrame (BaseVolumeRenderer* volrend)
+{
+  gl::GPUProfiler::Instance()->BeginFrame();
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+  // Every frame is rendered from scratch, as in the evaluation mode of the application
+  volrend->SetOutdated();
+  gl::GPUProfiler::Instance()->BeginScope("Update");
+  volrend->PrepareRender(m_rdr_parameters.GetCamera());
+  gl::GPUProfiler::Instance()->EndScope();
+
+  gl::GPUProfiler::Instance()->BeginScope("Render");
+  if (volrend->GetCurrentMultiScalingMode() == BaseVolumeRenderer::MULTIPLE_RAYS_PER_PIXEL)
+    volrend->MultiSampleRedraw();
+  else if (volrend->GetCurrentMultiScalingMode() == BaseVolumeRenderer::DOWN_SCALING_RENDER)
+    volrend->DownScalingRedraw();
+  else if (volrend->GetCurrentMultiScalingMode() == BaseVolumeRenderer::UP_SCALING_RENDER)
+    volrend->UpScalingRedraw();
+  else
+    volrend->Redraw();
+  gl::GPUProfiler::Instance()->EndScope();
+
+  gl::GPUProfiler::Instance()->EndFrame();
+}
+
+void BenchmarkRunner::MeasureFrames (BenchmarkJob* job, BaseVolumeRenderer* volrend, std::vector<double>* frame_times_ms)
+{
+  TRACE_SCOPE("MeasureFrames", "render");
+  for (int i = 0; i < job->warmup_frames; i++)
+    RenderFrame(volrend);
+  glFinish();
+  gl::GPUProfiler::Instance()->Flush();
+  gl::GPUProfiler::Instance()->ResetAccumulation();
+
+  // glFinish after each frame, so a frame is not hidden behind the next one
+  frame_times_ms->clear();
+  double measured_ms = 0.0;
+  while (frame_times_ms->size() < job->frames || measured_ms < job->min_time_ms)
+  {
+    std::chrono::steady_clock::time_point t_frame = std::chrono::steady_clock::now();
+    RenderFrame(volrend);
+    glFinish();
+    frame_times_ms->push_back(GetElapsedMilliseconds(t_frame));
+    measured_ms += frame_times_ms->back();
+  }
+  gl::GPUProfiler::Instance()->Flush();
+}
+
+void BenchmarkRunner::MeasurePathFrames (BenchmarkJob* job, BaseVolumeRenderer* volrend, vis::CameraPath* path,
+                                         std::vector<double>* frame_times_ms)
+{
+  TRACE_SCOPE_DETAIL("MeasurePathFrames", "render", path->GetName());
+  vis::CameraData cam_data = path->Evaluate(0.0);
+  m_rdr_parameters.GetCamera()->SetData(&cam_data);
+  for (int i = 0; i < job->warmup_frames; i++)
+    RenderFrame(volrend);
+  glFinish();
+  gl::GPUProfiler::Instance()->Flush();
+  gl::GPUProfiler::Instance()->ResetAccumulation();
+
+  // Frame i is always rendered at the same path time, whatever the frame rate
+  frame_times_ms->clear();
+  for (int i = 0; i < job->path_frames; i++)
+  {
+    cam_data = path->Evaluate(path->GetFrameTime(i, job->path_frames));
+    m_rdr_parameters.GetCamera()->SetData(&cam_data);
+
+    std::chrono::steady_clock::time_point t_frame = std::chrono::steady_clock::now();
+    RenderFrame(volrend);
+    glFinish();
+    frame_times_ms->push_back(GetElapsedMilliseconds(t_frame));
+  }
+  gl::GPUProfiler::Instance()->Flush();
+}
+
+std::string BenchmarkRunner::GetOutputFilePath (std::string filepath)
+{
+  if (std::filesystem::path(filepath).is_relative())
+    return m_path_to_data + filepath;
+  return filepath;
+}
+
+bool BenchmarkRunner::OpenResultsFile (std::string filepath)
+{
+  filepath = GetOutputFilePath(filepath);
+
+  if (std::filesystem::path(filepath).has_parent_path())
+    std::filesystem::create_directories(std::filesystem::path(filepath).parent_path());
+
+  m_results_file.open(filepath, std::ios_base::out);
+  if (!m_results_file.is_open())
+  {
+    std::cout << "Error: Unable to write benchmark results at " << filepath << "." << std::endl;
+    return false;
+  }
+
+  RunInfo run_info;
+  run_info.Collect();
+  run_info.Write(m_results_file);
+
+  m_results_file << "Renderer,Dataset,ContentHash,Gradient,TransferFunction,Camera,Width,Height,Sample,Parameters,"
+                 << "LoadTime (ms),InitTime (ms),Frames,TimePerFrame (ms),FramesPerSecond,"
+                 << FrameStatistics::GetCsvHeader() << ","
+                 << "GPUFrame (ms),GPUScopes (ms),GPUMemory (MB),GPUMemoryPeak (MB),GPUMemoryOwners (MB)\n";
+  return true;
+}
+
+bool BenchmarkRunner::OpenFramesFile (std::string filepath)
+{
+  filepath = GetOutputFilePath(filepath);
+
+  m_frames_file.open(filepath, std::ios_base::out);
+  if (!m_frames_file.is_open())
+  {
+    std::cout << "Error: Unable to write camera path frames at " << filepath << "." << std::endl;
+    return false;
+  }
+
+  RunInfo run_info;
+  run_info.Collect();
+  run_info.Write(m_frames_file);
+
+  m_frames_file << "Renderer,Dataset,Gradient,TransferFunction,Camera,Width,Height,Sample,Frame,PathTime (s),FrameTime (ms)\n";
+  return true;
+}
+
+void BenchmarkRunner::WriteResult (BenchmarkJob* job, BaseVolumeRenderer* volrend, std::string camera_name, int sample,
+                                   ParameterSpace* pspace, double load_ms, double init_ms,
+                                   std::vector<double>& frame_times_ms)
+{
+  FrameStatistics frame_stats;
+  frame_stats.Compute(frame_times_ms, job->max_cv);
+  const double time_per_frame = frame_stats.mean;
+
+  // "name=value;name=value", since each renderer has its own dimensions
+  std::string parameters = "";
+  for (int i = 0; i < pspace->GetNumDimensions(); i++)
+  {
+    if (i > 0) parameters.append(";");
+    parameters.append(pspace->GetDimensionName(i) + "=" + pspace->GetDimensionValue(i));
+  }
+
+  m_results_file << Quote(volrend->GetName()) << ","
+                 << Quote(m_data_mgr.GetCurrentVolumeName()) << ","
+                 << m_data_mgr.GetCurrentVolumeContentHash().ToString() << ","
+                 << Quote(GetCurrentGradientName()) << ","
+                 << Quote(m_data_mgr.GetCurrentTransferFunctionName()) << ","
+                 << Quote(camera_name) << ","
+                 << m_rdr_parameters.GetScreenWidth() << ","
+                 << m_rdr_parameters.GetScreenHeight() << ","
+                 << sample << ","
+                 << Quote(parameters) << ","
+                 << std::to_string(load_ms) << ","
+                 << std::to_string(init_ms) << ","
+                 << frame_times_ms.size() << ","
+                 << std::to_string(time_per_frame) << ","
+                 << std::to_string(1000.0 / time_per_frame) << ","
+                 << frame_stats.GetCsvValues() << ","
+                 << std::to_string(gl::GPUProfiler::Instance()->GetAccumulatedFrameMs()) << ","
+                 << Quote(gl::GPUProfiler::Instance()->GetAccumulatedResultsStr()) << ","
+                 << std::to_string((double)gl::GPUMemoryRegistry::Instance()->GetTotalBytes() / (1024.0 * 1024.0)) << ","
+                 << std::to_string((double)gl::GPUMemoryRegistry::Instance()->GetPeakBytes() / (1024.0 * 1024.0)) << ","
+                 << Quote(gl::GPUMemoryRegistry::Instance()->GetBytesPerOwnerStr()) << "\n";
+  m_results_file.flush();
+  // The peak of the next sample starts from the current allocations
+  gl::GPUMemoryRegistry::Instance()->ResetPeak();
+
+  if (frame_stats.unstable)
+    printf("    Warning: sample %d is unstable (stddev %.3f ms, mean %.3f ms, %d outliers)\n",
+      sample, frame_stats.filtered_stddev, frame_stats.filtered_mean, frame_stats.n_outliers);
+}
+
+void BenchmarkRunner::WritePathFrames (BenchmarkJob* job, BaseVolumeRenderer* volrend, vis::CameraPath* path, int sample,
+                                       std::vector<double>& frame_times_ms)
+{
+  // Columns identifying the configuration are the same for all frames
+  std::ostringstream config;
+  config << Quote(volrend->GetName()) << ","
+         << Quote(m_data_mgr.GetCurrentVolumeName()) << ","
+         << Quote(GetCurrentGradientName()) << ","
+         << Quote(m_data_mgr.GetCurrentTransferFunctionName()) << ","
+         << Quote("path:" + path->GetName()) << ","
+         << m_rdr_parameters.GetScreenWidth() << ","
+         << m_rdr_parameters.GetScreenHeight() << ","
+         << sample << ",";
+
+  for (int i = 0; i < frame_times_ms.size(); i++)
+  {
+    m_frames_file << config.str() << i << ","
+                  << std::to_string(path->GetFrameTime(i, job->path_frames)) << ","
+                  << std::to_string(frame_times_ms[i]) << "\n";
+  }
+  m_frames_file.flush();
+}
+
+double BenchmarkRunner::GetElapsedMilliseconds (std::chrono::steady_clock::time_point t0)
+{
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+std::string BenchmarkRunner::Quote (std::string str)
+{
+  std::string quoted = "\"";
+  for (int i = 0; i < str.size(); i++)
+  {
+    if (str[i] == '"') quoted.append("\"");
+    quoted.push_back(str[i]);
+  }
+  quoted.append("\"");
+  return quoted;
+}
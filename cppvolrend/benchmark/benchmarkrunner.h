@@ -0,0 +1,104 @@
+/**
+ * Headless benchmark runner (cppvolrend_bench).
+ *
+ * Runs every combination listed in a BenchmarkJob, without user interface:
+ *   for each dataset, gradient, transfer function, renderer, resolution and camera
+ *   state or camera path, the parameter space of the renderer is swept and
+ *   each sample point is rendered a fixed number of frames (or along the
+ *   camera path, see benchmarkjob.h). The renderers draw into
+ *   a framebuffer object of the benchmark resolution, so that the current GL
+ *   context needs no window of that size, or no window at all (see
+ *   main_bench.cpp).
+ *
+ * One line per sample point is written to a csv file, and one line per frame
+ *   of the camera paths to "<output>_frames.csv".
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef BENCHMARK_RUNNER_H
+#define BENCHMARK_RUNNER_H
+
+#include "../defines.h"
+#include "benchmarkjob.h"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <volvis_utils/datamanager.h>
+#include <volvis_utils/renderingparameters.h>
+#include <volvis_utils/camerapath.h>
+#include <volvis_utils/camerastatelist.h>
+#include <volvis_utils/lightsourcelist.h>
+
+#include "../utils/parameterspace.h"
+
+class BaseVolumeRenderer;
+
+class BenchmarkRunner
+{
+public:
+  BenchmarkRunner ();
+  ~BenchmarkRunner ();
+
+  void AddVolumeRenderer (BaseVolumeRenderer* volrend);
+
+  // Read datasets, transfer functions, camera states and light sources
+  void InitData (std::string path_to_data);
+
+  // Returns false if any item of the job could not be evaluated
+  bool Run (BenchmarkJob* job);
+
+protected:
+  BaseVolumeRenderer* FindVolumeRenderer (std::string name);
+  vis::CameraData* FindCameraState (std::string name);
+  // Name from DataManager::GetGradientGenerationTypeStrList, the texture is built if it changes
+  bool SetGradient (std::string name);
+  std::string GetCurrentGradientName ();
+
+  // Keep, override or drop the dimensions filled by the renderer
+  bool SetupParameterSpace (BenchmarkJob* job, BaseVolumeRenderer* volrend, ParameterSpace* pspace);
+
+  // Resizes the offscreen framebuffer, returns false if it is not complete
+  bool SetScreenSize (int w, int h);
+  void RenderFrame (BaseVolumeRenderer* volrend);
+  void MeasureFrames (BenchmarkJob* job, BaseVolumeRenderer* volrend, std::vector<double>* frame_times_ms);
+  // Plays the path in job->path_frames frames
+  void MeasurePathFrames (BenchmarkJob* job, BaseVolumeRenderer* volrend, vis::CameraPath* path,
+                          std::vector<double>* frame_times_ms);
+
+  // Relative paths are relative to the data folder
+  std::string GetOutputFilePath (std::string filepath);
+  bool OpenResultsFile (std::string filepath);
+  bool OpenFramesFile (std::string filepath);
+  void WriteResult (BenchmarkJob* job, BaseVolumeRenderer* volrend, std::string camera_name, int sample,
+                    ParameterSpace* pspace, double load_ms, double init_ms,
+                    std::vector<double>& frame_times_ms);
+  void WritePathFrames (BenchmarkJob* job, BaseVolumeRenderer* volrend, vis::CameraPath* path, int sample,
+                        std::vector<double>& frame_times_ms);
+
+  static double GetElapsedMilliseconds (std::chrono::steady_clock::time_point t0);
+  static std::string Quote (std::string str);
+
+  std::string m_path_to_data;
+
+  std::vector<BaseVolumeRenderer*> m_vtr_vr_methods;
+  vis::RenderingParameters m_rdr_parameters;
+  vis::CameraStateList m_camera_state_list;
+  vis::LightSourceList m_light_source_list;
+  vis::DataManager m_data_mgr;
+
+  std::ofstream m_results_file;
+  std::ofstream m_frames_file;
+
+  // Offscreen framebuffer used as screen by the renderers
+  GLuint m_screen_fbo;
+  GLuint m_screen_color_rbo;
+  GLuint m_screen_depth_stencil_rbo;
+
+private:
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "resultscomparison.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <map>
+
+ResultsComparison::ResultsComparison ()
+  : m_max_relative_slowdown(0.05)
+  , m_min_t(5.0)
+  , m_allow_unstable(false)
+{}
+
+ResultsComparison::~ResultsComparison ()
+{}
+
+void ResultsComparison::SetThresholds (double max_relative_slowdown, double min_t)
+{
+  m_max_relative_slowdown = max_relative_slowdown;
+  m_min_t = min_t;
+}
+
+void ResultsComparison::SetAllowUnstable (bool allow)
+{
+  m_allow_unstable = allow;
+}
+
+bool ResultsComparison::Compare (BenchmarkResults* base, BenchmarkResults* curr)
+{
+  entries.clear();
+  m_info_warnings.clear();
+
+  std::vector<std::string> key_names = GetKeyColumns(base);
+  if (base->FindColumn("TimePerFrame (ms)") < 0 || curr->FindColumn("TimePerFrame (ms)") < 0)
+  {
+    std::cout << "Error: Results files must have a \"TimePerFrame (ms)\" column." << std::endl;
+    return false;
+  }
+  if (key_names != GetKeyColumns(curr))
+  {
+    std::cout << "Error: Results files have different configuration columns." << std::endl;
+    return false;
+  }
+
+  // Runs on different machines or drivers are compared, but it is worth a warning
+  const char* info_keys[] = { "gl_renderer", "gl_version", "cpu" };
+  for (int i = 0; i < 3; i++)
+  {
+    if (base->GetInfo(info_keys[i]) != curr->GetInfo(info_keys[i]))
+      m_info_warnings.push_back(std::string(info_keys[i]) + " differs: \"" + base->GetInfo(info_keys[i])
+                                + "\" -> \"" + curr->GetInfo(info_keys[i]) + "\"");
+  }
+
+  std::vector<int> base_keys, curr_keys;
+  for (int i = 0; i < key_names.size(); i++)
+  {
+    base_keys.push_back(base->FindColumn(key_names[i]));
+    curr_keys.push_back(curr->FindColumn(key_names[i]));
+  }
+
+  std::map<std::string, int> curr_rows;
+  for (int r = 0; r < curr->rows.size(); r++)
+    curr_rows[GetConfiguration(curr, curr_keys, r)] = r;
+
+  BenchmarkResults* results[2] = { base, curr };
+  int c_mean[2], c_stddev[2], c_frames[2], c_unstable[2], c_hash[2];
+  for (int i = 0; i < 2; i++)
+  {
+    c_mean[i] = results[i]->FindColumn("TimePerFrame (ms)");
+    c_stddev[i] = results[i]->FindColumn("StdDevFrameTime (ms)");
+    c_frames[i] = results[i]->FindColumn("Frames");
+    c_unstable[i] = results[i]->FindColumn("Unstable");
+    c_hash[i] = results[i]->FindColumn("ContentHash");
+  }
+
+  for (int r = 0; r < base->rows.size(); r++)
+  {
+    Entry entry;
+    entry.configuration = GetConfiguration(base, base_keys, r);
+    entry.status = STATUS::UNCHANGED;
+    entry.base_ms = atof(base->rows[r][c_mean[0]].c_str());
+    entry.new_ms = 0.0;
+    entry.relative_diff = 0.0;
+    entry.t = 0.0;
+    entry.unstable = false;
+    entry.dataset_changed = false;
+
+    std::map<std::string, int>::iterator it = curr_rows.find(entry.configuration);
+    if (it == curr_rows.end())
+    {
+      entry.status = STATUS::MISSING;
+      entries.push_back(entry);
+      continue;
+    }
+
+    int row[2] = { r, it->second };
+    double mean[2], var_n[2];
+    bool unstable = false;
+    bool has_deviation = true;
+    for (int i = 0; i < 2; i++)
+    {
+      std::vector<std::string>& values = results[i]->rows[row[i]];
+      mean[i] = atof(values[c_mean[i]].c_str());
+      if (c_stddev[i] >= 0 && c_frames[i] >= 0 && atoi(values[c_frames[i]].c_str()) > 0)
+      {
+        double stddev = atof(values[c_stddev[i]].c_str());
+        var_n[i] = stddev * stddev / double(atoi(values[c_frames[i]].c_str()));
+      }
+      else
+        has_deviation = false;
+      if (c_unstable[i] >= 0 && atoi(values[c_unstable[i]].c_str()) != 0)
+        unstable = true;
+    }
+    if (c_hash[0] >= 0 && c_hash[1] >= 0)
+      entry.dataset_changed = base->rows[row[0]][c_hash[0]] != curr->rows[row[1]][c_hash[1]];
+
+    entry.unstable = unstable;
+    entry.new_ms = mean[1];
+    entry.relative_diff = mean[0] > 0.0 ? (mean[1] - mean[0]) / mean[0] : 0.0;
+
+    // Old results files have no deviation: only the relative threshold is used
+    if (!has_deviation)
+      entry.t = std::numeric_limits<double>::infinity();
+    else if (var_n[0] + var_n[1] > 0.0)
+      entry.t = std::abs(mean[1] - mean[0]) / std::sqrt(var_n[0] + var_n[1]);
+    else
+      entry.t = mean[1] != mean[0] ? std::numeric_limits<double>::infinity() : 0.0;
+
+    const bool significant = entry.t >= m_min_t;
+    if (significant && entry.relative_diff > m_max_relative_slowdown)
+      entry.status = unstable && m_allow_unstable ? STATUS::UNSTABLE : STATUS::REGRESSION;
+    else if (significant && entry.relative_diff < -m_max_relative_slowdown)
+      entry.status = unstable ? STATUS::UNSTABLE : STATUS::IMPROVEMENT;
+    else if (unstable)
+      entry.status = STATUS::UNSTABLE;
+
+    entries.push_back(entry);
+  }
+
+  return true;
+}
+
+void ResultsComparison::PrintReport (bool print_unchanged)
+{
+  const char* status_str[] = { "unchanged", "REGRESSION", "improvement", "unstable", "MISSING" };
+
+  for (int i = 0; i < m_info_warnings.size(); i++)
+    printf("Warning: %s\n", m_info_warnings[i].c_str());
+
+  for (int i = 0; i < entries.size(); i++)
+  {
+    Entry& e = entries[i];
+    if (e.status == STATUS::UNCHANGED && !print_unchanged) continue;
+
+    if (e.status == STATUS::MISSING)
+    {
+      printf("  %-11s %s\n", status_str[e.status], e.configuration.c_str());
+      continue;
+    }
+    printf("  %-11s %s: %.3f ms -> %.3f ms (%+.1f%%, t = %.1f)%s%s\n", status_str[e.status], e.configuration.c_str(),
+      e.base_ms, e.new_ms, e.relative_diff * 100.0, e.t, e.dataset_changed ? " [dataset changed]" : "",
+      e.unstable && e.status != STATUS::UNSTABLE ? " [unstable]" : "");
+  }
+
+  printf("%d configurations: %d regressions, %d improvements, %d unstable, %d missing\n", (int)entries.size(),
+    GetNumberOfEntries(STATUS::REGRESSION), GetNumberOfEntries(STATUS::IMPROVEMENT),
+    GetNumberOfEntries(STATUS::UNSTABLE), GetNumberOfEntries(STATUS::MISSING));
+}
+
+int ResultsComparison::GetNumberOfEntries (STATUS status)
+{
+  int n = 0;
+  for (int i = 0; i < entries.size(); i++)
+    if (entries[i].status == status) n++;
+  return n;
+}
+
+std::vector<std::string> ResultsComparison::GetKeyColumns (BenchmarkResults* results)
+{
+  std::vector<std::string> key_columns;
+  for (int i = 0; i < results->columns.size(); i++)
+  {
+    const std::string& name = results->columns[i];
+    if (name == "TimePerFrame (ms)") break;
+    if (name == "ContentHash" || name == "Sample" || name == "LoadTime (ms)" || name == "InitTime (ms)" || name == "Frames")
+      continue;
+    key_columns.push_back(name);
+  }
+  return key_columns;
+}
+
+std::string ResultsComparison::GetConfiguration (BenchmarkResults* results, std::vector<int>& key_columns, int row)
+{
+  std::string configuration = "";
+  for (int i = 0; i < key_columns.size(); i++)
+  {
+    if (i > 0) configuration.append(" | ");
+    configuration.append(results->rows[row][key_columns[i]]);
+  }
+  return configuration;
+}
@@ -0,0 +1,83 @@
+/**
+ * Comparison of two results files (cppvolrend_compare).
+ *
+ * Lines are matched by configuration: every column before "TimePerFrame (ms)",
+ *   except the ones that change between runs of the same configuration
+ *   (ContentHash, Sample, LoadTime, InitTime and Frames). In eval.csv files,
+ *   these are the parameter columns.
+ *
+ * A configuration is a regression if its mean frame time is slower than the
+ *   baseline by more than a relative threshold, and the difference is
+ *   significant: Welch's t statistic, from the mean, standard deviation and
+ *   number of frames of both runs, must be above a minimum value. Consecutive
+ *   frame times are not independent, so t is only used as a noise filter
+ *   (the default minimum is high) and not as a p-value.
+ *   A significant slowdown of an unstable sample (see utils/framestatistics.h)
+ *   is still a regression, unless unstable samples are allowed: then, as the
+ *   other unstable samples, it is only reported.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef BENCHMARK_RESULTS_COMPARISON_H
+#define BENCHMARK_RESULTS_COMPARISON_H
+
+#include "benchmarkresults.h"
+
+#include <string>
+#include <vector>
+
+class ResultsComparison
+{
+public:
+  enum STATUS : unsigned int {
+    UNCHANGED   = 0,
+    REGRESSION  = 1,
+    IMPROVEMENT = 2,
+    UNSTABLE    = 3,
+    MISSING     = 4,
+  };
+
+  class Entry
+  {
+  public:
+    std::string configuration;
+    STATUS status;
+    double base_ms, new_ms;
+    double relative_diff;
+    double t;
+    bool unstable;
+    bool dataset_changed;
+  };
+
+  ResultsComparison ();
+  ~ResultsComparison ();
+
+  // Relative slowdown (e.g. 0.05 for 5%) and minimum t of a regression
+  void SetThresholds (double max_relative_slowdown, double min_t);
+  // Unstable slowdowns are reported as UNSTABLE instead of REGRESSION
+  void SetAllowUnstable (bool allow);
+
+  // Returns false if the files can not be compared
+  bool Compare (BenchmarkResults* base, BenchmarkResults* curr);
+
+  void PrintReport (bool print_unchanged);
+
+  int GetNumberOfEntries (STATUS status);
+
+  std::vector<Entry> entries;
+
+protected:
+  std::vector<std::string> GetKeyColumns (BenchmarkResults* results);
+  std::string GetConfiguration (BenchmarkResults* results, std::vector<int>& key_columns, int row);
+
+  double m_max_relative_slowdown;
+  double m_min_t;
+  bool m_allow_unstable;
+
+  std::vector<std::string> m_info_warnings;
+
+private:
+};
+
+#endif
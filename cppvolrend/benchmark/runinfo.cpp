@@ -0,0 +1,105 @@
+#include "runinfo.h"
+#include "../defines.h"
+
+// generated at build time (cppvolrend/buildid.cmake)
+#include <buildid.h>
+
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+RunInfo::RunInfo ()
+{
+  m_entries.clear();
+}
+
+RunInfo::~RunInfo ()
+{
+  m_entries.clear();
+}
+
+void RunInfo::Collect ()
+{
+  std::time_t t = std::time(nullptr);
+  std::tm tm = *std::localtime(&t);
+  std::ostringstream date;
+  date << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
+
+  const GLubyte* gl_vendor = glGetString(GL_VENDOR);
+  const GLubyte* gl_renderer = glGetString(GL_RENDERER);
+  const GLubyte* gl_version = glGetString(GL_VERSION);
+
+  Set("build", CPPVOLREND_BUILD_ID);
+  Set("date", date.str());
+  Set("gl_vendor", gl_vendor ? (const char*)gl_vendor : "unknown");
+  Set("gl_renderer", gl_renderer ? (const char*)gl_renderer : "unknown");
+  Set("gl_version", gl_version ? (const char*)gl_version : "unknown");
+  Set("cpu", GetCpuName());
+  Set("cpu_threads", std::to_string(std::thread::hardware_concurrency()));
+}
+
+void RunInfo::Set (std::string key, std::string value)
+{
+  // Values are written in a single line
+  for (int i = 0; i < value.size(); i++)
+    if (value[i] == '\n' || value[i] == '\r') value[i] = ' ';
+
+  for (int i = 0; i < m_entries.size(); i++)
+  {
+    if (m_entries[i].first == key)
+    {
+      m_entries[i].second = value;
+      return;
+    }
+  }
+  m_entries.push_back(std::make_pair(key, value));
+}
+
+void RunInfo::Write (std::ostream& out)
+{
+  out << "#" << RESULTS_FORMAT_KEY << " " << RESULTS_FORMAT_VERSION << "\n";
+  for (int i = 0; i < m_entries.size(); i++)
+    out << "#" << m_entries[i].first << " " << m_entries[i].second << "\n";
+}
+
+std::string RunInfo::GetCpuName ()
+{
+  // Processor brand string, cpuid leaves 0x80000002 to 0x80000004
+  char brand[49];
+  memset(brand, 0, sizeof(brand));
+#if defined(_MSC_VER)
+  int regs[4];
+  __cpuid(regs, 0x80000000);
+  if ((unsigned int)regs[0] >= 0x80000004)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      __cpuid(regs, 0x80000002 + i);
+      memcpy(brand + 16 * i, regs, 16);
+    }
+  }
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  unsigned int regs[4];
+  if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      __get_cpuid(0x80000002 + i, &regs[0], &regs[1], &regs[2], &regs[3]);
+      memcpy(brand + 16 * i, regs, 16);
+    }
+  }
+#endif
+
+  std::string name(brand);
+  size_t first = name.find_first_not_of(' ');
+  if (first == std::string::npos) return "unknown";
+  return name.substr(first, name.find_last_not_of(' ') - first + 1);
+}
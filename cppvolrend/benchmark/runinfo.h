@@ -0,0 +1,53 @@
+/**
+ * Description of the run that produced a results file.
+ *
+ * Results files (eval.csv of the application and the output of cppvolrend_bench)
+ *   start with "#<key> <value>" lines, followed by the csv header and one line
+ *   per sample point. The first line is always the format version:
+ *
+ * #cppvolrend_results 2
+ * #build              <git revision at configure time>
+ * #date               <start of the run>
+ * #gl_vendor, #gl_renderer, #gl_version
+ * #cpu, #cpu_threads
+ *
+ *   plus the keys set by the caller (e.g. renderer and dataset of an evaluation
+ *   in the application). With pandas, the file is read with comment='#'.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef BENCHMARK_RUN_INFO_H
+#define BENCHMARK_RUN_INFO_H
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define RESULTS_FORMAT_KEY "cppvolrend_results"
+#define RESULTS_FORMAT_VERSION "2"
+
+class RunInfo
+{
+public:
+  RunInfo ();
+  ~RunInfo ();
+
+  // Build, date, gl driver and cpu (a GL context must be current)
+  void Collect ();
+
+  void Set (std::string key, std::string value);
+
+  // "#key value" lines, format version first
+  void Write (std::ostream& out);
+
+  static std::string GetCpuName ();
+
+protected:
+  std::vector<std::pair<std::string, std::string>> m_entries;
+
+private:
+};
+
+#endif
@@ -0,0 +1,15 @@
+# Writes the build id header (git revision of the sources) at build time,
+#   run with: cmake -DSOURCE_DIR=<repo> -DINPUT=<buildid.h.in> -DOUTPUT=<buildid.h> -P buildid.cmake
+# configure_file only touches OUTPUT when the revision changes, so the
+#   files that include it are not rebuilt every time.
+find_package(Git QUIET)
+if (GIT_FOUND)
+  execute_process(COMMAND ${GIT_EXECUTABLE} describe --always --dirty
+                  WORKING_DIRECTORY ${SOURCE_DIR}
+                  OUTPUT_VARIABLE CPPVOLREND_BUILD_ID
+                  OUTPUT_STRIP_TRAILING_WHITESPACE ERROR_QUIET)
+endif()
+if (NOT CPPVOLREND_BUILD_ID)
+  set(CPPVOLREND_BUILD_ID unknown)
+endif()
+configure_file(${INPUT} ${OUTPUT} @ONLY)
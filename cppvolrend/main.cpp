@@ -15,6 +15,8 @@
 #include <glm/glm.hpp>
 
 #include <math_utils/utils.h>
+#include <gl_utils/tracer.h>
+#include <gl_utils/programbinarycache.h>
 #include <glm/gtc/type_ptr.hpp>
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------------
@@ -47,8 +49,16 @@ float k (float x) {
 
 int main (int argc, char **argv)
 {
+  // Trace from the start, so the trace shows the time to the first frame
+  if (getenv("CPPVOLREND_TRACE")) gl::Tracer::Start(getenv("CPPVOLREND_TRACE"));
+  gl::Tracer::SetThreadName("Main");
+
   if (!app.Init(argc, argv)) return 1;
 
+  // Linked shader programs are cached on disk, unless CPPVOLREND_NO_SHADER_CACHE is set
+  if (!getenv("CPPVOLREND_NO_SHADER_CACHE"))
+    gl::ProgramBinaryCache::Instance()->SetDirectory(std::string(CPPVOLREND_DATA_DIR) + "shader_cache");
+
   RenderingManager::Instance()->InitGL();
 
   // Adding the rendering modes
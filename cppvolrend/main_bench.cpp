@@ -0,0 +1,217 @@
+/**
+ * C++ Volume Rendering Benchmark (headless)
+ *
+ * Usage: cppvolrend_bench <job file> [-o <results file>] [-trace <trace file>]
+ *
+ * Runs the cross product described in the job file (see benchmark/benchmarkjob.h)
+ *   and writes the results as csv. The frames are rendered into a framebuffer
+ *   object of each benchmark resolution (see benchmark/benchmarkrunner.h), the
+ *   GL context comes from EGL when built with CPPVOLREND_BENCH_EGL (surfaceless
+ *   or pbuffer, no display server needed), or else from a hidden window.
+ *   Returns a non zero exit code if any item of the job could not be evaluated.
+ *   With -trace (or the CPPVOLREND_TRACE environment variable), loading and
+ *   pre-processing stages are written as a Chrome trace (see gl_utils/tracer.h).
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#include "defines.h"
+#include "volrenderbase.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#ifdef USING_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <gl_utils/tracer.h>
+#include <gl_utils/programbinarycache.h>
+
+#include "benchmark/benchmarkjob.h"
+#include "benchmark/benchmarkrunner.h"
+
+//-----------------------------------------------------------------------------------------------------------------------------------------------------------------
+#include "volrendernull.h"
+// 1-pass - Ray Casting - GLSL
+#include "structured/rc1pass/rc1prenderer.h"
+#include "structured/rc1pcrtgt/crtgtrenderer.h"
+#include "structured/rc1pdosct/dosrcrenderer.h"
+#include "structured/rc1pextbsd/ebsrenderer.h"
+#include "structured/rc1pvctsg/vctrenderer.h"
+// Slice based
+#include "structured/sbtmdos/sbtmdosrenderer.h"
+//-----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+// Size of the hidden window, not of the rendered frames
+#define BENCHMARK_CONTEXT_WIDTH 64
+#define BENCHMARK_CONTEXT_HEIGHT 64
+
+#ifdef USING_EGL
+// Compatibility profile context, as the default one of freeglut and GLFW,
+//   with no surface if EGL_KHR_surfaceless_context is available, or else a 1x1 pbuffer.
+//   The surfaceless platform of Mesa is used when available, so that
+//   EGL_DEFAULT_DISPLAY does not open an X display.
+bool CreateEGLContext ()
+{
+  EGLDisplay display = EGL_NO_DISPLAY;
+  const char* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+  if (client_extensions && strstr(client_extensions, "EGL_MESA_platform_surfaceless"))
+  {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+      (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (get_platform_display)
+      display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+  }
+  if (display == EGL_NO_DISPLAY)
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+  EGLint major, minor;
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+  {
+    printf("Error: Unable to initialize EGL.\n");
+    return false;
+  }
+  if (!eglBindAPI(EGL_OPENGL_API))
+  {
+    printf("Error: EGL %d.%d does not support OpenGL.\n", major, minor);
+    return false;
+  }
+
+  const char* display_extensions = eglQueryString(display, EGL_EXTENSIONS);
+  bool surfaceless = display_extensions && strstr(display_extensions, "EGL_KHR_surfaceless_context");
+
+  EGLint config_attribs[] = {
+    EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+    EGL_NONE
+  };
+  EGLConfig config;
+  EGLint num_configs = 0;
+  if (!eglChooseConfig(display, config_attribs, &config, 1, &num_configs) || num_configs == 0)
+  {
+    printf("Error: No EGL config with OpenGL support.\n");
+    return false;
+  }
+
+  EGLSurface surface = EGL_NO_SURFACE;
+  if (!surfaceless)
+  {
+    EGLint pbuffer_attribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+    surface = eglCreatePbufferSurface(display, config, pbuffer_attribs);
+    if (surface == EGL_NO_SURFACE)
+    {
+      printf("Error: Unable to create the EGL pbuffer.\n");
+      return false;
+    }
+  }
+
+  EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, NULL);
+  if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, surface, surface, context))
+  {
+    printf("Error: Unable to create the EGL context.\n");
+    return false;
+  }
+  return true;
+}
+#endif
+
+// Without EGL, the window is never shown: it only provides the GL context
+bool CreateHiddenGLContext (int argc, char** argv)
+{
+#ifdef USING_EGL
+  if (!CreateEGLContext()) return false;
+#else
+#ifdef USING_FREEGLUT
+  glutInit(&argc, argv);
+  glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGBA | GLUT_DEPTH | GLUT_STENCIL | GLUT_ALPHA);
+  glutInitWindowSize(BENCHMARK_CONTEXT_WIDTH, BENCHMARK_CONTEXT_HEIGHT);
+  glutCreateWindow("CppVolRend [Benchmark]");
+  glutHideWindow();
+#else
+#ifdef USING_GLFW
+  if (!glfwInit()) return false;
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+  GLFWwindow* window = glfwCreateWindow(BENCHMARK_CONTEXT_WIDTH, BENCHMARK_CONTEXT_HEIGHT,
+                                        "CppVolRend [Benchmark]", NULL, NULL);
+  if (window == NULL) return false;
+  glfwMakeContextCurrent(window);
+#endif
+#endif
+#endif
+
+  GLenum glew_status = glewInit();
+#ifdef USING_EGL
+  // The GL entry points are loaded before glew looks for a GLX display
+  if (glew_status == GLEW_ERROR_NO_GLX_DISPLAY) glew_status = GLEW_OK;
+#endif
+  if (glew_status != GLEW_OK)
+  {
+    printf("Glew didn't initialized!\n");
+    return false;
+  }
+  printf("Running OpenGL %s [%s]\n\n", glGetString(GL_VERSION), glGetString(GL_RENDERER));
+
+  glEnable(GL_DEPTH_TEST);
+  glEnable(GL_CULL_FACE);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+  glClearColor(1.0f, 1.0f, 1.0f, 0.0f);
+
+  return true;
+}
+
+int main (int argc, char **argv)
+{
+  if (argc < 2)
+  {
+    printf("Usage: cppvolrend_bench <job file> [-o <results file>] [-trace <trace file>]\n");
+    return EXIT_FAILURE;
+  }
+
+  std::string trace_filepath = getenv("CPPVOLREND_TRACE") ? getenv("CPPVOLREND_TRACE") : "";
+
+  BenchmarkJob job;
+  if (!job.ReadJobFile(argv[1])) return EXIT_FAILURE;
+  for (int i = 2; i + 1 < argc; i++)
+  {
+    if (std::string(argv[i]) == "-o")
+      job.output_filepath = argv[++i];
+    else if (std::string(argv[i]) == "-trace")
+      trace_filepath = argv[++i];
+  }
+
+  if (!trace_filepath.empty()) gl::Tracer::Start(trace_filepath);
+  gl::Tracer::SetThreadName("Main");
+
+  if (!CreateHiddenGLContext(argc, argv)) return EXIT_FAILURE;
+
+  // Linked shader programs are cached on disk, unless CPPVOLREND_NO_SHADER_CACHE is set
+  if (!getenv("CPPVOLREND_NO_SHADER_CACHE"))
+    gl::ProgramBinaryCache::Instance()->SetDirectory(MAKE_STR(CMAKE_PATH_TO_DATA_FOLDER) + std::string("shader_cache"));
+
+  BenchmarkRunner bench;
+  bench.AddVolumeRenderer(new NullRenderer());
+  //-----------------------------------------------------------------------------------------------------------------------------------------------------------------
+  // 1-pass - Ray Casting - GLSL
+  bench.AddVolumeRenderer(new RayCasting1Pass());
+  bench.AddVolumeRenderer(new RC1PConeLightGroundTruthSteps());
+  bench.AddVolumeRenderer(new RC1PConeTracingDirOcclusionShading());
+  bench.AddVolumeRenderer(new RC1PExtinctionBasedShading());
+  bench.AddVolumeRenderer(new RC1PVoxelConeTracingSGPU());
+  //-----------------------------------------------------------------------------------------------------------------------------------------------------------------
+  // Slice based
+  bench.AddVolumeRenderer(new SBTMDirectionalOcclusionShading());
+  //-----------------------------------------------------------------------------------------------------------------------------------------------------------------
+
+  bench.InitData(MAKE_STR(CMAKE_PATH_TO_DATA_FOLDER));
+
+  bool all_evaluated = bench.Run(&job);
+  gl::Tracer::Stop();
+
+  return all_evaluated ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,75 @@
+/**
+ * C++ Volume Rendering Results Comparison
+ *
+ * Usage: cppvolrend_compare <baseline results> <new results> [-t <max slowdown %>] [-z <min t>] [-a]
+ *                                                                 [--allow-unstable]
+ *
+ * Compares two results files (eval.csv or cppvolrend_bench output) configuration
+ *   by configuration, see benchmark/resultscomparison.h. "-a" also lists the
+ *   unchanged configurations. "--allow-unstable" does not count significant
+ *   slowdowns of unstable samples as regressions.
+ *
+ * Exit codes: 0 if no regression, 1 if any configuration is slower (unstable
+ *   or not) or missing in the new results, 2 if the files could not be compared.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "benchmark/benchmarkresults.h"
+#include "benchmark/resultscomparison.h"
+
+#define COMPARE_EXIT_REGRESSION 1
+#define COMPARE_EXIT_ERROR 2
+
+int main (int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    printf("Usage: cppvolrend_compare <baseline results> <new results> [-t <max slowdown %%>] [-z <min t>] [-a] [--allow-unstable]\n");
+    return COMPARE_EXIT_ERROR;
+  }
+
+  double max_slowdown_percent = 5.0;
+  double min_t = 5.0;
+  bool print_unchanged = false;
+  bool allow_unstable = false;
+  for (int i = 3; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "-t" && i + 1 < argc)
+      max_slowdown_percent = atof(argv[++i]);
+    else if (arg == "-z" && i + 1 < argc)
+      min_t = atof(argv[++i]);
+    else if (arg == "-a")
+      print_unchanged = true;
+    else if (arg == "--allow-unstable")
+      allow_unstable = true;
+    else
+    {
+      printf("Unknown option %s\n", argv[i]);
+      return COMPARE_EXIT_ERROR;
+    }
+  }
+
+  BenchmarkResults base_results, new_results;
+  if (!base_results.ReadFile(argv[1])) return COMPARE_EXIT_ERROR;
+  if (!new_results.ReadFile(argv[2])) return COMPARE_EXIT_ERROR;
+
+  printf("Baseline: %s (build %s)\n", argv[1], base_results.GetInfo("build").c_str());
+  printf("New:      %s (build %s)\n", argv[2], new_results.GetInfo("build").c_str());
+
+  ResultsComparison comparison;
+  comparison.SetThresholds(max_slowdown_percent / 100.0, min_t);
+  comparison.SetAllowUnstable(allow_unstable);
+  if (!comparison.Compare(&base_results, &new_results)) return COMPARE_EXIT_ERROR;
+  comparison.PrintReport(print_unchanged);
+
+  if (comparison.GetNumberOfEntries(ResultsComparison::STATUS::REGRESSION) > 0 ||
+      comparison.GetNumberOfEntries(ResultsComparison::STATUS::MISSING) > 0)
+    return COMPARE_EXIT_REGRESSION;
+  return EXIT_SUCCESS;
+}
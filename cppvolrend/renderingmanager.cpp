@@ -5,7 +5,13 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include "volrenderbase.h"
+#include "utils/framestatistics.h"
+#include "benchmark/runinfo.h"
 #include <gl_utils/framebufferobject.h>
+#include <gl_utils/gpumemoryregistry.h>
+#include <gl_utils/gpuprofiler.h>
+#include <gl_utils/programbinarycache.h>
+#include <gl_utils/tracer.h>
 
 #include <volvis_utils/transferfunction1d.h>
 
@@ -24,6 +30,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 #include <chrono>
@@ -36,6 +43,7 @@
 #define RENDERING_MANAGER_MIN_VIEWPORT_SIZE 32
 #define RENDERING_MANAGER_MAX_VIEWPORT_SIZE 8192
 #define RENDERING_MANAGER_TIME_PER_FPS_COUNT_MS 5000.0
+#define RENDERING_MANAGER_CAMERA_PATH_RECORD_INTERVAL_S (1.0 / 30.0)
 
 #define WHITE_BACKGROUND
 
@@ -114,6 +122,11 @@ void RenderingManager::InitGL()
   int max;
   glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max);
   //std::cout << max << std::endl;
+
+  // The default gpu memory budget leaves headroom below the dedicated video memory
+  gl::GPUMemoryRegistry::Instance()->SetBudget(gl::GPUMemoryRegistry::GetDefaultBudget());
+  m_gpu_memory_budget_mb = (int)(gl::GPUMemoryRegistry::Instance()->GetBudget() >> 20);
+  gl::GPUMemoryRegistry::Instance()->AddEvictionCallback(RenderingManager::EvictWarmRenderer, this);
 }
 
 void RenderingManager::AddVolumeRenderer (BaseVolumeRenderer* bvolrend)
@@ -137,6 +150,7 @@ void RenderingManager::InitData ()
     m_std_cam_state_names.push_back(m_camera_state_list.GetCameraState(i)->cam_setup_name);
   m_current_camera_state_id = 0;
   curr_rdr_parameters.GetCamera()->SetData(m_camera_state_list.GetCameraState(m_current_camera_state_id));
+  ListCameraPathFiles();
 
   // Read light source lists
   std::string path_data_folder2(MAKE_STR(CMAKE_PATH_TO_DATA_FOLDER));
@@ -174,7 +188,7 @@ void RenderingManager::InitData ()
 void RenderingManager::Display ()
 {
   //We always redraw during evaluation
-  if (m_eval_running)
+  if (m_eval_running || m_campath_benchmark)
   {
     curr_vol_renderer->SetOutdated();
   }
@@ -193,26 +207,52 @@ void RenderingManager::Display ()
   // Build ImgGui interface
   if (m_imgui_render_ui) SetImGuiInterface();
 
+  gl::GPUProfiler::Instance()->BeginFrame();
+
+  // The first frame after a change of renderer or data is traced until the gpu is done
+  const bool trace_first_frame = m_trace_first_frame && gl::Tracer::IsEnabled();
+  const long long ts_frame = trace_first_frame ? gl::Tracer::GetTimestamp() : 0;
+
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
   // Render Function
   if (curr_vol_renderer && curr_vol_renderer->IsBuilt())
   {
+    gl::GPUProfiler::Instance()->BeginScope("Update");
     curr_vol_renderer->PrepareRender(curr_rdr_parameters.GetCamera());
+    gl::GPUProfiler::Instance()->EndScope();
 
+    gl::GPUProfiler::Instance()->BeginScope("Render");
 #ifdef MULTISAMPLE_AVAILABLE
     f_render[curr_vol_renderer->GetCurrentMultiScalingMode()](this);
 #else
     curr_vol_renderer->Redraw();
 #endif
+    gl::GPUProfiler::Instance()->EndScope();
   }
 
-  // If we must capture a screenshot
+  if (trace_first_frame)
+  {
+    glFinish();
+    gl::Tracer::AddCompleteEvent("FirstFrame", "render", ts_frame, gl::Tracer::GetTimestamp(), nullptr);
+    gl::Tracer::AddInstantEvent("FirstFrameReady", "render");
+  }
+  m_trace_first_frame = false;
+
+  // If we must capture a screenshot: rendered image only, before the ui is drawn
+  //   and the buffers are swapped
   if (curr_rdr_parameters.TakeScreenshot())
     SaveScreenshot();
 
   // Render the current ImGui interface
-  if (m_imgui_render_ui) DrawImGuiInterface();
+  if (m_imgui_render_ui)
+  {
+    gl::GPUProfiler::Instance()->BeginScope("UI");
+    DrawImGuiInterface();
+    gl::GPUProfiler::Instance()->EndScope();
+  }
+
+  gl::GPUProfiler::Instance()->EndFrame();
 
 #ifdef USING_FREEGLUT
   // Swap buffer
@@ -222,6 +262,9 @@ void RenderingManager::Display ()
   f_swapbuffer(d_swapbuffer);
 #endif
 #endif
+
+  // Write the screenshots whose readback is done
+  m_screenshot_capture.Update();
   
   // If camera is rotating
   if (animate_camera_rotation)
@@ -258,22 +301,69 @@ void RenderingManager::Display ()
     curr_vol_renderer->SetOutdated();
   }
 
+  UpdateCameraPath();
+
   if (m_eval_running)
   {
+    //Wait for the frame to finish, so each frame time is measured on its own
+    glFinish();
+    const std::chrono::steady_clock::time_point frame_end_time = std::chrono::steady_clock::now();
+
     //We shoot a number of frames for each evaluation sample
     m_eval_currframe++; //go to the next frame
-    if (m_eval_currframe >= m_eval_numframes)
+    if (m_eval_currframe <= m_eval_warmupframes)
+    {
+      //Warmup frames absorb shader rebuilds and pre-processing after a parameter change
+      if (m_eval_currframe == m_eval_warmupframes)
+      {
+        gl::GPUProfiler::Instance()->Flush();
+        gl::GPUProfiler::Instance()->ResetAccumulation();
+      }
+    }
+    else
+    {
+      m_eval_frametimes.push_back(std::chrono::duration<double, std::milli>(frame_end_time - m_eval_lastframe_time).count());
+      m_eval_measuredtime += m_eval_frametimes.back();
+    }
+    m_eval_lastframe_time = frame_end_time;
+
+    //... until both the number of frames and the time budget are reached
+    if (m_eval_frametimes.size() >= m_eval_numframes && m_eval_measuredtime >= m_eval_mintime_ms)
     {
       //Compute the rendering speed for that sample point
-      const double currenttime = GetCurrentRenderTime();
-      const double time_per_frame = (currenttime - m_eval_lasttime) / m_eval_numframes;
+      FrameStatistics frame_stats;
+      frame_stats.Compute(m_eval_frametimes, m_eval_max_cv);
+      const double time_per_frame = frame_stats.mean;
       const double frames_per_second = 1000.0 / time_per_frame;
+      if (frame_stats.unstable)
+      {
+        printf("Warning: evaluation sample %d is unstable (stddev %.3f ms, mean %.3f ms, %d outliers)\n",
+          m_eval_currsample, frame_stats.filtered_stddev, frame_stats.filtered_mean, frame_stats.n_outliers);
+      }
+
+      //Read back the gpu timings of the frames still in flight
+      gl::GPUProfiler::Instance()->Flush();
+      const double gpu_time_per_frame = gl::GPUProfiler::Instance()->GetAccumulatedFrameMs();
+      const std::string gpu_scopes = gl::GPUProfiler::Instance()->GetAccumulatedResultsStr();
+      gl::GPUProfiler::Instance()->ResetAccumulation();
+      const double gpu_memory_mb = (double)gl::GPUMemoryRegistry::Instance()->GetTotalBytes() / (1024.0 * 1024.0);
+      const double gpu_memory_peak_mb = (double)gl::GPUMemoryRegistry::Instance()->GetPeakBytes() / (1024.0 * 1024.0);
+      const std::string gpu_memory_owners = gl::GPUMemoryRegistry::Instance()->GetBytesPerOwnerStr();
+      gl::GPUMemoryRegistry::Instance()->ResetPeak();
 
       //Save the last rendered image
       std::string imagefilename = std::to_string(m_eval_currsample);
       size_t n_zero = 4;
       imagefilename = std::string(n_zero - std::min(n_zero, imagefilename.length()), '0') + imagefilename + ".png";
-      SaveScreenshot(m_eval_imgdirectory + "/" + imagefilename);
+      //Quality of the last rendered image against the reference image
+      ImageMetrics image_metrics;
+      if (m_eval_image_metrics && !ComputeImageMetrics(&image_metrics))
+        printf("Warning: evaluation sample %d has a different size than the reference image\n", m_eval_currsample);
+
+      if (m_eval_capture_renderer_output)
+        SaveRendererOutput(m_eval_imgdirectory + "/" + imagefilename);
+      else
+        SaveScreenshot(m_eval_imgdirectory + "/" + imagefilename, GL_FRONT); // the buffers are already swapped
 
       //Store evaluation results in csv file
       for(int i=0;i<m_eval_paramspace.GetNumDimensions();i++)
@@ -282,25 +372,42 @@ void RenderingManager::Display ()
       }
       m_eval_csvfile << std::to_string(time_per_frame) << ","
                      << std::to_string(frames_per_second) << ","
-                     << "\"" << imagefilename << "\"\n";
-
-
-      //We go to the next sample point in the parameter space.
-      if (m_eval_paramspace.IncrEvaluation())
+                     << frame_stats.n_frames << ","
+                     << frame_stats.GetCsvValues() << ","
+                     << std::to_string(gpu_time_per_frame) << ","
+                     << "\"" << gpu_scopes << "\","
+                     << std::to_string(gpu_memory_mb) << ","
+                     << std::to_string(gpu_memory_peak_mb) << ","
+                     << "\"" << gpu_memory_owners << "\",";
+      if (m_eval_image_metrics)
+        m_eval_csvfile << image_metrics.GetCsvValues() << ",";
+      m_eval_csvfile << "\"" << imagefilename << "\"\n";
+
+
+      //We go to the next sample point in the parameter space, or to the next point of the search.
+      const bool next_sample = m_eval_tuning ? m_tuner.Next(time_per_frame, image_metrics)
+                                             : m_eval_paramspace.IncrEvaluation();
+      if (next_sample)
       {
         //The ID of the new sample point
         m_eval_currsample++;
         //... and we shoot as many frames there as for the other samples.
         m_eval_currframe = 0;
+        m_eval_frametimes.clear();
+        m_eval_measuredtime = 0.0;
         //Restart time taking
-        m_eval_lasttime = GetCurrentRenderTime();
+        m_eval_lastframe_time = std::chrono::steady_clock::now();
       }
       else
       {
         //We reached the end of the evaluation.
-        m_eval_paramspace.EndEvaluation();
+        if (m_eval_tuning)
+          FinishTuning();
+        else
+          m_eval_paramspace.EndEvaluation();
         m_eval_running = false;
         m_eval_csvfile.close();
+        gl::GPUProfiler::Instance()->SetEnabled(m_imgui_gpu_profiler);
         //Enable or disable vsync according to user prefs
         if (m_vsync)
         {
@@ -316,6 +423,13 @@ void RenderingManager::Display ()
     }
   }
 
+  // The first volume is loaded once the first frame (and the ui) is on screen
+  if (m_data_mgr.IsVolumeLoadPending())
+  {
+    m_data_mgr.LoadPendingVolume();
+    UpdateDataAndResetCurrentVRMode();
+    PostRedisplay();
+  }
 }
 
 void RenderingManager::Reshape (int w, int h)
@@ -371,11 +485,19 @@ void RenderingManager::MouseMotion (int x, int y)
 
 void RenderingManager::CloseFunc ()
 {
+  m_screenshot_capture.Destroy();
+
   gl::PipelineShader::Unbind();
   gl::ArrayObject::Unbind();
 
   for (int i = m_vtr_vr_methods.size() - 1; i >= 0; i--) delete m_vtr_vr_methods[i];
   m_vtr_vr_methods.clear();
+  m_warm_renderers.clear();
+  m_renderer_data_version.clear();
+  gl::GPUMemoryRegistry::Instance()->RemoveEvictionCallback(RenderingManager::EvictWarmRenderer, this);
+
+  gl::GPUProfiler::DestroyInstance();
+  gl::Tracer::Stop();
 }
 
 void RenderingManager::IdleFunc ()
@@ -403,19 +525,76 @@ void RenderingManager::PostRedisplay ()
 // Update the volume renderer with the current volume and transfer function
 void RenderingManager::UpdateDataAndResetCurrentVRMode ()
 {
+  TRACE_SCOPE_DETAIL("InitRenderer", "render", curr_vol_renderer->GetName());
+  // Renderers other than the Null one (id 0) need the volume, even if the
+  //   first frame is not shown yet
+  if (curr_vol_renderer != m_vtr_vr_methods[0]) m_data_mgr.LoadPendingVolume();
   curr_vol_renderer->Init(curr_rdr_parameters.GetScreenWidth(), curr_rdr_parameters.GetScreenHeight());
+  m_renderer_data_version[curr_vol_renderer] = m_data_mgr.GetDataVersion();
+  m_trace_first_frame = true;
+
+  // The warm renderers may have been built with the previous data
+  TrimWarmRenderers();
 }
 
-void RenderingManager::SaveScreenshot (std::string filename)
+void RenderingManager::SaveScreenshot (std::string filename, GLenum read_buffer)
 {
-  // Get pixel data without alpha
-  GLubyte* rgb_data = GetFrontBufferPixelData(false);
   if (filename.empty())
   {
     filename = AddAbreviationName(curr_rdr_parameters.GetDefaultScreenshotName());
   }
-  GenerateImgFile(filename, curr_rdr_parameters.GetScreenWidth(), curr_rdr_parameters.GetScreenHeight(), rgb_data, false);
-  delete[] rgb_data;
+  //Deal with absolute and relative paths
+  if (std::filesystem::path(filename).is_relative())
+  {
+    std::string path_to_data = CPPVOLREND_DATA_DIR;
+    filename = path_to_data + filename;
+  }
+  // Pixel data without alpha
+  m_screenshot_capture.CaptureWindow(filename, curr_rdr_parameters.GetScreenWidth(), curr_rdr_parameters.GetScreenHeight(), read_buffer);
+}
+
+void RenderingManager::SaveRendererOutput (std::string filename)
+{
+  //Deal with absolute and relative paths
+  if (std::filesystem::path(filename).is_relative())
+  {
+    std::string path_to_data = CPPVOLREND_DATA_DIR;
+    filename = path_to_data + filename;
+  }
+  m_screenshot_capture.CaptureTexture(filename, curr_vol_renderer->GetScreenTextureID());
+}
+
+bool RenderingManager::ReadRendererOutput (std::vector<glm::vec4>* pixels, int* w, int* h)
+{
+  // The output texture may not have the size of the screen (down/up scaling modes)
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, curr_vol_renderer->GetScreenTextureID());
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, w);
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, h);
+  if ((*w) <= 0 || (*h) <= 0)
+  {
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return false;
+  }
+
+  pixels->resize((*w) * (*h));
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, pixels->data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+  return true;
+}
+
+bool RenderingManager::ComputeImageMetrics (ImageMetrics* metrics)
+{
+  std::vector<glm::vec4> image;
+  int w = 0, h = 0;
+  if (s_ref_image.empty() || !ReadRendererOutput(&image, &w, &h) || w != s_ref_image_width || h != s_ref_image_height)
+    return metrics->Compute(s_ref_image, std::vector<glm::vec4>(), 0, 0, glm::vec3(0.0f));
+
+  // The renderer output is composited over the clear color
+  GLfloat clear_color[4];
+  glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color);
+  TRACE_SCOPE("ImageMetrics", "eval");
+  return metrics->Compute(s_ref_image, image, w, h, glm::vec3(clear_color[0], clear_color[1], clear_color[2]));
 }
 
 void RenderingManager::UpdateLightSourceCameraVectors ()
@@ -425,6 +604,270 @@ void RenderingManager::UpdateLightSourceCameraVectors ()
   curr_rdr_parameters.SetBlinnPhongLightSourceCameraVectors(cforward, cup, cright);
 }
 
+void RenderingManager::UpdateCameraPath ()
+{
+  if (m_campath_recording)
+  {
+    //Path time starts at the first keyframe
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const int n_keyframes = m_camera_path.GetNumberOfKeyframes();
+    if (n_keyframes == 0) m_campath_starttime = now;
+
+    const double t = std::chrono::duration<double>(now - m_campath_starttime).count();
+    if (n_keyframes == 0 || t - m_camera_path.GetKeyframe(n_keyframes - 1)->time >= RENDERING_MANAGER_CAMERA_PATH_RECORD_INTERVAL_S)
+    {
+      vis::Camera* camera = curr_rdr_parameters.GetCamera();
+      m_camera_path.AddKeyframe(t, camera->GetEye(), camera->GetEye() + camera->GetDir() * camera->GetRadius(), camera->GetUp());
+    }
+  }
+  else if (m_campath_playing)
+  {
+    //Real time playback, looping
+    const double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_campath_starttime).count();
+    SetCameraPathData(fmod(t, m_camera_path.GetDuration()));
+  }
+  else if (m_campath_benchmark)
+  {
+    //Wait for the frame to finish, so each frame time is measured on its own
+    glFinish();
+    const std::chrono::steady_clock::time_point frame_end_time = std::chrono::steady_clock::now();
+    if (m_campath_currframe >= 0)
+      m_campath_frametimes.push_back(std::chrono::duration<double, std::milli>(frame_end_time - m_campath_lastframe_time).count());
+    m_campath_lastframe_time = frame_end_time;
+
+    //Frame i is always rendered at the same path time, whatever the frame rate
+    m_campath_currframe++;
+    if (m_campath_currframe < m_campath_numframes)
+    {
+      SetCameraPathData(m_camera_path.GetFrameTime(std::max(m_campath_currframe, 0), m_campath_numframes));
+      return;
+    }
+
+    //Store the time of each frame in a csv file - naming is datetime-based
+    auto t = std::time(nullptr);
+    auto tm = *std::localtime(&t);
+    std::ostringstream oss;
+    oss << std::put_time(&tm, "camerapath_eval_%d-%m-%Y_%H-%M-%S.csv");
+    std::ofstream f_csv(CPPVOLREND_DATA_DIR + oss.str(), std::ios_base::out);
+    if (f_csv.is_open())
+    {
+      RunInfo run_info;
+      run_info.Collect();
+      run_info.Set("renderer", curr_vol_renderer->GetName());
+      run_info.Set("dataset", m_data_mgr.GetCurrentVolumeName());
+      run_info.Set("content_hash", m_data_mgr.GetCurrentVolumeContentHash().ToString());
+      run_info.Set("gradient", m_data_mgr.CurrentGradientName());
+      run_info.Set("transfer_function", m_data_mgr.GetCurrentTransferFunctionName());
+      run_info.Set("resolution", std::to_string(curr_rdr_parameters.GetScreenWidth()) + " "
+                                 + std::to_string(curr_rdr_parameters.GetScreenHeight()));
+      run_info.Set("camera_path", m_camera_path.GetName());
+      run_info.Write(f_csv);
+
+      f_csv << "Frame,PathTime (s),FrameTime (ms)\n";
+      for (int i = 0; i < m_campath_frametimes.size(); i++)
+      {
+        f_csv << i << "," << std::to_string(m_camera_path.GetFrameTime(i, m_campath_numframes)) << ","
+              << std::to_string(m_campath_frametimes[i]) << "\n";
+      }
+      f_csv.close();
+    }
+    else
+    {
+      std::cout << "Error: Unable to write camera path results " << oss.str() << "." << std::endl;
+    }
+
+    FrameStatistics frame_stats;
+    frame_stats.Compute(m_campath_frametimes, m_eval_max_cv);
+    const int slowest_frame = (int)(std::max_element(m_campath_frametimes.begin(), m_campath_frametimes.end())
+                                    - m_campath_frametimes.begin());
+    printf("Camera path %s: %d frames, mean %.3f ms, median %.3f ms, slowest frame %d (%.3f ms)\n",
+      m_camera_path.GetName().c_str(), frame_stats.n_frames, frame_stats.mean, frame_stats.median,
+      slowest_frame, m_campath_frametimes[slowest_frame]);
+
+    StopCameraPath();
+  }
+}
+
+void RenderingManager::SetCameraPathData (double t)
+{
+  vis::CameraData cam_data = m_camera_path.Evaluate(t);
+  curr_rdr_parameters.GetCamera()->SetData(&cam_data);
+  curr_vol_renderer->SetOutdated();
+}
+
+void RenderingManager::StopCameraPath ()
+{
+  m_campath_playing = false;
+  if (m_campath_benchmark)
+  {
+    m_campath_benchmark = false;
+    //Enable or disable vsync according to user prefs
+    if (m_vsync)
+    {
+      wglSwapIntervalEXT(1);
+    }
+    else
+    {
+      wglSwapIntervalEXT(0);
+    }
+    //Restore UI
+    m_imgui_render_ui = true;
+  }
+}
+
+void RenderingManager::StartEvaluation (bool tuning)
+{
+  //The tuner compares each sample point with the reference image
+  if (tuning && s_ref_image.empty())
+  {
+    std::cout << "Error: A reference image is needed to tune the parameters." << std::endl;
+    return;
+  }
+  if (tuning && m_eval_paramspace.GetNumDimensions() == 0)
+  {
+    std::cout << "Error: The renderer has no parameters to tune." << std::endl;
+    return;
+  }
+
+  //Name of a directory containing all the evaluation files - naming is datetime-based
+  auto t = std::time(nullptr);
+  auto tm = *std::localtime(&t);
+  std::ostringstream oss;
+  oss << std::put_time(&tm, tuning ? "tune_%d-%m-%Y_%H-%M-%S" : "eval_%d-%m-%Y_%H-%M-%S");
+  const std::string path_to_data = CPPVOLREND_DATA_DIR;
+  m_eval_basedirectory = path_to_data + oss.str();
+  // - and an image subsirectory
+  m_eval_imgdirectory = m_eval_basedirectory + "/img";
+
+  //Create the new directories
+  std::filesystem::create_directory(m_eval_basedirectory);
+  std::filesystem::create_directory(m_eval_imgdirectory);
+
+  //Open a CSV file to record the results of the evaluation.
+  if (m_eval_csvfile.is_open()) m_eval_csvfile.close(); //Should really not happen, but better be save.
+  m_eval_csvfile.open(m_eval_basedirectory + "/eval.csv", std::ios_base::out);
+
+  //Start the evaluation if everything is fine
+  if (m_eval_csvfile.is_open())
+  {
+    //Reset parameter space to the beginning, or to the first point of the search
+    m_eval_tuning = tuning;
+    if (m_eval_tuning)
+    {
+      m_tuner.SetGoal((ParameterTuner::Goal)m_tuner_goal,
+        m_tuner_goal == ParameterTuner::FASTEST_WITHIN_ERROR ? m_tuner_max_error : m_tuner_time_budget_ms);
+      m_tuner.SetErrorMetric((ParameterTuner::ErrorMetric)m_tuner_metric);
+      m_tuner.Start(&m_eval_paramspace);
+    }
+    else
+    {
+      m_eval_paramspace.StartEvaluation();
+    }
+
+    //Initialize the csv file: description of the run, then the header
+    RunInfo run_info;
+    run_info.Collect();
+    run_info.Set("renderer", curr_vol_renderer->GetName());
+    run_info.Set("dataset", m_data_mgr.GetCurrentVolumeName());
+    run_info.Set("content_hash", m_data_mgr.GetCurrentVolumeContentHash().ToString());
+    run_info.Set("gradient", m_data_mgr.CurrentGradientName());
+    run_info.Set("transfer_function", m_data_mgr.GetCurrentTransferFunctionName());
+    run_info.Set("resolution", std::to_string(curr_rdr_parameters.GetScreenWidth()) + " "
+                               + std::to_string(curr_rdr_parameters.GetScreenHeight()));
+    run_info.Write(m_eval_csvfile);
+
+    for(int i=0;i<m_eval_paramspace.GetNumDimensions();i++)
+    {
+      m_eval_csvfile << m_eval_paramspace.GetDimensionName(i) << ",";
+    }
+    //Image metrics are computed if a reference image was stored
+    m_eval_image_metrics = !s_ref_image.empty();
+    m_eval_csvfile << "TimePerFrame (ms),FramesPerSecond,Frames," << FrameStatistics::GetCsvHeader() << ","
+                   << "GPUFrame (ms),GPUScopes (ms),GPUMemory (MB),GPUMemoryPeak (MB),GPUMemoryOwners (MB),";
+    if (m_eval_image_metrics)
+      m_eval_csvfile << ImageMetrics::GetCsvHeader() << ",";
+    m_eval_csvfile << "ImageFile\n";
+
+    //Gpu timings are always recorded during the evaluation
+    gl::GPUProfiler::Instance()->SetEnabled(true);
+    gl::GPUMemoryRegistry::Instance()->ResetPeak();
+    gl::GPUProfiler::Instance()->ResetAccumulation();
+
+    //Set a bool to trigger evaluation action in Display().
+    m_eval_running = true;
+    m_eval_currframe = 0;
+    m_eval_currsample = 0;
+    m_eval_frametimes.clear();
+    m_eval_measuredtime = 0.0;
+    m_eval_lastframe_time = std::chrono::steady_clock::now();
+    curr_vol_renderer->SetOutdated();
+    // Careful: Not rendering the ImGui may have unintended consequences,
+    // namely if they Gui code changes parameters based on the parameters
+    // that we are setting during the eval.
+    // On the other hand, we want to measure the speed of the volume renderer and not of ImGui.
+    m_imgui_render_ui = false;
+
+    //Disable VSync for full speed
+    wglSwapIntervalEXT(0);
+  }
+}
+
+void RenderingManager::FinishTuning ()
+{
+  //The parameters are left at the best point found
+  m_tuner.Stop();
+  curr_vol_renderer->SetOutdated();
+
+  std::ofstream f_csv(m_eval_basedirectory + "/tuning.csv", std::ios_base::out);
+  if (f_csv.is_open())
+  {
+    m_tuner.WriteCsv(f_csv);
+    f_csv.close();
+  }
+
+  ParameterTuner::SamplePoint best;
+  if (!m_tuner.GetBestPoint(&best)) return;
+  printf("Tuning: %d of %d sample points measured, best %.3f ms, %s %f%s\n", m_tuner.GetNumMeasuredPoints(),
+    m_eval_paramspace.GetNumSamplePoints(), best.time_ms, ParameterTuner::GetErrorMetricName(m_tuner.GetErrorMetric()),
+    best.error, best.feasible ? "" : " (no sample point meets the goal)");
+
+  //Presets are only written for points that meet the goal
+  if (!best.feasible) return;
+  std::vector<std::string> header;
+  header.push_back(std::string("renderer ") + curr_vol_renderer->GetName());
+  header.push_back("dataset " + m_data_mgr.GetCurrentVolumeName());
+  const GLubyte* gl_renderer = glGetString(GL_RENDERER);
+  header.push_back(std::string("gl_renderer ") + (gl_renderer ? (const char*)gl_renderer : "unknown"));
+  header.push_back(std::string(m_tuner.GetGoal() == ParameterTuner::FASTEST_WITHIN_ERROR ? "max_error " : "time_budget_ms ")
+                   + std::to_string(m_tuner.GetThreshold()) + " "
+                   + ParameterTuner::GetErrorMetricName(m_tuner.GetErrorMetric()));
+  header.push_back("time_ms " + std::to_string(best.time_ms) + " error " + std::to_string(best.error));
+  m_tuner.WritePreset(m_eval_basedirectory + "/tuned.preset", header);
+
+  std::error_code ec;
+  std::filesystem::create_directories(std::filesystem::path(GetPresetFilePath()).parent_path(), ec);
+  m_tuner.WritePreset(GetPresetFilePath(), header);
+}
+
+std::string RenderingManager::GetPresetFilePath ()
+{
+  return CPPVOLREND_DATA_DIR + std::string("presets/") + m_data_mgr.GetCurrentVolumeName() + "."
+         + curr_vol_renderer->GetAbbreviationName() + ".preset";
+}
+
+void RenderingManager::ListCameraPathFiles ()
+{
+  m_campath_files.clear();
+  std::error_code ec;
+  for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(CPPVOLREND_DATA_DIR, ec))
+  {
+    if (entry.path().extension() == ".cpath")
+      m_campath_files.push_back(entry.path().filename().string());
+  }
+  std::sort(m_campath_files.begin(), m_campath_files.end());
+  m_campath_file_id = glm::clamp(m_campath_file_id, 0, std::max((int)m_campath_files.size() - 1, 0));
+}
+
 void RenderingManager::ResetGLStateConfig ()
 {
 #ifdef USING_FREEGLUT
@@ -461,11 +904,7 @@ bool RenderingManager::GenerateImgFile (std::string out_str, int w, int h, unsig
   }
 
   //Create the file and save it
-  imFile* ifile = imFileNew(out_str.c_str(), image_type.c_str(), &error);
-  int user_color_mode = alpha ? IM_RGB | IM_ALPHA | IM_PACKED : IM_RGB | IM_PACKED;
-  error = imFileWriteImageInfo(ifile, w, h, user_color_mode, IM_BYTE);
-  error = imFileWriteImageData(ifile, gl_data);
-  imFileClose(ifile);
+  error = ScreenshotCapture::WriteImageFile(out_str, w, h, gl_data, alpha, image_type) ? 0 : -1;
 #else
   error = -1;
 #endif
@@ -473,24 +912,6 @@ bool RenderingManager::GenerateImgFile (std::string out_str, int w, int h, unsig
   return error == 0;
 }
 
-GLubyte* RenderingManager::GetFrontBufferPixelData (bool alpha)
-{
-  GLubyte *gl_img_data = new GLubyte[(alpha ? 4 : 3) * curr_rdr_parameters.GetScreenWidth() * curr_rdr_parameters.GetScreenHeight()];
-  
-  glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
-  glPushAttrib(GL_PIXEL_MODE_BIT);
-  glReadBuffer(GL_BACK);
-  glFlush();
-  glPixelStorei(GL_PACK_ALIGNMENT, 1);
-  
-  glReadPixels(0, 0, curr_rdr_parameters.GetScreenWidth(), curr_rdr_parameters.GetScreenHeight(), (alpha ? GL_RGBA : GL_RGB), GL_UNSIGNED_BYTE, gl_img_data);
-  
-  glPopAttrib();
-  glPopClientAttrib();
-
-  return gl_img_data;
-}
-
 // Go to previous renderer
 bool RenderingManager::PreviousRenderer ()
 {
@@ -520,18 +941,39 @@ bool RenderingManager::NextRenderer ()
 // Set current volume renderer
 void RenderingManager::SetCurrentVolumeRenderer ()
 {
-  if (curr_vol_renderer) curr_vol_renderer->Clean();
+  BaseVolumeRenderer* next_vol_renderer = m_vtr_vr_methods[m_current_vr_method_id];
+  if (next_vol_renderer->GetDataTypeSupport() != m_data_mgr.GetInputVolumeDataType())
+  {
+    // Null Renderer
+    m_current_vr_method_id = 0;
+    next_vol_renderer = m_vtr_vr_methods[m_current_vr_method_id];
+  }
 
-  curr_vol_renderer = m_vtr_vr_methods[m_current_vr_method_id];
-  if (curr_vol_renderer->GetDataTypeSupport() == m_data_mgr.GetInputVolumeDataType())
+  if (curr_vol_renderer)
   {
-    UpdateDataAndResetCurrentVRMode();
+    // Warm standby: the previous renderer stays built, switching back to it needs no Init
+    if (curr_vol_renderer != next_vol_renderer && curr_vol_renderer->IsBuilt()
+     && m_data_mgr.GetDerivedResources()->IsWarmStandbyEnabled())
+      m_warm_renderers.push_back(curr_vol_renderer);
+    else
+      curr_vol_renderer->Clean();
+  }
+
+  curr_vol_renderer = next_vol_renderer;
+  std::vector<BaseVolumeRenderer*>::iterator it_warm = std::find(m_warm_renderers.begin(), m_warm_renderers.end(), curr_vol_renderer);
+  if (it_warm != m_warm_renderers.end())
+    m_warm_renderers.erase(it_warm);
+
+  if (curr_vol_renderer->IsBuilt() && m_renderer_data_version[curr_vol_renderer] == m_data_mgr.GetDataVersion())
+  {
+    // The screen may have been resized meanwhile
+    curr_vol_renderer->Reshape(curr_rdr_parameters.GetScreenWidth(), curr_rdr_parameters.GetScreenHeight());
+    curr_vol_renderer->SetOutdated();
+    m_trace_first_frame = true;
+    TrimWarmRenderers();
   }
   else
   {
-    // Null Renderer
-    m_current_vr_method_id = 0;
-    curr_vol_renderer = m_vtr_vr_methods[m_current_vr_method_id];
     UpdateDataAndResetCurrentVRMode();
   }
 
@@ -539,6 +981,50 @@ void RenderingManager::SetCurrentVolumeRenderer ()
   curr_vol_renderer->FillParameterSpace(m_eval_paramspace);
 }
 
+void RenderingManager::TrimWarmRenderers ()
+{
+  std::vector<BaseVolumeRenderer*>::iterator it = m_warm_renderers.begin();
+  while (it != m_warm_renderers.end())
+  {
+    if (m_renderer_data_version[*it] != m_data_mgr.GetDataVersion())
+    {
+      (*it)->Clean();
+      it = m_warm_renderers.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  // Unreferenced derived resources are evicted first, then the resources of the warm renderers
+  while (!m_data_mgr.GetDerivedResources()->Trim() && !m_warm_renderers.empty())
+  {
+    m_warm_renderers.front()->Clean();
+    m_warm_renderers.erase(m_warm_renderers.begin());
+  }
+
+  // Same order for the gpu memory budget (see the eviction callbacks)
+  gl::GPUMemoryRegistry::Instance()->Reserve(0);
+}
+
+bool RenderingManager::EvictWarmRenderer (void* data)
+{
+  RenderingManager* rm = (RenderingManager*)data;
+  if (rm->m_warm_renderers.empty()) return false;
+
+  rm->m_warm_renderers.front()->Clean();
+  rm->m_warm_renderers.erase(rm->m_warm_renderers.begin());
+  return true;
+}
+
+void RenderingManager::CleanWarmRenderers ()
+{
+  for (int i = 0; i < m_warm_renderers.size(); i++)
+    m_warm_renderers[i]->Clean();
+  m_warm_renderers.clear();
+}
+
 void RenderingManager::SetImGuiInterface ()
 {
 #ifdef USING_IMGUI
@@ -558,6 +1044,19 @@ void RenderingManager::SetImGuiInterface ()
   ImGui::BeginMainMenuBar();
   if (ImGui::BeginMenu("File###FileMenu"))
   {
+    if (!gl::Tracer::IsEnabled() && ImGui::MenuItem("Start Trace###FileMenuStartTrace"))
+    {
+      auto t = std::time(nullptr);
+      auto tm = *std::localtime(&t);
+      std::ostringstream oss;
+      oss << std::put_time(&tm, "trace_%d-%m-%Y_%H-%M-%S.json");
+      gl::Tracer::Start(CPPVOLREND_DATA_DIR + oss.str());
+    }
+    else if (gl::Tracer::IsEnabled() && ImGui::MenuItem("Stop Trace###FileMenuStopTrace"))
+    {
+      gl::Tracer::Stop();
+    }
+    ImGui::Separator();
     if (ImGui::MenuItem("Exit###FileMenuExit"))
     {
       CloseFunc();
@@ -618,28 +1117,33 @@ void RenderingManager::SetImGuiInterface ()
       if (animate_camera_rotation) m_idle_rendering = true;
     }
 
+    if (ImGui::Checkbox("GPU Profiler", &m_imgui_gpu_profiler))
+    {
+      gl::GPUProfiler::Instance()->SetEnabled(m_imgui_gpu_profiler);
+    }
+
     if (ImGui::Button("Save Screenshot"))
     {
       curr_rdr_parameters.SetDefaultScreenshotName("output.png");
       curr_rdr_parameters.RequestSaveScreenshot();
     }
+    ImGui::SameLine();
+    if (ImGui::Button("Save Renderer Output"))
+    {
+      SaveRendererOutput(AddAbreviationName("output_renderer.png"));
+    }
+    const int pending_images = m_screenshot_capture.GetNumberOfPendingImages();
+    if (pending_images > 0)
+    {
+      ImGui::SameLine();
+      ImGui::Text("(%d images pending)", pending_images);
+    }
 
     ImGui::Separator();
     if (ImGui::Button("Reference Image###BTNstorerefimage"))
     {
-      s_ref_image.clear();
-      glPushAttrib(GL_CURRENT_BIT | GL_ENABLE_BIT);
-
-      int o_w = curr_rdr_parameters.GetScreenWidth(),
-        o_h = curr_rdr_parameters.GetScreenHeight();
-      s_ref_image.resize(o_w * o_h);
-
-      glActiveTexture(GL_TEXTURE0);
-      glBindTexture(GL_TEXTURE_2D, curr_vol_renderer->GetScreenTextureID());
-      glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, &s_ref_image[0]);
-      glBindTexture(GL_TEXTURE_2D, 0);
-
-      glPopAttrib();
+      if (!ReadRendererOutput(&s_ref_image, &s_ref_image_width, &s_ref_image_height))
+        s_ref_image.clear();
     }
     ImGui::SameLine();
     if (ImGui::Button("Generate Diff###BTNgeneratediffimage"))
@@ -716,6 +1220,21 @@ void RenderingManager::SetImGuiInterface ()
 
       glPopAttrib();
     }
+    if (!s_ref_image.empty())
+    {
+      ImGui::SameLine();
+      if (ImGui::Button("Image Metrics###BTNcomputeimagemetrics"))
+      {
+        if (ComputeImageMetrics(&m_last_image_metrics))
+          printf("Image metrics: RMSE %.6f, PSNR %.2f dB, SSIM %.4f, FLIPColor %.4f\n", m_last_image_metrics.rmse,
+            m_last_image_metrics.psnr, m_last_image_metrics.ssim, m_last_image_metrics.flip_color);
+        else
+          printf("Image metrics: the renderer output and the reference image have different sizes\n");
+      }
+      ImGui::Text("Reference %dx%d - RMSE %.4f, PSNR %.2f dB, SSIM %.4f, FLIPColor %.4f",
+        s_ref_image_width, s_ref_image_height, m_last_image_metrics.rmse, m_last_image_metrics.psnr,
+        m_last_image_metrics.ssim, m_last_image_metrics.flip_color);
+    }
     ImGui::Separator();
     if (ImGui::Button("Export LAB Diff Transfer Function Image###BTNexportimagetfdiff"))
     {
@@ -811,59 +1330,53 @@ void RenderingManager::SetImGuiInterface ()
 
       ImGui::PushItemWidth(100);
       ImGui::InputInt("Eval Frames per Sample", &m_eval_numframes, 1, 10);
+      ImGui::InputInt("Eval Warmup Frames", &m_eval_warmupframes, 1, 10);
+      ImGui::InputFloat("Eval Min Time per Sample (ms)", &m_eval_mintime_ms, 100.0f, 1000.0f, "%.0f");
+      ImGui::InputFloat("Eval Max Variation (stddev/mean)", &m_eval_max_cv, 0.01f, 0.05f, "%.2f");
       ImGui::PopItemWidth();
+      ImGui::Checkbox("Eval Images from Renderer Output", &m_eval_capture_renderer_output);
       m_eval_numframes = std::max(std::min(m_eval_numframes, 500), 1);
+      m_eval_warmupframes = std::max(std::min(m_eval_warmupframes, 500), 0);
+      m_eval_mintime_ms = std::max(std::min(m_eval_mintime_ms, 60000.0f), 0.0f);
+      m_eval_max_cv = std::max(m_eval_max_cv, 0.001f);
 
-      const double neededtime = ceil(m_ts_window_ms * numsamples * m_eval_numframes / 1000.);
+      const double timepersample = std::max(m_ts_window_ms * m_eval_numframes, (double)m_eval_mintime_ms)
+                                 + m_ts_window_ms * m_eval_warmupframes;
+      const double neededtime = ceil(timepersample * numsamples / 1000.);
       ImGui::Text("approx. %.0f seconds for evaluation at current FPS", neededtime);
       if (ImGui::Button("Start Evaluation"))
       {
-        //Name of a directory containing all the evaluation files - naming is datetime-based
-        auto t = std::time(nullptr);
-        auto tm = *std::localtime(&t);
-        std::ostringstream oss;
-        oss << std::put_time(&tm, "eval_%d-%m-%Y_%H-%M-%S");
-        const std::string path_to_data = CPPVOLREND_DATA_DIR;
-        m_eval_basedirectory = path_to_data + oss.str();
-        // - and an image subsirectory
-        m_eval_imgdirectory = m_eval_basedirectory + "/img";
-
-        //Create the new directories
-        std::filesystem::create_directory(m_eval_basedirectory);
-        std::filesystem::create_directory(m_eval_imgdirectory);
-
-        //Open a CSV file to record the results of the evaluation.
-        if (m_eval_csvfile.is_open()) m_eval_csvfile.close(); //Should really not happen, but better be save.
-        m_eval_csvfile.open(m_eval_basedirectory + "/eval.csv", std::ios_base::out);
-
-        //Start the evaluation if everything is fine
-        if (m_eval_csvfile.is_open())
-        {
-          //Reset parameter space to the beginning
-          m_eval_paramspace.StartEvaluation();
+        StartEvaluation(false);
+      }
 
-          //Initialize the csv file
-          for(int i=0;i<m_eval_paramspace.GetNumDimensions();i++)
-          {
-            m_eval_csvfile << m_eval_paramspace.GetDimensionName(i) << ",";
-          }
-          m_eval_csvfile << "TimePerFrame (ms),FramesPerSecond,ImageFile\n";
+      //The tuner searches the parameter space instead of measuring all of its sample points
+      ImGui::Separator();
+      static const char* tuner_goals[] = { "Fastest within Error", "Best Quality within Time" };
+      static const char* tuner_metrics[] = { "RMSE", "1-SSIM", "FLIPColor" };
+      ImGui::PushItemWidth(200);
+      ImGui::Combo("Tuning Goal", &m_tuner_goal, tuner_goals, IM_ARRAYSIZE(tuner_goals));
+      ImGui::Combo("Tuning Error", &m_tuner_metric, tuner_metrics, IM_ARRAYSIZE(tuner_metrics));
+      if (m_tuner_goal == ParameterTuner::FASTEST_WITHIN_ERROR)
+        ImGui::InputFloat("Max Error", &m_tuner_max_error, 0.001f, 0.01f, "%.4f");
+      else
+        ImGui::InputFloat("Time Budget (ms)", &m_tuner_time_budget_ms, 1.0f, 10.0f, "%.1f");
+      ImGui::PopItemWidth();
+      m_tuner_max_error = std::max(m_tuner_max_error, 0.0f);
+      m_tuner_time_budget_ms = std::max(m_tuner_time_budget_ms, 0.0f);
 
-          //Set a bool to trigger evaluation action in Display().
-          m_eval_running = true;
-          m_eval_currframe = 0;
-          m_eval_currsample = 0;
-          m_eval_lasttime = GetCurrentRenderTime();
+      if (s_ref_image.empty())
+      {
+        ImGui::Text("Store a \"Reference Image\" to tune the parameters");
+      }
+      else if (ImGui::Button("Start Tuning"))
+      {
+        StartEvaluation(true);
+      }
+      ImGui::SameLine();
+      if (ImGui::Button("Apply Preset"))
+      {
+        if (ParameterTuner::ReadPreset(GetPresetFilePath(), &m_eval_paramspace))
           curr_vol_renderer->SetOutdated();
-          // Careful: Not rendering the ImGui may have unintended consequences,
-          // namely if they Gui code changes parameters based on the parameters
-          // that we are setting during the eval.
-          // On the other hand, we want to measure the speed of the volume renderer and not of ImGui.
-          m_imgui_render_ui = false;
-
-          //Disable VSync for full speed
-          wglSwapIntervalEXT(0);
-        }
       }
     }
 
@@ -878,6 +1391,84 @@ void RenderingManager::SetImGuiInterface ()
         curr_rdr_parameters.GetCamera()->SetData(m_camera_state_list.GetCameraState(m_current_camera_state_id));
         curr_vol_renderer->SetOutdated();
       }
+
+      ImGui::Text("- Camera Path: %d keyframes, %.2f s", m_camera_path.GetNumberOfKeyframes(), m_camera_path.GetDuration());
+      if (!m_campath_recording)
+      {
+        if (ImGui::Button("Record###BTNrecordcamerapath"))
+        {
+          StopCameraPath();
+          m_camera_path.Clear();
+          m_camera_path.SetName("");
+          m_campath_recording = true;
+          //Keyframes are taken after each frame, so we keep rendering
+          m_idle_rendering = true;
+        }
+      }
+      else if (ImGui::Button("Stop Recording###BTNstoprecordcamerapath"))
+      {
+        m_campath_recording = false;
+
+        //Recorded paths are saved in the data folder - naming is datetime-based
+        auto t = std::time(nullptr);
+        auto tm = *std::localtime(&t);
+        std::ostringstream oss;
+        oss << std::put_time(&tm, "camerapath_%d-%m-%Y_%H-%M-%S");
+        m_camera_path.SetName(oss.str());
+        if (m_camera_path.Write(CPPVOLREND_DATA_DIR + oss.str() + ".cpath"))
+        {
+          ListCameraPathFiles();
+          for (int i = 0; i < m_campath_files.size(); i++)
+            if (m_campath_files[i] == oss.str() + ".cpath") m_campath_file_id = i;
+        }
+      }
+      ImGui::SameLine();
+      ImGui::PushItemWidth(200);
+      ImGui::Combo("###ImArrayCameraPathFiles", &m_campath_file_id, vector_getter,
+        static_cast<void*>(&m_campath_files), m_campath_files.size());
+      ImGui::PopItemWidth();
+      ImGui::SameLine();
+      if (ImGui::Button("Load###BTNloadcamerapath") && !m_campath_recording
+        && m_campath_file_id >= 0 && m_campath_file_id < m_campath_files.size())
+      {
+        StopCameraPath();
+        m_camera_path.Read(CPPVOLREND_DATA_DIR + m_campath_files[m_campath_file_id]);
+      }
+
+      if (m_camera_path.GetDuration() > 0.0 && !m_campath_recording)
+      {
+        if (ImGui::Checkbox("Play Path", &m_campath_playing))
+        {
+          if (m_campath_playing)
+          {
+            m_campath_starttime = std::chrono::steady_clock::now();
+            animate_camera_rotation = false;
+            m_idle_rendering = true;
+          }
+        }
+        ImGui::SameLine();
+        ImGui::PushItemWidth(100);
+        ImGui::InputInt("Path Frames", &m_campath_numframes, 10, 100);
+        ImGui::PopItemWidth();
+        m_campath_numframes = std::max(std::min(m_campath_numframes, 100000), 2);
+        ImGui::SameLine();
+        if (ImGui::Button("Benchmark Path"))
+        {
+          StopCameraPath();
+          animate_camera_rotation = false;
+
+          //Warmup frames (see "Evaluation") are rendered at the start of the path
+          m_campath_benchmark = true;
+          m_campath_currframe = -1 - m_eval_warmupframes;
+          m_campath_frametimes.clear();
+          m_campath_lastframe_time = std::chrono::steady_clock::now();
+          SetCameraPathData(0.0);
+
+          //As in the evaluation, the UI is hidden and vsync disabled
+          m_imgui_render_ui = false;
+          wglSwapIntervalEXT(0);
+        }
+      }
     //  ImGui::Text("- Behaviour: ");
     //  static const char* items_camera_behaviours[]{
     //    "Flight",
@@ -1069,16 +1660,36 @@ void RenderingManager::SetImGuiInterface ()
           }
         }
 
-        if (m_data_mgr.GetCurrentStructuredVolume() != nullptr)
+        if (m_data_mgr.GetCurrentStructuredVolume() != nullptr || m_data_mgr.IsVolumeLoadPending())
         {
-          ImGui::BulletText("Regular Grid");
-
-          ImGui::BulletText("Resolution: %d %d %d", m_data_mgr.GetCurrentStructuredVolume()->GetWidth()
-                                                  , m_data_mgr.GetCurrentStructuredVolume()->GetHeight()
-                                                  , m_data_mgr.GetCurrentStructuredVolume()->GetDepth());
-          ImGui::BulletText("Voxel Size: %.2f %.2f %.2f", m_data_mgr.GetCurrentStructuredVolume()->GetScaleX()
-                                                        , m_data_mgr.GetCurrentStructuredVolume()->GetScaleY()
-                                                        , m_data_mgr.GetCurrentStructuredVolume()->GetScaleZ());
+          vis::DatasetInfo* dinfo = m_data_mgr.GetDatasetInfo(m_data_mgr.GetCurrentVolumeIndex());
+          if (m_data_mgr.GetCurrentStructuredVolume() != nullptr)
+          {
+            ImGui::BulletText("Regular Grid");
+
+            ImGui::BulletText("Resolution: %d %d %d", m_data_mgr.GetCurrentStructuredVolume()->GetWidth()
+                                                    , m_data_mgr.GetCurrentStructuredVolume()->GetHeight()
+                                                    , m_data_mgr.GetCurrentStructuredVolume()->GetDepth());
+            ImGui::BulletText("Voxel Size: %.2f %.2f %.2f", m_data_mgr.GetCurrentStructuredVolume()->GetScaleX()
+                                                          , m_data_mgr.GetCurrentStructuredVolume()->GetScaleY()
+                                                          , m_data_mgr.GetCurrentStructuredVolume()->GetScaleZ());
+          }
+          // Not loaded yet: header probed by the dataset catalog
+          else if (dinfo != nullptr && dinfo->header_available)
+          {
+            ImGui::BulletText("Regular Grid (loading)");
+
+            ImGui::BulletText("Resolution: %d %d %d", dinfo->width, dinfo->height, dinfo->depth);
+            ImGui::BulletText("Voxel Size: %.2f %.2f %.2f", dinfo->scalex, dinfo->scaley, dinfo->scalez);
+          }
+
+          if (dinfo != nullptr && dinfo->statistics_available)
+          {
+            ImGui::BulletText("Density Range: %.4f %.4f", dinfo->min_value, dinfo->max_value);
+            std::vector<float> v_histogram(dinfo->histogram.begin(), dinfo->histogram.end());
+            ImGui::PlotHistogram("###DatasetHistogram", v_histogram.data(), (int)v_histogram.size(),
+              0, NULL, 0.0f, FLT_MAX, ImVec2(0, 60));
+          }
         }
         
         if (ImGui::CollapsingHeader("Gradient Volume###DataManagerGradientVolume"))
@@ -1124,6 +1735,27 @@ void RenderingManager::SetImGuiInterface ()
         UpdateDataAndResetCurrentVRMode();
       }
     }
+    ImGui::Separator();
+    if (ImGui::CollapsingHeader("GPU Memory###DataManagerGPUMemory"))
+    {
+      gl::GPUMemoryRegistry* gpu_memory = gl::GPUMemoryRegistry::Instance();
+      ImGui::PushItemWidth(100);
+      if (ImGui::InputInt("Budget (MB), 0: none###GPUMemoryBudget", &m_gpu_memory_budget_mb, 64, 256))
+      {
+        m_gpu_memory_budget_mb = std::max(m_gpu_memory_budget_mb, 0);
+        gpu_memory->SetBudget((size_t)m_gpu_memory_budget_mb << 20);
+        TrimWarmRenderers();
+      }
+      ImGui::PopItemWidth();
+
+      ImGui::BulletText("Total: %.1f MB (peak %.1f MB)%s", (double)gpu_memory->GetTotalBytes() / (1024.0 * 1024.0),
+        (double)gpu_memory->GetPeakBytes() / (1024.0 * 1024.0), gpu_memory->IsOverBudget() ? ", over budget" : "");
+      ImGui::BulletText("Cache: %.1f MB, %d evictions", (double)gpu_memory->GetCacheBytes() / (1024.0 * 1024.0),
+        gpu_memory->GetNumberOfEvictions());
+      std::map<std::string, size_t> owners = gpu_memory->GetBytesPerOwner();
+      for (std::map<std::string, size_t>::iterator it = owners.begin(); it != owners.end(); ++it)
+        ImGui::Text("  %-24s %8.1f MB", it->first.c_str(), (double)it->second / (1024.0 * 1024.0));
+    }
     ImGui::End();
   }
 
@@ -1141,11 +1773,57 @@ void RenderingManager::SetImGuiInterface ()
     {
       curr_vol_renderer->ReloadShaders();
     }
+    if (gl::ProgramBinaryCache::Instance()->IsEnabled())
+    {
+      ImGui::SameLine();
+      ImGui::Text("Shader cache: %d hits, %d misses", gl::ProgramBinaryCache::Instance()->GetNumberOfHits(),
+        gl::ProgramBinaryCache::Instance()->GetNumberOfMisses());
+    }
+
+    // Keeps the previous renderers and the derived resources built, for A/B switching
+    vis::DerivedResourceRegistry* derived_resources = m_data_mgr.GetDerivedResources();
+    bool warm_standby = derived_resources->IsWarmStandbyEnabled();
+    if (ImGui::Checkbox("Warm Standby###WarmStandbyCheckbox", &warm_standby))
+    {
+      if (!warm_standby) CleanWarmRenderers();
+      derived_resources->SetWarmStandby(warm_standby);
+    }
+    if (warm_standby)
+    {
+      ImGui::SameLine();
+      ImGui::PushItemWidth(100);
+      if (ImGui::InputInt("Budget (MB)###WarmStandbyBudget", &m_warm_standby_budget_mb, 64, 256))
+      {
+        m_warm_standby_budget_mb = std::max(m_warm_standby_budget_mb, 0);
+        derived_resources->SetMemoryBudget((size_t)m_warm_standby_budget_mb << 20);
+        TrimWarmRenderers();
+      }
+      ImGui::PopItemWidth();
+      ImGui::Text("Derived resources: %d (%.1f MB), %d warm renderers", derived_resources->GetNumberOfResources(),
+        (double)derived_resources->GetTotalBytes() / (1024.0 * 1024.0), (int)m_warm_renderers.size());
+    }
 
     curr_vol_renderer->SetImGuiComponents();
 
     ImGui::End();
   }
+
+  if (m_imgui_gpu_profiler)
+  {
+    ImGui::Begin("GPU Profiler###GPUProfilerWindow", &m_imgui_gpu_profiler);
+    const std::vector<gl::GPUProfiler::ScopeResult>& gpu_scopes = gl::GPUProfiler::Instance()->GetLastFrameResults();
+    ImGui::Text("Frame %lld", gl::GPUProfiler::Instance()->GetLastResultFrameId());
+    for (int i = 0; i < gpu_scopes.size(); i++)
+    {
+      ImGui::Text("%*s%-16s %8.3f ms", 2 * gpu_scopes[i].depth, "", gpu_scopes[i].name.c_str(), gpu_scopes[i].ms);
+    }
+    ImGui::Text("Dropped frames: %lld", gl::GPUProfiler::Instance()->GetNumberOfDroppedFrames());
+    ImGui::End();
+
+    // Window closed by the user
+    if (!m_imgui_gpu_profiler)
+      gl::GPUProfiler::Instance()->SetEnabled(false);
+  }
    
   // Rendering
   ImGui::Render();
@@ -1237,9 +1915,30 @@ RenderingManager::RenderingManager ()
 
   animate_camera_rotation = false;
 
+  m_campath_file_id = 0;
+  m_campath_recording = false;
+  m_campath_playing = false;
+  m_campath_benchmark = false;
+  m_campath_numframes = 300;
+  m_campath_currframe = 0;
+
   m_eval_running = false;
   m_eval_numframes = 100;
+  m_eval_warmupframes = 10;
+  m_eval_mintime_ms = 0.0f;
+  m_eval_max_cv = FRAME_STATISTICS_DEFAULT_MAX_CV;
   m_eval_currframe = 0;
+  m_eval_measuredtime = 0.0;
+  m_eval_capture_renderer_output = false;
+  m_eval_image_metrics = false;
+  m_eval_tuning = false;
+  m_tuner_goal = ParameterTuner::FASTEST_WITHIN_ERROR;
+  m_tuner_metric = ParameterTuner::ERROR_RMSE;
+  m_tuner_max_error = 0.02f;
+  m_tuner_time_budget_ms = 16.0f;
+
+  s_ref_image_width = 0;
+  s_ref_image_height = 0;
 
   m_imgui_render_ui = true;
 
@@ -1261,6 +1960,13 @@ RenderingManager::RenderingManager ()
   m_imgui_data_window     = true;
 
   m_imgui_renderer_window = true;
+
+  m_imgui_gpu_profiler = false;
+
+  m_trace_first_frame = true;
+
+  m_warm_standby_budget_mb = (int)(DERIVED_RESOURCES_DEFAULT_BUDGET_BYTES >> 20);
+  m_gpu_memory_budget_mb = 0;
 }
 
 RenderingManager::~RenderingManager ()
@@ -13,16 +13,22 @@
 #include <vis_utils/camera.h>
 
 #include <glm/glm.hpp>
+#include <map>
 #include <vector>
 #include <fstream>
+#include <chrono>
 
 #include <volvis_utils/datamanager.h>
 #include <volvis_utils/renderingparameters.h>
 
+#include <volvis_utils/camerapath.h>
 #include <volvis_utils/camerastatelist.h>
 #include <volvis_utils/lightsourcelist.h>
 
+#include "utils/imagemetrics.h"
 #include "utils/parameterspace.h"
+#include "utils/parametertuner.h"
+#include "utils/screenshotcapture.h"
 
 class BaseVolumeRenderer;
 
@@ -86,21 +92,45 @@ protected:
 
 
 private:
-  void SaveScreenshot (std::string filename = "");
+  // Captures are written asynchronously (see utils/screenshotcapture.h).
+  //   read_buffer: GL_BACK before the swap, GL_FRONT after it
+  void SaveScreenshot (std::string filename = "", GLenum read_buffer = GL_BACK);
+  // Output texture of the current volume renderer, before it is composited on the window
+  void SaveRendererOutput (std::string filename);
+  // Reads back the output texture of the current volume renderer (RGBA floats)
+  bool ReadRendererOutput (std::vector<glm::vec4>* pixels, int* w, int* h);
+  // Metrics of the current renderer output against the reference image
+  bool ComputeImageMetrics (ImageMetrics* metrics);
   void UpdateLightSourceCameraVectors ();
+  // Record, play or benchmark the camera path, called after each frame
+  void UpdateCameraPath ();
+  void SetCameraPathData (double t);
+  void StopCameraPath ();
+  void ListCameraPathFiles ();
+  // Evaluation of all sample points of the parameter space, or search with the tuner
+  void StartEvaluation (bool tuning);
+  // Writes the measured points and the preset of the tuner, applies the best point
+  void FinishTuning ();
+  // Preset of the current dataset and renderer: data/presets/<dataset>.<renderer abbreviation>.preset
+  std::string GetPresetFilePath ();
   void ResetGLStateConfig ();
 
   std::string AddAbreviationName (std::string filename, std::string extension = ".png");
   bool GenerateImgFile (std::string out_str, int w, int h, unsigned char *gl_data, bool alpha = true, std::string image_type = "PNG");
 
-  GLubyte* GetFrontBufferPixelData (bool alpha = true);
-
   // Go to previous renderer
   bool PreviousRenderer ();
   // Go to next renderer
   bool NextRenderer ();
   // Set current volume renderer
   void SetCurrentVolumeRenderer ();
+  // Cleans the warm renderers built with older data, then the least recently
+  //   used ones while the derived resources exceed the warm standby budget
+  //   or the gpu memory exceeds its budget
+  void TrimWarmRenderers ();
+  void CleanWarmRenderers ();
+  // gl::GPUMemoryRegistry eviction callback: least recently used warm renderer
+  static bool EvictWarmRenderer (void* data);
 
   int m_current_vr_method_id;
 
@@ -121,15 +151,44 @@ private:
 
   bool animate_camera_rotation;
 
+  // Recorded camera path (volvis_utils/camerapath.h) and the .cpath files of the data folder
+  vis::CameraPath m_camera_path;
+  std::vector<std::string> m_campath_files;
+  int m_campath_file_id;
+  bool m_campath_recording;
+  bool m_campath_playing;
+  bool m_campath_benchmark;
+  int m_campath_numframes;
+  int m_campath_currframe;
+  std::chrono::steady_clock::time_point m_campath_starttime;
+  std::chrono::steady_clock::time_point m_campath_lastframe_time;
+  std::vector<double> m_campath_frametimes;
+
   ParameterSpace m_eval_paramspace;
   bool m_eval_running;
   int m_eval_numframes;
+  int m_eval_warmupframes;
+  float m_eval_mintime_ms;
+  float m_eval_max_cv;
   int m_eval_currframe;
   int m_eval_currsample;
-  double m_eval_lasttime;
+  std::chrono::steady_clock::time_point m_eval_lastframe_time;
+  std::vector<double> m_eval_frametimes;
+  double m_eval_measuredtime;
   std::string m_eval_basedirectory;
   std::string m_eval_imgdirectory;
   std::ofstream m_eval_csvfile;
+  bool m_eval_capture_renderer_output;
+  bool m_eval_image_metrics;
+  // Parameter search (utils/parametertuner.h) instead of the full grid
+  ParameterTuner m_tuner;
+  bool m_eval_tuning;
+  int m_tuner_goal;
+  int m_tuner_metric;
+  float m_tuner_max_error;
+  float m_tuner_time_budget_ms;
+
+  ScreenshotCapture m_screenshot_capture;
 
   void SetImGuiInterface ();
   void DrawImGuiInterface ();
@@ -151,7 +210,23 @@ private:
 
   bool m_imgui_renderer_window;
 
+  bool m_imgui_gpu_profiler;
+
+  bool m_trace_first_frame;
+
+  // Renderers kept built after a switch (warm standby), least recently used first
+  std::vector<BaseVolumeRenderer*> m_warm_renderers;
+  // Data version (DataManager::GetDataVersion) each renderer was built with
+  std::map<BaseVolumeRenderer*, unsigned int> m_renderer_data_version;
+  int m_warm_standby_budget_mb;
+  // gl::GPUMemoryRegistry budget, 0: none
+  int m_gpu_memory_budget_mb;
+
+  // Reference image for the image metrics ("Reference Image" button)
   std::vector<glm::vec4> s_ref_image;
+  int s_ref_image_width;
+  int s_ref_image_height;
+  ImageMetrics m_last_image_metrics;
 
   static void SingleSampleRender (void* data);
   static void MultiSampleRender (void* data);
@@ -20,6 +20,10 @@ RayCasting1Pass::RayCasting1Pass ()
   , cp_shader_rendering(nullptr)
   , m_u_step_size(0.5f)
   , m_apply_gradient_shading(false)
+  , m_use_packed_volume(0)
+  , m_packed_volume_16_bits(false)
+  , m_glsl_packed_volume(nullptr)
+  , m_on_the_fly_gradient_filter(0)
 {
 #ifdef MULTISAMPLE_AVAILABLE
   vr_pixel_multiscaling_support = true;
@@ -36,6 +40,8 @@ void RayCasting1Pass::Clean ()
   if (m_glsl_transfer_function) delete m_glsl_transfer_function;
   m_glsl_transfer_function = nullptr;
 
+  ReleasePackedVolume();
+
   DestroyRenderingPass();
 
   BaseVolumeRenderer::Clean();
@@ -53,6 +59,8 @@ bool RayCasting1Pass::Init (int swidth, int sheight)
 
   if (m_ext_data_manager->GetCurrentVolumeTexture() == nullptr) return false;
   m_glsl_transfer_function = m_ext_data_manager->GetCurrentTransferFunction()->GenerateTexture_1D_RGBt();
+  if (m_use_packed_volume) AcquirePackedVolume();
+  else SetGradientTextureUser(true);
   
   // Create Rendering Buffers and Shaders
   CreateRenderingPass();
@@ -71,6 +79,12 @@ bool RayCasting1Pass::Init (int swidth, int sheight)
 
 bool RayCasting1Pass::Update (vis::Camera* camera)
 {
+  UpdatePackedVolume();
+
+  // Switches to the shader variant of the current options
+  SetShaderDefines();
+  cp_shader_rendering->UpdateVariant();
+
   cp_shader_rendering->Bind();
 
   // MULTISAMPLE
@@ -85,51 +99,13 @@ bool RayCasting1Pass::Update (vis::Camera* camera)
                                                  m_ext_rendering_parameters->GetScreenHeight(), 0);
   }
 
-  cp_shader_rendering->SetUniform("CameraEye", camera->GetEye());
-  cp_shader_rendering->BindUniform("CameraEye");
-
-  cp_shader_rendering->SetUniform("u_CameraLookAt", camera->LookAt());
-  cp_shader_rendering->BindUniform("u_CameraLookAt");
-
-  cp_shader_rendering->SetUniform("ProjectionMatrix", camera->Projection());
-  cp_shader_rendering->BindUniform("ProjectionMatrix");
-
-  cp_shader_rendering->SetUniform("u_TanCameraFovY", (float)tan(DEGREE_TO_RADIANS(camera->GetFovY()) / 2.0));
-  cp_shader_rendering->BindUniform("u_TanCameraFovY");
-
-  cp_shader_rendering->SetUniform("u_CameraAspectRatio", camera->GetAspectRatio());
-  cp_shader_rendering->BindUniform("u_CameraAspectRatio");
-
-  cp_shader_rendering->SetUniform("StepSize", m_u_step_size);
-  cp_shader_rendering->BindUniform("StepSize");
-
-  cp_shader_rendering->SetUniform("ApplyOcclusion", 1);
-  cp_shader_rendering->BindUniform("ApplyOcclusion");
-
-  cp_shader_rendering->SetUniform("ApplyShadow", 1);
-  cp_shader_rendering->BindUniform("ApplyShadow");
-
-  cp_shader_rendering->SetUniform("ApplyGradientPhongShading", (m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture()) ? 1 : 0);
-  cp_shader_rendering->BindUniform("ApplyGradientPhongShading");
-
-  cp_shader_rendering->SetUniform("BlinnPhongKa", m_ext_rendering_parameters->GetBlinnPhongKambient());
-  cp_shader_rendering->BindUniform("BlinnPhongKa");
-  cp_shader_rendering->SetUniform("BlinnPhongKd", m_ext_rendering_parameters->GetBlinnPhongKdiffuse());
-  cp_shader_rendering->BindUniform("BlinnPhongKd");
-  cp_shader_rendering->SetUniform("BlinnPhongKs", m_ext_rendering_parameters->GetBlinnPhongKspecular());
-  cp_shader_rendering->BindUniform("BlinnPhongKs");
-  cp_shader_rendering->SetUniform("BlinnPhongShininess", m_ext_rendering_parameters->GetBlinnPhongNshininess());
-  cp_shader_rendering->BindUniform("BlinnPhongShininess");
-
-  cp_shader_rendering->SetUniform("BlinnPhongIspecular", m_ext_rendering_parameters->GetLightSourceSpecular());
-  cp_shader_rendering->BindUniform("BlinnPhongIspecular");
-
-  cp_shader_rendering->SetUniform("WorldEyePos", camera->GetEye());
-  cp_shader_rendering->BindUniform("WorldEyePos");
-
-  cp_shader_rendering->SetUniform("LightSourcePosition", m_ext_rendering_parameters->GetBlinnPhongLightingPosition());
-  cp_shader_rendering->BindUniform("LightSourcePosition");
+  // Camera and lighting: one write of the uniform block
+  m_ray_marching_uniforms.SetCamera(camera);
+  m_ray_marching_uniforms.SetStepSize(m_u_step_size);
+  m_ray_marching_uniforms.SetLighting(m_ext_rendering_parameters);
+  m_ray_marching_uniforms.Upload();
 
+  // Textures
   cp_shader_rendering->BindUniforms();
 
   gl::Shader::Unbind();
@@ -144,7 +120,9 @@ void RayCasting1Pass::Redraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
  
   m_rdr_frame_to_screen.Draw();
@@ -157,7 +135,9 @@ void RayCasting1Pass::MultiSampleRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawMultiSampleHigherResolutionMode();
@@ -170,7 +150,9 @@ void RayCasting1Pass::DownScalingRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawHigherResolutionWithDownScale();
@@ -183,7 +165,9 @@ void RayCasting1Pass::UpScalingRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawLowerResolutionWithUpScale();
@@ -201,64 +185,143 @@ void RayCasting1Pass::SetImGuiComponents ()
   
   AddImGuiMultiSampleOptions();
   
-  if (m_ext_data_manager->GetCurrentGradientTexture())
+  ImGui::Separator();
+  bool use_packed_volume = m_use_packed_volume != 0;
+  if (ImGui::Checkbox("Packed Density + Gradient", &use_packed_volume))
+  {
+    m_use_packed_volume = use_packed_volume ? 1 : 0;
+    UpdatePackedVolume();
+    SetOutdated();
+  }
+  if (m_use_packed_volume)
+  {
+    if (ImGui::Checkbox("16 Bits per Channel", &m_packed_volume_16_bits))
+    {
+      ReleasePackedVolume();
+      AcquirePackedVolume();
+      BindVolumeTextures();
+      SetOutdated();
+    }
+  }
+
+  if (IsGradientAvailable())
   {
-    ImGui::Separator();
     if (ImGui::Checkbox("Apply Gradient Shading", &m_apply_gradient_shading))
     {
-      // Delete current uniform
-      cp_shader_rendering->ClearUniform("TexVolumeGradient");
-
-      if (m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture())
-      {
-        cp_shader_rendering->Bind();
-        cp_shader_rendering->SetUniformTexture3D("TexVolumeGradient", m_ext_data_manager->GetCurrentGradientTexture()->GetTextureID(), 3);
-        cp_shader_rendering->BindUniform("TexVolumeGradient");
-        gl::ComputeShader::Unbind();
-      }
+      BindVolumeTextures();
       SetOutdated();
     }
-    ImGui::Separator();
+    if (m_ext_data_manager->IsGradientComputedInShader() && !m_glsl_packed_volume)
+    {
+      static const char* gradient_filters[] = { "Central Differences", "Trilinear Derivative" };
+      if (ImGui::Combo("Gradient Filter###RayCasting1PassUIGradientFilter", &m_on_the_fly_gradient_filter,
+        gradient_filters, IM_ARRAYSIZE(gradient_filters)))
+        SetOutdated();
+    }
   }
+  ImGui::Separator();
 }
 
 void RayCasting1Pass::FillParameterSpace(ParameterSpace& pspace)
 {
   pspace.ClearParameterDimensions();
   pspace.AddParameterDimension(new ParameterRangeFloat("StepSize", &m_u_step_size, 0.2, 2.0, 0.1));
+  if (m_ext_data_manager->IsGradientComputedInShader())
+    pspace.AddParameterDimension(new ParameterRangeInt("GradientFilter", &m_on_the_fly_gradient_filter, 0, 1, 1));
+  // Timing of the packed volume against the separate volume and gradient textures
+  if (m_use_packed_volume)
+    pspace.AddParameterDimension(new ParameterRangeInt("PackedVolume", &m_use_packed_volume, 0, 1, 1));
 }
 
-void RayCasting1Pass::CreateRenderingPass ()
+void RayCasting1Pass::SetShaderDefines ()
 {
-  glm::vec3 vol_resolution = glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetWidth() ,
-                                       m_ext_data_manager->GetCurrentStructuredVolume()->GetHeight(),
-                                       m_ext_data_manager->GetCurrentStructuredVolume()->GetDepth() );
+  bool on_the_fly_gradient = !m_glsl_packed_volume && m_ext_data_manager->IsGradientComputedInShader();
+  cp_shader_rendering->SetDefineFlag("PACKED_VOLUME", m_glsl_packed_volume != nullptr);
+  cp_shader_rendering->SetDefineFlag("ON_THE_FLY_GRADIENT", on_the_fly_gradient);
+  cp_shader_rendering->SetDefineFlag("GRADIENT_TRILINEAR_DERIVATIVE", on_the_fly_gradient && m_on_the_fly_gradient_filter == 1);
+  cp_shader_rendering->SetDefineFlag("APPLY_GRADIENT_SHADING", m_apply_gradient_shading && IsGradientAvailable());
+}
 
-  glm::vec3 vol_voxelsize = glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleX(),
-                                      m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleY(),
-                                      m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleZ());
+bool RayCasting1Pass::IsGradientAvailable ()
+{
+  return m_glsl_packed_volume || m_ext_data_manager->GetCurrentGradientTexture()
+    || m_ext_data_manager->IsGradientComputedInShader();
+}
+
+void RayCasting1Pass::AcquirePackedVolume ()
+{
+  ReleasePackedVolume();
+  // Not a reader of the gradient texture anymore, so it can be dropped for the packed volume
+  SetGradientTextureUser(false);
+  m_glsl_packed_volume = m_ext_data_manager->AcquirePackedVolumeTexture(m_packed_volume_16_bits);
+  // Does not fit in the gpu memory budget: back to the separate textures
+  if (m_glsl_packed_volume == nullptr)
+  {
+    m_use_packed_volume = 0;
+    SetGradientTextureUser(true);
+  }
+}
+
+void RayCasting1Pass::UpdatePackedVolume ()
+{
+  if ((m_use_packed_volume != 0) == (m_glsl_packed_volume != nullptr)) return;
+
+  if (m_use_packed_volume) AcquirePackedVolume();
+  else
+  {
+    ReleasePackedVolume();
+    SetGradientTextureUser(true);
+  }
+  BindVolumeTextures();
+}
+
+void RayCasting1Pass::ReleasePackedVolume ()
+{
+  // Owned by the derived resources of the data manager
+  if (m_glsl_packed_volume) m_ext_data_manager->ReleasePackedVolumeTexture(m_glsl_packed_volume);
+  m_glsl_packed_volume = nullptr;
+}
+
+void RayCasting1Pass::BindVolumeTextures ()
+{
+  cp_shader_rendering->ClearUniform("TexVolumeGradient");
+  cp_shader_rendering->Bind();
+
+  // The packed texture replaces both the volume and the gradient textures
+  if (m_glsl_packed_volume)
+    cp_shader_rendering->SetUniformTexture3D("TexVolume", m_glsl_packed_volume->GetTextureID(), 1);
+  else if (m_ext_data_manager->GetCurrentVolumeTexture())
+    cp_shader_rendering->SetUniformTexture3D("TexVolume", m_ext_data_manager->GetCurrentVolumeTexture()->GetTextureID(), 1);
+  cp_shader_rendering->BindUniform("TexVolume");
+
+  if (m_apply_gradient_shading && !m_glsl_packed_volume && m_ext_data_manager->GetCurrentGradientTexture())
+  {
+    cp_shader_rendering->SetUniformTexture3D("TexVolumeGradient", m_ext_data_manager->GetCurrentGradientTexture()->GetTextureID(), 3);
+    cp_shader_rendering->BindUniform("TexVolumeGradient");
+  }
+
+  gl::ComputeShader::Unbind();
+}
+
+void RayCasting1Pass::CreateRenderingPass ()
+{
+  m_ray_marching_uniforms.SetVolume(m_ext_data_manager->GetCurrentStructuredVolume());
 
-  glm::vec3 vol_aabb = vol_resolution * vol_voxelsize;
- 
   cp_shader_rendering = new gl::ComputeShader();
   cp_shader_rendering->AddShaderFile(CPPVOLREND_DIR"structured/_common_shaders/ray_bbox_intersection.comp");
   cp_shader_rendering->AddShaderFile(CPPVOLREND_DIR"structured/rc1pass/ray_marching_1p.comp");
+  RayMarchingUniforms::AddHeaderFile(cp_shader_rendering);
+  SetShaderDefines();
   cp_shader_rendering->LoadAndLink();
   cp_shader_rendering->Bind();
 
-  if (m_ext_data_manager->GetCurrentVolumeTexture())
-    cp_shader_rendering->SetUniformTexture3D("TexVolume", m_ext_data_manager->GetCurrentVolumeTexture()->GetTextureID(), 1);
   if (m_glsl_transfer_function)
     cp_shader_rendering->SetUniformTexture1D("TexTransferFunc", m_glsl_transfer_function->GetTextureID(), 2);
-  if (m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture())
-    cp_shader_rendering->SetUniformTexture3D("TexVolumeGradient", m_ext_data_manager->GetCurrentGradientTexture()->GetTextureID(), 3);
-
-  cp_shader_rendering->SetUniform("VolumeGridResolution", vol_resolution);
-  cp_shader_rendering->SetUniform("VolumeVoxelSize", vol_voxelsize);
-  cp_shader_rendering->SetUniform("VolumeGridSize", vol_aabb);
 
   cp_shader_rendering->BindUniforms();
   cp_shader_rendering->Unbind();
+
+  BindVolumeTextures();
 }
 
 void RayCasting1Pass::DestroyRenderingPass ()
@@ -67,6 +67,20 @@ private:
   void CreateRenderingPass ();
   void DestroyRenderingPass ();
   void RecreateRenderingPass ();
+
+  // Compile-time options of the ray marching shader, from the ImGui toggles
+  void SetShaderDefines ();
+
+  // Packed density + gradient texture of the data manager, PACKED_VOLUME path of the shader
+  void AcquirePackedVolume ();
+  void ReleasePackedVolume ();
+  // Acquires or releases the packed volume if m_use_packed_volume changed
+  //   (user interface or evaluation parameter)
+  void UpdatePackedVolume ();
+  // Volume (or packed volume) and gradient textures of the current options
+  void BindVolumeTextures ();
+  // Gradient texture, packed volume or gradients computed by the shader
+  bool IsGradientAvailable ();
   
   gl::Texture1D* m_glsl_transfer_function;
 
@@ -74,6 +88,14 @@ private:
 
 
   bool m_apply_gradient_shading;
+
+  // 0: volume + gradient textures, 1: packed volume
+  int m_use_packed_volume;
+  bool m_packed_volume_16_bits;
+  gl::Texture3D* m_glsl_packed_volume;
+
+  // DataManager::SHADER_ON_THE_FLY: 0 central differences, 1 trilinear derivative
+  int m_on_the_fly_gradient_filter;
   
 };
 
@@ -96,6 +96,7 @@ bool RC1PConeLightGroundTruthSteps::Init (int shader_width, int shader_height)
   if (IsBuilt()) Clean();
 
   if (m_ext_data_manager->GetCurrentVolumeTexture() == nullptr) return false;
+  SetGradientTextureUser(true);
   m_tex_transfer_function = m_ext_data_manager->GetCurrentTransferFunction()->GenerateTexture_1D_RGBt();
 
   CreateIntegrationPass();
@@ -293,7 +294,9 @@ void RC1PConeLightGroundTruthSteps::RedrawFrameTexture ()
     glBindImageTexture(1, m_tex_gt_state->GetTextureID(), 0, GL_FALSE, 0, GL_READ_WRITE, GL_RG16F);
 
     glActiveTexture(GL_TEXTURE0);
+    gl::GPUProfiler::Instance()->BeginScope("RayMarch");
     m_gt_rendering->Dispatch();
+    gl::GPUProfiler::Instance()->EndScope();
     gl::ComputeShader::Unbind();
     gl::ExitOnGLError("RC1PConeLightGroundTruthSteps: After dispatch to generate a new frame.");
 
@@ -332,7 +335,9 @@ void RC1PConeLightGroundTruthSteps::RedrawCube ()
   glBindTexture(GL_TEXTURE_2D, m_rdr_frame_to_screen.GetScreenOutputTexture()->GetTextureID());
   glBindImageTexture(0, m_rdr_frame_to_screen.GetScreenOutputTexture()->GetTextureID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   m_cp_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
   gl::ExitOnGLError("RC1PConeLightGroundTruthSteps: After dispatch.");
 }
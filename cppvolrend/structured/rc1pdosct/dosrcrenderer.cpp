@@ -103,6 +103,7 @@ bool RC1PConeTracingDirOcclusionShading::Init (int swidth, int sheight)
   if (IsBuilt()) Clean();
 
   if (m_ext_data_manager->GetCurrentVolumeTexture() == nullptr) return false;
+  SetGradientTextureUser(true);
   m_glsl_transfer_function = m_ext_data_manager->GetCurrentTransferFunction()->GenerateTexture_1D_RGBt();
 
   CreateRenderingPass();
@@ -133,8 +134,15 @@ bool RC1PConeTracingDirOcclusionShading::Init (int swidth, int sheight)
 
 bool RC1PConeTracingDirOcclusionShading::Update (vis::Camera* camera)
 {
+  // Switches to the shader variants of the current options
+  SetShadingDefines(cp_shader_rendering, m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture());
+  cp_shader_rendering->UpdateVariant();
+
   if (m_pre_illum_str_vol.IsActive())
   {
+    SetShadingDefines(cp_lightcache_shader, false);
+    cp_lightcache_shader->UpdateVariant();
+
     PreComputeLightCache(camera);
 
     cp_shader_rendering->Bind();
@@ -191,53 +199,11 @@ bool RC1PConeTracingDirOcclusionShading::Update (vis::Camera* camera)
       m_ext_rendering_parameters->GetScreenHeight(), 0);
   }
 
-  cp_shader_rendering->SetUniform("CameraEye", camera->GetEye());
-  cp_shader_rendering->BindUniform("CameraEye");
-
-  cp_shader_rendering->SetUniform("ViewMatrix", camera->LookAt());
-  cp_shader_rendering->BindUniform("ViewMatrix");
-
-  cp_shader_rendering->SetUniform("ProjectionMatrix", camera->Projection());
-  cp_shader_rendering->BindUniform("ProjectionMatrix");
-
-  cp_shader_rendering->SetUniform("fov_y_tangent", (float)tan(DEGREE_TO_RADIANS(camera->GetFovY()) / 2.0));
-  cp_shader_rendering->BindUniform("fov_y_tangent");
-
-  cp_shader_rendering->SetUniform("aspect_ratio", camera->GetAspectRatio());
-  cp_shader_rendering->BindUniform("aspect_ratio");
-
-  cp_shader_rendering->SetUniform("ApplyOcclusion", glsl_apply_occlusion ? 1 : 0);
-  cp_shader_rendering->BindUniform("ApplyOcclusion");
-
-  cp_shader_rendering->SetUniform("ApplyShadow", glsl_apply_shadow ? 1 : 0);
-  cp_shader_rendering->BindUniform("ApplyShadow");
-
-  cp_shader_rendering->SetUniform("Shade", (glsl_apply_shadow | glsl_apply_occlusion) ? 1 : 0);
-  cp_shader_rendering->BindUniform("Shade");
-
-  cp_shader_rendering->SetUniform("StepSize", m_u_step_size);
-  cp_shader_rendering->BindUniform("StepSize");
-
-  cp_shader_rendering->SetUniform("ApplyPhongShading", (m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture()) ? 1 : 0);
-  cp_shader_rendering->BindUniform("ApplyPhongShading");
-
-  cp_shader_rendering->SetUniform("Kambient", m_ext_rendering_parameters->GetBlinnPhongKambient());
-  cp_shader_rendering->BindUniform("Kambient");
-  cp_shader_rendering->SetUniform("Kdiffuse", m_ext_rendering_parameters->GetBlinnPhongKdiffuse());
-  cp_shader_rendering->BindUniform("Kdiffuse");
-  cp_shader_rendering->SetUniform("Kspecular", m_ext_rendering_parameters->GetBlinnPhongKspecular());
-  cp_shader_rendering->BindUniform("Kspecular");
-  cp_shader_rendering->SetUniform("Nshininess", m_ext_rendering_parameters->GetBlinnPhongNshininess());
-  cp_shader_rendering->BindUniform("Nshininess");
-
-  cp_shader_rendering->SetUniform("Ispecular", m_ext_rendering_parameters->GetLightSourceSpecular());
-  cp_shader_rendering->BindUniform("Ispecular");
-
-  cp_shader_rendering->SetUniform("WorldEyePos", camera->GetEye());
-  cp_shader_rendering->BindUniform("WorldEyePos");
-
-  cp_shader_rendering->SetUniform("WorldLightingPos", m_ext_rendering_parameters->GetBlinnPhongLightingPosition());
-  cp_shader_rendering->BindUniform("WorldLightingPos");
+  // Camera and lighting: one write of the uniform block
+  m_ray_marching_uniforms.SetCamera(camera);
+  m_ray_marching_uniforms.SetStepSize(m_u_step_size);
+  m_ray_marching_uniforms.SetLighting(m_ext_rendering_parameters);
+  m_ray_marching_uniforms.Upload();
 
   cp_shader_rendering->BindUniforms();
 
@@ -253,7 +219,9 @@ void RC1PConeTracingDirOcclusionShading::Redraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.Draw();
@@ -266,7 +234,9 @@ void RC1PConeTracingDirOcclusionShading::MultiSampleRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawMultiSampleHigherResolutionMode();
@@ -279,7 +249,9 @@ void RC1PConeTracingDirOcclusionShading::DownScalingRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawHigherResolutionWithDownScale();
@@ -292,7 +264,9 @@ void RC1PConeTracingDirOcclusionShading::UpScalingRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawLowerResolutionWithUpScale();
@@ -590,12 +564,6 @@ void RC1PConeTracingDirOcclusionShading::PreComputeLightCache (vis::Camera* came
   cp_lightcache_shader->SetUniformTexture1D("TexTransferFunc", m_glsl_transfer_function->GetTextureID(), 2);
   cp_lightcache_shader->BindUniform("TexTransferFunc");
 
-  cp_lightcache_shader->SetUniform("ApplyOcclusion", glsl_apply_occlusion ? 1 : 0);
-  cp_lightcache_shader->BindUniform("ApplyOcclusion");
-
-  cp_lightcache_shader->SetUniform("ApplyShadow", glsl_apply_shadow ? 1 : 0);
-  cp_lightcache_shader->BindUniform("ApplyShadow");
-
   // Upload eye position
   cp_lightcache_shader->SetUniform("WorldEyePos", camera->GetEye());
   cp_lightcache_shader->BindUniform("WorldEyePos");
@@ -646,7 +614,9 @@ void RC1PConeTracingDirOcclusionShading::PreComputeLightCache (vis::Camera* came
     m_pre_illum_str_vol.GetLightCacheTexturePointer()->GetHeight(),
     m_pre_illum_str_vol.GetLightCacheTexturePointer()->GetDepth());
 
+  gl::GPUProfiler::Instance()->BeginScope("LightCache");
   cp_lightcache_shader->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
 
   glBindTexture(GL_TEXTURE_3D, 0);
   glActiveTexture(GL_TEXTURE0);
@@ -656,30 +626,33 @@ void RC1PConeTracingDirOcclusionShading::PreComputeLightCache (vis::Camera* came
   gl::ExitOnGLError("ERROR: After SetData");
 }
 
+void RC1PConeTracingDirOcclusionShading::SetShadingDefines (gl::ComputeShader* shader, bool gradient_shading)
+{
+  shader->SetDefineFlag("APPLY_OCCLUSION", glsl_apply_occlusion);
+  shader->SetDefineFlag("APPLY_SHADOW", glsl_apply_shadow);
+  shader->SetDefineFlag("APPLY_GRADIENT_SHADING", gradient_shading);
+}
+
 void RC1PConeTracingDirOcclusionShading::CreateRenderingPass ()
 {
   bind_volume_of_gaussians = true;
   bind_cone_occlusion_vars = true;
   bind_cone_shadow_vars = true;
 
-  glm::vec3 vol_aabb = glm::vec3(
-    float(m_ext_data_manager->GetCurrentStructuredVolume()->GetWidth())  * (m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleX()),
-    float(m_ext_data_manager->GetCurrentStructuredVolume()->GetHeight()) * (m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleY()),
-    float(m_ext_data_manager->GetCurrentStructuredVolume()->GetDepth())  * (m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleZ())
-  );
-    
+  m_ray_marching_uniforms.SetVolume(m_ext_data_manager->GetCurrentStructuredVolume());
+
   cp_shader_rendering = new gl::ComputeShader();
 
   if (m_pre_illum_str_vol.IsActive())
     cp_shader_rendering->SetShaderFile(CPPVOLREND_DIR"structured/_common_shaders/obj_ray_marching.comp");
   else
     cp_shader_rendering->SetShaderFile(CPPVOLREND_DIR"structured/rc1pdosct/ray_bbox_marching.comp");
+  RayMarchingUniforms::AddHeaderFile(cp_shader_rendering);
+  SetShadingDefines(cp_shader_rendering, m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture());
 
   cp_shader_rendering->LoadAndLink();
   cp_shader_rendering->Bind();
   
-  cp_shader_rendering->SetUniform("VolumeScaledSizes", vol_aabb);
-  
   // Bind volume rendering textures
   if (m_ext_data_manager->GetCurrentVolumeTexture()) cp_shader_rendering->SetUniformTexture3D("TexVolume", m_ext_data_manager->GetCurrentVolumeTexture()->GetTextureID(), 1);
   if (m_glsl_transfer_function) cp_shader_rendering->SetUniformTexture1D("TexTransferFunc", m_glsl_transfer_function->GetTextureID(), 2);
@@ -701,6 +674,7 @@ void RC1PConeTracingDirOcclusionShading::CreateRenderingPass ()
     // Initialize compute shader
     cp_lightcache_shader = new gl::ComputeShader();
     cp_lightcache_shader->SetShaderFile(CPPVOLREND_DIR"structured/rc1pdosct/lightcachecomputation.comp");
+    SetShadingDefines(cp_lightcache_shader, false);
     cp_lightcache_shader->LoadAndLink();
     cp_lightcache_shader->Bind();
 
@@ -749,10 +723,26 @@ void RC1PConeTracingDirOcclusionShading::GenerateExtCoefVolume ()
   GLuint64 startTime, stopTime;
   unsigned int queryID[2];
 
-  glsl_ext_coef_volume = ext_coef_vol_gen.BuildMipMappedTexture(
-    m_ext_data_manager->GetCurrentVolumeTexture(),
-    m_ext_data_manager->GetCurrentTransferFunction()->GenerateTexture_1D_RGBA(),
-    glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetScale()));
+  // Shared with the other renderers while the volume, transfer function and generator parameters do not change
+  glm::ivec3 custom_resolution = ext_coef_vol_gen.GetCustomExtCoefVolumeResolution();
+  float ext_coef_params[5] = { ext_coef_vol_gen.GetBaseLevelGaussianSigma0(),
+    ext_coef_vol_gen.IsUsingCustomExtCoefVolumeResolution() ? 1.0f : 0.0f,
+    (float)custom_resolution.x, (float)custom_resolution.y, (float)custom_resolution.z };
+  vis::ContentHash128 ext_coef_key = m_ext_data_manager->GetDerivedDataKey("dos_extinction_coefficient_volume",
+    ext_coef_params, sizeof(ext_coef_params), true);
+
+  glsl_ext_coef_volume = m_ext_data_manager->GetDerivedResources()->Acquire(ext_coef_key);
+  if (glsl_ext_coef_volume == nullptr)
+  {
+    gl::Texture3D* ext_coef_volume = ext_coef_vol_gen.BuildMipMappedTexture(
+      m_ext_data_manager->GetCurrentVolumeTexture(),
+      m_ext_data_manager->GetCurrentTransferFunction()->GenerateTexture_1D_RGBA(),
+      glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetScale()));
+    // GL_R16F with its mipmaps (8/7 of the base level)
+    size_t ext_coef_bytesize = (size_t)ext_coef_volume->GetWidth() * ext_coef_volume->GetHeight() * ext_coef_volume->GetDepth() * 2 * 8 / 7;
+    glsl_ext_coef_volume = m_ext_data_manager->GetDerivedResources()->Add(ext_coef_key, ext_coef_volume, ext_coef_bytesize,
+      vis::DERIVED_RESOURCE_DEPENDENCY::DEPENDS_ON_VOLUME | vis::DERIVED_RESOURCE_DEPENDENCY::DEPENDS_ON_TRANSFER_FUNCTION);
+  }
 
   // request binding of extinction coefficient volume
   bind_volume_of_gaussians = true;
@@ -765,7 +755,8 @@ void RC1PConeTracingDirOcclusionShading::GenerateExtCoefVolume ()
 
 void RC1PConeTracingDirOcclusionShading::DestroyExtCoefVolume ()
 {
-  if (glsl_ext_coef_volume) delete glsl_ext_coef_volume;
+  // Owned by the derived resources of the data manager
+  if (glsl_ext_coef_volume) m_ext_data_manager->GetDerivedResources()->Release(glsl_ext_coef_volume);
   glsl_ext_coef_volume = nullptr;
 
   gl::ExitOnGLError("Could not destroy gaussian data!");
@@ -93,6 +93,9 @@ private:
   void CreateRenderingPass ();
   void DestroyRenderingPass ();
 
+  // Compile-time options of the rendering and light cache shaders, from the ImGui toggles
+  void SetShadingDefines (gl::ComputeShader* shader, bool gradient_shading);
+
   void GenerateExtCoefVolume ();
   void DestroyExtCoefVolume ();
 
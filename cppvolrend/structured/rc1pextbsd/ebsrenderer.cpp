@@ -86,14 +86,25 @@ bool RC1PExtinctionBasedShading::Init (int swidth, int sheight)
   if (IsBuilt()) Clean();
 
   if (m_ext_data_manager->GetCurrentVolumeTexture() == nullptr) return false;
+  SetGradientTextureUser(true);
   m_glsl_transfer_function = m_ext_data_manager->GetCurrentTransferFunction()->GenerateTexture_1D_RGBt();
 
   // Summed Area Table Dimensions 3D
   st_w = m_ext_data_manager->GetCurrentStructuredVolume()->GetWidth();
   st_h = m_ext_data_manager->GetCurrentStructuredVolume()->GetHeight();
   st_d = m_ext_data_manager->GetCurrentStructuredVolume()->GetDepth();
-  glsl_sat3d_tex = GenerateExtinctionSAT3DTex(m_ext_data_manager->GetCurrentStructuredVolume(),
-                                              m_ext_data_manager->GetCurrentTransferFunction());
+  // Shared with the other renderers while the volume and transfer function do not change
+  vis::ContentHash128 sat_key = m_ext_data_manager->GetDerivedDataKey("ebs_extinction_sat3d", nullptr, 0, true);
+  glsl_sat3d_tex = m_ext_data_manager->GetDerivedResources()->Acquire(sat_key);
+  if (glsl_sat3d_tex == nullptr)
+  {
+    gl::Texture3D* sat3d_tex = GenerateExtinctionSAT3DTex(m_ext_data_manager->GetCurrentStructuredVolume(),
+                                                          m_ext_data_manager->GetCurrentTransferFunction());
+    // GL_R32F
+    size_t sat3d_bytesize = (size_t)sat3d_tex->GetWidth() * sat3d_tex->GetHeight() * sat3d_tex->GetDepth() * sizeof(GLfloat);
+    glsl_sat3d_tex = m_ext_data_manager->GetDerivedResources()->Add(sat_key, sat3d_tex, sat3d_bytesize,
+      vis::DERIVED_RESOURCE_DEPENDENCY::DEPENDS_ON_VOLUME | vis::DERIVED_RESOURCE_DEPENDENCY::DEPENDS_ON_TRANSFER_FUNCTION);
+  }
 
   // Get the current Diagonal of the Volume
   vis::StructuredGridVolume* vold = m_ext_data_manager->GetCurrentStructuredVolume();
@@ -126,8 +137,15 @@ bool RC1PExtinctionBasedShading::Update (vis::Camera* camera)
 {
   if (m_pre_illum_str_vol.IsActive())
   {
+    // Switches to the light cache shader variant of the current options
+    SetShadingDefines(cp_lightcache_shader, false);
+    cp_lightcache_shader->UpdateVariant();
+
     PreComputeLightCache(camera);
 
+    SetShadingDefines(cp_shader_rendering, m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture());
+    cp_shader_rendering->UpdateVariant();
+
     cp_shader_rendering->Bind();
 
     cp_shader_rendering->SetUniformTexture3D("TexVolumeLightCache", m_pre_illum_str_vol.GetLightCacheTexturePointer()->GetTextureID(), 4);
@@ -135,49 +153,32 @@ bool RC1PExtinctionBasedShading::Update (vis::Camera* camera)
   }
   else // image space
   {
+    // Switches to the shader variant of the current options
+    SetShadingDefines(cp_shader_rendering, m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture());
+    cp_shader_rendering->UpdateVariant();
+
     cp_shader_rendering->Bind();
 
     cp_shader_rendering->SetUniformTexture3D("TexVolumeSAT3D", glsl_sat3d_tex->GetTextureID(), 4);
     cp_shader_rendering->BindUniform("TexVolumeSAT3D");
 
-    cp_shader_rendering->SetUniform("u_sat_width", (int)glsl_sat3d_tex->GetWidth());
-    cp_shader_rendering->BindUniform("u_sat_width");
-    cp_shader_rendering->SetUniform("u_sat_height", (int)glsl_sat3d_tex->GetHeight());
-    cp_shader_rendering->BindUniform("u_sat_height");
-    cp_shader_rendering->SetUniform("u_sat_depth", (int)glsl_sat3d_tex->GetDepth());
-    cp_shader_rendering->BindUniform("u_sat_depth");
+    m_u_sat_width.Set((int)glsl_sat3d_tex->GetWidth());
+    m_u_sat_height.Set((int)glsl_sat3d_tex->GetHeight());
+    m_u_sat_depth.Set((int)glsl_sat3d_tex->GetDepth());
 
     // Ambient Occlusion
-    cp_shader_rendering->SetUniform("AmbOccShells", ambient_occlusion_shells);
-    cp_shader_rendering->BindUniform("AmbOccShells");
-
-    cp_shader_rendering->SetUniform("AmbOccRadius", ambient_occlusion_radius);
-    cp_shader_rendering->BindUniform("AmbOccRadius");
+    m_u_amb_occ_shells.Set(ambient_occlusion_shells);
+    m_u_amb_occ_radius.Set(ambient_occlusion_radius);
 
     // Directional Shadows
-    cp_shader_rendering->SetUniform("DirSdwConeSamples", dir_shadow_cone_samples);
-    cp_shader_rendering->BindUniform("DirSdwConeSamples");
-
-    cp_shader_rendering->SetUniform("DirSdwConeAngle", (float)(dir_shadow_cone_angle * glm::pi<double>() / 180.0));
-    cp_shader_rendering->BindUniform("DirSdwConeAngle");
-
-    cp_shader_rendering->SetUniform("DirSdwSampleInterval", dir_shadow_sample_interval);
-    cp_shader_rendering->BindUniform("DirSdwSampleInterval");
-
-    cp_shader_rendering->SetUniform("DirSdwInitialStep", dir_shadow_initial_step);
-    cp_shader_rendering->BindUniform("DirSdwInitialStep");
-
-    cp_shader_rendering->SetUniform("DirSdwUserInterfaceWeight", dir_shadow_user_interface_weight);
-    cp_shader_rendering->BindUniform("DirSdwUserInterfaceWeight");
-
-    cp_shader_rendering->SetUniform("DirSdwConeMaxDistance", dir_cone_max_distance);
-    cp_shader_rendering->BindUniform("DirSdwConeMaxDistance");
-
-    cp_shader_rendering->SetUniform("LightCamForward", m_ext_rendering_parameters->GetBlinnPhongLightSourceCameraForward());
-    cp_shader_rendering->BindUniform("LightCamForward");
-
-    cp_shader_rendering->SetUniform("TypeOfShadow", type_of_shadow);
-    cp_shader_rendering->BindUniform("TypeOfShadow");
+    m_u_dir_sdw_cone_samples.Set(dir_shadow_cone_samples);
+    m_u_dir_sdw_cone_angle.Set((float)(dir_shadow_cone_angle * glm::pi<double>() / 180.0));
+    m_u_dir_sdw_sample_interval.Set(dir_shadow_sample_interval);
+    m_u_dir_sdw_initial_step.Set(dir_shadow_initial_step);
+    m_u_dir_sdw_user_interface_weight.Set(dir_shadow_user_interface_weight);
+    m_u_dir_sdw_cone_max_distance.Set(dir_cone_max_distance);
+
+    m_u_light_cam_forward.Set(m_ext_rendering_parameters->GetBlinnPhongLightSourceCameraForward());
   }
 
   cp_shader_rendering->Bind();
@@ -194,50 +195,11 @@ bool RC1PExtinctionBasedShading::Update (vis::Camera* camera)
       m_ext_rendering_parameters->GetScreenHeight(), 0);
   }
 
-  cp_shader_rendering->SetUniform("CameraEye", camera->GetEye());
-  cp_shader_rendering->BindUniform("CameraEye");
-
-  cp_shader_rendering->SetUniform("ViewMatrix", camera->LookAt());
-  cp_shader_rendering->BindUniform("ViewMatrix");
-
-  cp_shader_rendering->SetUniform("ProjectionMatrix", camera->Projection());
-  cp_shader_rendering->BindUniform("ProjectionMatrix");
-
-  cp_shader_rendering->SetUniform("fov_y_tangent", (float)tan((camera->GetFovY() / 2.0) * glm::pi<double>() / 180.0));
-  cp_shader_rendering->BindUniform("fov_y_tangent");
-
-  cp_shader_rendering->SetUniform("aspect_ratio", camera->GetAspectRatio());
-  cp_shader_rendering->BindUniform("aspect_ratio");
-
-  cp_shader_rendering->SetUniform("ApplyOcclusion", apply_ambient_occlusion ? 1 : 0);
-  cp_shader_rendering->BindUniform("ApplyOcclusion");
-
-  cp_shader_rendering->SetUniform("ApplyShadow", apply_directional_shadows ? 1 : 0);
-  cp_shader_rendering->BindUniform("ApplyShadow");
-
-  cp_shader_rendering->SetUniform("StepSize", m_u_step_size);
-  cp_shader_rendering->BindUniform("StepSize");
-
-  cp_shader_rendering->SetUniform("ApplyPhongShading", (m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture()) ? 1 : 0);
-  cp_shader_rendering->BindUniform("ApplyPhongShading");
-
-  cp_shader_rendering->SetUniform("Kambient", m_ext_rendering_parameters->GetBlinnPhongKambient());
-  cp_shader_rendering->BindUniform("Kambient");
-  cp_shader_rendering->SetUniform("Kdiffuse", m_ext_rendering_parameters->GetBlinnPhongKdiffuse());
-  cp_shader_rendering->BindUniform("Kdiffuse");
-  cp_shader_rendering->SetUniform("Kspecular", m_ext_rendering_parameters->GetBlinnPhongKspecular());
-  cp_shader_rendering->BindUniform("Kspecular");
-  cp_shader_rendering->SetUniform("Nshininess", m_ext_rendering_parameters->GetBlinnPhongNshininess());
-  cp_shader_rendering->BindUniform("Nshininess");
-
-  cp_shader_rendering->SetUniform("Ispecular", m_ext_rendering_parameters->GetLightSourceSpecular());
-  cp_shader_rendering->BindUniform("Ispecular");
-
-  cp_shader_rendering->SetUniform("WorldEyePos", camera->GetEye());
-  cp_shader_rendering->BindUniform("WorldEyePos");
-
-  cp_shader_rendering->SetUniform("WorldLightingPos", m_ext_rendering_parameters->GetBlinnPhongLightingPosition());
-  cp_shader_rendering->BindUniform("WorldLightingPos");
+  // Camera and lighting: one write of the uniform block
+  m_ray_marching_uniforms.SetCamera(camera);
+  m_ray_marching_uniforms.SetStepSize(m_u_step_size);
+  m_ray_marching_uniforms.SetLighting(m_ext_rendering_parameters);
+  m_ray_marching_uniforms.Upload();
 
   cp_shader_rendering->BindUniforms();
 
@@ -253,7 +215,9 @@ void RC1PExtinctionBasedShading::Redraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.Draw();
@@ -266,7 +230,9 @@ void RC1PExtinctionBasedShading::MultiSampleRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawMultiSampleHigherResolutionMode();
@@ -279,7 +245,9 @@ void RC1PExtinctionBasedShading::DownScalingRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawHigherResolutionWithDownScale();
@@ -292,7 +260,9 @@ void RC1PExtinctionBasedShading::UpScalingRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawLowerResolutionWithUpScale();
@@ -521,9 +491,6 @@ void RC1PExtinctionBasedShading::PreComputeLightCache (vis::Camera* camera)
   cp_lightcache_shader->SetUniform("LightCamForward", m_ext_rendering_parameters->GetBlinnPhongLightSourceCameraForward());
   cp_lightcache_shader->BindUniform("LightCamForward");
 
-  cp_lightcache_shader->SetUniform("TypeOfShadow", type_of_shadow);
-  cp_lightcache_shader->BindUniform("TypeOfShadow");
-
   // Upload eye position
   cp_lightcache_shader->SetUniform("WorldEyePos", camera->GetEye());
   cp_lightcache_shader->BindUniform("WorldEyePos");
@@ -532,12 +499,6 @@ void RC1PExtinctionBasedShading::PreComputeLightCache (vis::Camera* camera)
   cp_lightcache_shader->SetUniform("WorldLightingPos", m_ext_rendering_parameters->GetBlinnPhongLightingPosition());
   cp_lightcache_shader->BindUniform("WorldLightingPos");
 
-  cp_lightcache_shader->SetUniform("ApplyOcclusion", apply_ambient_occlusion ? 1 : 0);
-  cp_lightcache_shader->BindUniform("ApplyOcclusion");
-
-  cp_lightcache_shader->SetUniform("ApplyShadow", apply_directional_shadows ? 1 : 0);
-  cp_lightcache_shader->BindUniform("ApplyShadow");
-
   glActiveTexture(GL_TEXTURE0);
   cp_lightcache_shader->RecomputeNumberOfGroups(
     m_pre_illum_str_vol.GetLightCacheTexturePointer()->GetWidth(),
@@ -545,7 +506,9 @@ void RC1PExtinctionBasedShading::PreComputeLightCache (vis::Camera* camera)
     m_pre_illum_str_vol.GetLightCacheTexturePointer()->GetDepth()
   );
 
+  gl::GPUProfiler::Instance()->BeginScope("LightCache");
   cp_lightcache_shader->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
 
   glBindTexture(GL_TEXTURE_3D, 0);
   glActiveTexture(GL_TEXTURE0);
@@ -554,30 +517,43 @@ void RC1PExtinctionBasedShading::PreComputeLightCache (vis::Camera* camera)
   gl::ExitOnGLError("ERROR: After SetData");
 }
 
-void RC1PExtinctionBasedShading::CreateRenderingPass ()
+void RC1PExtinctionBasedShading::SetShadingDefines (gl::ComputeShader* shader, bool gradient_shading)
 {
-  glm::vec3 vol_resolution = glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetWidth(),
-    m_ext_data_manager->GetCurrentStructuredVolume()->GetHeight(),
-    m_ext_data_manager->GetCurrentStructuredVolume()->GetDepth());
+  shader->SetDefineFlag("APPLY_OCCLUSION", apply_ambient_occlusion);
+  shader->SetDefineFlag("APPLY_SHADOW", apply_directional_shadows);
+  shader->SetDefineFlag("DIRECTIONAL_LIGHT_SHADOW", type_of_shadow == 1);
+  shader->SetDefineFlag("APPLY_GRADIENT_SHADING", gradient_shading);
+}
 
-  glm::vec3 vol_voxelsize = glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleX(),
-    m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleY(),
-    m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleZ());
+void RC1PExtinctionBasedShading::CreateRenderingPass ()
+{
+  m_ray_marching_uniforms.SetVolume(m_ext_data_manager->GetCurrentStructuredVolume());
 
-  glm::vec3 vol_aabb = vol_resolution * vol_voxelsize;
-  
   cp_shader_rendering = new gl::ComputeShader();
+  RayMarchingUniforms::AddHeaderFile(cp_shader_rendering);
 
   if (m_pre_illum_str_vol.IsActive())
     cp_shader_rendering->SetShaderFile(CPPVOLREND_DIR"structured/_common_shaders/obj_ray_marching.comp");
   else
     cp_shader_rendering->SetShaderFile(CPPVOLREND_DIR"structured/rc1pextbsd/ebs_ray_bbox_marching.comp");
+  SetShadingDefines(cp_shader_rendering, m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture());
   
   cp_shader_rendering->LoadAndLink();
   cp_shader_rendering->Bind();
 
-  cp_shader_rendering->SetUniform("VolumeScales", vol_voxelsize);
-  cp_shader_rendering->SetUniform("VolumeScaledSizes", vol_aabb);
+  // Set at each Update of the image space mode
+  m_u_sat_width = cp_shader_rendering->GetUniformHandle("u_sat_width");
+  m_u_sat_height = cp_shader_rendering->GetUniformHandle("u_sat_height");
+  m_u_sat_depth = cp_shader_rendering->GetUniformHandle("u_sat_depth");
+  m_u_amb_occ_shells = cp_shader_rendering->GetUniformHandle("AmbOccShells");
+  m_u_amb_occ_radius = cp_shader_rendering->GetUniformHandle("AmbOccRadius");
+  m_u_dir_sdw_cone_samples = cp_shader_rendering->GetUniformHandle("DirSdwConeSamples");
+  m_u_dir_sdw_cone_angle = cp_shader_rendering->GetUniformHandle("DirSdwConeAngle");
+  m_u_dir_sdw_sample_interval = cp_shader_rendering->GetUniformHandle("DirSdwSampleInterval");
+  m_u_dir_sdw_initial_step = cp_shader_rendering->GetUniformHandle("DirSdwInitialStep");
+  m_u_dir_sdw_user_interface_weight = cp_shader_rendering->GetUniformHandle("DirSdwUserInterfaceWeight");
+  m_u_dir_sdw_cone_max_distance = cp_shader_rendering->GetUniformHandle("DirSdwConeMaxDistance");
+  m_u_light_cam_forward = cp_shader_rendering->GetUniformHandle("LightCamForward");
 
   // Bind volume rendering textures
   if (m_ext_data_manager->GetCurrentVolumeTexture()) cp_shader_rendering->SetUniformTexture3D("TexVolume", m_ext_data_manager->GetCurrentVolumeTexture()->GetTextureID(), 1);
@@ -599,6 +575,7 @@ void RC1PExtinctionBasedShading::CreateRenderingPass ()
   {
     cp_lightcache_shader = new gl::ComputeShader();
     cp_lightcache_shader->SetShaderFile(CPPVOLREND_DIR"structured/rc1pextbsd/lightcachecomputation.comp");
+    SetShadingDefines(cp_lightcache_shader, false);
     cp_lightcache_shader->LoadAndLink();
     cp_lightcache_shader->Bind();
 
@@ -612,12 +589,20 @@ void RC1PExtinctionBasedShading::DestroyRenderingShaders ()
 {
   if (cp_shader_rendering != nullptr) delete cp_shader_rendering;
   cp_shader_rendering = nullptr;
+
+  // Handles of the deleted shader
+  m_u_sat_width = m_u_sat_height = m_u_sat_depth = gl::UniformHandle();
+  m_u_amb_occ_shells = m_u_amb_occ_radius = gl::UniformHandle();
+  m_u_dir_sdw_cone_samples = m_u_dir_sdw_cone_angle = m_u_dir_sdw_sample_interval = gl::UniformHandle();
+  m_u_dir_sdw_initial_step = m_u_dir_sdw_user_interface_weight = m_u_dir_sdw_cone_max_distance = gl::UniformHandle();
+  m_u_light_cam_forward = gl::UniformHandle();
 }
 
 void RC1PExtinctionBasedShading::DestroySummedAreaTable ()
 {
+  // Owned by the derived resources of the data manager
   if (glsl_sat3d_tex != nullptr)
-    delete glsl_sat3d_tex;
+    m_ext_data_manager->GetDerivedResources()->Release(glsl_sat3d_tex);
   glsl_sat3d_tex = nullptr;
 }
 
@@ -699,24 +684,7 @@ gl::Texture3D* RC1PExtinctionBasedShading::GenerateExtinctionSAT3DTex (vis::Stru
   // 2
   // Then, we must create and generate the 3D texture
   double* sat_data = sat3d.GetData();
-  GLfloat* data_sat = new GLfloat[sat_w * sat_h * sat_d];
-  for (int x = 0; x < sat_w; x++)
-  {
-    for (int y = 0; y < sat_h; y++)
-    {
-      for (int z = 0; z < sat_d; z++)
-      {
-        int id = x + y * sat_w + z * sat_w * sat_h;
-        data_sat[id] = (GLfloat)sat_data[id];// / double(x * y * z);
-      }
-    }
-  }
-
-  gl::Texture3D* tex3d_sat = new gl::Texture3D(sat_w, sat_h, sat_d);
-  tex3d_sat->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-  tex3d_sat->SetData((GLvoid*)data_sat, GL_R32F, GL_RED, GL_FLOAT);
-
-  delete[] data_sat;
+  gl::Texture3D* tex3d_sat = vis::CreateScalarTexture(sat_data, sat_w, sat_h, sat_d, GL_R32F);
 
   gl::ExitOnGLError("volrend/utils.cpp - GenerateExtinctionSAT3DTex()");
   return tex3d_sat;
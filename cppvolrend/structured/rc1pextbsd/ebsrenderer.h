@@ -84,10 +84,19 @@ protected:
 
   // Rendering shaders
   gl::ComputeShader* cp_shader_rendering;
+  // Uniforms of the image space shader set at each Update, resolved in CreateRenderingPass
+  gl::UniformHandle m_u_sat_width, m_u_sat_height, m_u_sat_depth;
+  gl::UniformHandle m_u_amb_occ_shells, m_u_amb_occ_radius;
+  gl::UniformHandle m_u_dir_sdw_cone_samples, m_u_dir_sdw_cone_angle, m_u_dir_sdw_sample_interval;
+  gl::UniformHandle m_u_dir_sdw_initial_step, m_u_dir_sdw_user_interface_weight, m_u_dir_sdw_cone_max_distance;
+  gl::UniformHandle m_u_light_cam_forward;
 
   glm::mat4 ProjectionMatrix, ViewMatrix;
   void CreateRenderingPass ();
 
+  // Compile-time options of the rendering and light cache shaders, from the ImGui toggles
+  void SetShadingDefines (gl::ComputeShader* shader, bool gradient_shading);
+
 private:
   void DestroyRenderingShaders ();
   void DestroySummedAreaTable ();
@@ -1,5 +1,8 @@
 #include "preprocessingstages.h"
 
+#include <gl_utils/tracer.h>
+#include <gl_utils/halffloat.h>
+
 VCTPreProcessing::VCTPreProcessing ()
 {
   use_glsl_to_precompute_data = false;
@@ -20,7 +23,7 @@ double VCTPreProcessing::GetMeanFromSuperVoxel (int lvl, int lw, int lh, int ld,
   int y = glm::clamp(lh, 0, vh);
   int z = glm::clamp(ld, 0, vd);
 
-  return tree_spr_voxel[lvl]->sv_data[x + (y * vw) + (z * vw * vh)].mean;
+  return tree_spr_voxel[lvl]->sv_data[(size_t)x + ((size_t)y * vw) + ((size_t)z * vw * vh)].mean;
 }
 
 double VCTPreProcessing::GetStdDevFromSuperVoxel (int lvl, int lw, int lh, int ld, int vw, int vh, int vd)
@@ -29,11 +32,12 @@ double VCTPreProcessing::GetStdDevFromSuperVoxel (int lvl, int lw, int lh, int l
   int y = glm::clamp(lh, 0, vh);
   int z = glm::clamp(ld, 0, vd);
 
-  return tree_spr_voxel[lvl]->sv_data[x + (y * vw) + (z * vw * vh)].stdv;
+  return tree_spr_voxel[lvl]->sv_data[(size_t)x + ((size_t)y * vw) + ((size_t)z * vw * vh)].stdv;
 }
 
 void VCTPreProcessing::PreProcessSuperVoxels (vis::StructuredGridVolume* vol)
 {
+  TRACE_SCOPE("PreProcessSuperVoxels", "preprocess");
   if (use_glsl_to_precompute_data)
   {
     //glsl_supervoxel_meanstddev = GLSLPreComputeSuperVoxels();
@@ -51,8 +55,8 @@ void VCTPreProcessing::PreProcessSuperVoxels (vis::StructuredGridVolume* vol)
     {
       for (int z = 0; z < d; z++)
       {
-        tree_spr_voxel[0]->sv_data[x + (y * w) + (z * w * h)].mean = vol->GetNormalizedSample(x,y,z) * 255.0;
-        tree_spr_voxel[0]->sv_data[x + (y * w) + (z * w * h)].stdv = 0.0;
+        tree_spr_voxel[0]->sv_data[tree_spr_voxel[0]->GetIndex(x, y, z)].mean = vol->GetNormalizedSample(x,y,z) * 255.0;
+        tree_spr_voxel[0]->sv_data[tree_spr_voxel[0]->GetIndex(x, y, z)].stdv = 0.0;
       }
     }
   }
@@ -90,7 +94,7 @@ void VCTPreProcessing::PreProcessSuperVoxels (vis::StructuredGridVolume* vol)
           double vm7 = GetMeanFromSuperVoxel(mm_level - 1, lw + 1, lh + 1, ld + 1, vw, vh, vd);
           double vmn = (vm0 + vm1 + vm2 + vm3 + vm4 + vm5 + vm6 + vm7) / 8.0;
 
-          tree_spr_voxel[mm_level]->sv_data[iw + (ih * w) + (id * w * h)].mean = vmn;
+          tree_spr_voxel[mm_level]->sv_data[tree_spr_voxel[mm_level]->GetIndex(iw, ih, id)].mean = vmn;
 
           double vstdd = glm::sqrt(
             (pow(vm0 - vmn, 2.0)
@@ -103,7 +107,7 @@ void VCTPreProcessing::PreProcessSuperVoxels (vis::StructuredGridVolume* vol)
               + pow(vm7 - vmn, 2.0)) / 8.0
           );
 
-          tree_spr_voxel[mm_level]->sv_data[iw + (ih * w) + (id * w * h)].stdv = vstdd;
+          tree_spr_voxel[mm_level]->sv_data[tree_spr_voxel[mm_level]->GetIndex(iw, ih, id)].stdv = vstdd;
 
           max_stddev = glm::max(vstdd, max_stddev);
         }
@@ -123,22 +127,28 @@ void VCTPreProcessing::PreProcessSuperVoxels (vis::StructuredGridVolume* vol)
   glsl_supervoxel_meanstddev->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, true);
 
   // Set the data of each mipmap level to then update to glsl shader
+  //   (half float rows are uploaded tightly packed)
+  GLint unpack_alignment;
+  glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack_alignment);
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
   for (int i = 0; i < mm_level; i++)
   {
     int w = tree_spr_voxel[i]->dim.x;
     int h = tree_spr_voxel[i]->dim.y;
     int d = tree_spr_voxel[i]->dim.z;
         
-    GLfloat* sdata = new GLfloat[w*h*d * 2];
-    for (int v = 0; v < w*h*d; v++)
+    size_t n_voxels = (size_t)w * (size_t)h * (size_t)d;
+    GLhalf* sdata = new GLhalf[n_voxels * 2];
+    for (size_t v = 0; v < n_voxels; v++)
     {
-      sdata[v * 2 + 0] = tree_spr_voxel[i]->sv_data[v].mean;
-      sdata[v * 2 + 1] = tree_spr_voxel[i]->sv_data[v].stdv;
+      sdata[v * 2 + 0] = gl::FloatToHalf((float)tree_spr_voxel[i]->sv_data[v].mean);
+      sdata[v * 2 + 1] = gl::FloatToHalf((float)tree_spr_voxel[i]->sv_data[v].stdv);
     }
 
-    glTexImage3D(GL_TEXTURE_3D, i, GL_RG16F, w, h, d, 0, GL_RG, GL_FLOAT, sdata);
+    glTexImage3D(GL_TEXTURE_3D, i, GL_RG16F, w, h, d, 0, GL_RG, GL_HALF_FLOAT, sdata);
     delete[] sdata;
   }
+  glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment);
 
   maximum_standard_deviation = max_stddev;
   printf("Super Voxels Computed! Maximum Standard Deviation %g\n", max_stddev);
@@ -183,18 +193,19 @@ void VCTPreProcessing::PreProcessPreIntegrationTable (vis::StructuredGridVolume*
   int w = glm::ceil(dens_val);
   int h = glm::ceil(maximum_standard_deviation);
 
-  GLfloat* preintegrationvalues = new GLfloat[w * h];
+  // Stored as half floats as they are computed, no float staging copy
+  GLhalf* preintegrationvalues = new GLhalf[w * h];
   for (int iw = 0; iw < w; iw++)
   {
     for (int ih = 0; ih < h; ih++)
     {
-      preintegrationvalues[iw + (ih * w)] = (float)OpacityGaussianEvaluation(iw, ih, vol, tf);
+      preintegrationvalues[iw + (ih * w)] = gl::FloatToHalf((float)OpacityGaussianEvaluation(iw, ih, vol, tf));
     }
   }
 
   glsl_preintegration_lookup = new gl::Texture2D(w, h);
   glsl_preintegration_lookup->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-  glsl_preintegration_lookup->SetData(preintegrationvalues, GL_R16F, GL_RED, GL_FLOAT);
+  glsl_preintegration_lookup->SetData(preintegrationvalues, GL_R16F, GL_RED);
 
   delete[] preintegrationvalues;
 
@@ -80,7 +80,12 @@ public:
     SuperVoxelLevel (glm::ivec3 voldim)
     {
       dim = voldim;
-      sv_data = new SuperVoxel[dim.x * dim.y * dim.z];
+      sv_data = new SuperVoxel[(size_t)dim.x * (size_t)dim.y * (size_t)dim.z];
+    }
+
+    size_t GetIndex (int x, int y, int z)
+    {
+      return (size_t)x + ((size_t)y * (size_t)dim.x) + ((size_t)z * (size_t)dim.x * (size_t)dim.y);
     }
 
     ~SuperVoxelLevel ()
@@ -88,6 +88,7 @@ bool RC1PVoxelConeTracingSGPU::Init (int swidth, int sheight)
   if (IsBuilt()) Clean();
 
   if (m_ext_data_manager->GetCurrentVolumeTexture() == nullptr) return false;
+  SetGradientTextureUser(true);
   m_glsl_transfer_function = m_ext_data_manager->GetCurrentTransferFunction()->GenerateTexture_1D_RGBt();
 
   // Pre Processing stage to compute supervoxels and preintegration table
@@ -123,8 +124,15 @@ bool RC1PVoxelConeTracingSGPU::Init (int swidth, int sheight)
 
 bool RC1PVoxelConeTracingSGPU::Update (vis::Camera* camera)
 {
+  // Switches to the shader variants of the current options
+  SetShadingDefines(cp_shader_rendering, m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture());
+  cp_shader_rendering->UpdateVariant();
+
   if (m_pre_illum_str_vol.IsActive())
   {
+    SetShadingDefines(cp_lightcache_shader, false);
+    cp_lightcache_shader->UpdateVariant();
+
     PreComputeLightCache(camera);
 
     cp_shader_rendering->Bind();
@@ -184,50 +192,11 @@ bool RC1PVoxelConeTracingSGPU::Update (vis::Camera* camera)
       m_ext_rendering_parameters->GetScreenHeight(), 0);
   }
 
-  cp_shader_rendering->SetUniform("CameraEye", camera->GetEye());
-  cp_shader_rendering->BindUniform("CameraEye");
-
-  cp_shader_rendering->SetUniform("ViewMatrix", camera->LookAt());
-  cp_shader_rendering->BindUniform("ViewMatrix");
-
-  cp_shader_rendering->SetUniform("ProjectionMatrix", camera->Projection());
-  cp_shader_rendering->BindUniform("ProjectionMatrix");
-
-  cp_shader_rendering->SetUniform("fov_y_tangent", (float)tan((camera->GetFovY() / 2.0) * glm::pi<double>() / 180.0));
-  cp_shader_rendering->BindUniform("fov_y_tangent");
-
-  cp_shader_rendering->SetUniform("aspect_ratio", camera->GetAspectRatio());
-  cp_shader_rendering->BindUniform("aspect_ratio");
-
-  cp_shader_rendering->SetUniform("ApplyOcclusion", apply_ambient_occlusion ? 1 : 0);
-  cp_shader_rendering->BindUniform("ApplyOcclusion");
-
-  cp_shader_rendering->SetUniform("ApplyShadow", apply_voxel_cone_tracing ? 1 : 0);
-  cp_shader_rendering->BindUniform("ApplyShadow");
-
-  cp_shader_rendering->SetUniform("StepSize", m_u_step_size);
-  cp_shader_rendering->BindUniform("StepSize");
-
-  cp_shader_rendering->SetUniform("ApplyPhongShading", (m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture()) ? 1 : 0);
-  cp_shader_rendering->BindUniform("ApplyPhongShading");
-
-  cp_shader_rendering->SetUniform("Kambient", m_ext_rendering_parameters->GetBlinnPhongKambient());
-  cp_shader_rendering->BindUniform("Kambient");
-  cp_shader_rendering->SetUniform("Kdiffuse", m_ext_rendering_parameters->GetBlinnPhongKdiffuse());
-  cp_shader_rendering->BindUniform("Kdiffuse");
-  cp_shader_rendering->SetUniform("Kspecular", m_ext_rendering_parameters->GetBlinnPhongKspecular());
-  cp_shader_rendering->BindUniform("Kspecular");
-  cp_shader_rendering->SetUniform("Nshininess", m_ext_rendering_parameters->GetBlinnPhongNshininess());
-  cp_shader_rendering->BindUniform("Nshininess");
-
-  cp_shader_rendering->SetUniform("Ispecular", m_ext_rendering_parameters->GetLightSourceSpecular());
-  cp_shader_rendering->BindUniform("Ispecular");
-
-  cp_shader_rendering->SetUniform("WorldEyePos", camera->GetEye());
-  cp_shader_rendering->BindUniform("WorldEyePos");
-
-  cp_shader_rendering->SetUniform("WorldLightingPos", m_ext_rendering_parameters->GetBlinnPhongLightingPosition());
-  cp_shader_rendering->BindUniform("WorldLightingPos");
+  // Camera and lighting: one write of the uniform block
+  m_ray_marching_uniforms.SetCamera(camera);
+  m_ray_marching_uniforms.SetStepSize(m_u_step_size);
+  m_ray_marching_uniforms.SetLighting(m_ext_rendering_parameters);
+  m_ray_marching_uniforms.Upload();
 
   cp_shader_rendering->BindUniforms();
 
@@ -243,7 +212,9 @@ void RC1PVoxelConeTracingSGPU::Redraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.Draw();
@@ -256,7 +227,9 @@ void RC1PVoxelConeTracingSGPU::MultiSampleRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawMultiSampleHigherResolutionMode();
@@ -269,7 +242,9 @@ void RC1PVoxelConeTracingSGPU::DownScalingRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawHigherResolutionWithDownScale();
@@ -282,7 +257,9 @@ void RC1PVoxelConeTracingSGPU::UpScalingRedraw ()
   cp_shader_rendering->Bind();
   m_rdr_frame_to_screen.BindImageTexture();
 
+  gl::GPUProfiler::Instance()->BeginScope("RayMarch");
   cp_shader_rendering->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
   gl::ComputeShader::Unbind();
 
   m_rdr_frame_to_screen.DrawLowerResolutionWithUpScale();
@@ -492,12 +469,6 @@ void RC1PVoxelConeTracingSGPU::PreComputeLightCache (vis::Camera* camera)
   cp_lightcache_shader->SetUniform("WorldLightingPos", lpos);
   cp_lightcache_shader->BindUniform("WorldLightingPos");
 
-  cp_lightcache_shader->SetUniform("ApplyOcclusion", apply_ambient_occlusion ? 1 : 0);
-  cp_lightcache_shader->BindUniform("ApplyOcclusion");
-
-  cp_lightcache_shader->SetUniform("ApplyShadow", apply_voxel_cone_tracing ? 1 : 0);
-  cp_lightcache_shader->BindUniform("ApplyShadow");
-
   glActiveTexture(GL_TEXTURE0);
   cp_lightcache_shader->RecomputeNumberOfGroups(
     m_pre_illum_str_vol.GetLightCacheTexturePointer()->GetWidth(),
@@ -505,7 +476,9 @@ void RC1PVoxelConeTracingSGPU::PreComputeLightCache (vis::Camera* camera)
     m_pre_illum_str_vol.GetLightCacheTexturePointer()->GetDepth()
   );
 
+  gl::GPUProfiler::Instance()->BeginScope("LightCache");
   cp_lightcache_shader->Dispatch();
+  gl::GPUProfiler::Instance()->EndScope();
 
   glBindTexture(GL_TEXTURE_3D, 0);
   glActiveTexture(GL_TEXTURE0);
@@ -514,17 +487,16 @@ void RC1PVoxelConeTracingSGPU::PreComputeLightCache (vis::Camera* camera)
   gl::ExitOnGLError("ERROR: After SetData");
 }
 
-void RC1PVoxelConeTracingSGPU::CreateRenderingPass ()
+void RC1PVoxelConeTracingSGPU::SetShadingDefines (gl::ComputeShader* shader, bool gradient_shading)
 {
-  glm::vec3 vol_resolution = glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetWidth(),
-    m_ext_data_manager->GetCurrentStructuredVolume()->GetHeight(),
-    m_ext_data_manager->GetCurrentStructuredVolume()->GetDepth());
-
-  glm::vec3 vol_voxelsize = glm::vec3(m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleX(),
-    m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleY(),
-    m_ext_data_manager->GetCurrentStructuredVolume()->GetScaleZ());
+  shader->SetDefineFlag("APPLY_OCCLUSION", apply_ambient_occlusion);
+  shader->SetDefineFlag("APPLY_SHADOW", apply_voxel_cone_tracing);
+  shader->SetDefineFlag("APPLY_GRADIENT_SHADING", gradient_shading);
+}
 
-  glm::vec3 vol_aabb = vol_resolution * vol_voxelsize;
+void RC1PVoxelConeTracingSGPU::CreateRenderingPass ()
+{
+  m_ray_marching_uniforms.SetVolume(m_ext_data_manager->GetCurrentStructuredVolume());
 
   cp_shader_rendering = new gl::ComputeShader();
 
@@ -536,15 +508,13 @@ void RC1PVoxelConeTracingSGPU::CreateRenderingPass ()
   {
     cp_shader_rendering->SetShaderFile(CPPVOLREND_DIR"structured/rc1pvctsg/vct_ray_bbox_marching.comp");
   }
+  RayMarchingUniforms::AddHeaderFile(cp_shader_rendering);
+  SetShadingDefines(cp_shader_rendering, m_apply_gradient_shading && m_ext_data_manager->GetCurrentGradientTexture());
   
   cp_shader_rendering->LoadAndLink();
 
   cp_shader_rendering->Bind();
 
-  cp_shader_rendering->SetUniform("VolumeScaledSizes", vol_aabb);
-  cp_shader_rendering->SetUniform("VolumeScales", vol_voxelsize);
-
-
   // Bind volume rendering textures
   if (m_ext_data_manager->GetCurrentVolumeTexture()) cp_shader_rendering->SetUniformTexture3D("TexVolume", m_ext_data_manager->GetCurrentVolumeTexture()->GetTextureID(), 1);
   if (m_glsl_transfer_function) cp_shader_rendering->SetUniformTexture1D("TexTransferFunc", m_glsl_transfer_function->GetTextureID(), 2);
@@ -566,6 +536,7 @@ void RC1PVoxelConeTracingSGPU::CreateRenderingPass ()
     // Initialize compute shader
     cp_lightcache_shader = new gl::ComputeShader();
     cp_lightcache_shader->SetShaderFile(CPPVOLREND_DIR"structured/rc1pvctsg/lightcachecomputation.comp");
+    SetShadingDefines(cp_lightcache_shader, false);
     cp_lightcache_shader->LoadAndLink();
     cp_lightcache_shader->Bind();
 
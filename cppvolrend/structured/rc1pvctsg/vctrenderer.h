@@ -86,6 +86,9 @@ private:
   void CreateRenderingPass ();
   void DestroyRenderingShaders ();
 
+  // Compile-time options of the rendering and light cache shaders, from the ImGui toggles
+  void SetShadingDefines (gl::ComputeShader* shader, bool gradient_shading);
+
   gl::Texture1D* m_glsl_transfer_function;
 
   float m_u_step_size;
@@ -2,12 +2,14 @@
 
 #include <iostream>
 #include <gl_utils/utils.h>
+#include <gl_utils/framebufferobject.h>
+#include <gl_utils/gpumemoryregistry.h>
 
 #include <GL/glew.h>
 
 void LayeredFrameBufferObject::Unbind()
 {
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, gl::FrameBufferObject::GetScreenFramebuffer());
 }
 
 void LayeredFrameBufferObject::Bind()
@@ -24,12 +26,15 @@ LayeredFrameBufferObject::LayeredFrameBufferObject (GLuint custom_number_of_atta
   glGenFramebuffers(1, &m_id);
   Bind();
   Unbind();
+
+  gl::GPUMemoryRegistry::Instance()->SetOwner(this, "layered frame buffers");
 }
 
 LayeredFrameBufferObject::~LayeredFrameBufferObject ()
 {
   DestroyAttachments();
   glDeleteFramebuffers(1, &m_id);
+  if (gl::GPUMemoryRegistry::Exists()) gl::GPUMemoryRegistry::Instance()->Unregister(this);
 
   gl::ExitOnGLError("Error when destroying gl::LayeredFrameBufferObject!");
 }
@@ -62,6 +67,9 @@ bool LayeredFrameBufferObject::GenerateAttachments(unsigned int screen_width, un
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
   }
 
+  gl::GPUMemoryRegistry::Instance()->Register(this, gl::GPU_MEMORY_TEXTURE_2D, GL_RGBA16F,
+    (size_t)width * height * GetCurrentNumberOfAttachments() * gl::GPUMemoryRegistry::GetTexelByteSize(GL_RGBA16F));
+
   for (int i = 0; i < GetCurrentNumberOfAttachments(); i++)
     glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, m_color_attachments[i], 0);
 
@@ -89,6 +97,7 @@ void LayeredFrameBufferObject::DestroyAttachments ()
 {
   for (int i = 0; i < GetCurrentNumberOfAttachments(); i++)
     glDeleteTextures(1, &m_color_attachments[i]);
+  if (gl::GPUMemoryRegistry::Exists()) gl::GPUMemoryRegistry::Instance()->Register(this, gl::GPU_MEMORY_TEXTURE_2D, 0, 0);
 }
 
 bool LayeredFrameBufferObject::Resize (unsigned int screen_width, unsigned int screen_height)
@@ -106,7 +115,7 @@ bool LayeredFrameBufferObject::Resize (unsigned int screen_width, unsigned int s
 void LayeredFrameBufferObject::RenderColorAttachments(unsigned int screen_width, unsigned int screen_height)
 {
   // output frame = screen
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, gl::FrameBufferObject::GetScreenFramebuffer());
 
   // input frame = gBuffer
   glBindFramebuffer(GL_READ_FRAMEBUFFER, m_id);
@@ -154,13 +163,13 @@ void LayeredFrameBufferObject::RenderColorAttachments(unsigned int screen_width,
   glReadBuffer(GL_COLOR_ATTACHMENT7);
   glBlitFramebuffer(0, 0, width, height, x30, yd0, x31, yd1, GL_COLOR_BUFFER_BIT, GL_LINEAR);
 
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, gl::FrameBufferObject::GetScreenFramebuffer());
 }
 
 void LayeredFrameBufferObject::RenderColorAttachment(unsigned int screen_width, unsigned int screen_height, int id)
 {
   //output frame = screen
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  glBindFramebuffer(GL_FRAMEBUFFER, gl::FrameBufferObject::GetScreenFramebuffer());
 
   //input frame = framebuffer
   glBindFramebuffer(GL_READ_FRAMEBUFFER, m_id);
@@ -171,7 +180,7 @@ void LayeredFrameBufferObject::RenderColorAttachment(unsigned int screen_width,
   // https://stackoverflow.com/questions/11315534/copying-depth-render-buffer-to-the-depth-buffer
   //glBlitFramebuffer(0, 0, width, height, 0, 0, screen_width, screen_height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 
-  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+  glBindFramebuffer(GL_DRAW_FRAMEBUFFER, gl::FrameBufferObject::GetScreenFramebuffer());
 }
 
 GLint LayeredFrameBufferObject::GetMaxLayers()
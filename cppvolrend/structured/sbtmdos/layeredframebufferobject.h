@@ -8,7 +8,7 @@
 class LayeredFrameBufferObject
 {
 public:
-  /*! Unbind Framebuffer Object (bind GL_FRAMEBUFFER to 0).
+  /*! Unbind Framebuffer Object (bind GL_FRAMEBUFFER to gl::FrameBufferObject::GetScreenFramebuffer).
   */
   static void Unbind();
 
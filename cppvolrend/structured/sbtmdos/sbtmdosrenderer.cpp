@@ -180,6 +180,7 @@ void SBTMDirectionalOcclusionShading::Redraw ()
 
   GLuint eye_buffer = 2;
 
+  gl::GPUProfiler::Instance()->BeginScope("SliceRender");
   lfb_object.Bind();
 
   glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT | GL_TEXTURE_BIT);
@@ -242,6 +243,7 @@ void SBTMDirectionalOcclusionShading::Redraw ()
   glPopAttrib();
 
   lfb_object.Unbind();
+  gl::GPUProfiler::Instance()->EndScope();
   // BLEND THE RESULT WITH THE BACKGROUND COLOR
   // 27. CompositWithWindowFrameBuffer(eye_buffer)
 //#define SIBGRAPI_2019
@@ -271,6 +273,7 @@ void SBTMDirectionalOcclusionShading::MultiSampleRedraw ()
 
   GLuint eye_buffer = 2;
 
+  gl::GPUProfiler::Instance()->BeginScope("SliceRender");
   lfb_object.Bind();
 
   glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT | GL_TEXTURE_BIT | GL_VIEWPORT_BIT);
@@ -333,6 +336,7 @@ void SBTMDirectionalOcclusionShading::MultiSampleRedraw ()
   glPopAttrib();
 
   lfb_object.Unbind();
+  gl::GPUProfiler::Instance()->EndScope();
   // BLEND THE RESULT WITH THE BACKGROUND COLOR
   // 27. CompositWithWindowFrameBuffer(eye_buffer)
 //#define SIBGRAPI_2019
@@ -362,6 +366,7 @@ void SBTMDirectionalOcclusionShading::DownScalingRedraw ()
 
   GLuint eye_buffer = 2;
 
+  gl::GPUProfiler::Instance()->BeginScope("SliceRender");
   lfb_object.Bind();
 
   glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT | GL_TEXTURE_BIT | GL_VIEWPORT_BIT);
@@ -424,6 +429,7 @@ void SBTMDirectionalOcclusionShading::DownScalingRedraw ()
   glPopAttrib();
 
   lfb_object.Unbind();
+  gl::GPUProfiler::Instance()->EndScope();
   // BLEND THE RESULT WITH THE BACKGROUND COLOR
   // 27. CompositWithWindowFrameBuffer(eye_buffer)
 //#define SIBGRAPI_2019
@@ -456,6 +462,7 @@ void SBTMDirectionalOcclusionShading::UpScalingRedraw ()
 
   GLuint eye_buffer = 2;
 
+  gl::GPUProfiler::Instance()->BeginScope("SliceRender");
   lfb_object.Bind();
 
   glPushAttrib(GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT | GL_TEXTURE_BIT | GL_VIEWPORT_BIT);
@@ -518,6 +525,7 @@ void SBTMDirectionalOcclusionShading::UpScalingRedraw ()
   glPopAttrib();
 
   lfb_object.Unbind();
+  gl::GPUProfiler::Instance()->EndScope();
   // BLEND THE RESULT WITH THE BACKGROUND COLOR
   // 27. CompositWithWindowFrameBuffer(eye_buffer)
 //#define SIBGRAPI_2019
@@ -0,0 +1,106 @@
+#include "framestatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+FrameStatistics::FrameStatistics ()
+  : n_frames(0)
+  , mean(0.0), min(0.0), max(0.0)
+  , median(0.0), p95(0.0), p99(0.0)
+  , stddev(0.0)
+  , n_outliers(0)
+  , filtered_mean(0.0)
+  , filtered_stddev(0.0)
+  , unstable(false)
+{
+}
+
+FrameStatistics::~FrameStatistics ()
+{
+}
+
+void FrameStatistics::Compute (const std::vector<double>& frame_times_ms, double max_cv)
+{
+  *this = FrameStatistics();
+  n_frames = (int)frame_times_ms.size();
+  if (n_frames == 0) return;
+
+  std::vector<double> sorted_times = frame_times_ms;
+  std::sort(sorted_times.begin(), sorted_times.end());
+
+  min = sorted_times.front();
+  max = sorted_times.back();
+  median = Percentile(sorted_times, 50.0);
+  p95 = Percentile(sorted_times, 95.0);
+  p99 = Percentile(sorted_times, 99.0);
+
+  double sum = 0.0;
+  for (int i = 0; i < n_frames; i++)
+    sum += sorted_times[i];
+  mean = sum / double(n_frames);
+
+  double sum_sq_diff = 0.0;
+  for (int i = 0; i < n_frames; i++)
+    sum_sq_diff += (sorted_times[i] - mean) * (sorted_times[i] - mean);
+  stddev = n_frames > 1 ? std::sqrt(sum_sq_diff / double(n_frames - 1)) : 0.0;
+
+  // Median absolute deviation, scaled to be comparable to the stddev of a normal distribution
+  std::vector<double> abs_deviations(n_frames);
+  for (int i = 0; i < n_frames; i++)
+    abs_deviations[i] = std::abs(sorted_times[i] - median);
+  std::sort(abs_deviations.begin(), abs_deviations.end());
+  const double mad = 1.4826 * Percentile(abs_deviations, 50.0);
+
+  double filtered_sum = 0.0;
+  int n_filtered = 0;
+  for (int i = 0; i < n_frames; i++)
+  {
+    if (mad > 0.0 && std::abs(sorted_times[i] - median) > FRAME_STATISTICS_OUTLIER_MADS * mad)
+    {
+      n_outliers++;
+      continue;
+    }
+    filtered_sum += sorted_times[i];
+    n_filtered++;
+  }
+  filtered_mean = filtered_sum / double(n_filtered);
+
+  double filtered_sum_sq_diff = 0.0;
+  for (int i = 0; i < n_frames; i++)
+  {
+    if (mad > 0.0 && std::abs(sorted_times[i] - median) > FRAME_STATISTICS_OUTLIER_MADS * mad) continue;
+    filtered_sum_sq_diff += (sorted_times[i] - filtered_mean) * (sorted_times[i] - filtered_mean);
+  }
+  filtered_stddev = n_filtered > 1 ? std::sqrt(filtered_sum_sq_diff / double(n_filtered - 1)) : 0.0;
+
+  // Too few frames also give unreliable estimates
+  unstable = n_frames < 3 || (filtered_mean > 0.0 && filtered_stddev / filtered_mean > max_cv);
+}
+
+std::string FrameStatistics::GetCsvHeader ()
+{
+  return "MinFrameTime (ms),MedianFrameTime (ms),P95FrameTime (ms),P99FrameTime (ms),MaxFrameTime (ms),"
+         "StdDevFrameTime (ms),Outliers,FilteredTimePerFrame (ms),Unstable";
+}
+
+std::string FrameStatistics::GetCsvValues ()
+{
+  return std::to_string(min) + ","
+       + std::to_string(median) + ","
+       + std::to_string(p95) + ","
+       + std::to_string(p99) + ","
+       + std::to_string(max) + ","
+       + std::to_string(stddev) + ","
+       + std::to_string(n_outliers) + ","
+       + std::to_string(filtered_mean) + ","
+       + (unstable ? "1" : "0");
+}
+
+double FrameStatistics::Percentile (const std::vector<double>& sorted_values, double p)
+{
+  const double rank = (p / 100.0) * double(sorted_values.size() - 1);
+  const size_t r0 = (size_t)std::floor(rank);
+  const size_t r1 = std::min(r0 + 1, sorted_values.size() - 1);
+  const double t = rank - double(r0);
+  return sorted_values[r0] * (1.0 - t) + sorted_values[r1] * t;
+}
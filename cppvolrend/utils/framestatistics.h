@@ -0,0 +1,59 @@
+/**
+ * Statistics of the frame times measured for one evaluation sample.
+ *
+ * Besides the mean, order statistics (median, p95, p99) are computed, since
+ *   frame times are skewed by occasional slow frames (driver work, shader
+ *   rebuilds, os scheduling). Outliers are the frames farther than
+ *   FRAME_STATISTICS_OUTLIER_MADS median absolute deviations from the median,
+ *   and are left out of the filtered mean.
+ *
+ * A sample is flagged as unstable if the coefficient of variation
+ *   (stddev / mean) of the frames, outliers excluded, is above a threshold.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef CPPVOLREND_FRAME_STATISTICS_H
+#define CPPVOLREND_FRAME_STATISTICS_H
+
+#include <string>
+#include <vector>
+
+#define FRAME_STATISTICS_OUTLIER_MADS 5.0
+#define FRAME_STATISTICS_DEFAULT_MAX_CV 0.05
+
+class FrameStatistics
+{
+public:
+  FrameStatistics ();
+  ~FrameStatistics ();
+
+  void Compute (const std::vector<double>& frame_times_ms, double max_cv = FRAME_STATISTICS_DEFAULT_MAX_CV);
+
+  // Column names and values, comma separated, in the same order
+  static std::string GetCsvHeader ();
+  std::string GetCsvValues ();
+
+  int n_frames;
+  double mean;
+  double min;
+  double max;
+  double median;
+  double p95;
+  double p99;
+  double stddev;
+
+  int n_outliers;
+  double filtered_mean;
+  double filtered_stddev;
+
+  bool unstable;
+
+protected:
+  // Linear interpolation between the closest ranks, sorted_values must not be empty
+  static double Percentile (const std::vector<double>& sorted_values, double p);
+
+private:
+};
+
+#endif
@@ -0,0 +1,285 @@
+#include "imagemetrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#define IMAGE_METRICS_PI 3.14159265358979323846
+
+namespace
+{
+  float SRGBToLinear (float c)
+  {
+    return c <= 0.04045f ? c / 12.92f : pow((c + 0.055f) / 1.055f, 2.4f);
+  }
+
+  glm::vec3 LinearRGBToXYZ (glm::vec3 c)
+  {
+    return glm::vec3(0.4124564f * c.r + 0.3575761f * c.g + 0.1804375f * c.b,
+                     0.2126729f * c.r + 0.7151522f * c.g + 0.0721750f * c.b,
+                     0.0193339f * c.r + 0.1191920f * c.g + 0.9503041f * c.b);
+  }
+
+  glm::vec3 XYZToLinearRGB (glm::vec3 c)
+  {
+    return glm::vec3( 3.2404542f * c.x - 1.5371385f * c.y - 0.4985314f * c.z,
+                     -0.9692660f * c.x + 1.8760108f * c.y + 0.0415560f * c.z,
+                      0.0556434f * c.x - 0.2040259f * c.y + 1.0572252f * c.z);
+  }
+
+  // White point: XYZ of linear RGB (1, 1, 1)
+  const glm::vec3 XYZ_WHITE = LinearRGBToXYZ(glm::vec3(1.0f));
+
+  // Linearized CIELab (Y, Cx, Cz) used by FLIP for the spatial filtering
+  glm::vec3 XYZToYCxCz (glm::vec3 c)
+  {
+    c = c / XYZ_WHITE;
+    return glm::vec3(116.0f * c.y - 16.0f, 500.0f * (c.x - c.y), 200.0f * (c.y - c.z));
+  }
+
+  glm::vec3 YCxCzToXYZ (glm::vec3 c)
+  {
+    float y = (c.x + 16.0f) / 116.0f;
+    return glm::vec3(y + c.y / 500.0f, y, y - c.z / 200.0f) * XYZ_WHITE;
+  }
+
+  // CIELab, with a* and b* scaled by 0.01 L* (Hunt effect)
+  glm::vec3 XYZToHuntLab (glm::vec3 c)
+  {
+    const float delta = 6.0f / 29.0f;
+    c = c / XYZ_WHITE;
+    for (int i = 0; i < 3; i++)
+      c[i] = c[i] > delta * delta * delta ? cbrt(c[i]) : c[i] / (3.0f * delta * delta) + 4.0f / 29.0f;
+
+    float l = 116.0f * c.y - 16.0f;
+    return glm::vec3(l, 0.01f * l * 500.0f * (c.x - c.y), 0.01f * l * 200.0f * (c.y - c.z));
+  }
+
+  float HyAB (glm::vec3 a, glm::vec3 b)
+  {
+    return fabs(a.x - b.x) + sqrt((a.y - b.y) * (a.y - b.y) + (a.z - b.z) * (a.z - b.z));
+  }
+}
+
+ImageMetrics::ImageMetrics ()
+  : rmse(0.0)
+  , psnr(0.0)
+  , ssim(0.0)
+  , flip_color(0.0)
+{}
+
+ImageMetrics::~ImageMetrics ()
+{}
+
+bool ImageMetrics::Compute (const std::vector<glm::vec4>& reference, const std::vector<glm::vec4>& image, int w, int h,
+                            glm::vec3 background, double pixels_per_degree)
+{
+  rmse = psnr = ssim = flip_color = std::numeric_limits<double>::quiet_NaN();
+
+  const int n_pixels = w * h;
+  if (n_pixels <= 0 || reference.size() != n_pixels || image.size() != n_pixels)
+    return false;
+
+  // Colors over the background, and their luminance
+  std::vector<glm::vec3> srgb_ref(n_pixels), srgb_img(n_pixels);
+  std::vector<float> y_ref(n_pixels), y_img(n_pixels);
+  double sum_sq_error = 0.0;
+#pragma omp parallel for reduction(+:sum_sq_error)
+  for (int i = 0; i < n_pixels; i++)
+  {
+    srgb_ref[i] = glm::clamp(glm::vec3(reference[i]) + (1.0f - reference[i].a) * background, 0.0f, 1.0f);
+    srgb_img[i] = glm::clamp(glm::vec3(image[i]) + (1.0f - image[i].a) * background, 0.0f, 1.0f);
+    y_ref[i] = glm::dot(srgb_ref[i], glm::vec3(0.2126f, 0.7152f, 0.0722f));
+    y_img[i] = glm::dot(srgb_img[i], glm::vec3(0.2126f, 0.7152f, 0.0722f));
+
+    glm::vec3 d = srgb_img[i] - srgb_ref[i];
+    sum_sq_error += (double)glm::dot(d, d);
+  }
+
+  rmse = sqrt(sum_sq_error / (3.0 * n_pixels));
+  psnr = rmse > 0.0 ? 20.0 * log10(1.0 / rmse) : std::numeric_limits<double>::infinity();
+  ssim = ComputeSSIM(y_ref, y_img, w, h);
+  flip_color = ComputeFLIPColor(srgb_ref, srgb_img, w, h, pixels_per_degree);
+
+  return true;
+}
+
+std::string ImageMetrics::GetCsvHeader ()
+{
+  return "RMSE,PSNR (dB),SSIM,FLIPColor";
+}
+
+std::string ImageMetrics::GetCsvValues ()
+{
+  return std::to_string(rmse) + ","
+       + std::to_string(psnr) + ","
+       + std::to_string(ssim) + ","
+       + std::to_string(flip_color);
+}
+
+void ImageMetrics::Convolve (std::vector<float>& channel, int w, int h, const std::vector<float>& kernel)
+{
+  const int radius = (int)kernel.size() / 2;
+  std::vector<float> tmp(channel.size());
+
+#pragma omp parallel for
+  for (int y = 0; y < h; y++)
+  {
+    for (int x = 0; x < w; x++)
+    {
+      float sum = 0.0f;
+      for (int k = -radius; k <= radius; k++)
+        sum += kernel[k + radius] * channel[y * w + glm::clamp(x + k, 0, w - 1)];
+      tmp[y * w + x] = sum;
+    }
+  }
+
+#pragma omp parallel for
+  for (int y = 0; y < h; y++)
+  {
+    for (int x = 0; x < w; x++)
+    {
+      float sum = 0.0f;
+      for (int k = -radius; k <= radius; k++)
+        sum += kernel[k + radius] * tmp[glm::clamp(y + k, 0, h - 1) * w + x];
+      channel[y * w + x] = sum;
+    }
+  }
+}
+
+double ImageMetrics::ComputeSSIM (const std::vector<float>& y_ref, const std::vector<float>& y_img, int w, int h)
+{
+  const int n_pixels = w * h;
+  const double sigma = 1.5;
+  const int radius = 5;
+  std::vector<float> kernel(2 * radius + 1);
+  float kernel_sum = 0.0f;
+  for (int k = -radius; k <= radius; k++)
+  {
+    kernel[k + radius] = (float)exp(-(k * k) / (2.0 * sigma * sigma));
+    kernel_sum += kernel[k + radius];
+  }
+  for (int k = 0; k < kernel.size(); k++) kernel[k] /= kernel_sum;
+
+  // Local means, variances and covariance
+  std::vector<float> mu_ref = y_ref, mu_img = y_img;
+  std::vector<float> sq_ref(n_pixels), sq_img(n_pixels), prod(n_pixels);
+#pragma omp parallel for
+  for (int i = 0; i < n_pixels; i++)
+  {
+    sq_ref[i] = y_ref[i] * y_ref[i];
+    sq_img[i] = y_img[i] * y_img[i];
+    prod[i] = y_ref[i] * y_img[i];
+  }
+  Convolve(mu_ref, w, h, kernel);
+  Convolve(mu_img, w, h, kernel);
+  Convolve(sq_ref, w, h, kernel);
+  Convolve(sq_img, w, h, kernel);
+  Convolve(prod, w, h, kernel);
+
+  // Dynamic range of 1
+  const double c1 = 0.01 * 0.01, c2 = 0.03 * 0.03;
+  double sum_ssim = 0.0;
+#pragma omp parallel for reduction(+:sum_ssim)
+  for (int i = 0; i < n_pixels; i++)
+  {
+    double mr = mu_ref[i], mi = mu_img[i];
+    double var_ref = sq_ref[i] - mr * mr;
+    double var_img = sq_img[i] - mi * mi;
+    double covar = prod[i] - mr * mi;
+    sum_ssim += ((2.0 * mr * mi + c1) * (2.0 * covar + c2))
+              / ((mr * mr + mi * mi + c1) * (var_ref + var_img + c2));
+  }
+
+  return sum_ssim / n_pixels;
+}
+
+double ImageMetrics::ComputeFLIPColor (const std::vector<glm::vec3>& srgb_ref, const std::vector<glm::vec3>& srgb_img,
+                                       int w, int h, double pixels_per_degree)
+{
+  const int n_pixels = w * h;
+
+  // Contrast sensitivity functions of the achromatic, red-green and blue-yellow
+  //   channels: sums of two gaussians a * sqrt(pi / b) * exp(-pi^2 d^2 / b),
+  //   d in degrees. Each gaussian is separable, and filtered on its own.
+  const double csf_a[3][2] = { { 1.0, 0.0 }, { 1.0, 0.0 }, { 34.1, 13.5 } };
+  const double csf_b[3][2] = { { 0.0047, 1e-5 }, { 0.0053, 1e-5 }, { 0.04, 0.025 } };
+  const int radius = (int)ceil(3.0 * sqrt(0.04 / (2.0 * IMAGE_METRICS_PI * IMAGE_METRICS_PI)) * pixels_per_degree);
+
+  std::vector<float> channels[2][3];
+  for (int img = 0; img < 2; img++)
+  {
+    const std::vector<glm::vec3>& srgb = img == 0 ? srgb_ref : srgb_img;
+    for (int c = 0; c < 3; c++) channels[img][c].resize(n_pixels);
+
+#pragma omp parallel for
+    for (int i = 0; i < n_pixels; i++)
+    {
+      glm::vec3 lin(SRGBToLinear(srgb[i].r), SRGBToLinear(srgb[i].g), SRGBToLinear(srgb[i].b));
+      glm::vec3 ycxcz = XYZToYCxCz(LinearRGBToXYZ(lin));
+      for (int c = 0; c < 3; c++) channels[img][c][i] = ycxcz[c];
+    }
+
+    for (int c = 0; c < 3; c++)
+    {
+      // Weights of the 2D gaussians, normalized so the whole filter sums to 1
+      std::vector<float> kernels[2];
+      double weights[2] = { 0.0, 0.0 };
+      for (int g = 0; g < 2; g++)
+      {
+        if (csf_a[c][g] == 0.0) continue;
+        kernels[g].resize(2 * radius + 1);
+        double sum = 0.0;
+        for (int k = -radius; k <= radius; k++)
+        {
+          double d = k / pixels_per_degree;
+          kernels[g][k + radius] = (float)exp(-IMAGE_METRICS_PI * IMAGE_METRICS_PI * d * d / csf_b[c][g]);
+          sum += kernels[g][k + radius];
+        }
+        for (int k = 0; k < kernels[g].size(); k++) kernels[g][k] = (float)(kernels[g][k] / sum);
+        weights[g] = csf_a[c][g] * sqrt(IMAGE_METRICS_PI / csf_b[c][g]) * sum * sum;
+      }
+
+      if (kernels[1].empty())
+      {
+        Convolve(channels[img][c], w, h, kernels[0]);
+      }
+      else
+      {
+        std::vector<float> second = channels[img][c];
+        Convolve(channels[img][c], w, h, kernels[0]);
+        Convolve(second, w, h, kernels[1]);
+        const float w0 = (float)(weights[0] / (weights[0] + weights[1]));
+#pragma omp parallel for
+        for (int i = 0; i < n_pixels; i++)
+          channels[img][c][i] = w0 * channels[img][c][i] + (1.0f - w0) * second[i];
+      }
+    }
+  }
+
+  // Color error, remapped so that errors above pc * cmax use the last 5% of the range
+  const float qc = 0.7f, pc = 0.4f, pt = 0.95f;
+  const float cmax = pow(HyAB(XYZToHuntLab(LinearRGBToXYZ(glm::vec3(0.0f, 1.0f, 0.0f))),
+                              XYZToHuntLab(LinearRGBToXYZ(glm::vec3(0.0f, 0.0f, 1.0f)))), qc);
+  double sum_error = 0.0;
+#pragma omp parallel for reduction(+:sum_error)
+  for (int i = 0; i < n_pixels; i++)
+  {
+    glm::vec3 lab[2];
+    for (int img = 0; img < 2; img++)
+    {
+      glm::vec3 ycxcz(channels[img][0][i], channels[img][1][i], channels[img][2][i]);
+      glm::vec3 lin = glm::clamp(XYZToLinearRGB(YCxCzToXYZ(ycxcz)), 0.0f, 1.0f);
+      lab[img] = XYZToHuntLab(LinearRGBToXYZ(lin));
+    }
+
+    float error = pow(HyAB(lab[0], lab[1]), qc);
+    if (error < pc * cmax)
+      error = pt / (pc * cmax) * error;
+    else
+      error = pt + (error - pc * cmax) / (cmax - pc * cmax) * (1.0f - pt);
+    sum_error += error;
+  }
+
+  return sum_error / n_pixels;
+}
@@ -0,0 +1,66 @@
+/**
+ * Image quality metrics between a rendered frame and a reference frame,
+ *   e.g. the output of a ground truth renderer or of a run with many samples.
+ *
+ * Both images are premultiplied RGBA floats (the output texture of a volume
+ *   renderer), composited over the background color before the comparison,
+ *   and taken as sRGB colors in [0, 1]:
+ *
+ * . RMSE and PSNR (dB) of the RGB channels (PSNR is inf for equal images)
+ * . SSIM of the luminance, 11x11 gaussian windows (sigma 1.5)
+ *     Z. Wang et al., Image Quality Assessment: From Error Visibility to
+ *     Structural Similarity, 2004
+ * . FLIPColor: mean color error of FLIP, in [0, 1], with the spatial
+ *     filtering of the contrast sensitivity functions and the HyAB distance
+ *     in Hunt-adjusted L*a*b*. The feature (edge and point) term of FLIP is
+ *     not computed, so FLIPColor underestimates FLIP around sharp edges.
+ *     P. Andersson et al., FLIP: A Difference Evaluator for Alternating
+ *     Images, 2020
+ *
+ * The per pixel work and the filters run in parallel with OpenMP.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef CPPVOLREND_IMAGE_METRICS_H
+#define CPPVOLREND_IMAGE_METRICS_H
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Pixels per degree of visual angle used by FLIP (0.7 m from a 0.7 m wide 4K monitor)
+#define IMAGE_METRICS_DEFAULT_PIXELS_PER_DEGREE 67.0
+
+class ImageMetrics
+{
+public:
+  ImageMetrics ();
+  ~ImageMetrics ();
+
+  // Returns false (and NaN metrics) if the images are empty or their sizes do not match w x h
+  bool Compute (const std::vector<glm::vec4>& reference, const std::vector<glm::vec4>& image, int w, int h,
+                glm::vec3 background, double pixels_per_degree = IMAGE_METRICS_DEFAULT_PIXELS_PER_DEGREE);
+
+  // Column names and values, comma separated, in the same order
+  static std::string GetCsvHeader ();
+  std::string GetCsvValues ();
+
+  double rmse;
+  double psnr;
+  double ssim;
+  double flip_color;
+
+protected:
+  // Separable convolution with a normalized 1D kernel of 2 * radius + 1 weights, clamped at the borders
+  static void Convolve (std::vector<float>& channel, int w, int h, const std::vector<float>& kernel);
+
+  static double ComputeSSIM (const std::vector<float>& y_ref, const std::vector<float>& y_img, int w, int h);
+  static double ComputeFLIPColor (const std::vector<glm::vec3>& srgb_ref, const std::vector<glm::vec3>& srgb_img,
+                                  int w, int h, double pixels_per_degree);
+
+private:
+};
+
+#endif
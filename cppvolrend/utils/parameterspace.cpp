@@ -28,6 +28,30 @@ void ParameterSpace::ClearParameterDimensions()
   ComputeNumSamplePoints();
 }
 
+void ParameterSpace::RemoveParameterDimension(const int idx)
+{
+  assert(idx >=0 && idx < m_dimensions.size());
+  delete m_dimensions[idx];
+  m_dimensions.erase(m_dimensions.begin() + idx);
+
+  ComputeNumSamplePoints();
+}
+
+int ParameterSpace::FindDimension(const std::string& name) const
+{
+  for(int i=0;i<(int)m_dimensions.size();i++)
+  {
+    if (m_dimensions[i]->GetName() == name) return i;
+  }
+  return -1;
+}
+
+ParameterRangeBase* ParameterSpace::GetDimension(const int idx)
+{
+  assert(idx >=0 && idx < m_dimensions.size());
+  return m_dimensions[idx];
+}
+
 int ParameterSpace::GetNumDimensions() const
 {
   return (int)m_dimensions.size();
@@ -45,6 +69,25 @@ const std::string ParameterSpace::GetDimensionValue(const int idx) const
   return m_dimensions[idx]->GetValueStr();
 }
 
+void ParameterSpace::SetSamplePoint(const std::vector<int>& steps)
+{
+  assert(steps.size() == m_dimensions.size());
+  for(int i=0;i<(int)m_dimensions.size();i++)
+  {
+    m_dimensions[i]->SetStep(steps[i]);
+  }
+}
+
+std::vector<int> ParameterSpace::GetNearestSamplePoint() const
+{
+  std::vector<int> steps(m_dimensions.size());
+  for(int i=0;i<(int)m_dimensions.size();i++)
+  {
+    steps[i] = m_dimensions[i]->GetNearestStep();
+  }
+  return steps;
+}
+
 int ParameterSpace::ComputeNumSamplePoints()
 {
   m_numsamples_cached = 0;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <math.h>
+#include <algorithm>
 #include <cassert>
 #include <vector>
 #include <string>
@@ -37,6 +38,12 @@ public:
   ///Returns the number of steps in this range.
   virtual int NumSteps() const = 0;
 
+  ///Sets the parameter to a given step of the range, clamped to [0, NumSteps() - 1].
+  virtual void SetStep(const int step) = 0;
+
+  ///Returns the step of the range closest to the current value.
+  virtual int GetNearestStep() const = 0;
+
   ///Store the current value to be restored later with RestoreCurrentValue()
   virtual void SaveCurrentValue() = 0;
 
@@ -49,6 +56,13 @@ public:
   ///Returns the current value as a string
   virtual std::string GetValueStr() const = 0;
 
+  ///Sets the current value, converted to the parameter type. It does not need to lie on a step.
+  virtual void SetValue(const double value) = 0;
+
+  ///Changes start, end and step size of the range, converted to the parameter type.
+  ///Returns false (and keeps the previous range) if the values are not a valid range.
+  virtual bool SetRange(const double start, const double end, const double incr) = 0;
+
 //Attributes
 protected:
   ///Name of this range
@@ -143,12 +157,43 @@ public:
     return 1 + (int)ceil((m_end - m_start) / m_incr);
   }
 
+  ///Sets the parameter to a given step of the range, clamped to [0, NumSteps() - 1].
+  virtual void SetStep(const int step) override
+  {
+    assert(m_curr);
+    const int s = std::max(0, std::min(step, NumSteps() - 1));
+    *m_curr = std::min((T)(m_start + s * m_incr), m_end);
+  }
+
+  ///Returns the step of the range closest to the current value.
+  virtual int GetNearestStep() const override
+  {
+    assert(m_curr);
+    const int s = (int)floor((double)(*m_curr - m_start) / (double)m_incr + 0.5);
+    return std::max(0, std::min(s, NumSteps() - 1));
+  }
+
   ///Returns the current value as a string
   virtual std::string GetValueStr() const override
   {
     return std::to_string(*m_curr);
   }
 
+  ///Sets the current value, converted to the parameter type. It does not need to lie on a step.
+  virtual void SetValue(const double value) override
+  {
+    assert(m_curr);
+    *m_curr = (T)value;
+  }
+
+  ///Changes start, end and step size of the range, converted to the parameter type.
+  virtual bool SetRange(const double start, const double end, const double incr) override
+  {
+    if (start > end || (T)incr <= 0) return false;
+    Set((T)start, (T)end, (T)incr, m_curr);
+    return true;
+  }
+
 //Attributes
 protected:
   T m_start;
@@ -183,6 +228,19 @@ public:
   ///Removes all dimensions.
   void ClearParameterDimensions();
 
+  ///Removes (and deletes) a dimension identified by index.
+  void RemoveParameterDimension(const int idx);
+
+  ///Returns the index of the dimension with the given name, or -1.
+  int FindDimension(const std::string& name) const;
+
+  ///Returns a dimension identified by index, e.g. to change its range.
+  ///Call UpdateNumSamplePoints() after changing it.
+  ParameterRangeBase* GetDimension(const int idx);
+
+  ///Recomputes the number of sample points after a range was changed.
+  void UpdateNumSamplePoints() {ComputeNumSamplePoints();};
+
   ///The number of dimensions.
   int GetNumDimensions() const;
 
@@ -194,6 +252,13 @@ public:
   /// This can be used as the content of a csv file.
   const std::string GetDimensionValue(const int idx) const;
 
+  ///Sets all dimensions to the given steps, one per dimension.
+  ///This allows to visit the sample points in any order, e.g. for a search.
+  void SetSamplePoint(const std::vector<int>& steps);
+
+  ///Returns the steps closest to the current values, one per dimension.
+  std::vector<int> GetNearestSamplePoint() const;
+
   ///The number of sample points of the parameter space.
   int GetNumSamplePoints() const {return m_numsamples_cached;};
 
@@ -0,0 +1,326 @@
+#include "parametertuner.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+ParameterTuner::ParameterTuner()
+  :m_goal(FASTEST_WITHIN_ERROR)
+  ,m_threshold(0.02)
+  ,m_metric(ERROR_RMSE)
+  ,m_max_passes(3)
+  ,m_pspace(NULL)
+  ,m_running(false)
+  ,m_pass(0)
+  ,m_dim(0)
+  ,m_stride(1)
+  ,m_line_best(0)
+{
+}
+
+ParameterTuner::~ParameterTuner()
+{
+}
+
+void ParameterTuner::SetGoal(const Goal goal, const double threshold)
+{
+  m_goal = goal;
+  m_threshold = threshold;
+}
+
+const char* ParameterTuner::GetErrorMetricName(const ErrorMetric metric)
+{
+  switch (metric)
+  {
+  case ERROR_ONE_MINUS_SSIM:
+    return "1-SSIM";
+  case ERROR_FLIP_COLOR:
+    return "FLIPColor";
+  default:
+    return "RMSE";
+  }
+}
+
+bool ParameterTuner::Start(ParameterSpace* pspace)
+{
+  m_running = false;
+  m_points.clear();
+  m_pspace = pspace;
+  if (!m_pspace || m_pspace->GetNumDimensions() == 0) return false;
+
+  //The search starts at the current parameters
+  m_best = m_pspace->GetNearestSamplePoint();
+  m_pass_start = m_best;
+  m_pass = 0;
+  m_dim = 0;
+  StartLine();
+
+  m_running = true;
+  return Advance();
+}
+
+bool ParameterTuner::Next(const double time_ms, const ImageMetrics& metrics)
+{
+  if (!m_running) return false;
+
+  SamplePoint point;
+  point.steps = m_current;
+  for(int i=0;i<m_pspace->GetNumDimensions();i++)
+  {
+    point.values.push_back(m_pspace->GetDimensionValue(i));
+  }
+  point.time_ms = time_ms;
+  point.error = GetError(metrics);
+  point.feasible = (m_goal == FASTEST_WITHIN_ERROR) ? point.error <= m_threshold : point.time_ms <= m_threshold;
+  point.pareto = false;
+  m_points[m_current] = point;
+
+  return Advance();
+}
+
+void ParameterTuner::Stop()
+{
+  if (!m_running) return;
+  m_running = false;
+
+  SamplePoint best;
+  if (GetBestPoint(&best)) m_pspace->SetSamplePoint(best.steps);
+  UpdateParetoFront();
+}
+
+bool ParameterTuner::GetBestPoint(SamplePoint* point) const
+{
+  const SamplePoint* best = NULL;
+  for(auto it=m_points.begin();it!=m_points.end();it++)
+  {
+    if (!best || IsBetter(it->second, *best)) best = &it->second;
+  }
+  if (!best) return false;
+
+  *point = *best;
+  return true;
+}
+
+void ParameterTuner::WriteCsv(std::ostream& os) const
+{
+  SamplePoint best;
+  const bool has_best = GetBestPoint(&best);
+
+  for(int i=0;m_pspace && i<m_pspace->GetNumDimensions();i++)
+  {
+    os << m_pspace->GetDimensionName(i) << ",";
+  }
+  os << "TimePerFrame (ms),Error (" << GetErrorMetricName(m_metric) << "),Feasible,Pareto,Best\n";
+
+  for(auto it=m_points.begin();it!=m_points.end();it++)
+  {
+    const SamplePoint& p = it->second;
+    for(int i=0;i<(int)p.values.size();i++)
+    {
+      os << p.values[i] << ",";
+    }
+    os << std::to_string(p.time_ms) << "," << std::to_string(p.error) << ","
+       << (p.feasible ? 1 : 0) << "," << (p.pareto ? 1 : 0) << ","
+       << ((has_best && p.steps == best.steps) ? 1 : 0) << "\n";
+  }
+}
+
+bool ParameterTuner::WritePreset(const std::string& filepath, const std::vector<std::string>& header) const
+{
+  SamplePoint best;
+  if (!GetBestPoint(&best)) return false;
+
+  std::ofstream f_preset(filepath, std::ios_base::out);
+  if (!f_preset.is_open())
+  {
+    std::cout << "Error: Unable to write preset " << filepath << "." << std::endl;
+    return false;
+  }
+
+  for(int i=0;i<(int)header.size();i++)
+  {
+    f_preset << "# " << header[i] << "\n";
+  }
+  for(int i=0;i<(int)best.values.size();i++)
+  {
+    f_preset << m_pspace->GetDimensionName(i) << " " << best.values[i] << "\n";
+  }
+  f_preset.close();
+
+  printf("Preset written to %s\n", filepath.c_str());
+  return true;
+}
+
+bool ParameterTuner::ReadPreset(const std::string& filepath, ParameterSpace* pspace)
+{
+  std::ifstream f_preset(filepath);
+  if (!f_preset.is_open())
+  {
+    std::cout << "Error: Unable to read preset " << filepath << "." << std::endl;
+    return false;
+  }
+
+  std::string s_line;
+  int n_line = 0;
+  while (std::getline(f_preset, s_line))
+  {
+    n_line++;
+    s_line = s_line.substr(0, s_line.find('#'));
+    if (s_line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+    std::istringstream ss(s_line);
+    std::string name;
+    double value;
+    if (!(ss >> name >> value))
+    {
+      std::cout << "Error: Invalid value at line " << n_line << " of preset " << filepath << "." << std::endl;
+      return false;
+    }
+
+    const int idx = pspace->FindDimension(name);
+    if (idx < 0)
+    {
+      printf("Warning: preset parameter %s is not a parameter of the current renderer\n", name.c_str());
+      continue;
+    }
+    pspace->GetDimension(idx)->SetValue(value);
+  }
+  f_preset.close();
+
+  return true;
+}
+
+double ParameterTuner::GetError(const ImageMetrics& metrics) const
+{
+  double error;
+  switch (m_metric)
+  {
+  case ERROR_ONE_MINUS_SSIM:
+    error = 1.0 - metrics.ssim;
+    break;
+  case ERROR_FLIP_COLOR:
+    error = metrics.flip_color;
+    break;
+  default:
+    error = metrics.rmse;
+    break;
+  }
+  return std::isnan(error) ? std::numeric_limits<double>::infinity() : error;
+}
+
+bool ParameterTuner::IsBetter(const SamplePoint& a, const SamplePoint& b) const
+{
+  if (a.feasible != b.feasible) return a.feasible;
+
+  //Feasible points are ranked by the objective, infeasible ones by the constraint
+  const bool by_time = (m_goal == FASTEST_WITHIN_ERROR) == a.feasible;
+  if (by_time)
+  {
+    if (a.time_ms != b.time_ms) return a.time_ms < b.time_ms;
+    return a.error < b.error;
+  }
+  if (a.error != b.error) return a.error < b.error;
+  return a.time_ms < b.time_ms;
+}
+
+void ParameterTuner::StartLine()
+{
+  const int n = m_pspace->GetDimension(m_dim)->NumSteps();
+
+  //Coarse steps first, at least 5 of them
+  m_stride = 1;
+  while (m_stride * 8 <= n - 1) m_stride *= 2;
+
+  m_line_queue.clear();
+  m_line_queue.push_back(m_best[m_dim]);
+  for(int s=0;s<n;s+=m_stride)
+  {
+    m_line_queue.push_back(s);
+  }
+  m_line_queue.push_back(n - 1);
+  m_line_best = m_best[m_dim];
+}
+
+bool ParameterTuner::Advance()
+{
+  while (true)
+  {
+    //Next point of the line that was not measured yet
+    while (!m_line_queue.empty())
+    {
+      std::vector<int> point = m_best;
+      point[m_dim] = m_line_queue.front();
+      m_line_queue.erase(m_line_queue.begin());
+
+      if (m_points.find(point) == m_points.end())
+      {
+        m_current = point;
+        m_pspace->SetSamplePoint(m_current);
+        return true;
+      }
+    }
+
+    //Best step of the line among the measured ones
+    const int n = m_pspace->GetDimension(m_dim)->NumSteps();
+    const SamplePoint* line_best = NULL;
+    std::vector<int> point = m_best;
+    for(int s=0;s<n;s++)
+    {
+      point[m_dim] = s;
+      auto it = m_points.find(point);
+      if (it != m_points.end() && (!line_best || IsBetter(it->second, *line_best)))
+      {
+        line_best = &it->second;
+        m_line_best = s;
+      }
+    }
+
+    //Refine around it with half the stride
+    if (m_stride > 1)
+    {
+      m_stride /= 2;
+      if (m_line_best - m_stride >= 0) m_line_queue.push_back(m_line_best - m_stride);
+      if (m_line_best + m_stride < n) m_line_queue.push_back(m_line_best + m_stride);
+      continue;
+    }
+
+    //Line done, go to the next dimension
+    m_best[m_dim] = m_line_best;
+    m_dim++;
+    if (m_dim == m_pspace->GetNumDimensions())
+    {
+      //Pass done, stop if the best point did not move
+      m_pass++;
+      m_dim = 0;
+      if (m_best == m_pass_start || m_pass >= m_max_passes)
+      {
+        m_running = false;
+        m_pspace->SetSamplePoint(m_best);
+        UpdateParetoFront();
+        return false;
+      }
+      m_pass_start = m_best;
+    }
+    StartLine();
+  }
+}
+
+void ParameterTuner::UpdateParetoFront()
+{
+  for(auto it=m_points.begin();it!=m_points.end();it++)
+  {
+    SamplePoint& p = it->second;
+    p.pareto = true;
+    for(auto jt=m_points.begin();jt!=m_points.end() && p.pareto;jt++)
+    {
+      const SamplePoint& q = jt->second;
+      if (q.time_ms <= p.time_ms && q.error <= p.error && (q.time_ms < p.time_ms || q.error < p.error))
+      {
+        p.pareto = false;
+      }
+    }
+  }
+}
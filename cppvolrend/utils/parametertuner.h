@@ -0,0 +1,158 @@
+#pragma once
+
+#include "parameterspace.h"
+#include "imagemetrics.h"
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** Searches a parameter space for a good trade-off between speed and quality,
+*   instead of evaluating all of its sample points.
+*
+*   Each sample point is measured by the caller (time per frame and image
+*   metrics against a reference image) and reported with Next(), which then
+*   moves the parameter space to the next point to measure.
+*
+*   The search is a coordinate descent: one dimension after the other is
+*   searched with the others fixed at the best point found so far, until a
+*   pass over all dimensions does not move the best point anymore.
+*   Each line search starts with every k-th step of the dimension and then
+*   halves k around the best step (k = 4, 2, 1 for 20 steps, 10 instead of
+*   20 sample points). Measured points are cached, so lines crossing at the best
+*   point and the later passes only measure new points.
+*
+*   A point is feasible if it meets the constraint of the goal: an error
+*   threshold (the fastest feasible point is best) or a time budget (the
+*   feasible point with the smallest error is best). Infeasible points are
+*   ranked by the value of the constraint, so the search walks towards the
+*   feasible region.
+*
+*   All measured points are kept, with their (time, error) Pareto front.
+*/
+class ParameterTuner
+{
+//Types
+public:
+  enum Goal
+  {
+    FASTEST_WITHIN_ERROR = 0,
+    BEST_QUALITY_WITHIN_TIME = 1,
+  };
+
+  ///Image metric used as error (lower is better).
+  enum ErrorMetric
+  {
+    ERROR_RMSE = 0,
+    ERROR_ONE_MINUS_SSIM = 1,
+    ERROR_FLIP_COLOR = 2,
+  };
+
+  class SamplePoint
+  {
+  public:
+    std::vector<int> steps;
+    ///Parameter values as strings, one per dimension.
+    std::vector<std::string> values;
+    double time_ms;
+    double error;
+    bool feasible;
+    bool pareto;
+  };
+
+//Construction / Deconstruction
+public:
+  ParameterTuner();
+  virtual ~ParameterTuner();
+
+//Functions
+public:
+  ///Goal of the search. @c threshold is the maximum error or the time budget (ms).
+  void SetGoal(const Goal goal, const double threshold);
+  Goal GetGoal() const {return m_goal;};
+  double GetThreshold() const {return m_threshold;};
+
+  void SetErrorMetric(const ErrorMetric metric) {m_metric = metric;};
+  ErrorMetric GetErrorMetric() const {return m_metric;};
+  static const char* GetErrorMetricName(const ErrorMetric metric);
+
+  ///Maximum number of passes over all dimensions.
+  void SetMaxPasses(const int max_passes) {m_max_passes = max_passes;};
+
+  ///Starts a search at the current values of @c pspace (snapped to the closest steps)
+  ///and sets it to the first point to measure. Measurements of a previous search are discarded.
+  ///Returns false if the parameter space has no dimensions.
+  bool Start(ParameterSpace* pspace);
+
+  ///Reports the measurement of the current point and sets the parameter space to the next point.
+  ///Returns false at the end of the search, with the parameter space set to the best point.
+  bool Next(const double time_ms, const ImageMetrics& metrics);
+
+  ///Stops the search, with the parameter space set to the best point measured, if any.
+  void Stop();
+
+  bool IsRunning() const {return m_running;};
+
+  ///The number of measured points.
+  int GetNumMeasuredPoints() const {return (int)m_points.size();};
+
+  ///Returns false if no point was measured.
+  bool GetBestPoint(SamplePoint* point) const;
+
+  ///Writes all measured points: parameters, time, error, feasibility and Pareto front membership.
+  void WriteCsv(std::ostream& os) const;
+
+//Presets
+public:
+  ///Writes the parameter values of the best point, one "name value" line per dimension.
+  ///@c header lines are written as comments before them, e.g. renderer, dataset and gpu.
+  bool WritePreset(const std::string& filepath, const std::vector<std::string>& header) const;
+
+  ///Sets the dimensions of @c pspace named in a preset file to their values.
+  ///Names that are not in @c pspace are skipped with a warning.
+  static bool ReadPreset(const std::string& filepath, ParameterSpace* pspace);
+
+protected:
+  ///Error of the measured image, NaN metrics (e.g. size mismatch) give an infinite error.
+  double GetError(const ImageMetrics& metrics) const;
+
+  ///true if @c a is a better point than @c b for the goal.
+  bool IsBetter(const SamplePoint& a, const SamplePoint& b) const;
+
+  ///Queues the first points of the line search along the current dimension.
+  void StartLine();
+
+  ///Moves to the next point that is not measured yet. Returns false at the end of the search.
+  bool Advance();
+
+  ///Updates the Pareto front flags of all points.
+  void UpdateParetoFront();
+
+//Attributes
+protected:
+  Goal m_goal;
+  double m_threshold;
+  ErrorMetric m_metric;
+  int m_max_passes;
+
+  ParameterSpace* m_pspace;
+  bool m_running;
+
+  ///Measured points, by steps
+  std::map<std::vector<int>, SamplePoint> m_points;
+
+  ///Best point so far, the fixed coordinates of the line searches
+  std::vector<int> m_best;
+  ///Best point at the start of the current pass
+  std::vector<int> m_pass_start;
+  int m_pass;
+  int m_dim;
+  ///Current stride of the line search, and its best step
+  int m_stride;
+  int m_line_best;
+  ///Steps of the current line still to be visited
+  std::vector<int> m_line_queue;
+  ///Point being measured
+  std::vector<int> m_current;
+};
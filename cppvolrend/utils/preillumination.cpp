@@ -1,5 +1,7 @@
 #include "preillumination.h"
 
+#include <gl_utils/gpumemoryregistry.h>
+
 #include "imgui.h"
 #include "imgui_impl_glut.h"
 #include "imgui_impl_opengl2.h"
@@ -65,10 +67,28 @@ void PreIlluminationStructuredVolume::GenerateLightCacheTexture ()
   
   if(IsActive())
   {
+    // The resolution is halved until the light cache fits in the gpu memory budget.
+    //   The requested resolution is kept, so the next rebuild tries it again.
+    size_t texel_bytesize = gl::GPUMemoryRegistry::GetTexelByteSize(m_tex_internal_format);
+    glm::ivec3 resolution = m_light_cache_resolution;
+    while (!gl::GPUMemoryRegistry::Instance()->Reserve((size_t)resolution.x * resolution.y
+                                                       * resolution.z * texel_bytesize))
+    {
+      if (glm::all(glm::lessThanEqual(resolution, glm::ivec3(1))))
+      {
+        printf("Warning: the light cache does not fit in the gpu memory budget\n");
+        break;
+      }
+      resolution = glm::max(resolution / 2, glm::ivec3(1));
+    }
+    if (resolution != m_light_cache_resolution)
+    {
+      printf("Warning: light cache resolution reduced to %d %d %d to fit in the gpu memory budget\n",
+        resolution.x, resolution.y, resolution.z);
+    }
+
     // Initialize extinction coefficient volume texture 3D
-    m_tex_glsl_light_vol_cache = new gl::Texture3D(m_light_cache_resolution.x,
-                                                   m_light_cache_resolution.y,
-                                                   m_light_cache_resolution.z);
+    m_tex_glsl_light_vol_cache = new gl::Texture3D(resolution.x, resolution.y, resolution.z);
 
     // Set initial texture parameters
     m_tex_glsl_light_vol_cache->GenerateTexture(GL_LINEAR, GL_LINEAR,
@@ -76,6 +96,7 @@ void PreIlluminationStructuredVolume::GenerateLightCacheTexture ()
     
     // Set default data:
     m_tex_glsl_light_vol_cache->SetData(NULL, m_tex_internal_format, m_tex_data_format, m_tex_data_type);
+    gl::GPUMemoryRegistry::Instance()->SetOwner(m_tex_glsl_light_vol_cache, "light cache");
   }
 }
 
@@ -21,6 +21,7 @@ public:
   bool IsActive ();
   void SetActive (bool f);
 
+  // Requested resolution, the texture may be smaller to fit in the gpu memory budget
   glm::ivec3 GetLightCacheResolution ();
   void SetLightCacheResolution (glm::ivec3 tex_resolution);
   void SetLightCacheResolution (int w, int h, int d);
@@ -0,0 +1,81 @@
+#include "raymarchinguniforms.h"
+
+#include "../defines.h"
+
+#include <cstddef>
+
+// Offsets of ray_marching_uniforms.comp
+static_assert(offsetof(RayMarchingUniforms::Block, camera_eye) == 128, "RayMarchingUniforms: camera layout");
+static_assert(offsetof(RayMarchingUniforms::Block, step_size) == 148, "RayMarchingUniforms: camera layout");
+static_assert(offsetof(RayMarchingUniforms::Block, volume_grid_resolution) == 160, "RayMarchingUniforms: volume layout");
+static_assert(offsetof(RayMarchingUniforms::Block, volume_grid_size) == 192, "RayMarchingUniforms: volume layout");
+static_assert(offsetof(RayMarchingUniforms::Block, light_source_position) == 208, "RayMarchingUniforms: lighting layout");
+static_assert(offsetof(RayMarchingUniforms::Block, blinnphong_ispecular) == 224, "RayMarchingUniforms: lighting layout");
+static_assert(offsetof(RayMarchingUniforms::Block, blinnphong_shininess) == 244, "RayMarchingUniforms: lighting layout");
+static_assert(sizeof(RayMarchingUniforms::Block) == 256, "RayMarchingUniforms: block size");
+
+void RayMarchingUniforms::AddHeaderFile (gl::ComputeShader* shader)
+{
+  shader->AddHeaderFile(CPPVOLREND_DIR"structured/_common_shaders/ray_marching_uniforms.comp");
+}
+
+RayMarchingUniforms::RayMarchingUniforms ()
+  // Value-initialized: the padding is compared by the upload too
+  : m_block()
+  , m_buffer(nullptr)
+{
+}
+
+RayMarchingUniforms::~RayMarchingUniforms ()
+{
+  Destroy();
+}
+
+void RayMarchingUniforms::SetCamera (vis::Camera* camera)
+{
+  m_block.camera_lookat = camera->LookAt();
+  m_block.camera_projection = camera->Projection();
+  m_block.camera_eye = camera->GetEye();
+  m_block.tan_camera_fov_y = camera->GetTanFovY();
+  m_block.camera_aspect_ratio = camera->GetAspectRatio();
+}
+
+void RayMarchingUniforms::SetStepSize (float step_size)
+{
+  m_block.step_size = step_size;
+}
+
+void RayMarchingUniforms::SetVolume (vis::StructuredGridVolume* volume)
+{
+  m_block.volume_grid_resolution = glm::vec3(volume->GetWidth(), volume->GetHeight(), volume->GetDepth());
+  m_block.volume_voxel_size = glm::vec3(volume->GetScaleX(), volume->GetScaleY(), volume->GetScaleZ());
+  m_block.volume_grid_size = m_block.volume_grid_resolution * m_block.volume_voxel_size;
+}
+
+void RayMarchingUniforms::SetLighting (vis::RenderingParameters* rdr_prm)
+{
+  m_block.light_source_position = rdr_prm->GetBlinnPhongLightingPosition();
+  m_block.blinnphong_ka = rdr_prm->GetBlinnPhongKambient();
+  m_block.blinnphong_ispecular = rdr_prm->GetLightSourceSpecular();
+  m_block.blinnphong_kd = rdr_prm->GetBlinnPhongKdiffuse();
+  m_block.blinnphong_ks = rdr_prm->GetBlinnPhongKspecular();
+  m_block.blinnphong_shininess = rdr_prm->GetBlinnPhongNshininess();
+}
+
+void RayMarchingUniforms::Upload ()
+{
+  if (!m_buffer)
+    m_buffer = new gl::UniformBuffer(sizeof(Block), RAY_MARCHING_UNIFORMS_BINDING);
+  m_buffer->SetData(&m_block);
+}
+
+void RayMarchingUniforms::Bind ()
+{
+  if (m_buffer) m_buffer->Bind();
+}
+
+void RayMarchingUniforms::Destroy ()
+{
+  if (m_buffer) delete m_buffer;
+  m_buffer = nullptr;
+}
@@ -0,0 +1,90 @@
+/**
+ * Camera, volume and lighting parameters shared by the ray marching shaders,
+ *   stored in the RayMarchingUniforms uniform block
+ *   (structured/_common_shaders/ray_marching_uniforms.comp).
+ *
+ * Each renderer owns one block: the volume part is set when the rendering
+ *   pass is built, the camera and lighting parts at each Update. Upload writes
+ *   the whole block with one glBufferSubData, or nothing if it did not change,
+ *   instead of one map lookup and one glUniform* call per parameter. The block
+ *   is bound by BaseVolumeRenderer::PrepareRender, before each Redraw.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef CPPVOLREND_RAY_MARCHING_UNIFORMS_H
+#define CPPVOLREND_RAY_MARCHING_UNIFORMS_H
+
+#include <glm/glm.hpp>
+
+#include <gl_utils/computeshader.h>
+#include <gl_utils/uniformbuffer.h>
+
+#include <vis_utils/camera.h>
+
+#include <volvis_utils/structuredgridvolume.h>
+#include <volvis_utils/renderingparameters.h>
+
+// binding = 0 of the uniform block
+#define RAY_MARCHING_UNIFORMS_BINDING 0
+
+class RayMarchingUniforms
+{
+public:
+  // std140 layout of the block: vec3 members are aligned to 16 bytes
+  class Block
+  {
+  public:
+    // Camera
+    glm::mat4 camera_lookat;
+    glm::mat4 camera_projection;
+    glm::vec3 camera_eye;
+    float     tan_camera_fov_y;
+    float     camera_aspect_ratio;
+    float     step_size;
+    float     pad_camera[2];
+
+    // Volume
+    glm::vec3 volume_grid_resolution;
+    float     pad_volume_0;
+    glm::vec3 volume_voxel_size;
+    float     pad_volume_1;
+    glm::vec3 volume_grid_size;
+    float     pad_volume_2;
+
+    // Lighting
+    glm::vec3 light_source_position;
+    float     blinnphong_ka;
+    glm::vec3 blinnphong_ispecular;
+    float     blinnphong_kd;
+    float     blinnphong_ks;
+    float     blinnphong_shininess;
+    float     pad_lighting[2];
+  };
+
+  // Adds the declaration of the block to the sources of the shader, before LoadAndLink
+  static void AddHeaderFile (gl::ComputeShader* shader);
+
+  RayMarchingUniforms ();
+  ~RayMarchingUniforms ();
+
+  void SetCamera (vis::Camera* camera);
+  void SetStepSize (float step_size);
+  void SetVolume (vis::StructuredGridVolume* volume);
+  void SetLighting (vis::RenderingParameters* rdr_prm);
+
+  // Writes the block to its buffer, created at the first upload
+  void Upload ();
+  // Binds the buffer to RAY_MARCHING_UNIFORMS_BINDING
+  void Bind ();
+
+  void Destroy ();
+
+protected:
+
+private:
+  Block m_block;
+  gl::UniformBuffer* m_buffer;
+};
+
+#endif
@@ -0,0 +1,251 @@
+#include "screenshotcapture.h"
+
+#include <gl_utils/gpumemoryregistry.h>
+#include <gl_utils/tracer.h>
+
+#include <im/im.h>
+#include <im/im_image.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+ScreenshotCapture::ScreenshotCapture ()
+  : m_encoding(0)
+  , m_stop_worker(false)
+{
+  for (int i = 0; i < SCREENSHOT_CAPTURE_READBACK_SLOTS; i++)
+  {
+    m_slots[i].pbo = 0;
+    m_slots[i].pbo_size = 0;
+    m_slots[i].fence = 0;
+  }
+}
+
+ScreenshotCapture::~ScreenshotCapture ()
+{
+  // Without a GL context, only the images already read back are written
+  if (m_worker.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop_worker = true;
+    }
+    m_cv_queue.notify_all();
+    m_worker.join();
+  }
+}
+
+void ScreenshotCapture::CaptureWindow (std::string filepath, int w, int h, GLenum read_buffer, std::string image_type)
+{
+  TRACE_SCOPE_DETAIL("CaptureWindow", "io", filepath);
+  ReadbackSlot* slot = AcquireSlot((GLsizeiptr)w * (GLsizeiptr)h * 3);
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+  glPushClientAttrib(GL_CLIENT_PIXEL_STORE_BIT);
+  glPushAttrib(GL_PIXEL_MODE_BIT);
+  glReadBuffer(read_buffer);
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, 0);
+  glPopAttrib();
+  glPopClientAttrib();
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  slot->image.filepath = filepath;
+  slot->image.image_type = image_type;
+  slot->image.width = w;
+  slot->image.height = h;
+  slot->image.is_float = false;
+}
+
+void ScreenshotCapture::CaptureTexture (std::string filepath, GLuint texture_id, std::string image_type)
+{
+  TRACE_SCOPE_DETAIL("CaptureTexture", "io", filepath);
+  GLint w = 0, h = 0;
+  glBindTexture(GL_TEXTURE_2D, texture_id);
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w);
+  glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  if (w <= 0 || h <= 0)
+  {
+    std::cout << "Error: Unable to capture texture " << texture_id << "." << std::endl;
+    return;
+  }
+
+  ReadbackSlot* slot = AcquireSlot((GLsizeiptr)w * (GLsizeiptr)h * 4 * sizeof(float));
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+  glBindTexture(GL_TEXTURE_2D, texture_id);
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, 0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+  slot->image.filepath = filepath;
+  slot->image.image_type = image_type;
+  slot->image.width = w;
+  slot->image.height = h;
+  slot->image.is_float = true;
+}
+
+void ScreenshotCapture::Update ()
+{
+  // Readbacks finish in order, stop at the first one still in flight
+  while (!m_pending_slots.empty())
+  {
+    GLenum status = glClientWaitSync(m_slots[m_pending_slots.front()].fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+    CompleteReadback(&m_slots[m_pending_slots.front()]);
+  }
+}
+
+void ScreenshotCapture::Finish ()
+{
+  while (!m_pending_slots.empty())
+    CompleteReadback(&m_slots[m_pending_slots.front()]);
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv_done.wait(lock, [this] { return m_queue.empty() && m_encoding == 0; });
+}
+
+void ScreenshotCapture::Destroy ()
+{
+  Finish();
+
+  for (int i = 0; i < SCREENSHOT_CAPTURE_READBACK_SLOTS; i++)
+  {
+    if (m_slots[i].pbo) glDeleteBuffers(1, &m_slots[i].pbo);
+    if (gl::GPUMemoryRegistry::Exists()) gl::GPUMemoryRegistry::Instance()->Unregister(&m_slots[i].pbo);
+    m_slots[i].pbo = 0;
+    m_slots[i].pbo_size = 0;
+  }
+}
+
+int ScreenshotCapture::GetNumberOfPendingImages ()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return (int)m_pending_slots.size() + (int)m_queue.size() + m_encoding;
+}
+
+bool ScreenshotCapture::WriteImageFile (std::string filepath, int w, int h, unsigned char* data, bool alpha,
+                                        std::string image_type)
+{
+  int error;
+  imFile* ifile = imFileNew(filepath.c_str(), image_type.c_str(), &error);
+  if (ifile == NULL) return false;
+
+  int user_color_mode = alpha ? IM_RGB | IM_ALPHA | IM_PACKED : IM_RGB | IM_PACKED;
+  error = imFileWriteImageInfo(ifile, w, h, user_color_mode, IM_BYTE);
+  if (error == IM_ERR_NONE) error = imFileWriteImageData(ifile, data);
+  imFileClose(ifile);
+
+  return error == IM_ERR_NONE;
+}
+
+ScreenshotCapture::ReadbackSlot* ScreenshotCapture::AcquireSlot (GLsizeiptr size)
+{
+  if (m_pending_slots.size() == SCREENSHOT_CAPTURE_READBACK_SLOTS)
+    CompleteReadback(&m_slots[m_pending_slots.front()]);
+
+  int id = 0;
+  while (std::find(m_pending_slots.begin(), m_pending_slots.end(), id) != m_pending_slots.end()) id++;
+  m_pending_slots.push_back(id);
+
+  ReadbackSlot* slot = &m_slots[id];
+  if (slot->pbo == 0) glGenBuffers(1, &slot->pbo);
+  if (slot->pbo_size < size)
+  {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot->pbo_size = size;
+    gl::GPUMemoryRegistry::Instance()->Register(&slot->pbo, gl::GPU_MEMORY_BUFFER, 0, (size_t)size);
+    gl::GPUMemoryRegistry::Instance()->SetOwner(&slot->pbo, "screenshot readback");
+  }
+  return slot;
+}
+
+void ScreenshotCapture::CompleteReadback (ReadbackSlot* slot)
+{
+  TRACE_SCOPE("CompleteReadback", "io");
+  // The first wait flushes the commands, in case the fence was not submitted yet
+  GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+  while (glClientWaitSync(slot->fence, flags, 1000000000) == GL_TIMEOUT_EXPIRED) flags = 0;
+  glDeleteSync(slot->fence);
+  slot->fence = 0;
+
+  Image& image = slot->image;
+  size_t size = (size_t)image.width * (size_t)image.height * (image.is_float ? 4 * sizeof(float) : 3);
+  image.data.resize(size);
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+  void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+  if (pixels)
+  {
+    memcpy(image.data.data(), pixels, size);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  m_pending_slots.pop_front();
+
+  if (!pixels)
+  {
+    std::cout << "Error: Unable to read back " << image.filepath << "." << std::endl;
+    return;
+  }
+
+  if (!m_worker.joinable()) StartWorker();
+
+  // A full queue makes the render thread wait for the encoding
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv_done.wait(lock, [this] { return m_queue.size() < SCREENSHOT_CAPTURE_MAX_QUEUED_IMAGES; });
+  m_queue.push_back(std::move(image));
+  lock.unlock();
+  m_cv_queue.notify_one();
+}
+
+void ScreenshotCapture::StartWorker ()
+{
+  m_stop_worker = false;
+  m_worker = std::thread(&ScreenshotCapture::WorkerLoop, this);
+}
+
+void ScreenshotCapture::WorkerLoop ()
+{
+  gl::Tracer::SetThreadName("ScreenshotEncoder");
+  while (true)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv_queue.wait(lock, [this] { return m_stop_worker || !m_queue.empty(); });
+    if (m_queue.empty()) return;
+
+    Image image = std::move(m_queue.front());
+    m_queue.pop_front();
+    m_encoding++;
+    lock.unlock();
+    m_cv_done.notify_all();
+
+    {
+      TRACE_SCOPE_DETAIL("EncodeScreenshot", "io", image.filepath);
+      std::vector<unsigned char> rgba;
+      unsigned char* data = image.data.data();
+      if (image.is_float)
+      {
+        const float* fdata = (const float*)image.data.data();
+        rgba.resize((size_t)image.width * (size_t)image.height * 4);
+        for (size_t i = 0; i < rgba.size(); i++)
+          rgba[i] = (unsigned char)(std::min(std::max(fdata[i], 0.0f), 1.0f) * 255.0f + 0.5f);
+        data = rgba.data();
+      }
+
+      if (!WriteImageFile(image.filepath, image.width, image.height, data, image.is_float, image.image_type))
+        std::cout << "Error: Unable to write image " << image.filepath << "." << std::endl;
+    }
+
+    lock.lock();
+    m_encoding--;
+    lock.unlock();
+    m_cv_done.notify_all();
+  }
+}
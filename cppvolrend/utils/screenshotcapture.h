@@ -0,0 +1,115 @@
+/**
+ * Asynchronous screenshot capture.
+ *
+ * A capture copies the pixels into one of SCREENSHOT_CAPTURE_READBACK_SLOTS
+ *   pixel buffer objects (glReadPixels or glGetTexImage into a bound
+ *   GL_PIXEL_PACK_BUFFER return before the copy is done) and inserts a fence.
+ *   Update, called once per frame, maps the buffers whose fence is signaled
+ *   and hands their pixels to a worker thread, which writes the image files.
+ *   The render thread only waits when all slots are in use, or when the
+ *   queue of images to encode is full (SCREENSHOT_CAPTURE_MAX_QUEUED_IMAGES).
+ *
+ * Two sources can be captured:
+ * . a color buffer of the window (RGB): the back buffer before the swap,
+ *     with what was drawn so far, or the front buffer after the swap, with
+ *     the presented frame. The contents of the back buffer are undefined
+ *     after a swap.
+ * . a RGBA float texture, e.g. the output of a volume renderer before it
+ *     is composited on the window (BaseVolumeRenderer::GetScreenTextureID).
+ *     Colors are clamped to [0, 1] and written with alpha.
+ *
+ * Images are written with the IM library (PNG by default, the file format
+ *   is given by the caller).
+ *
+ * https://www.khronos.org/opengl/wiki/Pixel_Buffer_Object
+ * https://www.khronos.org/opengl/wiki/Sync_Object
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef CPPVOLREND_SCREENSHOT_CAPTURE_H
+#define CPPVOLREND_SCREENSHOT_CAPTURE_H
+
+#include <GL/glew.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define SCREENSHOT_CAPTURE_READBACK_SLOTS 2
+#define SCREENSHOT_CAPTURE_MAX_QUEUED_IMAGES 4
+
+class ScreenshotCapture
+{
+public:
+  ScreenshotCapture ();
+  ~ScreenshotCapture ();
+
+  // Starts the readback of a color buffer of the window (w x h pixels),
+  //   read_buffer: GL_BACK before the swap, GL_FRONT after it
+  void CaptureWindow (std::string filepath, int w, int h, GLenum read_buffer = GL_BACK, std::string image_type = "PNG");
+  // Starts the readback of level 0 of a 2D RGBA texture
+  void CaptureTexture (std::string filepath, GLuint texture_id, std::string image_type = "PNG");
+
+  // Hands the finished readbacks to the worker thread, called once per frame
+  void Update ();
+  // Waits until all captured images are written (a GL context must be current)
+  void Finish ();
+  // Finishes and deletes the pixel buffer objects
+  void Destroy ();
+
+  // Images captured but not written yet
+  int GetNumberOfPendingImages ();
+
+  // Writes packed 8 bit RGB(A) pixels, origin at the bottom left
+  static bool WriteImageFile (std::string filepath, int w, int h, unsigned char* data, bool alpha,
+                              std::string image_type = "PNG");
+
+protected:
+  class Image
+  {
+  public:
+    std::string filepath;
+    std::string image_type;
+    int width, height;
+    // RGB unsigned bytes (window) or RGBA floats (texture)
+    bool is_float;
+    std::vector<unsigned char> data;
+  };
+
+  class ReadbackSlot
+  {
+  public:
+    GLuint pbo;
+    GLsizeiptr pbo_size;
+    GLsync fence;
+    Image image;
+  };
+
+  // Next free slot, waiting for the oldest readback if none is free
+  ReadbackSlot* AcquireSlot (GLsizeiptr size);
+  // Copies the pixels of a finished readback to the encoding queue
+  void CompleteReadback (ReadbackSlot* slot);
+
+  void StartWorker ();
+  void WorkerLoop ();
+
+  ReadbackSlot m_slots[SCREENSHOT_CAPTURE_READBACK_SLOTS];
+  // Slots in use, oldest first
+  std::deque<int> m_pending_slots;
+
+  std::thread m_worker;
+  std::mutex m_mutex;
+  std::condition_variable m_cv_queue;
+  std::condition_variable m_cv_done;
+  std::deque<Image> m_queue;
+  int m_encoding;
+  bool m_stop_worker;
+
+private:
+};
+
+#endif
@@ -5,6 +5,7 @@
 BaseVolumeRenderer::BaseVolumeRenderer()
   : vr_pixel_multiscaling_support(false)
   , vr_pixel_multiscaling_mode(0)
+  , vr_gradient_texture_user(false)
   , m_rdr_frame_to_screen(CPPVOLREND_DIR"../../libs/vis_utils/shader/")
 {
   SetBuilt(false);
@@ -26,6 +27,8 @@ void BaseVolumeRenderer::SetExternalResources (vis::DataManager* data_mgr, vis::
 void BaseVolumeRenderer::Clean ()
 {
   m_rdr_frame_to_screen.Clean();
+  m_ray_marching_uniforms.Destroy();
+  SetGradientTextureUser(false);
   SetBuilt(false);
 }
 
@@ -81,6 +84,8 @@ void BaseVolumeRenderer::PrepareRender (vis::Camera* camera)
     Update(camera);
     vr_outdated = false;
   }
+  // The binding point is shared by all the renderers
+  m_ray_marching_uniforms.Bind();
 }
 
 void BaseVolumeRenderer::SetOutdated ()
@@ -118,6 +123,14 @@ void BaseVolumeRenderer::SetBuilt (bool b_built)
   vr_built = b_built;
 }
 
+void BaseVolumeRenderer::SetGradientTextureUser (bool f)
+{
+  if (f == vr_gradient_texture_user) return;
+  vr_gradient_texture_user = f;
+  if (f) m_ext_data_manager->AddGradientTextureUser();
+  else m_ext_data_manager->RemoveGradientTextureUser();
+}
+
 bool BaseVolumeRenderer::AddImGuiMultiSampleOptions ()
 {
   bool f = false;
@@ -13,6 +13,7 @@
 #include <gl_utils/texture2d.h>
 #include <gl_utils/pipelineshader.h>
 #include <gl_utils/computeshader.h>
+#include <gl_utils/gpuprofiler.h>
 
 #include <vis_utils/camera.h>
 #include <vis_utils/renderoutputframe.h>
@@ -21,6 +22,7 @@
 #include <volvis_utils/renderingparameters.h>
 
 #include "utils/parameterspace.h"
+#include "utils/raymarchinguniforms.h"
 
 class BaseVolumeRenderer
 {
@@ -77,6 +79,9 @@ public:
 protected:
   void SetBuilt (bool b_built);
   bool AddImGuiMultiSampleOptions ();
+  // Registers the renderer as a reader of the gradient texture of the data
+  //   manager (DataManager::AddGradientTextureUser), until Clean
+  void SetGradientTextureUser (bool f);
 
   //////////////////////////////////////////
   // State Variables
@@ -84,6 +89,7 @@ protected:
   bool vr_outdated;
   bool vr_pixel_multiscaling_support;
   int vr_pixel_multiscaling_mode;
+  bool vr_gradient_texture_user;
 
   //////////////////////////////////////////
   // External Resources
@@ -94,6 +100,10 @@ protected:
   // Render Screen Texture
   vis::RenderFrameToScreen m_rdr_frame_to_screen;
 
+  //////////////////////////////////////////
+  // Camera, volume and lighting of the ray marching shaders
+  RayMarchingUniforms m_ray_marching_uniforms;
+
 private:
 };
 
@@ -0,0 +1,29 @@
+/**
+ * Secure functions of the MSVC CRT used by the file readers (fopen_s,
+ *   sscanf_s), mapped to the standard ones when building with gcc or clang.
+ *
+ * . sscanf_s is only given numeric conversions here, which take no buffer
+ *   size argument, so sscanf reads the same arguments.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef FILE_UTILS_CRT_COMPAT_H
+#define FILE_UTILS_CRT_COMPAT_H
+
+#include <cerrno>
+#include <cstdio>
+
+#ifndef _MSC_VER
+typedef int errno_t;
+
+inline errno_t fopen_s (FILE** file, const char* filename, const char* mode)
+{
+  *file = fopen(filename, mode);
+  return *file == NULL ? errno : 0;
+}
+
+#define sscanf_s sscanf
+#endif
+
+#endif
@@ -1,4 +1,5 @@
 #include "pvm.h"
+#include "crtcompat.h"
 #include <fstream>
 #include <iostream>
 #include <cmath>
@@ -79,11 +80,11 @@ int Pvm::GetComponents ()
 
 void* Pvm::PostProcessData (unsigned char* data)
 {
-  int v_array_size = width * height * depth;
+  size_t v_array_size = (size_t)width * (size_t)height * (size_t)depth;
   if(components == 1)
   {
     unsigned char* prc_data = new unsigned char[v_array_size];
-    for (int i = 0; i < width * height * depth; i++)
+    for (size_t i = 0; i < v_array_size; i++)
       prc_data[i] = data[i];
     return prc_data;
   }
@@ -91,7 +92,7 @@ void* Pvm::PostProcessData (unsigned char* data)
   {
     unsigned short* prc_data = new unsigned short[v_array_size];
     unsigned short vl = 256;
-    for (int i = 0; i < width * height * depth; i++)
+    for (size_t i = 0; i < v_array_size; i++)
     {
       unsigned short v1 = data[(i * 2)];
       unsigned short v2 = data[(i * 2) + 1];
@@ -110,20 +111,21 @@ void* Pvm::PostProcessData (unsigned char* data)
 // Reescale between 0 ~ 1 using max_density_value
 float* Pvm::GenerateNormalizeData ()
 {
-  float* custom_data = new float[width*height*depth];
+  size_t v_array_size = (size_t)width * (size_t)height * (size_t)depth;
+  float* custom_data = new float[v_array_size];
 
   float max_density_value = pow(2, components * 8) - 1;
   
   if (components == 1)
   {
     unsigned char* a_pvm_data = (unsigned char*)pvm_data;
-    for (int i = 0; i < width*height*depth; i++)
+    for (size_t i = 0; i < v_array_size; i++)
       custom_data[i] = ((float)a_pvm_data[i] / max_density_value);
   }
   else if (components == 2)
   {
     unsigned short* a_pvm_data = (unsigned short*)pvm_data;
-    for (int i = 0; i < width*height*depth; i++)
+    for (size_t i = 0; i < v_array_size; i++)
       custom_data[i] = ((float)a_pvm_data[i] / max_density_value);
   }
  
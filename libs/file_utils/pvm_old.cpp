@@ -13,6 +13,8 @@
 #include <cstring>
 #include <cerrno>
 
+#include <gl_utils/tracer.h>
+
 #define DDS_MAXSTR (256)
 
 #define DDS_BLOCKSIZE (1<<20)
@@ -21,6 +23,12 @@
 #define DDS_RL (7)
 
 PvmOld::PvmOld (const char *file_name)
+  : PvmOld(file_name, true)
+{}
+
+PvmOld::PvmOld (const char *file_name, bool decode_float_data)
+  : pvm_data(NULL)
+  , raw_data(NULL)
 {
   std::string filename(file_name);
 
@@ -34,15 +42,24 @@ PvmOld::PvmOld (const char *file_name)
   printf("Scale: [%.7f %.7f %.7f]\n", scalex, scaley, scalez);
   printf("Components: %d\n", components);
 
-  pvm_data = PostProcessData(raw);
-  
-  free(raw);
+  if (decode_float_data)
+  {
+    pvm_data = PostProcessData(raw);
+    free(raw);
+  }
+  else
+  {
+    raw_data = raw;
+  }
 }
 
 PvmOld::~PvmOld ()
 {
   if (pvm_data) delete[] pvm_data;
   pvm_data = NULL;
+
+  if (raw_data) free(raw_data);
+  raw_data = NULL;
 }
 
 float* PvmOld::GetData ()
@@ -52,13 +69,14 @@ float* PvmOld::GetData ()
 
 float* PvmOld::GenerateNormalizeData ()
 {
-  float* custom_data = new float[width*height*depth];
+  size_t n_voxels = (size_t)width * (size_t)height * (size_t)depth;
+  float* custom_data = new float[n_voxels];
 
   float max_density_value = pow(2, components * 8) - 1;
   // min is = 0
 
   // Reescale between 0 ~ 1 using max_density_value
-  for (int i = 0; i < width*height*depth; i++)
+  for (size_t i = 0; i < n_voxels; i++)
     custom_data[i] = pvm_data[i] / max_density_value;
 
   return custom_data;
@@ -66,11 +84,12 @@ float* PvmOld::GenerateNormalizeData ()
 
 float* PvmOld::GenerateReescaledMinMaxData (bool normalized, float* fmin, float* fmax)
 {
+  size_t n_voxels = (size_t)width * (size_t)height * (size_t)depth;
   float max_density_value = pow(2, components * 8) - 1;
   float min = max_density_value;
   float max = 0;
 
-  for (int i = 0; i < width*height*depth; i++)
+  for (size_t i = 0; i < n_voxels; i++)
   {
     min = glm::min(min, pvm_data[i]);
     max = glm::max(max, pvm_data[i]);
@@ -79,22 +98,88 @@ float* PvmOld::GenerateReescaledMinMaxData (bool normalized, float* fmin, float*
   if (fmin) *fmin = min;
   if (fmax) *fmax = max;
 
-  float* custom_data = new float[width*height*depth];
+  float* custom_data = new float[n_voxels];
   
   // First we reescale between 0 ~ 1 using min and max value found
-  for (int i = 0; i < width*height*depth; i++)
+  for (size_t i = 0; i < n_voxels; i++)
     custom_data[i] = (pvm_data[i] - min) / (max - min);
   
   // if normalized is FALSE, reescale by the max_density_value
   if (!normalized) 
   {
-    for (int i = 0; i < width*height*depth; i++)
+    for (size_t i = 0; i < n_voxels; i++)
       custom_data[i] = custom_data[i] * max_density_value;
   }
 
   return custom_data;
 }
 
+// Big endian 16 bits, same as PostProcessData
+static inline float DecodeRawValue (const unsigned char* data, size_t i, unsigned int components)
+{
+  if (components == 1)
+    return (float)data[i];
+  return (float)(data[i * 2] * 256 + data[i * 2 + 1]);
+}
+
+bool PvmOld::DecodeReescaledMinMaxData (void* dst, unsigned int dst_bytes_per_voxel, float* fmin, float* fmax)
+{
+  if (!dst || !raw_data || (components != 1 && components != 2))
+    return false;
+  if (dst_bytes_per_voxel != components && dst_bytes_per_voxel != sizeof(float))
+    return false;
+
+  long long n_voxels = (long long)width * (long long)height * (long long)depth;
+  float max_density_value = pow(2, components * 8) - 1;
+  float min = max_density_value;
+  float max = 0;
+
+  // 1. min/max, each thread reduces its own range
+#pragma omp parallel
+  {
+    TRACE_SCOPE("DecodeMinMax", "worker");
+    float t_min = max_density_value;
+    float t_max = 0;
+#pragma omp for
+    for (long long i = 0; i < n_voxels; i++)
+    {
+      float v = DecodeRawValue(raw_data, (size_t)i, components);
+      t_min = glm::min(t_min, v);
+      t_max = glm::max(t_max, v);
+    }
+#pragma omp critical
+    {
+      min = glm::min(min, t_min);
+      max = glm::max(max, t_max);
+    }
+  }
+
+  if (fmin) *fmin = min;
+  if (fmax) *fmax = max;
+
+  // 2. decode, rescale and truncate straight into dst, using the same
+  //    float operations as GenerateReescaledMinMaxData
+#pragma omp parallel
+  {
+    TRACE_SCOPE("DecodeNormalize", "worker");
+#pragma omp for
+    for (long long i = 0; i < n_voxels; i++)
+    {
+      float v = max > min ? (DecodeRawValue(raw_data, (size_t)i, components) - min) / (max - min) : 0.0f;
+      int q = (int)(v * max_density_value);
+
+      if (dst_bytes_per_voxel == 1)
+        ((unsigned char*)dst)[i] = (unsigned char)q;
+      else if (dst_bytes_per_voxel == 2)
+        ((unsigned short*)dst)[i] = (unsigned short)q;
+      else
+        ((float*)dst)[i] = (float)((double)q / (double)max_density_value);
+    }
+  }
+
+  return true;
+}
+
 void PvmOld::GetScale (double* sx, double* sy, double* sz)
 {
   *sx = scalex;
@@ -116,11 +201,12 @@ int PvmOld::GetComponents ()
 
 void PvmOld::TransformData (unsigned int dst_bytes_per_voxel)
 {
+  size_t n_voxels = (size_t)width * (size_t)height * (size_t)depth;
   float old_max_density_value = pow(2, components * 8) - 1;
   float new_max_density_value = pow(2, dst_bytes_per_voxel * 8) - 1;
 
   // First we reescale between 0~1
-  for (int i = 0; i < width*height*depth; i++)
+  for (size_t i = 0; i < n_voxels; i++)
   {
     pvm_data[i] = (pvm_data[i] / old_max_density_value) * new_max_density_value;
   }
@@ -130,9 +216,10 @@ void PvmOld::TransformData (unsigned int dst_bytes_per_voxel)
 
 float* PvmOld::PostProcessData (unsigned char* data)
 {
-  float* prc_data = new float[width*height*depth];
+  size_t n_voxels = (size_t)width * (size_t)height * (size_t)depth;
+  float* prc_data = new float[n_voxels];
 
-  for (int i = 0; i < width*height*depth; i++) 
+  for (size_t i = 0; i < n_voxels; i++) 
   {
     if (components == 1)
     {
@@ -200,7 +287,7 @@ unsigned char* DDSV3Old::readPVMvolume (const char* filename,
     else return(NULL);
 
     ptr = &data[5];
-    if (sscanf_s((char*)ptr, "%d %d %d\n%g %g %g\n", width, height, depth, &sx, &sy, &sz) != 6) DDSOLD_ERRORMSG();
+    if (sscanf((char*)ptr, "%d %d %d\n%g %g %g\n", width, height, depth, &sx, &sy, &sz) != 6) DDSOLD_ERRORMSG();
     if (*width < 1 || *height < 1 || *depth < 1 || sx <= 0.0f || sy <= 0.0f || sz <= 0.0f) DDSOLD_ERRORMSG();
     ptr = (unsigned char*)strchr((char*)ptr, '\n') + 1;
   }
@@ -210,7 +297,7 @@ unsigned char* DDSV3Old::readPVMvolume (const char* filename,
     while (*ptr == '#')
       while (*ptr++ != '\n');
 
-    if (sscanf_s((char*)ptr, "%d %d %d\n", width, height, depth) != 3) DDSOLD_ERRORMSG();
+    if (sscanf((char*)ptr, "%d %d %d\n", width, height, depth) != 3) DDSOLD_ERRORMSG();
     if (*width < 1 || *height < 1 || *depth < 1) DDSOLD_ERRORMSG();
   }
 
@@ -222,7 +309,7 @@ unsigned char* DDSV3Old::readPVMvolume (const char* filename,
   }
 
   ptr = (unsigned char*)strchr((char*)ptr, '\n') + 1;
-  if (sscanf_s((char *)ptr, "%d\n", &numc) != 1) DDSOLD_ERRORMSG();
+  if (sscanf((char *)ptr, "%d\n", &numc) != 1) DDSOLD_ERRORMSG();
   if (numc<1) DDSOLD_ERRORMSG();
 
   if (components != NULL) *components = numc;
@@ -307,7 +394,7 @@ unsigned char* DDSV3Old::readPNMimage (const char* filename,
   memcpy(str, data, 3);
   str[3] = '\0';
 
-  if (sscanf_s(str, "P%1d\n", &pnmtype) != 1) return(NULL);
+  if (sscanf(str, "P%1d\n", &pnmtype) != 1) return(NULL);
 
   ptr1 = data + 3;
   while (*ptr1 == '\n' || *ptr1 == '#')
@@ -336,7 +423,7 @@ unsigned char* DDSV3Old::readPNMimage (const char* filename,
   memcpy(str, ptr1, ptr2 - ptr1);
   str[ptr2 - ptr1] = '\0';
 
-  if (sscanf_s(str, "%d %d\n%d\n", width, height, &maxval) != 3) DDSOLD_ERRORMSG();
+  if (sscanf(str, "%d %d\n%d\n", width, height, &maxval) != 3) DDSOLD_ERRORMSG();
 
   if (*width<1 || *height<1) DDSOLD_ERRORMSG();
 
@@ -499,7 +586,6 @@ unsigned char* DDSV3Old::readDDSfile (const char *filename, unsigned int *bytes)
   int version = 1;
 
   FILE *file;
-  errno_t err;
 
   int cnt;
 
@@ -507,7 +593,7 @@ unsigned char* DDSV3Old::readDDSfile (const char *filename, unsigned int *bytes)
   unsigned int size;
 
 
-  if ((err = fopen_s(&file, filename, "rb")) != 0) return(NULL);
+  if ((file = fopen(filename, "rb")) == NULL) return(NULL);
 
   for (cnt = 0; DDS_ID[cnt] != '\0'; cnt++)
   {
@@ -521,7 +607,7 @@ unsigned char* DDSV3Old::readDDSfile (const char *filename, unsigned int *bytes)
 
   if (version == 0)
   {
-    if ((err = fopen_s(&file, filename, "rb")) != 0) return(NULL);
+    if ((file = fopen(filename, "rb")) == NULL) return(NULL);
 
     for (cnt = 0; DDS_ID2[cnt] != '\0'; cnt++)
     {
@@ -585,11 +671,10 @@ unsigned char* DDSV3Old::readRAWfiled (FILE *file, unsigned int *bytes)
 unsigned char* DDSV3Old::readRAWfile (const char *filename, unsigned int *bytes)
 {
   FILE* file;
-  errno_t err;
 
   unsigned char* data;
 
-  if ((err = fopen_s(&file, filename, "rb")) != 0) return(NULL);
+  if ((file = fopen(filename, "rb")) == NULL) return(NULL);
 
   data = readRAWfiled(file, bytes);
 
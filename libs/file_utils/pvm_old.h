@@ -100,10 +100,23 @@ public:
 
 public:
   PvmOld (const char *file_name);
+  // If decode_float_data is false, only the decoded file bytes are kept
+  //   (1 or 2 bytes per voxel) and GetData returns NULL. Use
+  //   DecodeReescaledMinMaxData to convert them into the final buffer.
+  PvmOld (const char *file_name, bool decode_float_data);
   ~PvmOld ();
 
   float* GetData ();
 
+  // Fused version of GenerateReescaledMinMaxData (normalized = false)
+  //   followed by an integer truncation. Each voxel is written once into
+  //   dst (width * height * depth elements):
+  // . dst_bytes_per_voxel == components: native unsigned char/short
+  // . dst_bytes_per_voxel == 4: float, divided by the max density value
+  bool DecodeReescaledMinMaxData (void* dst, unsigned int dst_bytes_per_voxel,
+                                  float* fmin = NULL,
+                                  float* fmax = NULL);
+
   float* GenerateNormalizeData ();
   float* GenerateReescaledMinMaxData (bool normalized = false,
                                       float* fmin = NULL,
@@ -118,6 +131,7 @@ public:
 
 protected:
   float* pvm_data;
+  unsigned char* raw_data;
 
   unsigned int width, height, depth;
   float scalex, scaley, scalez;
@@ -9,16 +9,22 @@ class IRAWLoader
 {
 public:
   IRAWLoader (std::string fileName, size_t bytes_per_pixel, size_t num_voxels, size_t type_size);
+  // Reads into data (num_voxels * type_size bytes), owned by the caller, so
+  //   large volumes are not copied from a second full size array
+  IRAWLoader (std::string fileName, size_t bytes_per_pixel, size_t num_voxels, size_t type_size, void* data);
   ~IRAWLoader ();
 
   void* GetData ();
   bool IsLoaded ();
 private:
+  void Read ();
+
   std::string m_filename;
   size_t m_bytesperpixel;
   size_t m_numvoxels;
   size_t m_typesize;
   void* m_data;
+  bool m_owns_data;
 };
 
 #endif
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "bufferobject.h"
+#include "gpumemoryregistry.h"
 
 namespace gl
 {
@@ -17,6 +18,7 @@ namespace gl
   BufferObject::~BufferObject ()
   {
     glDeleteBuffers(1, &m_id);
+    if (GPUMemoryRegistry::Exists()) GPUMemoryRegistry::Instance()->Unregister(this);
     gl::ExitOnGLError("ERROR: Could not destroy the buffer object");
   }
 
@@ -35,6 +37,7 @@ namespace gl
   {
     Bind();
     glBufferData(m_target, size, data, usage);
+    GPUMemoryRegistry::Instance()->Register(this, GPU_MEMORY_BUFFER, 0, (size_t)size);
     gl::ExitOnGLError("ERROR: Could not set Buffer Object data");
   }
 
@@ -1,5 +1,9 @@
 #include "computeshader.h"
 #include <gl_utils/utils.h>
+#include <gl_utils/tracer.h>
+#include <gl_utils/programbinarycache.h>
+
+#include <algorithm>
 
 namespace gl
 {
@@ -10,44 +14,87 @@ namespace gl
     num_groups_z = 0;
 
     vec_compute_shader_names.clear();
-    vec_compute_shader_ids.clear();
+    vec_header_names.clear();
+    m_variant_key = "";
   }
 
   ComputeShader::~ComputeShader ()
   {
     Unbind();
 
-    for (int i = 0; i < vec_compute_shader_ids.size(); i++)
-    {
-      glDetachShader(shader_program, vec_compute_shader_ids[i]);
-      glDeleteShader(vec_compute_shader_ids[i]);
-    }
+    // shader_program is deleted by gl::Shader
+    for (std::map<std::string, GLuint>::iterator it = m_variants.begin(); it != m_variants.end(); ++it)
+      if (it->second != shader_program)
+        glDeleteProgram(it->second);
+    m_variants.clear();
 
     vec_compute_shader_names.clear();
-    vec_compute_shader_ids.clear();
+    vec_header_names.clear();
   }
 
   bool ComputeShader::LoadAndLink ()
   {
+    TRACE_SCOPE_DETAIL("CompileComputeShader", "shader", vec_compute_shader_names.empty() ? "" : vec_compute_shader_names.back());
+
     // Creates a compute shader and the respective program that contains the shader.
     if (shader_program == -1)
       shader_program = glCreateProgram();
 
+    // Sources are read once, for the key of the program binary and for the compilation
+    std::vector<GLenum> stages;
+    std::vector<std::string> sources;
+    for (int i = 0; i < vec_compute_shader_names.size(); i++)
+    {
+      char* shader_source = gl::TextFileRead(vec_compute_shader_names[i].c_str());
+      stages.push_back(GL_COMPUTE_SHADER);
+      sources.push_back(shader_source);
+      free(shader_source);
+    }
+    std::vector<std::string> headers;
+    for (int i = 0; i < vec_header_names.size(); i++)
+    {
+      char* header_source = gl::TextFileRead(vec_header_names[i].c_str());
+      headers.push_back(header_source);
+      free(header_source);
+    }
+
+    gl::ProgramBinaryCache* binary_cache = gl::ProgramBinaryCache::Instance();
+    m_variant_key = GetDefinesKey();
+    m_variants[m_variant_key] = shader_program;
+
+    // The headers are part of the key, after the sources (without a stage)
+    std::vector<std::string> key_sources = sources;
+    key_sources.insert(key_sources.end(), headers.begin(), headers.end());
+    std::string binary_key = binary_cache->ComputeKey(stages, key_sources, m_variant_key);
+    if (binary_cache->Load(shader_program, binary_key))
+    {
+      glValidateProgram(shader_program);
+      gl::ExitOnGLError("gl::ComputeShader >> Unable to load the program binary.");
+      return true;
+    }
+
+    std::vector<GLuint> shader_ids;
     for (int i = 0; i < vec_compute_shader_names.size(); i++)
     {
       GLuint new_shader = glCreateShader(GL_COMPUTE_SHADER);
       
-      CompileShader(new_shader, vec_compute_shader_names[i]);
+      CompileShader(new_shader, vec_compute_shader_names[i], InjectPreamble(sources[i], headers));
       
-      vec_compute_shader_ids.push_back(new_shader);
-      assert(vec_compute_shader_ids[i] == new_shader);
-    
+      shader_ids.push_back(new_shader);
       glAttachShader(shader_program, new_shader);
     }
     
+    binary_cache->PrepareProgram(shader_program);
     glLinkProgram(shader_program);
     glValidateProgram(shader_program);
 
+    // The linked program keeps the code, the shader objects are not needed anymore
+    for (int i = 0; i < shader_ids.size(); i++)
+    {
+      glDetachShader(shader_program, shader_ids[i]);
+      glDeleteShader(shader_ids[i]);
+    }
+
     gl::ExitOnGLError("gl::ComputeShader >> Unable to link shaders.");
 
     // Check link status
@@ -63,6 +110,8 @@ namespace gl
     }
 
     gl::ExitOnGLError("gl::ComputeShader >> Unable to load and link shaders.");
+
+    binary_cache->Store(shader_program, binary_key);
     
     return true;
   }
@@ -71,26 +120,87 @@ namespace gl
   {
     Unbind();
 
-    for (int i = 0; i < vec_compute_shader_ids.size(); i++)
-    {
-      glDetachShader(shader_program, vec_compute_shader_ids[i]);
-      glDeleteShader(vec_compute_shader_ids[i]);
-    }
-    vec_compute_shader_ids.clear();
+    // The other variants are compiled again from the edited sources when they are used
+    for (std::map<std::string, GLuint>::iterator it = m_variants.begin(); it != m_variants.end(); ++it)
+      if (it->second != shader_program)
+        glDeleteProgram(it->second);
+    m_variants.clear();
 
     LoadAndLink();
 
-    Bind();
+    RebindUniforms();
 
-    for (std::map<std::string, UniformVariable>::iterator it = uniform_variables.begin(); it != uniform_variables.end(); ++it)
-      uniform_variables[it->first].location = glGetUniformLocation(shader_program, it->first.c_str());
-    BindUniforms();
+    return true;
+  }
 
-    gl::Shader::Unbind();
+  void ComputeShader::AddHeaderFile (std::string filepath)
+  {
+    vec_header_names.push_back(filepath);
+  }
+
+  void ComputeShader::SetDefine (std::string name, std::string value)
+  {
+    m_defines[name] = value;
+  }
+
+  void ComputeShader::SetDefineFlag (std::string name, bool enabled)
+  {
+    if (enabled)
+      SetDefine(name);
+    else
+      UnsetDefine(name);
+  }
+
+  void ComputeShader::UnsetDefine (std::string name)
+  {
+    m_defines.erase(name);
+  }
+
+  void ComputeShader::ClearDefines ()
+  {
+    m_defines.clear();
+  }
+
+  std::string ComputeShader::GetDefinesKey ()
+  {
+    std::string key = "";
+    for (std::map<std::string, std::string>::iterator it = m_defines.begin(); it != m_defines.end(); ++it)
+      key += it->first + "=" + it->second + ";";
+    return key;
+  }
+
+  bool ComputeShader::UpdateVariant ()
+  {
+    // Not loaded yet: LoadAndLink compiles the current defines
+    if (shader_program == -1) return false;
+
+    std::string key = GetDefinesKey();
+    if (key == m_variant_key) return false;
+
+    Unbind();
+    std::map<std::string, GLuint>::iterator it = m_variants.find(key);
+    if (it != m_variants.end())
+    {
+      shader_program = it->second;
+      m_variant_key = key;
+    }
+    else
+    {
+      shader_program = -1;
+      LoadAndLink();
+    }
+
+    // The uniforms keep their values, only their locations change
+    RebindUniforms();
 
     return true;
   }
 
+  int ComputeShader::GetNumberOfVariants ()
+  {
+    return (int)m_variants.size();
+  }
+
   void ComputeShader::SetShaderFile (std::string filename)
   {
     vec_compute_shader_names.clear();
@@ -135,14 +245,12 @@ namespace gl
   }
 
 
-  void ComputeShader::CompileShader (GLuint shader_id, std::string filename)
+  void ComputeShader::CompileShader (GLuint shader_id, std::string filename, const std::string& source)
   {
-    char* shader_source = gl::TextFileRead(filename.c_str());
-    const char* const_shader_source = shader_source;
+    const char* const_shader_source = source.c_str();
 
     // Second parameters can be > 1 if const_shader_source is an array.
     glShaderSource(shader_id, 1, &const_shader_source, NULL);
-    free(shader_source);
 
     glCompileShader(shader_id);
 
@@ -150,7 +258,7 @@ namespace gl
     int rvalue;
     glGetShaderiv(shader_id, GL_COMPILE_STATUS, &rvalue);
     if (!rvalue) {
-      fprintf(stderr, "Error in compiling the compute shader\n");
+      fprintf(stderr, "Error in compiling the compute shader %s\n", filename.c_str());
       GLchar log[10240];
       GLsizei length;
       glGetShaderInfoLog(shader_id, 10239, &length, log);
@@ -160,4 +268,41 @@ namespace gl
 
     gl::ExitOnGLError("gl::ComputeShader >> Could not compile the shader file!");
   }
+
+  std::string ComputeShader::InjectPreamble (const std::string& source, const std::vector<std::string>& headers)
+  {
+    // Without defines and headers the source is unchanged
+    if (m_defines.empty() && headers.empty()) return source;
+
+    // The #version directive must come first, the defines follow it
+    size_t insert_at = 0;
+    size_t version = source.find("#version");
+    if (version != std::string::npos)
+    {
+      insert_at = source.find('\n', version);
+      insert_at = (insert_at == std::string::npos) ? source.size() : insert_at + 1;
+    }
+    int next_line = 1 + (int)std::count(source.begin(), source.begin() + insert_at, '\n');
+
+    std::string preamble = "";
+    for (std::map<std::string, std::string>::iterator it = m_defines.begin(); it != m_defines.end(); ++it)
+      preamble += "#define " + it->first + (it->second.empty() ? "" : " " + it->second) + "\n";
+    for (int i = 0; i < headers.size(); i++)
+      preamble += headers[i] + "\n";
+    // Keeps the line numbers of the compiler log
+    preamble += "#line " + std::to_string(next_line) + "\n";
+
+    return source.substr(0, insert_at) + preamble + source.substr(insert_at);
+  }
+
+  void ComputeShader::RebindUniforms ()
+  {
+    Bind();
+
+    for (std::map<std::string, UniformVariable>::iterator it = uniform_variables.begin(); it != uniform_variables.end(); ++it)
+      uniform_variables[it->first].location = glGetUniformLocation(shader_program, it->first.c_str());
+    BindUniforms();
+
+    gl::Shader::Unbind();
+  }
 }
\ No newline at end of file
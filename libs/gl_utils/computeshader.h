@@ -1,6 +1,12 @@
 /**
  * OpenGL General Purpose Compute Shader Class
  * - Reload support
+ * - Compile-time permutations: a set of #define lines injected after the
+ *   #version line of each source. Each set of defines is a variant of the
+ *   program, compiled (or loaded from the program binary cache) at its first
+ *   use and kept, so switching back to a variant does not compile it again.
+ * - Header files: sources inserted after the #version line (and the defines)
+ *   of each shader file, e.g. a uniform block shared by several programs.
  *
  * About glBindImageTexture and glBindTexture:
  * . https://stackoverflow.com/questions/37136813/what-is-the-difference-between-glbindimagetexture-and-glbindtexture
@@ -16,6 +22,7 @@
 #include "shader.h"
 
 #include <iostream>
+#include <map>
 #include <string>
 
 #include "texture3d.h"
@@ -33,6 +40,22 @@ namespace gl
 
     void SetShaderFile (std::string filename);
     void AddShaderFile (std::string filepath);
+    // Applied at the next LoadAndLink, kept by SetShaderFile
+    void AddHeaderFile (std::string filepath);
+
+    // Defines of the next variant, applied by UpdateVariant (or by the next LoadAndLink)
+    void SetDefine (std::string name, std::string value = "");
+    // Defines name if enabled, removes it otherwise
+    void SetDefineFlag (std::string name, bool enabled);
+    void UnsetDefine (std::string name);
+    void ClearDefines ();
+    // "NAME=VALUE;" of each define, sorted by name: the key of a variant
+    std::string GetDefinesKey ();
+
+    // Switches to the variant of the current defines, compiling it if needed,
+    //   and binds the current uniform values to it. Returns true if the program changed.
+    bool UpdateVariant ();
+    int GetNumberOfVariants ();
 
     void RecomputeNumberOfGroups (GLuint w, GLuint h, GLuint d, GLuint t_x = 8, GLuint t_y = 8, GLuint t_z = 8);
     
@@ -46,9 +69,18 @@ namespace gl
 
   private:
     std::vector<std::string> vec_compute_shader_names;
-    std::vector<GLuint> vec_compute_shader_ids;
+    std::vector<std::string> vec_header_names;
+
+    void CompileShader (GLuint shader_id, std::string filename, const std::string& source);
+    // Source with the #define lines of m_defines and the header sources after its #version line
+    std::string InjectPreamble (const std::string& source, const std::vector<std::string>& headers);
+    // Resolves the locations of the uniforms in the current program and sets their values
+    void RebindUniforms ();
 
-    void CompileShader (GLuint shader_id, std::string filename);
+    std::map<std::string, std::string> m_defines;
+    // Linked programs by defines key, shader_program is the one of m_variant_key
+    std::map<std::string, GLuint> m_variants;
+    std::string m_variant_key;
 
     GLuint num_groups_x;
     GLuint num_groups_y;
@@ -2,14 +2,27 @@
 
 #include <iostream>
 #include <gl_utils/utils.h>
+#include <gl_utils/gpumemoryregistry.h>
 
 #include <GL/glew.h>
 
 namespace gl
 {
+  GLuint FrameBufferObject::s_screen_fbo = 0;
+
   void FrameBufferObject::Unbind()
   {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, s_screen_fbo);
+  }
+
+  void FrameBufferObject::SetScreenFramebuffer (GLuint fbo)
+  {
+    s_screen_fbo = fbo;
+  }
+
+  GLuint FrameBufferObject::GetScreenFramebuffer ()
+  {
+    return s_screen_fbo;
   }
 
   void FrameBufferObject::Bind ()
@@ -29,12 +42,15 @@ namespace gl
     glGenFramebuffers(1, &m_id);
     Bind();
     Unbind();
+
+    GPUMemoryRegistry::Instance()->SetOwner(this, "frame buffers");
   }
   
   FrameBufferObject::~FrameBufferObject ()
   {
     DestroyAttachments();
     glDeleteFramebuffers(1, &m_id);
+    if (GPUMemoryRegistry::Exists()) GPUMemoryRegistry::Instance()->Unregister(this);
 
     gl::ExitOnGLError("Error when destroying gl::FrameBufferObject!");
   }
@@ -79,6 +95,12 @@ namespace gl
       glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
     }
 
+    // All the attachments are accounted as one allocation
+    GLint color_format = (bits == 16) ? GL_RGBA16F : GL_RGBA32F;
+    size_t texel_bytes = GetCurrentNumberOfAttachments() * GPUMemoryRegistry::GetTexelByteSize(color_format)
+      + (use_depth_buffer ? GPUMemoryRegistry::GetTexelByteSize(GL_DEPTH_COMPONENT) : 0);
+    GPUMemoryRegistry::Instance()->Register(this, GPU_MEMORY_TEXTURE_2D, color_format, (size_t)width * height * texel_bytes);
+
     for (int i = 0; i < GetCurrentNumberOfAttachments(); i++)
       glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, m_color_attachments[i], 0);
     
@@ -116,6 +138,7 @@ namespace gl
     {
       glDeleteTextures(1, &m_depth_attachment);
     }
+    if (GPUMemoryRegistry::Exists()) GPUMemoryRegistry::Instance()->Register(this, GPU_MEMORY_TEXTURE_2D, 0, 0);
   }
 
   bool FrameBufferObject::Resize (unsigned int screen_width, unsigned int screen_height)
@@ -133,7 +156,7 @@ namespace gl
   void FrameBufferObject::RenderColorAttachments (unsigned int screen_width, unsigned int screen_height)
   {
     // output frame = screen
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, s_screen_fbo);
 
     // input frame = gBuffer
     glBindFramebuffer(GL_READ_FRAMEBUFFER, m_id);
@@ -181,13 +204,13 @@ namespace gl
     glReadBuffer(GL_COLOR_ATTACHMENT7);
     glBlitFramebuffer(0, 0, width, height, x30, yd0, x31, yd1, GL_COLOR_BUFFER_BIT, GL_LINEAR);
     
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, s_screen_fbo);
   }
 
   void FrameBufferObject::RenderColorAttachment (unsigned int screen_width, unsigned int screen_height, int id)
   {
     //output frame = screen
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, s_screen_fbo);
     //input frame = framebuffer
     glBindFramebuffer(GL_READ_FRAMEBUFFER, m_id);
 
@@ -197,7 +220,7 @@ namespace gl
     // https://stackoverflow.com/questions/11315534/copying-depth-render-buffer-to-the-depth-buffer
     //glBlitFramebuffer(0, 0, width, height, 0, 0, screen_width, screen_height, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
 
-    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, s_screen_fbo);
   }
 
   GLint FrameBufferObject::GetMaxLayers ()
@@ -15,9 +15,16 @@ namespace gl
   class FrameBufferObject
   {
   public:
-    /*! Unbind Framebuffer Object (bind GL_FRAMEBUFFER to 0).
+    /*! Unbind Framebuffer Object (bind GL_FRAMEBUFFER to the screen framebuffer).
     */
     static void Unbind ();
+
+    /*! Framebuffer used as screen by Unbind and RenderColorAttachment(s).
+    \param fbo 0 for the window (default), or an offscreen framebuffer
+      when there is no window, as in the headless benchmark.
+    */
+    static void SetScreenFramebuffer (GLuint fbo);
+    static GLuint GetScreenFramebuffer ();
     
     /*! Bind Framebuffer Object to m_id.
     */
@@ -102,6 +109,8 @@ namespace gl
 
   protected:
   private:
+    static GLuint s_screen_fbo;
+
     GLuint cur_number_of_attachments;
     bool use_depth_buffer;
     int bits;
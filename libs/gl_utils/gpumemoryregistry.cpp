@@ -0,0 +1,261 @@
+#include "gpumemoryregistry.h"
+
+#include <cstdio>
+#include <sstream>
+#include <iomanip>
+
+namespace gl
+{
+  GPUMemoryRegistry::Allocation::Allocation ()
+    : kind(GPU_MEMORY_TEXTURE_3D)
+    , internalformat(0)
+    , bytesize(0)
+    , owner(GPU_MEMORY_DEFAULT_OWNER)
+    , memclass(GPU_MEMORY_RESIDENT)
+  {
+  }
+
+  GPUMemoryRegistry* GPUMemoryRegistry::crr_instance = nullptr;
+
+  GPUMemoryRegistry* GPUMemoryRegistry::Instance ()
+  {
+    if (!crr_instance)
+      crr_instance = new GPUMemoryRegistry();
+
+    return crr_instance;
+  }
+
+  bool GPUMemoryRegistry::Exists ()
+  {
+    return (crr_instance != nullptr);
+  }
+
+  void GPUMemoryRegistry::DestroyInstance ()
+  {
+    if (crr_instance)
+    {
+      delete crr_instance;
+      crr_instance = nullptr;
+    }
+  }
+
+  size_t GPUMemoryRegistry::GetTexelByteSize (GLint internalformat)
+  {
+    switch (internalformat)
+    {
+    case GL_R8: case GL_R8I: case GL_R8UI: case GL_RED:
+      return 1;
+    case GL_R16: case GL_R16F: case GL_R16I: case GL_R16UI:
+    case GL_RG8: case GL_RG8I: case GL_RG8UI:
+    case GL_DEPTH_COMPONENT16:
+      return 2;
+    case GL_RGB8: case GL_RGB8I: case GL_RGB8UI: case GL_RGB:
+    case GL_DEPTH_COMPONENT24:
+      return 3;
+    case GL_R32F: case GL_R32I: case GL_R32UI:
+    case GL_RG16: case GL_RG16F: case GL_RG16I: case GL_RG16UI:
+    case GL_RGBA8: case GL_RGBA8I: case GL_RGBA8UI: case GL_RGBA:
+    case GL_RGB10_A2: case GL_R11F_G11F_B10F:
+    case GL_DEPTH_COMPONENT: case GL_DEPTH_COMPONENT32: case GL_DEPTH_COMPONENT32F:
+    case GL_DEPTH24_STENCIL8:
+      return 4;
+    case GL_RGB16: case GL_RGB16F: case GL_RGB16I: case GL_RGB16UI:
+      return 6;
+    case GL_RG32F: case GL_RG32I: case GL_RG32UI:
+    case GL_RGBA16: case GL_RGBA16F: case GL_RGBA16I: case GL_RGBA16UI:
+      return 8;
+    case GL_RGB32F: case GL_RGB32I: case GL_RGB32UI:
+      return 12;
+    case GL_RGBA32F: case GL_RGBA32I: case GL_RGBA32UI:
+      return 16;
+    default:
+      return 0;
+    }
+  }
+
+  size_t GPUMemoryRegistry::QueryDedicatedVideoMemory ()
+  {
+    // Clear the previous errors, an invalid enum means the extension is not supported
+    while (glGetError() != GL_NO_ERROR);
+
+    GLint kbytes = 0;
+    glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &kbytes);
+    if (glGetError() != GL_NO_ERROR || kbytes <= 0)
+      return 0;
+
+    return (size_t)kbytes * 1024;
+  }
+
+  size_t GPUMemoryRegistry::GetDefaultBudget ()
+  {
+    size_t vram = QueryDedicatedVideoMemory();
+    if (vram == 0)
+      return (size_t)GPU_MEMORY_DEFAULT_BUDGET_FALLBACK_MB << 20;
+
+    return (size_t)((double)vram * GPU_MEMORY_DEFAULT_BUDGET_FRACTION);
+  }
+
+  void GPUMemoryRegistry::Register (const void* resource, GPU_MEMORY_KIND kind, GLint internalformat, size_t bytesize)
+  {
+    std::map<const void*, Allocation>::iterator it = m_allocations.find(resource);
+    if (it == m_allocations.end())
+    {
+      it = m_allocations.insert(std::make_pair(resource, Allocation())).first;
+    }
+
+    m_total_bytes = m_total_bytes - it->second.bytesize + bytesize;
+    it->second.kind = kind;
+    it->second.internalformat = internalformat;
+    it->second.bytesize = bytesize;
+
+    if (m_total_bytes > m_peak_bytes) m_peak_bytes = m_total_bytes;
+  }
+
+  void GPUMemoryRegistry::Unregister (const void* resource)
+  {
+    std::map<const void*, Allocation>::iterator it = m_allocations.find(resource);
+    if (it == m_allocations.end()) return;
+
+    m_total_bytes -= it->second.bytesize;
+    m_allocations.erase(it);
+  }
+
+  void GPUMemoryRegistry::SetOwner (const void* resource, std::string owner, GPU_MEMORY_CLASS memclass)
+  {
+    std::map<const void*, Allocation>::iterator it = m_allocations.find(resource);
+    if (it == m_allocations.end())
+    {
+      it = m_allocations.insert(std::make_pair(resource, Allocation())).first;
+    }
+
+    it->second.owner = owner;
+    it->second.memclass = memclass;
+  }
+
+  int GPUMemoryRegistry::GetNumberOfResources ()
+  {
+    return (int)m_allocations.size();
+  }
+
+  size_t GPUMemoryRegistry::GetTotalBytes ()
+  {
+    return m_total_bytes;
+  }
+
+  size_t GPUMemoryRegistry::GetCacheBytes ()
+  {
+    size_t total = 0;
+    for (std::map<const void*, Allocation>::iterator it = m_allocations.begin(); it != m_allocations.end(); ++it)
+      if (it->second.memclass == GPU_MEMORY_CACHE)
+        total += it->second.bytesize;
+    return total;
+  }
+
+  size_t GPUMemoryRegistry::GetPeakBytes ()
+  {
+    return m_peak_bytes;
+  }
+
+  void GPUMemoryRegistry::ResetPeak ()
+  {
+    m_peak_bytes = m_total_bytes;
+  }
+
+  std::map<std::string, size_t> GPUMemoryRegistry::GetBytesPerOwner ()
+  {
+    std::map<std::string, size_t> owners;
+    for (std::map<const void*, Allocation>::iterator it = m_allocations.begin(); it != m_allocations.end(); ++it)
+      if (it->second.bytesize > 0)
+        owners[it->second.owner] += it->second.bytesize;
+    return owners;
+  }
+
+  std::string GPUMemoryRegistry::GetBytesPerOwnerStr ()
+  {
+    std::map<std::string, size_t> owners = GetBytesPerOwner();
+
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+    for (std::map<std::string, size_t>::iterator it = owners.begin(); it != owners.end(); ++it)
+    {
+      if (it != owners.begin()) oss << ";";
+      oss << it->first << "=" << (double)it->second / (1024.0 * 1024.0);
+    }
+    return oss.str();
+  }
+
+  void GPUMemoryRegistry::SetBudget (size_t bytesize)
+  {
+    m_budget_bytes = bytesize;
+  }
+
+  size_t GPUMemoryRegistry::GetBudget ()
+  {
+    return m_budget_bytes;
+  }
+
+  bool GPUMemoryRegistry::IsOverBudget ()
+  {
+    return m_budget_bytes > 0 && m_total_bytes > m_budget_bytes;
+  }
+
+  void GPUMemoryRegistry::AddEvictionCallback (EvictionCallback callback, void* data)
+  {
+    Evictor evictor;
+    evictor.callback = callback;
+    evictor.data = data;
+    m_evictors.push_back(evictor);
+  }
+
+  void GPUMemoryRegistry::RemoveEvictionCallback (EvictionCallback callback, void* data)
+  {
+    for (int i = 0; i < m_evictors.size(); i++)
+    {
+      if (m_evictors[i].callback == callback && m_evictors[i].data == data)
+      {
+        m_evictors.erase(m_evictors.begin() + i);
+        return;
+      }
+    }
+  }
+
+  bool GPUMemoryRegistry::Reserve (size_t bytesize)
+  {
+    if (m_budget_bytes == 0) return true;
+
+    // Each callback frees memory until it has nothing left, then the next one is called
+    int i_evictor = 0;
+    while (m_total_bytes + bytesize > m_budget_bytes)
+    {
+      if (i_evictor >= m_evictors.size())
+        return false;
+
+      // A callback that claims to evict without lowering the total would loop forever
+      size_t total_bytes = m_total_bytes;
+      if (m_evictors[i_evictor].callback(m_evictors[i_evictor].data) && m_total_bytes < total_bytes)
+        m_n_evictions++;
+      else
+        i_evictor++;
+    }
+    return true;
+  }
+
+  int GPUMemoryRegistry::GetNumberOfEvictions ()
+  {
+    return m_n_evictions;
+  }
+
+  GPUMemoryRegistry::GPUMemoryRegistry ()
+    : m_total_bytes(0)
+    , m_peak_bytes(0)
+    , m_budget_bytes(0)
+    , m_n_evictions(0)
+  {
+  }
+
+  GPUMemoryRegistry::~GPUMemoryRegistry ()
+  {
+    m_allocations.clear();
+    m_evictors.clear();
+  }
+}
@@ -0,0 +1,143 @@
+/**
+ * Registry of the gpu memory allocated by the application.
+ *
+ * gl::Texture1D/2D/3D, gl::BufferObject, gl::UniformBuffer and the frame
+ *   buffer attachments register their size and internal format when their
+ *   storage is (re)defined, and unregister when it is deleted. Raw gl objects
+ *   (pixel buffers, layered attachments...) are registered by their owner,
+ *   with the address of the object name as key.
+ * . An owner label groups the allocations in the totals (e.g. "volume",
+ *   "gradient", "light cache"). Cache allocations can be deleted and built
+ *   again, the others are needed by the current frame.
+ * . The sizes are computed from the internal formats: drivers may pad some
+ *   formats (e.g. rgb to rgba), so the totals are a lower bound.
+ *
+ * Budget: before a large allocation, Reserve calls the eviction callbacks
+ *   (unreferenced derived textures, warm standby renderers...) until the
+ *   new total fits in the budget. If it still does not fit, the caller
+ *   allocates a lower resolution version of its data, or nothing.
+ * . The default budget leaves headroom for the driver, the window system
+ *   and the other applications: a fraction of the dedicated video memory,
+ *   or a fixed size if the driver does not report it.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef GL_UTILS_GPU_MEMORY_REGISTRY_H
+#define GL_UTILS_GPU_MEMORY_REGISTRY_H
+
+#include <GL/glew.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Owner label of the allocations registered without one
+#define GPU_MEMORY_DEFAULT_OWNER "other"
+
+// Default budget: fraction of the dedicated video memory...
+#define GPU_MEMORY_DEFAULT_BUDGET_FRACTION 0.75
+// ... or size (MB) when it is unknown
+#define GPU_MEMORY_DEFAULT_BUDGET_FALLBACK_MB 1024
+
+namespace gl
+{
+  enum GPU_MEMORY_KIND : unsigned int {
+    GPU_MEMORY_TEXTURE_1D = 0,
+    GPU_MEMORY_TEXTURE_2D = 1,
+    GPU_MEMORY_TEXTURE_3D = 2,
+    GPU_MEMORY_BUFFER     = 3,
+  };
+
+  enum GPU_MEMORY_CLASS : unsigned int {
+    GPU_MEMORY_RESIDENT = 0,
+    GPU_MEMORY_CACHE    = 1,
+  };
+
+  class GPUMemoryRegistry
+  {
+  public:
+    class Allocation
+    {
+    public:
+      Allocation ();
+
+      GPU_MEMORY_KIND kind;
+      GLint internalformat;
+      size_t bytesize;
+      std::string owner;
+      GPU_MEMORY_CLASS memclass;
+    };
+
+    // Frees some cache memory. Returns false if there is nothing left to free.
+    typedef bool (*EvictionCallback) (void* data);
+
+    static GPUMemoryRegistry* Instance ();
+    static bool Exists ();
+    static void DestroyInstance ();
+
+    // Bytes per texel of an internal format, 0 if unknown
+    static size_t GetTexelByteSize (GLint internalformat);
+    // Dedicated video memory reported by GL_NVX_gpu_memory_info, 0 if unavailable
+    static size_t QueryDedicatedVideoMemory ();
+    // GPU_MEMORY_DEFAULT_BUDGET_FRACTION of the dedicated video memory,
+    //   GPU_MEMORY_DEFAULT_BUDGET_FALLBACK_MB if it is unavailable
+    static size_t GetDefaultBudget ();
+
+    // Registers or resizes an allocation. The owner and class of a resource are kept.
+    void Register (const void* resource, GPU_MEMORY_KIND kind, GLint internalformat, size_t bytesize);
+    void Unregister (const void* resource);
+    // May be called before Register
+    void SetOwner (const void* resource, std::string owner, GPU_MEMORY_CLASS memclass = GPU_MEMORY_RESIDENT);
+
+    int GetNumberOfResources ();
+    size_t GetTotalBytes ();
+    size_t GetCacheBytes ();
+    // Highest total since the last reset
+    size_t GetPeakBytes ();
+    void ResetPeak ();
+    // Total of each owner
+    std::map<std::string, size_t> GetBytesPerOwner ();
+    // "owner=MB;owner=MB;..." of the current allocations
+    std::string GetBytesPerOwnerStr ();
+
+    // 0: no budget
+    void SetBudget (size_t bytesize);
+    size_t GetBudget ();
+    bool IsOverBudget ();
+
+    // Callbacks are called in the order they were added
+    void AddEvictionCallback (EvictionCallback callback, void* data);
+    void RemoveEvictionCallback (EvictionCallback callback, void* data);
+
+    // Evicts cache memory until bytesize more bytes fit in the budget.
+    //   A callback that frees nothing is skipped, even if it returns true.
+    //   Returns false if they still do not fit.
+    bool Reserve (size_t bytesize);
+    int GetNumberOfEvictions ();
+
+  protected:
+    class Evictor
+    {
+    public:
+      EvictionCallback callback;
+      void* data;
+    };
+
+    std::map<const void*, Allocation> m_allocations;
+    size_t m_total_bytes;
+    size_t m_peak_bytes;
+
+    size_t m_budget_bytes;
+    std::vector<Evictor> m_evictors;
+    int m_n_evictions;
+
+  private:
+    GPUMemoryRegistry ();
+    ~GPUMemoryRegistry ();
+
+    static GPUMemoryRegistry* crr_instance;
+  };
+}
+
+#endif
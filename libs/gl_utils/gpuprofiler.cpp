@@ -0,0 +1,282 @@
+#include "gpuprofiler.h"
+
+#include <cstdio>
+
+namespace gl
+{
+  GPUProfiler* GPUProfiler::crr_instance = nullptr;
+
+  GPUProfiler* GPUProfiler::Instance ()
+  {
+    if (!crr_instance)
+      crr_instance = new GPUProfiler();
+
+    return crr_instance;
+  }
+
+  bool GPUProfiler::Exists ()
+  {
+    return (crr_instance != nullptr);
+  }
+
+  void GPUProfiler::DestroyInstance ()
+  {
+    if (crr_instance)
+    {
+      delete crr_instance;
+      crr_instance = nullptr;
+    }
+  }
+
+  void GPUProfiler::SetEnabled (bool enabled)
+  {
+    if (m_in_frame) EndFrame();
+    m_enabled = enabled;
+  }
+
+  bool GPUProfiler::IsEnabled ()
+  {
+    return m_enabled;
+  }
+
+  void GPUProfiler::BeginFrame ()
+  {
+    if (!m_enabled) return;
+    if (m_in_frame) EndFrame();
+
+    CollectAvailableFrames();
+
+    // Non-blocking: if the gpu is still behind, the oldest frame is lost
+    m_curr_slot = &m_slots[m_frame_count % GPU_PROFILER_FRAMES_IN_FLIGHT];
+    if (m_curr_slot->pending)
+      m_dropped_frames++;
+
+    m_curr_slot->frame_id = m_frame_count;
+    m_curr_slot->pending = false;
+    m_curr_slot->n_used_queries = 0;
+    m_curr_slot->scopes.clear();
+    m_open_scopes.clear();
+
+    m_in_frame = true;
+  }
+
+  void GPUProfiler::EndFrame ()
+  {
+    if (!m_in_frame) return;
+
+    while (!m_open_scopes.empty())
+      EndScope();
+
+    m_curr_slot->pending = !m_curr_slot->scopes.empty();
+    m_curr_slot = nullptr;
+    m_in_frame = false;
+    m_frame_count++;
+  }
+
+  void GPUProfiler::BeginScope (const char* name)
+  {
+    if (!m_in_frame)
+    {
+      if (m_enabled) m_open_scopes.push_back(-1);
+      return;
+    }
+
+    ScopeRecord rec;
+    rec.name = name;
+    rec.depth = 0;
+    for (int i = 0; i < m_open_scopes.size(); i++)
+      if (m_open_scopes[i] >= 0) rec.depth++;
+    rec.q_begin = NextQuery(m_curr_slot);
+    rec.q_end = -1;
+    glQueryCounter(m_curr_slot->queries[rec.q_begin], GL_TIMESTAMP);
+
+    m_open_scopes.push_back((int)m_curr_slot->scopes.size());
+    m_curr_slot->scopes.push_back(rec);
+  }
+
+  void GPUProfiler::EndScope ()
+  {
+    if (m_open_scopes.empty()) return;
+
+    int idx = m_open_scopes.back();
+    m_open_scopes.pop_back();
+    if (idx < 0 || !m_in_frame) return;
+
+    ScopeRecord& rec = m_curr_slot->scopes[idx];
+    rec.q_end = NextQuery(m_curr_slot);
+    glQueryCounter(m_curr_slot->queries[rec.q_end], GL_TIMESTAMP);
+  }
+
+  void GPUProfiler::Flush ()
+  {
+    if (m_in_frame) EndFrame();
+
+    // Oldest frames first, so the last results are from the last frame
+    for (long long f = m_frame_count - GPU_PROFILER_FRAMES_IN_FLIGHT; f < m_frame_count; f++)
+    {
+      if (f < 0) continue;
+      FrameSlot* slot = &m_slots[f % GPU_PROFILER_FRAMES_IN_FLIGHT];
+      if (slot->pending && slot->frame_id == f)
+        CollectFrame(slot, true);
+    }
+  }
+
+  const std::vector<GPUProfiler::ScopeResult>& GPUProfiler::GetLastFrameResults ()
+  {
+    return m_last_results;
+  }
+
+  long long GPUProfiler::GetLastResultFrameId ()
+  {
+    return m_last_result_frame;
+  }
+
+  long long GPUProfiler::GetNumberOfDroppedFrames ()
+  {
+    return m_dropped_frames;
+  }
+
+  void GPUProfiler::ResetAccumulation ()
+  {
+    m_accum_frames = 0;
+    m_accum_names.clear();
+    m_accum_sum_ms.clear();
+    m_accum_depth.clear();
+  }
+
+  int GPUProfiler::GetNumberOfAccumulatedFrames ()
+  {
+    return m_accum_frames;
+  }
+
+  const std::vector<std::string>& GPUProfiler::GetAccumulatedScopeNames ()
+  {
+    return m_accum_names;
+  }
+
+  double GPUProfiler::GetAccumulatedAverageMs (std::string name)
+  {
+    std::map<std::string, double>::iterator it = m_accum_sum_ms.find(name);
+    if (it == m_accum_sum_ms.end() || m_accum_frames == 0)
+      return 0.0;
+    return it->second / double(m_accum_frames);
+  }
+
+  double GPUProfiler::GetAccumulatedFrameMs ()
+  {
+    double frame_ms = 0.0;
+    for (int i = 0; i < m_accum_names.size(); i++)
+      if (m_accum_depth[m_accum_names[i]] == 0)
+        frame_ms += GetAccumulatedAverageMs(m_accum_names[i]);
+    return frame_ms;
+  }
+
+  std::string GPUProfiler::GetAccumulatedResultsStr ()
+  {
+    std::string str = "";
+    for (int i = 0; i < m_accum_names.size(); i++)
+    {
+      if (i > 0) str.append(";");
+      str.append(m_accum_names[i] + "=" + std::to_string(GetAccumulatedAverageMs(m_accum_names[i])));
+    }
+    return str;
+  }
+
+  int GPUProfiler::NextQuery (FrameSlot* slot)
+  {
+    if (slot->n_used_queries == slot->queries.size())
+    {
+      // Grow the pool of this slot, queries are never deleted while profiling
+      size_t n_old = slot->queries.size();
+      size_t n_new = n_old == 0 ? 16 : n_old * 2;
+      slot->queries.resize(n_new);
+      glGenQueries((GLsizei)(n_new - n_old), &slot->queries[n_old]);
+    }
+    return slot->n_used_queries++;
+  }
+
+  bool GPUProfiler::CollectFrame (FrameSlot* slot, bool wait)
+  {
+    if (!slot->pending) return false;
+
+    // Timestamps complete in order: the last query tells about the whole frame
+    if (!wait)
+    {
+      GLint available = 0;
+      glGetQueryObjectiv(slot->queries[slot->n_used_queries - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+      if (!available) return false;
+    }
+
+    m_last_results.clear();
+    for (int i = 0; i < slot->scopes.size(); i++)
+    {
+      ScopeRecord& rec = slot->scopes[i];
+      if (rec.q_end < 0) continue;
+
+      GLuint64 t_begin = 0, t_end = 0;
+      glGetQueryObjectui64v(slot->queries[rec.q_begin], GL_QUERY_RESULT, &t_begin);
+      glGetQueryObjectui64v(slot->queries[rec.q_end], GL_QUERY_RESULT, &t_end);
+
+      ScopeResult res;
+      res.name = rec.name;
+      res.depth = rec.depth;
+      res.ms = double(t_end - t_begin) / 1000000.0;
+      m_last_results.push_back(res);
+
+      // Scopes opened several times in a frame are summed
+      if (m_accum_sum_ms.find(res.name) == m_accum_sum_ms.end())
+      {
+        m_accum_names.push_back(res.name);
+        m_accum_sum_ms[res.name] = 0.0;
+        m_accum_depth[res.name] = res.depth;
+      }
+      m_accum_sum_ms[res.name] += res.ms;
+    }
+    m_accum_frames++;
+    m_last_result_frame = slot->frame_id;
+
+    slot->pending = false;
+    return true;
+  }
+
+  void GPUProfiler::CollectAvailableFrames ()
+  {
+    for (long long f = m_frame_count - GPU_PROFILER_FRAMES_IN_FLIGHT; f < m_frame_count; f++)
+    {
+      if (f < 0) continue;
+      FrameSlot* slot = &m_slots[f % GPU_PROFILER_FRAMES_IN_FLIGHT];
+      if (slot->pending && slot->frame_id == f)
+      {
+        // Keep the order: a frame is only read after the previous ones
+        if (!CollectFrame(slot, false)) break;
+      }
+    }
+  }
+
+  GPUProfiler::GPUProfiler ()
+    : m_enabled(false)
+    , m_in_frame(false)
+    , m_frame_count(0)
+    , m_dropped_frames(0)
+    , m_curr_slot(nullptr)
+    , m_last_result_frame(-1)
+    , m_accum_frames(0)
+  {
+    for (int i = 0; i < GPU_PROFILER_FRAMES_IN_FLIGHT; i++)
+    {
+      m_slots[i].frame_id = -1;
+      m_slots[i].pending = false;
+      m_slots[i].n_used_queries = 0;
+    }
+  }
+
+  GPUProfiler::~GPUProfiler ()
+  {
+    for (int i = 0; i < GPU_PROFILER_FRAMES_IN_FLIGHT; i++)
+    {
+      if (!m_slots[i].queries.empty())
+        glDeleteQueries((GLsizei)m_slots[i].queries.size(), m_slots[i].queries.data());
+      m_slots[i].queries.clear();
+    }
+  }
+}
@@ -0,0 +1,144 @@
+/**
+ * GPU profiler with named scopes, using GL_TIMESTAMP queries.
+ *
+ * Each scope writes two timestamps (glQueryCounter), so the cpu never waits
+ *   for the gpu while recording. Queries are kept in a ring with one slot per
+ *   frame in flight: the results of a frame are read back a few frames later,
+ *   only when they are already available. Unlike gl::Timer, there is no
+ *   blocking wait, except in Flush.
+ *
+ * Scopes may be nested and must be opened between BeginFrame and EndFrame.
+ *   When the profiler is disabled, every call returns immediately.
+ *
+ * https://www.khronos.org/opengl/wiki/Query_Object#Timer_queries
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef GL_UTILS_GPU_PROFILER_H
+#define GL_UTILS_GPU_PROFILER_H
+
+#include <GL/glew.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Frames recorded before the queries of a slot are reused
+#define GPU_PROFILER_FRAMES_IN_FLIGHT 4
+
+#define GPU_PROFILER_CONCAT_(a, b) a##b
+#define GPU_PROFILER_CONCAT(a, b) GPU_PROFILER_CONCAT_(a, b)
+// Profile the gpu work until the end of the current block
+#define GPU_PROFILER_SCOPE(name) gl::GPUProfilerScope GPU_PROFILER_CONCAT(gpu_profiler_scope_, __LINE__)(name)
+
+namespace gl
+{
+  class GPUProfiler
+  {
+  public:
+    class ScopeResult
+    {
+    public:
+      std::string name;
+      int depth;
+      double ms;
+    };
+
+    static GPUProfiler* Instance ();
+    static bool Exists ();
+    static void DestroyInstance ();
+
+    void SetEnabled (bool enabled);
+    bool IsEnabled ();
+
+    void BeginFrame ();
+    void EndFrame ();
+
+    void BeginScope (const char* name);
+    void EndScope ();
+
+    // Wait for the frames still in flight (e.g. at the end of an evaluation sample)
+    void Flush ();
+
+    // Scopes of the most recent frame read back from the gpu, in the order they were opened
+    const std::vector<ScopeResult>& GetLastFrameResults ();
+    // Id of the frame of GetLastFrameResults, -1 if none
+    long long GetLastResultFrameId ();
+    // Frames not read back since their slot had to be reused
+    long long GetNumberOfDroppedFrames ();
+
+    // Average time per frame of each scope name, since the last reset
+    void ResetAccumulation ();
+    int GetNumberOfAccumulatedFrames ();
+    const std::vector<std::string>& GetAccumulatedScopeNames ();
+    double GetAccumulatedAverageMs (std::string name);
+    // Sum of the averages of the outermost scopes
+    double GetAccumulatedFrameMs ();
+    // "name=ms;name=ms;..." of the accumulated averages
+    std::string GetAccumulatedResultsStr ();
+
+  protected:
+    class ScopeRecord
+    {
+    public:
+      std::string name;
+      int depth;
+      int q_begin, q_end;
+    };
+
+    class FrameSlot
+    {
+    public:
+      long long frame_id;
+      bool pending;
+      std::vector<GLuint> queries;
+      int n_used_queries;
+      std::vector<ScopeRecord> scopes;
+    };
+
+    int NextQuery (FrameSlot* slot);
+    // Returns false if wait is false and the results are not available yet
+    bool CollectFrame (FrameSlot* slot, bool wait);
+    void CollectAvailableFrames ();
+
+    bool m_enabled;
+    bool m_in_frame;
+    long long m_frame_count;
+    long long m_dropped_frames;
+
+    FrameSlot m_slots[GPU_PROFILER_FRAMES_IN_FLIGHT];
+    FrameSlot* m_curr_slot;
+    // Indices of the open scopes in the current slot (-1 for ignored scopes)
+    std::vector<int> m_open_scopes;
+
+    std::vector<ScopeResult> m_last_results;
+    long long m_last_result_frame;
+
+    int m_accum_frames;
+    std::vector<std::string> m_accum_names;
+    std::map<std::string, double> m_accum_sum_ms;
+    std::map<std::string, int> m_accum_depth;
+
+  private:
+    GPUProfiler ();
+    ~GPUProfiler ();
+
+    static GPUProfiler* crr_instance;
+  };
+
+  class GPUProfilerScope
+  {
+  public:
+    GPUProfilerScope (const char* name)
+    {
+      GPUProfiler::Instance()->BeginScope(name);
+    }
+    ~GPUProfilerScope ()
+    {
+      GPUProfiler::Instance()->EndScope();
+    }
+  };
+}
+
+#endif
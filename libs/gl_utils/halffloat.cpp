@@ -0,0 +1,237 @@
+#include "halffloat.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GL_UTILS_HALF_FLOAT_F16C
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define GL_UTILS_HALF_FLOAT_NEON
+#include <arm_neon.h>
+#endif
+
+// F16C functions are compiled for avx + f16c and only called if the cpu has them
+#if defined(GL_UTILS_HALF_FLOAT_F16C) && (defined(__GNUC__) || defined(__clang__))
+#define GL_UTILS_F16C_TARGET __attribute__((target("avx,f16c")))
+#else
+#define GL_UTILS_F16C_TARGET
+#endif
+
+// Floats converted at once by DoubleToHalf
+#define HALF_FLOAT_STAGING_SIZE 1024
+
+namespace gl
+{
+  namespace
+  {
+    typedef void (*HalfConversion) (const float* src, GLhalf* dst, size_t n);
+
+    void FloatToHalfScalar (const float* src, GLhalf* dst, size_t n)
+    {
+      for (size_t i = 0; i < n; i++)
+        dst[i] = FloatToHalf(src[i]);
+    }
+
+#ifdef GL_UTILS_HALF_FLOAT_F16C
+    GL_UTILS_F16C_TARGET void FloatToHalfF16C (const float* src, GLhalf* dst, size_t n)
+    {
+      size_t i = 0;
+      for (; i + 8 <= n; i += 8)
+      {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(dst + i), h);
+      }
+      for (; i < n; i++)
+        dst[i] = FloatToHalf(src[i]);
+    }
+
+    // cpu flags of F16C and AVX, and ymm registers saved by the os
+    bool IsF16CSupported ()
+    {
+      unsigned int regs[4] = { 0, 0, 0, 0 };
+#ifdef _MSC_VER
+      int info[4];
+      __cpuid(info, 1);
+      for (int i = 0; i < 4; i++) regs[i] = (unsigned int)info[i];
+#else
+      if (!__get_cpuid(1, &regs[0], &regs[1], &regs[2], &regs[3]))
+        return false;
+#endif
+      const unsigned int osxsave = 1u << 27, avx = 1u << 28, f16c = 1u << 29;
+      if ((regs[2] & (osxsave | avx | f16c)) != (osxsave | avx | f16c))
+        return false;
+
+#ifdef _MSC_VER
+      unsigned long long xcr0 = _xgetbv(0);
+#else
+      unsigned int xcr0_lo, xcr0_hi;
+      __asm__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+      unsigned long long xcr0 = ((unsigned long long)xcr0_hi << 32) | xcr0_lo;
+#endif
+      return (xcr0 & 0x6) == 0x6;
+    }
+#endif
+
+#ifdef GL_UTILS_HALF_FLOAT_NEON
+    void FloatToHalfNEON (const float* src, GLhalf* dst, size_t n)
+    {
+      size_t i = 0;
+      for (; i + 4 <= n; i += 4)
+        vst1_u16((uint16_t*)(dst + i), vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+      for (; i < n; i++)
+        dst[i] = FloatToHalf(src[i]);
+    }
+#endif
+
+    class ConversionPath
+    {
+    public:
+      HalfConversion conversion;
+      const char* name;
+    };
+
+    ConversionPath SelectConversion ()
+    {
+      ConversionPath path = { FloatToHalfScalar, "scalar" };
+#if defined(GL_UTILS_HALF_FLOAT_F16C)
+      if (IsF16CSupported())
+      {
+        path.conversion = FloatToHalfF16C;
+        path.name = "F16C";
+      }
+#elif defined(GL_UTILS_HALF_FLOAT_NEON)
+      path.conversion = FloatToHalfNEON;
+      path.name = "NEON";
+#endif
+      return path;
+    }
+
+    // Selected once, at the first conversion: the initialization of the local
+    //   static is thread safe, even if the first calls come from several threads
+    const ConversionPath& GetConversionPath ()
+    {
+      static const ConversionPath path = SelectConversion();
+      return path;
+    }
+
+    HalfConversion GetConversion ()
+    {
+      return GetConversionPath().conversion;
+    }
+  }
+
+  GLhalf FloatToHalf (float value)
+  {
+    unsigned int f;
+    memcpy(&f, &value, sizeof(float));
+
+    unsigned int sign = f & 0x80000000u;
+    f ^= sign;
+
+    unsigned int h;
+    // 2^16 or more (including inf and NaN): inf, or a quiet NaN
+    if (f >= ((127u + 16u) << 23))
+    {
+      h = (f > (255u << 23)) ? 0x7E00u : 0x7C00u;
+    }
+    // Subnormal half or zero: the float addition aligns and rounds the mantissa
+    else if (f < (113u << 23))
+    {
+      const unsigned int denorm_magic_u = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+      float denorm_magic, v;
+      memcpy(&denorm_magic, &denorm_magic_u, sizeof(float));
+      memcpy(&v, &f, sizeof(float));
+      v += denorm_magic;
+      memcpy(&f, &v, sizeof(float));
+      h = f - denorm_magic_u;
+    }
+    // Normal half: rebias the exponent, round to nearest even
+    else
+    {
+      unsigned int mant_odd = (f >> 13) & 1u;
+      f += ((unsigned int)(15 - 127) << 23) + 0xFFFu;
+      f += mant_odd;
+      h = f >> 13;
+    }
+
+    return (GLhalf)(h | (sign >> 16));
+  }
+
+  float HalfToFloat (GLhalf value)
+  {
+    const unsigned int shifted_exp = 0x7C00u << 13;
+    const unsigned int magic_u = 113u << 23;
+
+    unsigned int f = ((unsigned int)value & 0x7FFFu) << 13;
+    unsigned int exp = shifted_exp & f;
+    f += (127u - 15u) << 23;
+
+    // Inf or NaN
+    if (exp == shifted_exp)
+    {
+      f += (128u - 16u) << 23;
+    }
+    // Zero or subnormal: renormalize
+    else if (exp == 0)
+    {
+      f += 1u << 23;
+      float magic, v;
+      memcpy(&magic, &magic_u, sizeof(float));
+      memcpy(&v, &f, sizeof(float));
+      v -= magic;
+      memcpy(&f, &v, sizeof(float));
+    }
+
+    f |= ((unsigned int)value & 0x8000u) << 16;
+
+    float ret;
+    memcpy(&ret, &f, sizeof(float));
+    return ret;
+  }
+
+  void FloatToHalf (const float* src, GLhalf* dst, size_t n)
+  {
+    HalfConversion conversion = GetConversion();
+    if (n < 2 * HALF_FLOAT_CONVERSION_BLOCK_SIZE)
+    {
+      conversion(src, dst, n);
+      return;
+    }
+
+    long long n_blocks = (long long)((n + HALF_FLOAT_CONVERSION_BLOCK_SIZE - 1) / HALF_FLOAT_CONVERSION_BLOCK_SIZE);
+#pragma omp parallel for
+    for (long long b = 0; b < n_blocks; b++)
+    {
+      size_t first = (size_t)b * HALF_FLOAT_CONVERSION_BLOCK_SIZE;
+      size_t count = n - first < HALF_FLOAT_CONVERSION_BLOCK_SIZE ? n - first : HALF_FLOAT_CONVERSION_BLOCK_SIZE;
+      conversion(src + first, dst + first, count);
+    }
+  }
+
+  void DoubleToHalf (const double* src, GLhalf* dst, size_t n)
+  {
+    HalfConversion conversion = GetConversion();
+
+    long long n_blocks = (long long)((n + HALF_FLOAT_STAGING_SIZE - 1) / HALF_FLOAT_STAGING_SIZE);
+#pragma omp parallel for
+    for (long long b = 0; b < n_blocks; b++)
+    {
+      float staging[HALF_FLOAT_STAGING_SIZE];
+      size_t first = (size_t)b * HALF_FLOAT_STAGING_SIZE;
+      size_t count = n - first < HALF_FLOAT_STAGING_SIZE ? n - first : HALF_FLOAT_STAGING_SIZE;
+      for (size_t i = 0; i < count; i++)
+        staging[i] = (float)src[first + i];
+      conversion(staging, dst + first, count);
+    }
+  }
+
+  const char* GetHalfFloatConversionPath ()
+  {
+    return GetConversionPath().name;
+  }
+}
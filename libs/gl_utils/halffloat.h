@@ -0,0 +1,45 @@
+/**
+ * Conversion of 32 bit floats to half floats (IEEE 754 binary16), to upload
+ *   GL_R16F/GL_RG16F/GL_RGB16F/GL_RGBA16F textures as GL_HALF_FLOAT data:
+ *   the staging arrays and the transfers are half the size of GL_FLOAT data,
+ *   and the driver does not convert them on the cpu.
+ *
+ * . Rounding to nearest even, as the drivers and the gpu do: overflows become
+ *   infinities, and NaNs stay (quiet) NaNs.
+ * . Arrays are converted 8 values at a time with F16C (x86, checked at run
+ *   time) or 4 at a time with NEON (aarch64), and with the scalar conversion
+ *   otherwise. Large arrays are split between the OpenMP threads.
+ *
+ * http://fgiesen.wordpress.com/2012/03/28/half-to-float-done-quic/
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef GL_UTILS_HALF_FLOAT_H
+#define GL_UTILS_HALF_FLOAT_H
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+// Values converted by each OpenMP task
+#define HALF_FLOAT_CONVERSION_BLOCK_SIZE 65536
+// Values converted at a time by Texture2D/3D::SetHalfFloatData: the host
+//   staging copy is bounded instead of the size of the texture
+#define HALF_FLOAT_STAGING_SIZE (4 * 1024 * 1024)
+
+namespace gl
+{
+  GLhalf FloatToHalf (float value);
+  float HalfToFloat (GLhalf value);
+
+  // Converts n values, src and dst must not overlap
+  void FloatToHalf (const float* src, GLhalf* dst, size_t n);
+  // Same, through a float staging block (e.g. from the double precision SATs)
+  void DoubleToHalf (const double* src, GLhalf* dst, size_t n);
+
+  // "F16C", "NEON" or "scalar": conversion used by the array functions
+  const char* GetHalfFloatConversionPath ();
+}
+
+#endif
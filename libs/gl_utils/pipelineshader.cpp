@@ -1,5 +1,7 @@
 #include "pipelineshader.h"
 #include "utils.h"
+#include "tracer.h"
+#include "programbinarycache.h"
 
 #include <GL/glew.h>
 
@@ -13,10 +15,15 @@ namespace gl
 void PipelineShader::CompileShader (GLuint shader_id, std::string filename)
 {
   char* shader_source = TextFileRead(filename.c_str());
-  const char* const_shader_source = shader_source;
+  CompileShaderSource(shader_id, shader_source);
+  free(shader_source);
+}
+
+void PipelineShader::CompileShaderSource (GLuint shader_id, const std::string& source)
+{
+  const char* const_shader_source = source.c_str();
 
   glShaderSource(shader_id, 1, &const_shader_source, NULL);
-  free(shader_source);
 
   glCompileShader(shader_id);
 }
@@ -114,13 +121,43 @@ PipelineShader::~PipelineShader()
 
 bool PipelineShader::LoadAndLink()
 {
+  TRACE_SCOPE_DETAIL("CompilePipelineShader", "shader", vec_fragment_shaders_names.empty() ? "" : vec_fragment_shaders_names.back());
+
   if (shader_program == -1)
     shader_program = glCreateProgram();
 
+  // Sources are read once, for the key of the program binary and for the compilation
+  std::vector<GLenum> stages;
+  std::vector<std::string> sources;
+  for (unsigned int i = 0; i < vec_vertex_shaders_names.size(); i++)
+    stages.push_back(GL_VERTEX_SHADER);
+  for (unsigned int i = 0; i < vec_fragment_shaders_names.size(); i++)
+    stages.push_back(GL_FRAGMENT_SHADER);
+  for (unsigned int i = 0; i < vec_geometry_shaders_names.size(); i++)
+    stages.push_back(GL_GEOMETRY_SHADER);
+  std::vector<std::string> names = vec_vertex_shaders_names;
+  names.insert(names.end(), vec_fragment_shaders_names.begin(), vec_fragment_shaders_names.end());
+  names.insert(names.end(), vec_geometry_shaders_names.begin(), vec_geometry_shaders_names.end());
+  for (unsigned int i = 0; i < names.size(); i++)
+  {
+    char* shader_source = TextFileRead(names[i].c_str());
+    sources.push_back(shader_source);
+    free(shader_source);
+  }
+
+  gl::ProgramBinaryCache* binary_cache = gl::ProgramBinaryCache::Instance();
+  std::string binary_key = binary_cache->ComputeKey(stages, sources);
+  if (binary_cache->Load(shader_program, binary_key))
+  {
+    gl::ExitOnGLError("GLShader: Unable to load the program binary.");
+    return true;
+  }
+
+  unsigned int source_id = 0;
   for (unsigned int i = 0; i < vec_vertex_shaders_names.size(); i++)
   {
     GLuint new_shader = glCreateShader(GL_VERTEX_SHADER);
-    CompileShader(new_shader, vec_vertex_shaders_names[i]);
+    CompileShaderSource(new_shader, sources[source_id++]);
 
     vec_vertex_shaders_ids.push_back(new_shader);
     assert(vec_vertex_shaders_ids[i] == new_shader);
@@ -131,7 +168,7 @@ bool PipelineShader::LoadAndLink()
   for (unsigned int i = 0; i < vec_fragment_shaders_names.size(); i++)
   {
     GLuint new_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    CompileShader(new_shader, vec_fragment_shaders_names[i]);
+    CompileShaderSource(new_shader, sources[source_id++]);
 
     vec_fragment_shaders_ids.push_back(new_shader);
     assert(vec_fragment_shaders_ids[i] == new_shader);
@@ -142,7 +179,7 @@ bool PipelineShader::LoadAndLink()
   for (unsigned int i = 0; i < vec_geometry_shaders_names.size(); i++)
   {
     GLuint new_shader = glCreateShader(GL_GEOMETRY_SHADER);
-    CompileShader(new_shader, vec_geometry_shaders_names[i]);
+    CompileShaderSource(new_shader, sources[source_id++]);
 
     vec_geometry_shaders_ids.push_back(new_shader);
     assert(vec_geometry_shaders_ids[i] == new_shader);
@@ -150,9 +187,14 @@ bool PipelineShader::LoadAndLink()
     glAttachShader(shader_program, new_shader);
   }
 
+  binary_cache->PrepareProgram(shader_program);
   glLinkProgram(shader_program);
 
   gl::ExitOnGLError("GLShader: Unable to load and link shaders.");
+
+  GLint link_status = GL_FALSE;
+  glGetProgramiv(shader_program, GL_LINK_STATUS, &link_status);
+  if (link_status == GL_TRUE) binary_cache->Store(shader_program, binary_key);
   return true;
 }
 
@@ -44,6 +44,7 @@ namespace gl
     };
 
     static void CompileShader(GLuint shader, std::string filename);
+    static void CompileShaderSource(GLuint shader, const std::string& source);
 
     PipelineShader ();
     PipelineShader (std::string vert, std::string frag);
@@ -0,0 +1,247 @@
+#include "programbinarycache.h"
+#include "tracer.h"
+
+#include <vis_utils/contenthash.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+// Identifies the files of the cache, and their layout
+#define PROGRAM_BINARY_CACHE_MAGIC 0x42504c47u
+#define PROGRAM_BINARY_CACHE_VERSION 1u
+
+namespace gl
+{
+  namespace
+  {
+    class FileHeader
+    {
+    public:
+      unsigned int magic;
+      unsigned int version;
+      unsigned int format;
+      unsigned int length;
+    };
+  }
+
+  ProgramBinaryCache* ProgramBinaryCache::crr_instance = nullptr;
+
+  ProgramBinaryCache* ProgramBinaryCache::Instance ()
+  {
+    if (!crr_instance)
+      crr_instance = new ProgramBinaryCache();
+
+    return crr_instance;
+  }
+
+  bool ProgramBinaryCache::Exists ()
+  {
+    return (crr_instance != nullptr);
+  }
+
+  void ProgramBinaryCache::DestroyInstance ()
+  {
+    if (crr_instance)
+    {
+      delete crr_instance;
+      crr_instance = nullptr;
+    }
+  }
+
+  void ProgramBinaryCache::SetDirectory (std::string directory)
+  {
+    m_directory = directory;
+    if (m_directory.empty()) return;
+
+    if (m_directory.back() != '/' && m_directory.back() != '\\') m_directory += "/";
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+    if (ec)
+    {
+      std::cout << "Error: Unable to create the shader cache directory " << m_directory << "." << std::endl;
+      m_directory.clear();
+    }
+  }
+
+  std::string ProgramBinaryCache::GetDirectory ()
+  {
+    return m_directory;
+  }
+
+  bool ProgramBinaryCache::IsEnabled ()
+  {
+    if (m_directory.empty()) return false;
+
+    // Needs a current context, so it is done at the first use
+    if (!m_driver_queried)
+    {
+      m_driver_queried = true;
+
+      GLint n_formats = 0;
+      if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats);
+      m_supported = n_formats > 0;
+      if (!m_supported)
+        printf("Warning: the driver has no program binary format, shaders are not cached\n");
+
+      const GLubyte* gl_vendor = glGetString(GL_VENDOR);
+      const GLubyte* gl_renderer = glGetString(GL_RENDERER);
+      const GLubyte* gl_version = glGetString(GL_VERSION);
+      m_driver = std::string(gl_vendor ? (const char*)gl_vendor : "") + "\n"
+               + std::string(gl_renderer ? (const char*)gl_renderer : "") + "\n"
+               + std::string(gl_version ? (const char*)gl_version : "");
+    }
+
+    return m_supported;
+  }
+
+  std::string ProgramBinaryCache::ComputeKey (const std::vector<GLenum>& stages, const std::vector<std::string>& sources,
+                                              std::string defines)
+  {
+    IsEnabled();
+
+    // One hash per string (so "ab" + "c" != "a" + "bc"), the stage seeds its source
+    std::vector<vis::ContentHash128> hashes;
+    hashes.push_back(vis::HashBytes128(m_driver.data(), m_driver.size()));
+    hashes.push_back(vis::HashBytes128(defines.data(), defines.size()));
+    for (int i = 0; i < sources.size(); i++)
+    {
+      unsigned int stage = i < stages.size() ? stages[i] : 0;
+      hashes.push_back(vis::HashBytes128(sources[i].data(), sources[i].size(), stage));
+    }
+
+    return vis::CombineHashes(hashes.data(), hashes.size()).ToString();
+  }
+
+  void ProgramBinaryCache::PrepareProgram (GLuint program)
+  {
+    if (!IsEnabled()) return;
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+
+  bool ProgramBinaryCache::Load (GLuint program, std::string key)
+  {
+    if (!IsEnabled()) return false;
+    TRACE_SCOPE_DETAIL("LoadProgramBinary", "shader", key);
+
+    std::ifstream file(GetFilePath(key), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+      m_misses++;
+      return false;
+    }
+
+    FileHeader header;
+    std::vector<char> binary;
+    bool valid = false;
+    if (file.read((char*)&header, sizeof(FileHeader))
+     && header.magic == PROGRAM_BINARY_CACHE_MAGIC && header.version == PROGRAM_BINARY_CACHE_VERSION
+     && header.length > 0)
+    {
+      binary.resize(header.length);
+      valid = (bool)file.read(binary.data(), header.length);
+    }
+    file.close();
+
+    if (valid)
+    {
+      glProgramBinary(program, (GLenum)header.format, binary.data(), (GLsizei)header.length);
+
+      GLint link_status = GL_FALSE;
+      glGetProgramiv(program, GL_LINK_STATUS, &link_status);
+      valid = link_status == GL_TRUE;
+    }
+    // Clear the error of a rejected binary, the program is compiled from its sources instead
+    while (glGetError() != GL_NO_ERROR);
+
+    if (!valid)
+    {
+      printf("Warning: program binary %s was rejected by the driver, compiling it again\n", key.c_str());
+      m_misses++;
+      return false;
+    }
+
+    m_hits++;
+    return true;
+  }
+
+  bool ProgramBinaryCache::Store (GLuint program, std::string key)
+  {
+    if (!IsEnabled()) return false;
+    TRACE_SCOPE_DETAIL("StoreProgramBinary", "shader", key);
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return false;
+
+    FileHeader header;
+    header.magic = PROGRAM_BINARY_CACHE_MAGIC;
+    header.version = PROGRAM_BINARY_CACHE_VERSION;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0) return false;
+    header.format = format;
+    header.length = (unsigned int)written;
+
+    // Written to a temporary file first, so a crash never leaves a truncated binary
+    std::string filepath = GetFilePath(key);
+    std::ofstream file(filepath + ".tmp", std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+      std::cout << "Error: Unable to write program binary " << filepath << "." << std::endl;
+      return false;
+    }
+    file.write((const char*)&header, sizeof(FileHeader));
+    file.write(binary.data(), written);
+    file.close();
+
+    std::error_code ec;
+    std::filesystem::rename(filepath + ".tmp", filepath, ec);
+    return !ec;
+  }
+
+  void ProgramBinaryCache::Clear ()
+  {
+    if (m_directory.empty()) return;
+
+    std::error_code ec;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(m_directory, ec))
+    {
+      if (entry.path().extension() == ".bin")
+        std::filesystem::remove(entry.path(), ec);
+    }
+  }
+
+  int ProgramBinaryCache::GetNumberOfHits ()
+  {
+    return m_hits;
+  }
+
+  int ProgramBinaryCache::GetNumberOfMisses ()
+  {
+    return m_misses;
+  }
+
+  ProgramBinaryCache::ProgramBinaryCache ()
+    : m_directory("")
+    , m_driver_queried(false)
+    , m_supported(false)
+    , m_driver("")
+    , m_hits(0)
+    , m_misses(0)
+  {
+  }
+
+  ProgramBinaryCache::~ProgramBinaryCache ()
+  {
+  }
+
+  std::string ProgramBinaryCache::GetFilePath (std::string key)
+  {
+    return m_directory + key + ".bin";
+  }
+}
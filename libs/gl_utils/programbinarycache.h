@@ -0,0 +1,80 @@
+/**
+ * On-disk cache of linked shader programs (glGetProgramBinary / glProgramBinary).
+ *
+ * The key of a program is a hash of its sources (and of the stage of each
+ *   one), of its defines and of the driver (GL_VENDOR, GL_RENDERER and
+ *   GL_VERSION), so an edited shader or a driver update gives a new key.
+ *   The binary of each key is stored in one file of the cache directory.
+ *
+ * On a miss, or if the driver rejects a stored binary (GL_LINK_STATUS is
+ *   false after glProgramBinary), the caller compiles and links the sources
+ *   as usual and stores the new binary. Without a directory, or if the driver
+ *   supports no binary format, Load always misses and Store does nothing.
+ *
+ * https://www.khronos.org/opengl/wiki/Shader_Compilation#Binary_upload
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef GL_UTILS_PROGRAM_BINARY_CACHE_H
+#define GL_UTILS_PROGRAM_BINARY_CACHE_H
+
+#include <GL/glew.h>
+
+#include <string>
+#include <vector>
+
+namespace gl
+{
+  class ProgramBinaryCache
+  {
+  public:
+    static ProgramBinaryCache* Instance ();
+    static bool Exists ();
+    static void DestroyInstance ();
+
+    // Directory of the binaries, created if needed. An empty directory disables the cache.
+    void SetDirectory (std::string directory);
+    std::string GetDirectory ();
+    bool IsEnabled ();
+
+    // Key of a program: its sources in attachment order with their stages (GL_COMPUTE_SHADER...), and its defines
+    std::string ComputeKey (const std::vector<GLenum>& stages, const std::vector<std::string>& sources,
+                            std::string defines = "");
+
+    // Must be called before glLinkProgram, so the driver keeps the binary
+    void PrepareProgram (GLuint program);
+
+    // Loads the binary of the key into the program. Returns false on a miss or if the binary is rejected.
+    bool Load (GLuint program, std::string key);
+    // Stores the binary of a linked program
+    bool Store (GLuint program, std::string key);
+
+    // Deletes all the binaries of the directory
+    void Clear ();
+
+    int GetNumberOfHits ();
+    int GetNumberOfMisses ();
+
+  protected:
+
+  private:
+    ProgramBinaryCache ();
+    ~ProgramBinaryCache ();
+
+    static ProgramBinaryCache* crr_instance;
+
+    std::string GetFilePath (std::string key);
+
+    std::string m_directory;
+    // Binary formats supported by the driver, and its GL_VENDOR, GL_RENDERER and GL_VERSION
+    bool m_driver_queried;
+    bool m_supported;
+    std::string m_driver;
+
+    int m_hits;
+    int m_misses;
+  };
+}
+
+#endif
@@ -3,6 +3,7 @@
 #include <cstdio>
 #include <iostream>
 #include <cerrno>
+#include <cstring>
 
 #include <gl_utils/utils.h>
 
@@ -178,6 +179,126 @@ namespace gl
     UniformBind_TEXTURE_GENERAL(unif_data, GL_TEXTURE_RECTANGLE);
   }
 
+  // Data of a handle uniform of the given type, allocated at the first Set
+  //   (or at a change of type) and written in place afterwards
+  static void* UniformReserveData (UniformVariable* v, GLSL_UNIFORM_VARIABLE_TYPES type)
+  {
+    if (v->type == type && v->data) return v->data;
+
+    v->DestroyData();
+    v->type = type;
+    v->v_count = -1;
+    switch (type)
+    {
+      case GLSL_UNIFORM_VARIABLE_TYPES::UNSIGNED_INT:
+        v->data = new GLuint();
+        v->bind_function = UniformBind_UNSIGNED_INT;
+        v->destroydata_function = UniformDestroyData_UNSIGNED_INT;
+        break;
+      case GLSL_UNIFORM_VARIABLE_TYPES::INT:
+        v->data = new GLint();
+        v->bind_function = UniformBind_INT;
+        v->destroydata_function = UniformDestroyData_INT;
+        break;
+      case GLSL_UNIFORM_VARIABLE_TYPES::FLOAT:
+        v->data = new GLfloat();
+        v->bind_function = UniformBind_FLOAT;
+        v->destroydata_function = UniformDestroyData_FLOAT;
+        break;
+      case GLSL_UNIFORM_VARIABLE_TYPES::FLOAT2:
+        v->data = new GLfloat[2];
+        v->bind_function = UniformBind_FLOAT2;
+        v->destroydata_function = UniformDestroyData_FLOAT_ARRAY;
+        break;
+      case GLSL_UNIFORM_VARIABLE_TYPES::FLOAT3:
+        v->data = new GLfloat[3];
+        v->bind_function = UniformBind_FLOAT3;
+        v->destroydata_function = UniformDestroyData_FLOAT_ARRAY;
+        break;
+      case GLSL_UNIFORM_VARIABLE_TYPES::FLOAT4:
+        v->data = new GLfloat[4];
+        v->bind_function = UniformBind_FLOAT4;
+        v->destroydata_function = UniformDestroyData_FLOAT_ARRAY;
+        break;
+      case GLSL_UNIFORM_VARIABLE_TYPES::FLOAT4X4:
+        v->data = new GLfloat[16];
+        v->bind_function = UniformBind_FLOAT4X4;
+        v->destroydata_function = UniformDestroyData_FLOAT_ARRAY;
+        break;
+      default:
+        v->type = GLSL_UNIFORM_VARIABLE_TYPES::NONE;
+        v->bind_function = nullptr;
+        v->destroydata_function = nullptr;
+        break;
+    }
+    return v->data;
+  }
+
+  UniformHandle::UniformHandle ()
+    : m_variable(nullptr)
+  {
+  }
+
+  UniformHandle::UniformHandle (UniformVariable* variable)
+    : m_variable(variable)
+  {
+  }
+
+  bool UniformHandle::IsValid ()
+  {
+    return m_variable != nullptr;
+  }
+
+  void UniformHandle::Set (unsigned int value)
+  {
+    if (!m_variable) return;
+    *(GLuint*)UniformReserveData(m_variable, GLSL_UNIFORM_VARIABLE_TYPES::UNSIGNED_INT) = (GLuint)value;
+    m_variable->Bind();
+  }
+
+  void UniformHandle::Set (int value)
+  {
+    if (!m_variable) return;
+    *(GLint*)UniformReserveData(m_variable, GLSL_UNIFORM_VARIABLE_TYPES::INT) = (GLint)value;
+    m_variable->Bind();
+  }
+
+  void UniformHandle::Set (float value)
+  {
+    if (!m_variable) return;
+    *(GLfloat*)UniformReserveData(m_variable, GLSL_UNIFORM_VARIABLE_TYPES::FLOAT) = (GLfloat)value;
+    m_variable->Bind();
+  }
+
+  void UniformHandle::Set (glm::vec2 value)
+  {
+    if (!m_variable) return;
+    memcpy(UniformReserveData(m_variable, GLSL_UNIFORM_VARIABLE_TYPES::FLOAT2), &value[0], 2 * sizeof(GLfloat));
+    m_variable->Bind();
+  }
+
+  void UniformHandle::Set (glm::vec3 value)
+  {
+    if (!m_variable) return;
+    memcpy(UniformReserveData(m_variable, GLSL_UNIFORM_VARIABLE_TYPES::FLOAT3), &value[0], 3 * sizeof(GLfloat));
+    m_variable->Bind();
+  }
+
+  void UniformHandle::Set (glm::vec4 value)
+  {
+    if (!m_variable) return;
+    memcpy(UniformReserveData(m_variable, GLSL_UNIFORM_VARIABLE_TYPES::FLOAT4), &value[0], 4 * sizeof(GLfloat));
+    m_variable->Bind();
+  }
+
+  void UniformHandle::Set (glm::mat4 value)
+  {
+    if (!m_variable) return;
+    // glm matrices are stored in column major order, as glUniformMatrix4fv expects
+    memcpy(UniformReserveData(m_variable, GLSL_UNIFORM_VARIABLE_TYPES::FLOAT4X4), &value[0][0], 16 * sizeof(GLfloat));
+    m_variable->Bind();
+  }
+
   UniformVariable::UniformVariable()
   {
     type     = GLSL_UNIFORM_VARIABLE_TYPES::NONE;
@@ -261,6 +382,19 @@ namespace gl
     return attrib_location;
   }
   
+  UniformHandle Shader::GetUniformHandle (std::string name)
+  {
+    std::map<std::string, UniformVariable>::iterator it = uniform_variables.find(name);
+    if (it == uniform_variables.end())
+    {
+      UniformVariable ul;
+      ul.location = glGetUniformLocation(shader_program, name.c_str());
+      it = uniform_variables.insert(std::pair<std::string, UniformVariable>(name, ul)).first;
+    }
+    // std::map nodes do not move, the pointer is valid until the uniform is erased
+    return UniformHandle(&it->second);
+  }
+
   void Shader::BindUniforms ()
   {
     for (std::map<std::string, UniformVariable>::iterator it = uniform_variables.begin(); it != uniform_variables.end(); ++it)
@@ -67,6 +67,33 @@ namespace gl
     UniformFunction destroydata_function;
   };
 
+  // Uniform of a shader resolved once (Shader::GetUniformHandle): Set stores the
+  //   value and calls glUniform* at the cached location, without any lookup by
+  //   name. As with BindUniform, the program must be bound. The location is
+  //   resolved again when the program is reloaded or switches variant, the
+  //   handle is valid until the uniform is cleared (ClearUniform(s)).
+  class UniformHandle
+  {
+  public:
+    UniformHandle ();
+
+    bool IsValid ();
+
+    void Set (unsigned int value);
+    void Set (int value);
+    void Set (float value);
+    void Set (glm::vec2 value);
+    void Set (glm::vec3 value);
+    void Set (glm::vec4 value);
+    void Set (glm::mat4 value);
+
+  private:
+    friend class Shader;
+    UniformHandle (UniformVariable* variable);
+
+    UniformVariable* m_variable;
+  };
+
   class Shader
   {
   public:
@@ -86,6 +113,9 @@ namespace gl
     GLint GetUniformLoc (char* name);
     GLint GetAttribLoc (char* name); 
   
+    // Handle of the uniform, created without a value if it was not set yet
+    UniformHandle GetUniformHandle (std::string name);
+
     void BindUniforms ();
     void ClearUniforms ();
     void BindUniform (std::string var_name);
@@ -0,0 +1,205 @@
+#include "slabuploader.h"
+#include "gpumemoryregistry.h"
+#include "tracer.h"
+
+#include <cstdio>
+#include <iostream>
+
+// Time waited by each glClientWaitSync call, in nanoseconds
+#define SLAB_UPLOADER_FENCE_TIMEOUT 1000000000
+
+namespace gl
+{
+  size_t SlabUploader::GetPixelByteSize (GLenum format, GLenum type)
+  {
+    size_t n_components = 0;
+    switch (format)
+    {
+    case GL_RED: case GL_RED_INTEGER:
+      n_components = 1; break;
+    case GL_RG: case GL_RG_INTEGER:
+      n_components = 2; break;
+    case GL_RGB: case GL_RGB_INTEGER:
+      n_components = 3; break;
+    case GL_RGBA: case GL_RGBA_INTEGER:
+      n_components = 4; break;
+    default:
+      return 0;
+    }
+
+    switch (type)
+    {
+    case GL_UNSIGNED_BYTE: case GL_BYTE:
+      return n_components;
+    case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT:
+      return n_components * 2;
+    case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT:
+      return n_components * 4;
+    default:
+      return 0;
+    }
+  }
+
+  SlabUploader::SlabUploader (Texture3D* texture, GLenum format, GLenum type)
+    : m_texture(texture)
+    , m_format(format)
+    , m_type(type)
+    , m_slab_depth(0)
+    , m_slab_bytes(0)
+    , m_persistent(false)
+    , m_host_slab(nullptr)
+  {
+    for (int i = 0; i < SLAB_UPLOADER_RING_SIZE; i++)
+    {
+      m_buffers[i] = 0;
+      m_mapped[i] = nullptr;
+      m_fences[i] = 0;
+    }
+
+    size_t slice_bytes = (size_t)texture->GetWidth() * texture->GetHeight() * GetPixelByteSize(format, type);
+    if (slice_bytes == 0)
+    {
+      std::cout << "Error: gl::SlabUploader: unsupported format/type" << std::endl;
+      return;
+    }
+
+    m_slab_depth = (int)(SLAB_UPLOADER_SLAB_BYTES / slice_bytes);
+    if (m_slab_depth < 1) m_slab_depth = 1;
+    if (m_slab_depth > (int)texture->GetDepth()) m_slab_depth = (int)texture->GetDepth();
+    m_slab_bytes = slice_bytes * m_slab_depth;
+
+    m_persistent = GLEW_ARB_buffer_storage != 0;
+    if (m_persistent)
+    {
+      GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+      glGenBuffers(SLAB_UPLOADER_RING_SIZE, m_buffers);
+      for (int i = 0; i < SLAB_UPLOADER_RING_SIZE; i++)
+      {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffers[i]);
+        glBufferStorage(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)m_slab_bytes, nullptr, flags);
+        m_mapped[i] = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)m_slab_bytes, flags);
+        if (!m_mapped[i]) m_persistent = false;
+      }
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+      if (m_persistent)
+      {
+        GPUMemoryRegistry::Instance()->Register(m_buffers, GPU_MEMORY_BUFFER, 0, m_slab_bytes * SLAB_UPLOADER_RING_SIZE);
+        GPUMemoryRegistry::Instance()->SetOwner(m_buffers, "upload staging");
+      }
+      else
+      {
+        printf("Warning: gl::SlabUploader: pixel buffers could not be mapped, uploading from a host slab\n");
+        for (int i = 0; i < SLAB_UPLOADER_RING_SIZE; i++)
+        {
+          if (m_mapped[i])
+          {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffers[i]);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            m_mapped[i] = nullptr;
+          }
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glDeleteBuffers(SLAB_UPLOADER_RING_SIZE, m_buffers);
+        for (int i = 0; i < SLAB_UPLOADER_RING_SIZE; i++)
+          m_buffers[i] = 0;
+      }
+    }
+
+    if (!m_persistent)
+      m_host_slab = new unsigned char[m_slab_bytes];
+  }
+
+  SlabUploader::~SlabUploader ()
+  {
+    if (m_persistent)
+    {
+      for (int i = 0; i < SLAB_UPLOADER_RING_SIZE; i++)
+      {
+        if (m_fences[i]) glDeleteSync(m_fences[i]);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffers[i]);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      }
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      glDeleteBuffers(SLAB_UPLOADER_RING_SIZE, m_buffers);
+      if (GPUMemoryRegistry::Exists()) GPUMemoryRegistry::Instance()->Unregister(m_buffers);
+    }
+
+    if (m_host_slab)
+      delete[] m_host_slab;
+  }
+
+  bool SlabUploader::Upload (SlabProducer producer, void* data)
+  {
+    TRACE_SCOPE("SlabUploader::Upload", "preprocess");
+    if (m_slab_depth == 0)
+      return false;
+
+    int depth = (int)m_texture->GetDepth();
+    int i_slab = 0;
+    for (int first_slice = 0; first_slice < depth; first_slice += m_slab_depth, i_slab++)
+    {
+      int n_slices = depth - first_slice < m_slab_depth ? depth - first_slice : m_slab_depth;
+
+      if (m_persistent)
+      {
+        int i_buffer = i_slab % SLAB_UPLOADER_RING_SIZE;
+        WaitFence(i_buffer);
+
+        producer(data, first_slice, n_slices, m_mapped[i_buffer]);
+
+        // The pointer is an offset in the bound pixel unpack buffer
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffers[i_buffer]);
+        if (!m_texture->SetSubData(first_slice, n_slices, (GLvoid*)0, m_format, m_type))
+        {
+          glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+          return false;
+        }
+        m_fences[i_buffer] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      }
+      else
+      {
+        producer(data, first_slice, n_slices, m_host_slab);
+        if (!m_texture->SetSubData(first_slice, n_slices, m_host_slab, m_format, m_type))
+          return false;
+      }
+    }
+
+    // The buffers can be unmapped (or reused) only after the last copies
+    for (int i = 0; i < SLAB_UPLOADER_RING_SIZE; i++)
+      WaitFence(i);
+
+    gl::ExitOnGLError("gl::SlabUploader: After Upload\n");
+    return true;
+  }
+
+  int SlabUploader::GetSlabDepth ()
+  {
+    return m_slab_depth;
+  }
+
+  size_t SlabUploader::GetStagingBytes ()
+  {
+    return m_persistent ? m_slab_bytes * SLAB_UPLOADER_RING_SIZE : m_slab_bytes;
+  }
+
+  bool SlabUploader::IsPersistentlyMapped ()
+  {
+    return m_persistent;
+  }
+
+  void SlabUploader::WaitFence (int i_buffer)
+  {
+    if (!m_fences[i_buffer]) return;
+
+    GLenum status = glClientWaitSync(m_fences[i_buffer], GL_SYNC_FLUSH_COMMANDS_BIT, SLAB_UPLOADER_FENCE_TIMEOUT);
+    while (status == GL_TIMEOUT_EXPIRED)
+      status = glClientWaitSync(m_fences[i_buffer], 0, SLAB_UPLOADER_FENCE_TIMEOUT);
+    if (status == GL_WAIT_FAILED)
+      std::cout << "Error: gl::SlabUploader: glClientWaitSync failed" << std::endl;
+
+    glDeleteSync(m_fences[i_buffer]);
+    m_fences[i_buffer] = 0;
+  }
+}
@@ -0,0 +1,79 @@
+/**
+ * Streamed upload of a 3D texture, z-slab by z-slab.
+ *
+ * The texture storage is allocated once (Texture3D::AllocateStorage, immutable)
+ *   and each slab is written by a producer callback straight into one of a
+ *   small ring of persistently mapped pixel unpack buffers, then copied to the
+ *   texture with glTexSubImage3D. The host never holds more than the ring
+ *   (SLAB_UPLOADER_RING_SIZE slabs of about SLAB_UPLOADER_SLAB_BYTES), instead
+ *   of a full volume staging array.
+ * . Producers split their slab between the OpenMP threads, while the gpu
+ *   copies the previous slabs: a buffer is written again only after the
+ *   fence of its last copy is signaled.
+ * . Without ARB_buffer_storage, slabs are produced in a host buffer and copied
+ *   by glTexSubImage3D from client memory.
+ *
+ * https://www.khronos.org/opengl/wiki/Buffer_Object#Persistent_mapping
+ * https://www.khronos.org/opengl/wiki/Pixel_Buffer_Object
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef GL_UTILS_SLAB_UPLOADER_H
+#define GL_UTILS_SLAB_UPLOADER_H
+
+#include <gl_utils/texture3d.h>
+
+#include <GL/glew.h>
+
+#include <cstddef>
+
+// Target size of each slab, rounded to whole slices (at least one)
+#define SLAB_UPLOADER_SLAB_BYTES (16 * 1024 * 1024)
+// Number of pixel buffers written and copied in turns
+#define SLAB_UPLOADER_RING_SIZE 3
+
+namespace gl
+{
+  // Writes the slices [first_slice, first_slice + n_slices) of the texture in
+  //   slab, tightly packed (width x height x n_slices pixels of the format/type
+  //   given to the uploader)
+  typedef void (*SlabProducer) (void* data, int first_slice, int n_slices, GLvoid* slab);
+
+  class SlabUploader
+  {
+  public:
+    // Bytes per pixel of tightly packed client data, 0 if not supported
+    static size_t GetPixelByteSize (GLenum format, GLenum type);
+
+    SlabUploader (Texture3D* texture, GLenum format, GLenum type);
+    ~SlabUploader ();
+
+    // Fills the whole texture, which must have its storage allocated
+    bool Upload (SlabProducer producer, void* data);
+
+    int GetSlabDepth ();
+    // Host memory of the ring (or of the host slab)
+    size_t GetStagingBytes ();
+    bool IsPersistentlyMapped ();
+
+  private:
+    void WaitFence (int i_buffer);
+
+    Texture3D* m_texture;
+    GLenum m_format;
+    GLenum m_type;
+
+    int m_slab_depth;
+    size_t m_slab_bytes;
+
+    bool m_persistent;
+    GLuint m_buffers[SLAB_UPLOADER_RING_SIZE];
+    GLvoid* m_mapped[SLAB_UPLOADER_RING_SIZE];
+    GLsync m_fences[SLAB_UPLOADER_RING_SIZE];
+
+    unsigned char* m_host_slab;
+  };
+}
+
+#endif
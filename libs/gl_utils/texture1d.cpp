@@ -1,4 +1,5 @@
 #include "texture1d.h"
+#include "gpumemoryregistry.h"
 #include <GL/glew.h>
 #include <cassert>
 
@@ -14,6 +15,7 @@ namespace gl
   Texture1D::~Texture1D ()
   {
     glDeleteTextures(1, &m_textureID);
+    if (GPUMemoryRegistry::Exists()) GPUMemoryRegistry::Instance()->Unregister(this);
   }
 
   void Texture1D::GenerateTexture (GLint min_filter_param, GLint max_filter_param, GLint wrap_s_param)
@@ -37,6 +39,8 @@ namespace gl
 
     // Set Data
     glTexImage1D(GL_TEXTURE_1D, 0, internalformat, m_length, 0, format, type, data);
+    GPUMemoryRegistry::Instance()->Register(this, GPU_MEMORY_TEXTURE_1D, internalformat,
+      (size_t)m_length * GPUMemoryRegistry::GetTexelByteSize(internalformat));
     #if _DEBUG
       printf("texture1d.cpp: Texture generated with id %d!\n", m_textureID);
     #endif
@@ -63,6 +67,7 @@ namespace gl
   {
     GLint temp_texture = m_textureID;
     glDeleteTextures(1, &m_textureID);
+    if (GPUMemoryRegistry::Exists()) GPUMemoryRegistry::Instance()->Unregister(this);
     #if _DEBUG
     printf("lqc: Texture1D with id %d destroyed!\n", temp_texture);
     #endif
@@ -1,5 +1,8 @@
 #include "texture2d.h"
+#include "gpumemoryregistry.h"
+#include "halffloat.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <GL/glew.h>
@@ -17,6 +20,7 @@ namespace gl
   Texture2D::~Texture2D ()
   {
     glDeleteTextures(1, &m_textureID);
+    if (GPUMemoryRegistry::Exists()) GPUMemoryRegistry::Instance()->Unregister(this);
   }
 
   void Texture2D::GenerateTexture (GLint min_filter_param, GLint max_filter_param, GLint wrap_s_param, GLint wrap_t_param)
@@ -39,9 +43,18 @@ namespace gl
     // Bind texture
     glBindTexture(GL_TEXTURE_2D, m_textureID);
 
+    // Client data is tightly packed: rows of 8 or 16 bit texels
+    //   (GL_HALF_FLOAT included) are not always 4 byte aligned
+    GLint unpack_alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack_alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
     // Set Data
     // For bigger textures: GL_PROXY_TEXTURE_2D
     glTexImage2D(GL_TEXTURE_2D, 0, internalformat, m_width, m_height, 0, format, type, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment);
+    GPUMemoryRegistry::Instance()->Register(this, GPU_MEMORY_TEXTURE_2D, internalformat,
+      (size_t)m_width * m_height * GPUMemoryRegistry::GetTexelByteSize(internalformat));
     #if _DEBUG
         printf("texture2d.cpp: Texture generated with id %d!\n", m_textureID);
     #endif
@@ -54,6 +67,46 @@ namespace gl
     return true;
   }
 
+  bool Texture2D::SetData (const GLhalf* data, GLint internalformat, GLenum format)
+  {
+    return SetData((GLvoid*)data, internalformat, format, GL_HALF_FLOAT);
+  }
+
+  bool Texture2D::SetHalfFloatData (const GLfloat* data, GLint internalformat, GLenum format)
+  {
+    if (!SetData((const GLhalf*)NULL, internalformat, format))
+      return false;
+    if (data == NULL || m_width == 0 || m_height == 0)
+      return true;
+
+    int n_components = 1;
+    if (format == GL_RG) n_components = 2;
+    else if (format == GL_RGB) n_components = 3;
+    else if (format == GL_RGBA) n_components = 4;
+
+    // Converted and uploaded a block of rows at a time
+    size_t row_values = (size_t)m_width * n_components;
+    unsigned int block_rows = (unsigned int)std::max((size_t)1, HALF_FLOAT_STAGING_SIZE / row_values);
+    block_rows = std::min(block_rows, m_height);
+    GLhalf* half_data = new GLhalf[block_rows * row_values];
+
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    GLint unpack_alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack_alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (unsigned int y = 0; y < m_height; y += block_rows)
+    {
+      unsigned int n_rows = std::min(block_rows, m_height - y);
+      gl::FloatToHalf(data + y * row_values, half_data, n_rows * row_values);
+      glTexSubImage2D(GL_TEXTURE_2D, 0, 0, y, m_width, n_rows, format, GL_HALF_FLOAT, half_data);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    delete[] half_data;
+    return true;
+  }
+
   GLuint Texture2D::GetTextureID ()
   {
     return m_textureID;
@@ -74,6 +127,7 @@ namespace gl
   {
     GLint temp_texture = m_textureID;
     glDeleteTextures(1, &m_textureID);
+    if (GPUMemoryRegistry::Exists()) GPUMemoryRegistry::Instance()->Unregister(this);
     printf("lqc: Texture2D with id %d destroyed!\n", temp_texture);
     m_textureID = -1;
   }
@@ -15,6 +15,12 @@ namespace gl
     , GLint wrap_s_param, GLint wrap_t_param);
 
     bool SetData(GLvoid* data, GLint internalformat, GLenum format, GLenum type);
+    // Half float data, uploaded as GL_HALF_FLOAT (internalformat: GL_R16F...)
+    bool SetData (const GLhalf* data, GLint internalformat, GLenum format);
+    // Converts float data to half floats, HALF_FLOAT_STAGING_SIZE values at a
+    //   time, and uploads them as GL_HALF_FLOAT. Producers that can write
+    //   half floats directly should use SetData(const GLhalf*...) instead.
+    bool SetHalfFloatData (const GLfloat* data, GLint internalformat, GLenum format);
     
     GLuint GetTextureID ();
 
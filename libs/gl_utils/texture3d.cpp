@@ -1,5 +1,9 @@
 #include "texture3d.h"
+#include "gpumemoryregistry.h"
+#include "halffloat.h"
+#include <algorithm>
 #include <cassert>
+#include <iostream>
 
 #include <GL/glew.h>
 
@@ -24,6 +28,7 @@ namespace gl
     glGetIntegerv (GL_MAX_3D_TEXTURE_SIZE, &maxtex3d);
     assert (m_width <= maxtex3d || m_height <= maxtex3d || m_depth <= maxtex3d);
     m_textureID = -1;
+    m_immutable = false;
   }
 
   Texture3D::Texture3D (glm::ivec3 size)
@@ -36,6 +41,7 @@ namespace gl
     glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &maxtex3d);
     assert(m_width <= maxtex3d || m_height <= maxtex3d || m_depth <= maxtex3d);
     m_textureID = -1;
+    m_immutable = false;
   }
 
   Texture3D::~Texture3D ()
@@ -50,6 +56,7 @@ namespace gl
       DestroyTexture();
     glGenTextures(1, &m_textureID);
     glBindTexture(GL_TEXTURE_3D, m_textureID);
+    m_immutable = false;
 
     if (generatemipmap)
     {
@@ -72,14 +79,28 @@ namespace gl
   {
     if (m_textureID == -1)
       return false;
+    if (m_immutable)
+    {
+      std::cout << "Error: gl::Texture3D: SetData on a texture with immutable storage" << std::endl;
+      return false;
+    }
 
     gl::ExitOnGLError("gl::Texture3D: Before Texture3D SetData\n");
 
     // Bind texture
     glBindTexture(GL_TEXTURE_3D, m_textureID);
 
+    // Client data is tightly packed: rows of 8 or 16 bit texels
+    //   (GL_HALF_FLOAT included) are not always 4 byte aligned
+    GLint unpack_alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack_alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
     // Set Data
     glTexImage3D(GL_TEXTURE_3D, 0, internalformat, m_width, m_height, m_depth, 0, format, type, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment);
+    GPUMemoryRegistry::Instance()->Register(this, GPU_MEMORY_TEXTURE_3D, internalformat,
+      (size_t)m_width * m_height * m_depth * GPUMemoryRegistry::GetTexelByteSize(internalformat));
     #if _DEBUG
       printf("gl::Texture3D: Texture generated with id %d!\n", m_textureID);
     #endif
@@ -93,6 +114,77 @@ namespace gl
     return true;
   }
 
+  bool Texture3D::SetData (const GLhalf* data, GLint internalformat, GLenum format)
+  {
+    return SetData((GLvoid*)data, internalformat, format, GL_HALF_FLOAT);
+  }
+
+  bool Texture3D::SetHalfFloatData (const GLfloat* data, GLint internalformat, GLenum format)
+  {
+    if (!SetData((const GLhalf*)NULL, internalformat, format))
+      return false;
+    if (data == NULL || m_width == 0 || m_height == 0 || m_depth == 0)
+      return true;
+
+    int n_components = 1;
+    if (format == GL_RG) n_components = 2;
+    else if (format == GL_RGB) n_components = 3;
+    else if (format == GL_RGBA) n_components = 4;
+
+    // Converted and uploaded a block of slices at a time (at least one slice)
+    size_t slice_values = (size_t)m_width * m_height * n_components;
+    unsigned int block_slices = (unsigned int)std::max((size_t)1, HALF_FLOAT_STAGING_SIZE / slice_values);
+    block_slices = std::min(block_slices, m_depth);
+    GLhalf* half_data = new GLhalf[block_slices * slice_values];
+
+    for (unsigned int z = 0; z < m_depth; z += block_slices)
+    {
+      unsigned int n_slices = std::min(block_slices, m_depth - z);
+      gl::FloatToHalf(data + z * slice_values, half_data, n_slices * slice_values);
+      SetSubData(z, n_slices, half_data, format, GL_HALF_FLOAT);
+    }
+
+    delete[] half_data;
+    return true;
+  }
+
+  bool Texture3D::AllocateStorage (GLint internalformat)
+  {
+    if (m_textureID == -1)
+      return false;
+
+    gl::ExitOnGLError("gl::Texture3D: Before Texture3D AllocateStorage\n");
+
+    glBindTexture(GL_TEXTURE_3D, m_textureID);
+    glTexStorage3D(GL_TEXTURE_3D, 1, internalformat, m_width, m_height, m_depth);
+    GPUMemoryRegistry::Instance()->Register(this, GPU_MEMORY_TEXTURE_3D, internalformat,
+      (size_t)m_width * m_height * m_depth * GPUMemoryRegistry::GetTexelByteSize(internalformat));
+    glBindTexture(GL_TEXTURE_3D, 0);
+    m_immutable = true;
+
+    gl::ExitOnGLError("gl::Texture3D: After Texture3D AllocateStorage\n");
+    return true;
+  }
+
+  bool Texture3D::SetSubData (int first_slice, int n_slices, const GLvoid* data, GLenum format, GLenum type)
+  {
+    if (m_textureID == -1 || first_slice < 0 || first_slice + n_slices > (int)m_depth)
+      return false;
+
+    GLint unpack_alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &unpack_alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glBindTexture(GL_TEXTURE_3D, m_textureID);
+    glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, first_slice, m_width, m_height, n_slices, format, type, data);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, unpack_alignment);
+
+    gl::ExitOnGLError("gl::Texture3D: After Texture3D SetSubData\n");
+    return true;
+  }
+
   GLuint Texture3D::GetTextureID ()
   {
     return m_textureID;
@@ -117,6 +209,7 @@ namespace gl
   {
     GLint temp_texture = m_textureID;
     glDeleteTextures(1, &m_textureID);
+    if (GPUMemoryRegistry::Exists()) GPUMemoryRegistry::Instance()->Unregister(this);
 #if _DEBUG
     printf("gl::Texture3D: Texture id %d destroyed!\n", temp_texture);
 #endif
@@ -18,6 +18,21 @@ namespace gl
     , GLint wrap_s_param, GLint wrap_t_param, GLint wrap_r_param, bool generatemipmap = false);
 
     bool SetData (GLvoid* data, GLint internalformat, GLenum format, GLenum type);
+    // Half float data, uploaded as GL_HALF_FLOAT
+    //   (internalformat: GL_R16F, GL_RG16F, GL_RGB16F or GL_RGBA16F)
+    bool SetData (const GLhalf* data, GLint internalformat, GLenum format);
+    // Converts float data to half floats, HALF_FLOAT_STAGING_SIZE values at a
+    //   time, and uploads them as GL_HALF_FLOAT. Producers that can write
+    //   half floats directly should use SetData(const GLhalf*...) instead.
+    bool SetHalfFloatData (const GLfloat* data, GLint internalformat, GLenum format);
+
+    // Immutable storage (glTexStorage3D) of a single level, filled afterwards
+    //   by SetSubData (e.g. through a gl::SlabUploader). SetData can't be used
+    //   with it until GenerateTexture is called again.
+    bool AllocateStorage (GLint internalformat);
+    // Writes the slices [first_slice, first_slice + n_slices), tightly packed.
+    //   With a pixel unpack buffer bound, data is an offset in the buffer.
+    bool SetSubData (int first_slice, int n_slices, const GLvoid* data, GLenum format, GLenum type);
 
     GLuint GetTextureID ();
 
@@ -33,6 +48,7 @@ namespace gl
     unsigned int m_height;
     unsigned int m_depth;
     GLuint m_textureID;
+    bool m_immutable;
   };
 }
 
@@ -0,0 +1,183 @@
+#include "tracer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace gl
+{
+  namespace
+  {
+    class TraceEvent
+    {
+    public:
+      const char* name;
+      const char* category;
+      // 'X' complete event, 'i' instant event
+      char phase;
+      long long ts_begin;
+      long long ts_end;
+      std::string detail;
+    };
+
+    // Only the owner thread adds events, the mutex guards against Start/Stop
+    class ThreadBuffer
+    {
+    public:
+      int tid;
+      std::string name;
+      std::mutex lock;
+      std::vector<TraceEvent> events;
+    };
+
+    std::mutex s_buffers_lock;
+    // Buffers are never deleted: thread_local pointers to them remain valid across traces
+    std::vector<ThreadBuffer*> s_buffers;
+    std::string s_filepath;
+    std::chrono::steady_clock::time_point s_start_time;
+
+    thread_local ThreadBuffer* t_buffer = nullptr;
+
+    ThreadBuffer* GetThreadBuffer ()
+    {
+      if (!t_buffer)
+      {
+        std::lock_guard<std::mutex> guard(s_buffers_lock);
+        t_buffer = new ThreadBuffer();
+        t_buffer->tid = (int)s_buffers.size() + 1;
+        t_buffer->name = "Thread " + std::to_string(t_buffer->tid);
+        s_buffers.push_back(t_buffer);
+      }
+      return t_buffer;
+    }
+
+    std::string EscapeJson (const std::string& str)
+    {
+      std::string escaped = "";
+      for (int i = 0; i < str.size(); i++)
+      {
+        char c = str[i];
+        if (c == '"' || c == '\\') { escaped.push_back('\\'); escaped.push_back(c); }
+        else if (c == '\n') escaped.append("\\n");
+        else if ((unsigned char)c < 0x20) escaped.push_back(' ');
+        else escaped.push_back(c);
+      }
+      return escaped;
+    }
+  }
+
+  std::atomic<bool> Tracer::s_enabled(false);
+
+  void Tracer::Start (std::string filepath)
+  {
+    if (IsEnabled()) Stop();
+
+    std::lock_guard<std::mutex> guard(s_buffers_lock);
+    for (int i = 0; i < s_buffers.size(); i++)
+    {
+      std::lock_guard<std::mutex> buffer_guard(s_buffers[i]->lock);
+      s_buffers[i]->events.clear();
+    }
+    s_filepath = filepath;
+    s_start_time = std::chrono::steady_clock::now();
+    s_enabled.store(true);
+
+    printf("Started  -> Tracing to %s\n", s_filepath.c_str());
+  }
+
+  bool Tracer::Stop ()
+  {
+    if (!IsEnabled()) return true;
+    s_enabled.store(false);
+
+    std::ofstream f_trace(s_filepath, std::ios_base::out);
+    if (!f_trace.is_open())
+    {
+      std::cout << "Error: Unable to write trace file " << s_filepath << "." << std::endl;
+      return false;
+    }
+
+    std::lock_guard<std::mutex> guard(s_buffers_lock);
+    f_trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    f_trace << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"cppvolrend\"}}";
+    int n_events = 0;
+    for (int i = 0; i < s_buffers.size(); i++)
+    {
+      ThreadBuffer* buffer = s_buffers[i];
+      std::lock_guard<std::mutex> buffer_guard(buffer->lock);
+      if (buffer->events.empty()) continue;
+
+      f_trace << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+              << ",\"args\":{\"name\":\"" << EscapeJson(buffer->name) << "\"}}";
+      for (int e = 0; e < buffer->events.size(); e++)
+      {
+        TraceEvent& ev = buffer->events[e];
+        f_trace << ",\n{\"name\":\"" << EscapeJson(ev.name) << "\",\"cat\":\"" << EscapeJson(ev.category)
+                << "\",\"ph\":\"" << ev.phase << "\",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":" << ev.ts_begin;
+        if (ev.phase == 'X')
+          f_trace << ",\"dur\":" << (ev.ts_end - ev.ts_begin);
+        else
+          f_trace << ",\"s\":\"p\"";
+        if (!ev.detail.empty())
+          f_trace << ",\"args\":{\"detail\":\"" << EscapeJson(ev.detail) << "\"}";
+        f_trace << "}";
+      }
+      n_events += (int)buffer->events.size();
+      buffer->events.clear();
+    }
+    f_trace << "\n]}\n";
+    f_trace.close();
+
+    printf("Finished -> Tracing, %d events written to %s\n", n_events, s_filepath.c_str());
+    return true;
+  }
+
+  void Tracer::SetThreadName (std::string name)
+  {
+    ThreadBuffer* buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> guard(buffer->lock);
+    buffer->name = name;
+  }
+
+  void Tracer::AddInstantEvent (const char* name, const char* category)
+  {
+    if (!IsEnabled()) return;
+
+    TraceEvent ev;
+    ev.name = name;
+    ev.category = category;
+    ev.phase = 'i';
+    ev.ts_begin = ev.ts_end = GetTimestamp();
+
+    ThreadBuffer* buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> guard(buffer->lock);
+    buffer->events.push_back(ev);
+  }
+
+  long long Tracer::GetTimestamp ()
+  {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_start_time).count();
+  }
+
+  void Tracer::AddCompleteEvent (const char* name, const char* category, long long ts_begin, long long ts_end,
+                                 const std::string* detail)
+  {
+    // The trace may have been stopped while the scope was open
+    if (!IsEnabled()) return;
+
+    TraceEvent ev;
+    ev.name = name;
+    ev.category = category;
+    ev.phase = 'X';
+    ev.ts_begin = ts_begin;
+    ev.ts_end = ts_end;
+    if (detail) ev.detail = *detail;
+
+    ThreadBuffer* buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> guard(buffer->lock);
+    buffer->events.push_back(ev);
+  }
+}
@@ -0,0 +1,104 @@
+/**
+ * Scoped cpu tracing, written as a Chrome trace (JSON) file.
+ *
+ * TRACE_SCOPE records the time spent until the end of the current block, in
+ *   the thread that runs it (OpenMP workers included). Events are kept in
+ *   per-thread buffers and written by Stop(); the file can be opened in
+ *   https://ui.perfetto.dev or chrome://tracing.
+ *
+ * Tracing is always compiled in: while it is not started, a scope only reads
+ *   an atomic flag. Names and categories must be string literals (only the
+ *   pointer is stored), the optional detail is copied only while tracing.
+ *
+ * https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef GL_UTILS_TRACER_H
+#define GL_UTILS_TRACER_H
+
+#include <atomic>
+#include <string>
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+// Trace the current block
+#define TRACE_SCOPE(name, category) gl::TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name, category)
+// Trace the current block, with a detail string (e.g. a file name) shown in the event arguments
+#define TRACE_SCOPE_DETAIL(name, category, detail) gl::TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name, category, detail)
+
+namespace gl
+{
+  class Tracer
+  {
+  public:
+    // Starts a new trace, written to filepath by Stop
+    static void Start (std::string filepath);
+    // Returns false if the trace file could not be written
+    static bool Stop ();
+
+    static bool IsEnabled ()
+    {
+      return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    // Name of the calling thread in the trace viewer
+    static void SetThreadName (std::string name);
+
+    // Marker without duration (e.g. "FirstFrame")
+    static void AddInstantEvent (const char* name, const char* category);
+
+    // Microseconds since Start
+    static long long GetTimestamp ();
+    static void AddCompleteEvent (const char* name, const char* category, long long ts_begin, long long ts_end,
+                                  const std::string* detail);
+
+  protected:
+    static std::atomic<bool> s_enabled;
+
+  private:
+    Tracer ();
+  };
+
+  class TraceScope
+  {
+  public:
+    TraceScope (const char* name, const char* category)
+      : m_name(nullptr)
+    {
+      if (Tracer::IsEnabled())
+      {
+        m_name = name;
+        m_category = category;
+        m_begin = Tracer::GetTimestamp();
+      }
+    }
+
+    TraceScope (const char* name, const char* category, const std::string& detail)
+      : m_name(nullptr)
+    {
+      if (Tracer::IsEnabled())
+      {
+        m_name = name;
+        m_category = category;
+        m_detail = detail;
+        m_begin = Tracer::GetTimestamp();
+      }
+    }
+
+    ~TraceScope ()
+    {
+      if (m_name)
+        Tracer::AddCompleteEvent(m_name, m_category, m_begin, Tracer::GetTimestamp(), m_detail.empty() ? nullptr : &m_detail);
+    }
+
+  private:
+    const char* m_name;
+    const char* m_category;
+    std::string m_detail;
+    long long m_begin;
+  };
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "uniformbuffer.h"
+#include "utils.h"
+#include "gpumemoryregistry.h"
+
+#include <cstring>
+
+namespace gl
+{
+  void UniformBuffer::Unbind (GLuint binding)
+  {
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, 0);
+  }
+
+  UniformBuffer::UniformBuffer (GLsizeiptr bytesize, GLuint binding)
+    : m_id(0), m_binding(binding), m_bytesize(bytesize)
+  {
+    glGenBuffers(1, &m_id);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_id);
+    glBufferData(GL_UNIFORM_BUFFER, m_bytesize, NULL, GL_DYNAMIC_DRAW);
+    GPUMemoryRegistry::Instance()->Register(this, GPU_MEMORY_BUFFER, 0, (size_t)m_bytesize);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    gl::ExitOnGLError("ERROR: Could not generate the Uniform Buffer Object");
+  }
+
+  UniformBuffer::~UniformBuffer ()
+  {
+    glDeleteBuffers(1, &m_id);
+    if (GPUMemoryRegistry::Exists()) GPUMemoryRegistry::Instance()->Unregister(this);
+    gl::ExitOnGLError("ERROR: Could not destroy the Uniform Buffer Object");
+  }
+
+  bool UniformBuffer::SetData (const void* data)
+  {
+    if (m_last_data.size() == (size_t)m_bytesize && memcmp(m_last_data.data(), data, m_bytesize) == 0)
+      return false;
+
+    m_last_data.assign((const unsigned char*)data, (const unsigned char*)data + m_bytesize);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_id);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, m_bytesize, data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    // Uploaded every frame: a glGetError here would sync with the driver
+    #ifdef _DEBUG
+      gl::ExitOnGLError("ERROR: Could not set Uniform Buffer Object data");
+    #endif
+    return true;
+  }
+
+  void UniformBuffer::Bind ()
+  {
+    glBindBufferBase(GL_UNIFORM_BUFFER, m_binding, m_id);
+  }
+
+  GLuint UniformBuffer::GetID ()
+  {
+    return m_id;
+  }
+
+  GLuint UniformBuffer::GetBinding ()
+  {
+    return m_binding;
+  }
+
+  GLsizeiptr UniformBuffer::GetSize ()
+  {
+    return m_bytesize;
+  }
+}
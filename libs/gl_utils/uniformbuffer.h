@@ -0,0 +1,54 @@
+/**
+ * OpenGL Uniform Buffer Object
+ *
+ * A std140 uniform block filled from a C++ struct with the same layout, and
+ *   bound to a fixed binding point (layout (std140, binding = N) in glsl), so
+ *   every program that declares the block reads the same buffer without any
+ *   glGetUniformLocation or glUniform* call.
+ *
+ * SetData keeps a copy of the last data written: an unchanged block costs no
+ *   gl call, a changed one costs a single glBufferSubData.
+ *
+ * https://www.khronos.org/opengl/wiki/Uniform_Buffer_Object
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef GL_UTILS_UNIFORM_BUFFER_H
+#define GL_UTILS_UNIFORM_BUFFER_H
+
+#include <GL/glew.h>
+
+#include <vector>
+
+namespace gl
+{
+  class UniformBuffer
+  {
+  public:
+    static void Unbind (GLuint binding);
+
+    UniformBuffer (GLsizeiptr bytesize, GLuint binding);
+    ~UniformBuffer ();
+
+    // Writes bytesize bytes of data if they differ from the last ones written.
+    //   Returns true if the buffer was written.
+    bool SetData (const void* data);
+
+    // Binds the buffer to its binding point (glBindBufferBase)
+    void Bind ();
+
+    GLuint GetID ();
+    GLuint GetBinding ();
+    GLsizeiptr GetSize ();
+
+  private:
+    GLuint m_id;
+    GLuint m_binding;
+    GLsizeiptr m_bytesize;
+
+    std::vector<unsigned char> m_last_data;
+  };
+}
+
+#endif
@@ -0,0 +1,195 @@
+#include "contenthash.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace vis
+{
+  static const unsigned long long HASH_PRIME_1 = 11400714785074694791ULL;
+  static const unsigned long long HASH_PRIME_2 = 14029467366897019727ULL;
+  static const unsigned long long HASH_PRIME_3 =  1609587929392839161ULL;
+  static const unsigned long long HASH_PRIME_4 =  9650029242287828579ULL;
+  static const unsigned long long HASH_PRIME_5 =  2870177450012600261ULL;
+
+  static inline unsigned long long RotL64 (unsigned long long x, int r)
+  {
+    return (x << r) | (x >> (64 - r));
+  }
+
+  static inline unsigned long long Read64 (const unsigned char* p)
+  {
+    unsigned long long v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  static inline unsigned int Read32 (const unsigned char* p)
+  {
+    unsigned int v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  static inline unsigned long long Round (unsigned long long acc, unsigned long long input)
+  {
+    acc += input * HASH_PRIME_2;
+    acc = RotL64(acc, 31);
+    return acc * HASH_PRIME_1;
+  }
+
+  static inline unsigned long long MergeRound (unsigned long long acc, unsigned long long val)
+  {
+    acc ^= Round(0, val);
+    return acc * HASH_PRIME_1 + HASH_PRIME_4;
+  }
+
+  // Consume the remaining (< 32) bytes and avalanche
+  static unsigned long long Finalize (unsigned long long h, const unsigned char* p, size_t len)
+  {
+    while (len >= 8)
+    {
+      h ^= Round(0, Read64(p));
+      h = RotL64(h, 27) * HASH_PRIME_1 + HASH_PRIME_4;
+      p += 8; len -= 8;
+    }
+    if (len >= 4)
+    {
+      h ^= (unsigned long long)Read32(p) * HASH_PRIME_1;
+      h = RotL64(h, 23) * HASH_PRIME_2 + HASH_PRIME_3;
+      p += 4; len -= 4;
+    }
+    while (len > 0)
+    {
+      h ^= (unsigned long long)(*p) * HASH_PRIME_5;
+      h = RotL64(h, 11) * HASH_PRIME_1;
+      p++; len--;
+    }
+
+    h ^= h >> 33;
+    h *= HASH_PRIME_2;
+    h ^= h >> 29;
+    h *= HASH_PRIME_3;
+    h ^= h >> 32;
+    return h;
+  }
+
+  std::string ContentHash128::ToString () const
+  {
+    char str[33];
+    snprintf(str, sizeof(str), "%016llx%016llx", high, low);
+    return std::string(str);
+  }
+
+  ContentHash128 ContentHash128::FromString (std::string str)
+  {
+    if (str.size() != 32)
+      return ContentHash128();
+    return ContentHash128(strtoull(str.substr(16, 16).c_str(), NULL, 16),
+                          strtoull(str.substr(0, 16).c_str(), NULL, 16));
+  }
+
+  ContentHash128 HashBytes128 (const void* data, size_t bytesize, unsigned long long seed)
+  {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    size_t len = bytesize;
+
+    unsigned long long h_low, h_high;
+    if (len >= 32)
+    {
+      // Four independent lanes, so consecutive rounds do not depend on each other
+      unsigned long long v1 = seed + HASH_PRIME_1 + HASH_PRIME_2;
+      unsigned long long v2 = seed + HASH_PRIME_2;
+      unsigned long long v3 = seed;
+      unsigned long long v4 = seed - HASH_PRIME_1;
+      do
+      {
+        v1 = Round(v1, Read64(p));
+        v2 = Round(v2, Read64(p + 8));
+        v3 = Round(v3, Read64(p + 16));
+        v4 = Round(v4, Read64(p + 24));
+        p += 32; len -= 32;
+      } while (len >= 32);
+
+      h_low = RotL64(v1, 1) + RotL64(v2, 7) + RotL64(v3, 12) + RotL64(v4, 18);
+      h_low = MergeRound(h_low, v1);
+      h_low = MergeRound(h_low, v2);
+      h_low = MergeRound(h_low, v3);
+      h_low = MergeRound(h_low, v4);
+
+      // Second word from the same lanes, merged in another order
+      h_high = RotL64(v3, 1) + RotL64(v4, 7) + RotL64(v1, 12) + RotL64(v2, 18);
+      h_high = MergeRound(h_high, v3);
+      h_high = MergeRound(h_high, v4);
+      h_high = MergeRound(h_high, v1);
+      h_high = MergeRound(h_high, v2);
+    }
+    else
+    {
+      h_low = seed + HASH_PRIME_5;
+      h_high = seed + HASH_PRIME_3;
+    }
+
+    h_low += (unsigned long long)bytesize;
+    h_high += (unsigned long long)bytesize ^ HASH_PRIME_4;
+
+    return ContentHash128(Finalize(h_low, p, len), Finalize(h_high, p, len));
+  }
+
+  unsigned long long HashBytes64 (const void* data, size_t bytesize, unsigned long long seed)
+  {
+    return HashBytes128(data, bytesize, seed).low;
+  }
+
+  ContentHash128 ComputeContentHash (const void* data, size_t bytesize, size_t chunk_bytes)
+  {
+    if (chunk_bytes == 0 || bytesize <= chunk_bytes)
+      return HashBytes128(data, bytesize);
+
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    long long n_chunks = (long long)((bytesize + chunk_bytes - 1) / chunk_bytes);
+    std::vector<ContentHash128> chunk_hashes(n_chunks);
+
+#pragma omp parallel for schedule(static)
+    for (long long c = 0; c < n_chunks; c++)
+    {
+      size_t offset = (size_t)c * chunk_bytes;
+      size_t len = bytesize - offset < chunk_bytes ? bytesize - offset : chunk_bytes;
+      chunk_hashes[c] = HashBytes128(p + offset, len);
+    }
+
+    return CombineHashes(chunk_hashes.data(), chunk_hashes.size(), (unsigned long long)bytesize);
+  }
+
+  std::vector<unsigned long long> ComputeChunkHashes (const void* data, size_t bytesize, size_t chunk_bytes)
+  {
+    std::vector<unsigned long long> chunk_hashes;
+    if (chunk_bytes == 0)
+      return chunk_hashes;
+
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    long long n_chunks = (long long)((bytesize + chunk_bytes - 1) / chunk_bytes);
+    chunk_hashes.resize(n_chunks);
+
+#pragma omp parallel for schedule(static)
+    for (long long c = 0; c < n_chunks; c++)
+    {
+      size_t offset = (size_t)c * chunk_bytes;
+      size_t len = bytesize - offset < chunk_bytes ? bytesize - offset : chunk_bytes;
+      chunk_hashes[c] = HashBytes64(p + offset, len);
+    }
+
+    return chunk_hashes;
+  }
+
+  ContentHash128 CombineHashes (const ContentHash128* hashes, size_t n_hashes, unsigned long long seed)
+  {
+    std::vector<unsigned long long> words(n_hashes * 2);
+    for (size_t i = 0; i < n_hashes; i++)
+    {
+      words[i * 2 + 0] = hashes[i].low;
+      words[i * 2 + 1] = hashes[i].high;
+    }
+    return HashBytes128(words.data(), words.size() * sizeof(unsigned long long), seed);
+  }
+}
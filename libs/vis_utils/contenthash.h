@@ -0,0 +1,69 @@
+/**
+ * Fast non-cryptographic content hash of raw memory buffers.
+ *
+ * The buffer is split into fixed size chunks that are hashed in parallel
+ *   (OpenMP). Each chunk is processed by four independent 64-bit lanes
+ *   (same rounds as XXH64) and finalized into a 128-bit value. The chunk
+ *   hashes are then combined in order, so the result only depends on the
+ *   content and the chunk size, never on the number of threads.
+ *
+ * Not suited for security purposes: it is an identity for caches of
+ *   derived data (gradients, SATs, supervoxels...) and for change
+ *   detection.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef VIS_UTILS_CONTENT_HASH_H
+#define VIS_UTILS_CONTENT_HASH_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// 1 MiB per chunk: large enough to amortize the thread scheduling
+#define CONTENT_HASH_CHUNK_BYTES (1 << 20)
+
+namespace vis
+{
+  class ContentHash128
+  {
+  public:
+    ContentHash128 ()
+      : low(0), high(0)
+    {}
+    ContentHash128 (unsigned long long _low, unsigned long long _high)
+      : low(_low), high(_high)
+    {}
+
+    bool operator== (const ContentHash128& o) const { return low == o.low && high == o.high; }
+    bool operator!= (const ContentHash128& o) const { return !(*this == o); }
+    bool operator<  (const ContentHash128& o) const { return high < o.high || (high == o.high && low < o.low); }
+
+    bool IsNull () const { return low == 0 && high == 0; }
+
+    // 32 hexadecimal digits, high word first
+    std::string ToString () const;
+    static ContentHash128 FromString (std::string str);
+
+    unsigned long long low, high;
+  };
+
+  // Serial hash of a small buffer (keys, strings, parameters)
+  ContentHash128 HashBytes128 (const void* data, size_t bytesize, unsigned long long seed = 0);
+  unsigned long long HashBytes64 (const void* data, size_t bytesize, unsigned long long seed = 0);
+
+  // Parallel hash of a large buffer
+  ContentHash128 ComputeContentHash (const void* data, size_t bytesize,
+                                     size_t chunk_bytes = CONTENT_HASH_CHUNK_BYTES);
+
+  // One 64-bit hash per chunk of chunk_bytes (the last chunk may be shorter),
+  //   to find which parts of a buffer have changed
+  std::vector<unsigned long long> ComputeChunkHashes (const void* data, size_t bytesize,
+                                                      size_t chunk_bytes = CONTENT_HASH_CHUNK_BYTES);
+
+  // Combine an ordered list of hashes into a single one
+  ContentHash128 CombineHashes (const ContentHash128* hashes, size_t n_hashes, unsigned long long seed = 0);
+}
+
+#endif
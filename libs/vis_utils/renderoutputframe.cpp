@@ -2,6 +2,7 @@
 
 #include <gl_utils/texture2d.h>
 #include <gl_utils/pipelineshader.h>
+#include <gl_utils/gpuprofiler.h>
 #include <vis_utils/defines.h>
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -235,6 +236,7 @@ void RenderFrameToScreen::Draw (GLuint screen_output_id)
     CreateVertexBuffers();
   }
 
+  gl::GPUProfiler::Instance()->BeginScope("Blend");
   m_ps_shader->Bind();
 
   glActiveTexture(GL_TEXTURE0);
@@ -255,6 +257,7 @@ void RenderFrameToScreen::Draw (GLuint screen_output_id)
   gl::PipelineShader::Unbind();
 
   glBindTexture(GL_TEXTURE_2D, 0);
+  gl::GPUProfiler::Instance()->EndScope();
 }
 
 void RenderFrameToScreen::SetMultiResolutionScreenMultiplier (glm::ivec2 mr)
@@ -280,6 +283,7 @@ void RenderFrameToScreen::DrawMultiSampleHigherResolutionMode(GLuint ext_screen_
       gl::ExitOnGLError("vis::RenderFrameToScreen: Could not unbind compute shader...");
     }
 
+    gl::GPUProfiler::Instance()->BeginScope("ScalingFilter");
     m_cp_shader_multisample->Bind();
 
     glActiveTexture(GL_TEXTURE0);
@@ -293,6 +297,7 @@ void RenderFrameToScreen::DrawMultiSampleHigherResolutionMode(GLuint ext_screen_
     m_cp_shader_multisample->BindUniform("TexGeneratedFrame");
 
     m_cp_shader_multisample->Dispatch();
+    gl::GPUProfiler::Instance()->EndScope();
 
     Draw(m_filtered_screen_output->GetTextureID());
   }
@@ -345,6 +350,7 @@ void RenderFrameToScreen::DrawHigherResolutionWithDownScale (GLuint ext_screen_o
       gl::ExitOnGLError("vis::RenderFrameToScreen: Could not unbind compute shader...");
     }
 
+    gl::GPUProfiler::Instance()->BeginScope("ScalingFilter");
     m_cp_shader_downscale->Bind();
 
     glActiveTexture(GL_TEXTURE0);
@@ -409,6 +415,7 @@ void RenderFrameToScreen::DrawHigherResolutionWithDownScale (GLuint ext_screen_o
 
       m_cp_shader_digital_filter->Unbind();
     }
+    gl::GPUProfiler::Instance()->EndScope();
 
     Draw(m_filtered_screen_output->GetTextureID());
   }
@@ -462,6 +469,7 @@ void RenderFrameToScreen::DrawLowerResolutionWithUpScale (GLuint ext_screen_outp
       gl::ExitOnGLError("vis::RenderFrameToScreen: Could not unbind upsampling compute shader...");
     }
 
+    gl::GPUProfiler::Instance()->BeginScope("ScalingFilter");
     if (m_kernel_filter == vis::IMAGE_FILTER_KERNEL::K4_CARDINAL_BSPLINE_3 || m_kernel_filter == vis::IMAGE_FILTER_KERNEL::K4_CARDINAL_OMOMS3)
     {
       if (m_cp_shader_digital_filter == nullptr)
@@ -528,6 +536,7 @@ void RenderFrameToScreen::DrawLowerResolutionWithUpScale (GLuint ext_screen_outp
 
     m_cp_shader_upscale->Dispatch();
     m_cp_shader_upscale->Unbind();
+    gl::GPUProfiler::Instance()->EndScope();
     Draw(m_filtered_screen_output->GetTextureID());
   }
 }
@@ -33,6 +33,7 @@ the SAT at non-integer locations if necessary.
 
 #include <gl_utils/texture2d.h>
 #include <gl_utils/texture3d.h>
+#include <gl_utils/tracer.h>
 
 // Using OpenMP to increase the speed of SAT computation
 #define USE_OMP
@@ -47,16 +48,16 @@ namespace vis
     SummedAreaTable2D (unsigned int _w, unsigned int _h)
       : w(_w), h(_h)
     {
-      data = new T[w*h];
+      data = new T[(size_t)w * (size_t)h];
       zero = T(0);
 
       for (int x = 0; x < w; x++)
         data[x] = zero;
       for (int y = 0; y < h; y++)
-        data[w*y] = zero;
+        data[(size_t)w * y] = zero;
     }
   
-    ~SummedAreaTable2D ()
+    virtual ~SummedAreaTable2D ()
     {
       if (data)
         delete[] data;
@@ -70,7 +71,7 @@ namespace vis
   
     void SetValue (T val, int x, int y)
     {
-      data[x + w*y] = val;
+      data[GetDataIndex(x, y)] = val;
     }
   
     T GetValue (int x, int y)
@@ -80,7 +81,7 @@ namespace vis
       if (x >= w) x = w - 1;
       if (y >= h) y = h - 1;
   
-      return data[x + w*y];
+      return data[GetDataIndex(x, y)];
     }
   
     T GetAverage ()
@@ -99,11 +100,17 @@ namespace vis
       {
         for (int y = 0; y < h; y++)
         {
-          data[x + w*y] += v;
+          data[GetDataIndex(x, y)] += v;
         }
       }
     }
   
+    // 64-bit linear index, so tables above 2^32 elements are addressable
+    size_t GetDataIndex (int x, int y)
+    {
+      return (size_t)x + ((size_t)w * (size_t)y);
+    }
+
     void GetSizes (int* sw, int* sh)
     {
       *sw = w;
@@ -142,6 +149,7 @@ namespace vis
     // 2010 - Real-time ambient occlusion and halos with Summed Area Tables
     virtual void BuildSAT ()
     {
+      TRACE_SCOPE("BuildSAT2D", "preprocess");
       //First Step
       SetValue(GetValue(0, 0), 0, 0);
   
@@ -175,16 +183,16 @@ namespace vis
     SummedAreaTable3D (unsigned int _w, unsigned int _h, unsigned int _d)
       : w(_w), h(_h), d(_d)
     {
-      data = new T[w*h*d];
+      data = new T[(size_t)w * (size_t)h * (size_t)d];
       zero = T(0);
   
-      for (int x = 0; x < w; x++)
+      for (int z = 0; z < d; z++)
         for (int y = 0; y < h; y++)
-          for (int z = 0; z < d; z++)
+          for (int x = 0; x < w; x++)
             SetValue((T)zero, x, y, z);
     }
   
-    ~SummedAreaTable3D ()
+    virtual ~SummedAreaTable3D ()
     {
       if (data)
         delete[] data;
@@ -196,9 +204,15 @@ namespace vis
       return data;
     }
 
+    // 64-bit linear index, so tables above 2^32 elements are addressable
+    size_t GetDataIndex (int x, int y, int z)
+    {
+      return (size_t)x + ((size_t)w * (size_t)y) + ((size_t)w * (size_t)h * (size_t)z);
+    }
+
     void SetValue (T val, int x, int y, int z)
     {
-      data[x + (w * y) + (w * h * z)] = val;
+      data[GetDataIndex(x, y, z)] = val;
     }
   
     T GetValue (int x, int y, int z)
@@ -209,14 +223,17 @@ namespace vis
       if (y >= h) y = h - 1;
       if (z >= d) z = d - 1;
   
-      return data[x + (w * y) + (w * h * z)];
+      return data[GetDataIndex(x, y, z)];
     }
     
     // 2010 - Real-time ambient occlusion and halos with Summed Area Tables
+    // . The loops follow the memory order (x innermost): tables above 2^31
+    //   elements do not fit in the caches, and each strided access would miss
     // TODO:
     // . Use #pragma omp parallel for
     virtual void BuildSAT ()
     {
+      TRACE_SCOPE("BuildSAT3D", "preprocess");
       //////////////////////////////////////////////////////////////
       // 1 - First Step
       SetValue(GetValue(0, 0, 0), 0, 0, 0);
@@ -232,22 +249,22 @@ namespace vis
   
       //////////////////////////////////////////////////////////////
       // 3 - Third Step
-      for (int x = 1; x < w; x++)
-        for (int z = 1; z < d; z++)
+      for (int z = 1; z < d; z++)
+        for (int x = 1; x < w; x++)
           SetValue(GetValue(x - 1, 0, z) +
                    GetValue(x, 0, z - 1) -
                    GetValue(x - 1, 0, z - 1) +
                    GetValue(x, 0, z),
                    x, 0, z);
-      for (int x = 1; x < w; x++)
-        for (int y = 1; y < h; y++)
+      for (int y = 1; y < h; y++)
+        for (int x = 1; x < w; x++)
           SetValue(GetValue(x - 1, y, 0) +
                    GetValue(x, y - 1, 0) - 
                    GetValue(x - 1, y - 1, 0) +
                    GetValue(x, y, 0),
                    x, y, 0);
-      for (int y = 1; y < h; y++)
-        for (int z = 1; z < d; z++)
+      for (int z = 1; z < d; z++)
+        for (int y = 1; y < h; y++)
           SetValue(GetValue(0, y - 1, z) + 
                    GetValue(0, y, z - 1) - 
                    GetValue(0, y - 1, z - 1) + 
@@ -256,11 +273,11 @@ namespace vis
 
       //////////////////////////////////////////////////////////////
       // 4 - Fourth Step
-      for (int x = 1; x < w; x++)
+      for (int z = 1; z < d; z++)
       {
         for (int y = 1; y < h; y++)
         {
-          for (int z = 1; z < d; z++)
+          for (int x = 1; x < w; x++)
           {
             T val = GetValue(x, y, z)
                   + GetValue(x - 1, y - 1, z - 1)
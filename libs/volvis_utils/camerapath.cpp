@@ -0,0 +1,214 @@
+/**
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#include "camerapath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace vis
+{
+  // Spherical interpolation of unit vectors, falls back to normalized
+  //   linear interpolation for (almost) parallel vectors
+  static glm::vec3 SlerpDirection (glm::vec3 a, glm::vec3 b, float u)
+  {
+    float cos_angle = glm::clamp(glm::dot(a, b), -1.0f, 1.0f);
+    float angle = acos(cos_angle);
+    if (angle < 1e-4f)
+      return glm::normalize(glm::mix(a, b, u));
+
+    // (Almost) opposite vectors: the plane of the arc is undefined, so rotate
+    //   a by u * pi about any axis orthogonal to it
+    if (angle > glm::pi<float>() - 1e-4f)
+    {
+      glm::vec3 axis = glm::cross(a, glm::vec3(1.0f, 0.0f, 0.0f));
+      if (glm::length(axis) < 1e-2f)
+        axis = glm::cross(a, glm::vec3(0.0f, 1.0f, 0.0f));
+      axis = glm::normalize(axis);
+
+      float theta = u * glm::pi<float>();
+      return glm::normalize(a * (float)cos(theta) + glm::cross(axis, a) * (float)sin(theta));
+    }
+
+    float sin_angle = sin(angle);
+    return glm::normalize(a * (float)(sin((1.0f - u) * angle) / sin_angle)
+                        + b * (float)(sin(u * angle) / sin_angle));
+  }
+
+  CameraPath::CameraPath ()
+    : m_name("")
+    , m_time_offset(0.0)
+  {
+  }
+
+  CameraPath::~CameraPath ()
+  {
+    Clear();
+  }
+
+  void CameraPath::Clear ()
+  {
+    m_keyframes.clear();
+  }
+
+  void CameraPath::SetName (std::string name)
+  {
+    m_name = name;
+  }
+
+  std::string CameraPath::GetName ()
+  {
+    return m_name;
+  }
+
+  void CameraPath::AddKeyframe (double time, glm::vec3 eye, glm::vec3 center, glm::vec3 up)
+  {
+    if (m_keyframes.empty()) m_time_offset = time;
+
+    Keyframe k;
+    k.time = m_keyframes.empty() ? 0.0 : std::max(time - m_time_offset, m_keyframes.back().time);
+    k.eye = eye;
+    k.center = center;
+    k.up = glm::normalize(up);
+    m_keyframes.push_back(k);
+  }
+
+  int CameraPath::GetNumberOfKeyframes ()
+  {
+    return (int)m_keyframes.size();
+  }
+
+  CameraPath::Keyframe* CameraPath::GetKeyframe (int i)
+  {
+    return &m_keyframes[i];
+  }
+
+  double CameraPath::GetDuration ()
+  {
+    if (m_keyframes.size() < 2) return 0.0;
+    return m_keyframes.back().time;
+  }
+
+  CameraData CameraPath::Evaluate (double t)
+  {
+    if (m_keyframes.empty())
+      return CameraData(m_name, glm::vec3(0, 0, 1), glm::vec3(0), glm::vec3(0, 1, 0));
+    if (m_keyframes.size() == 1 || t <= 0.0)
+      return CameraData(m_name, m_keyframes[0].eye, m_keyframes[0].center, m_keyframes[0].up);
+    if (t >= GetDuration())
+      return CameraData(m_name, m_keyframes.back().eye, m_keyframes.back().center, m_keyframes.back().up);
+
+    // first keyframe after t
+    std::vector<Keyframe>::iterator it = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), t,
+      [](double time, const Keyframe& k) { return time < k.time; });
+    Keyframe& k1 = *it;
+    Keyframe& k0 = *(it - 1);
+
+    double dt = k1.time - k0.time;
+    float u = dt > 0.0 ? (float)((t - k0.time) / dt) : 1.0f;
+
+    glm::vec3 center = glm::mix(k0.center, k1.center, u);
+
+    glm::vec3 offset0 = k0.eye - k0.center;
+    glm::vec3 offset1 = k1.eye - k1.center;
+    float length0 = glm::length(offset0);
+    float length1 = glm::length(offset1);
+    float radius = glm::mix(length0, length1, u);
+
+    // eye == center has no direction: take the one of the other keyframe,
+    //   if both are degenerated the eye simply follows the center
+    glm::vec3 eye = center;
+    if (length0 > 0.0f || length1 > 0.0f)
+    {
+      glm::vec3 dir0 = length0 > 0.0f ? offset0 / length0 : offset1 / length1;
+      glm::vec3 dir1 = length1 > 0.0f ? offset1 / length1 : dir0;
+      eye = center + SlerpDirection(dir0, dir1, u) * radius;
+    }
+
+    glm::vec3 up = SlerpDirection(k0.up, k1.up, u);
+
+    return CameraData(m_name, eye, center, up);
+  }
+
+  double CameraPath::GetFrameTime (int i, int n_frames)
+  {
+    if (n_frames < 2) return 0.0;
+    return GetDuration() * (double)i / (double)(n_frames - 1);
+  }
+
+  bool CameraPath::Read (std::string filepath)
+  {
+    Clear();
+
+    std::ifstream f_path(filepath);
+    if (!f_path.is_open())
+    {
+      std::cout << "Error: Unable to read camera path " << filepath << "." << std::endl;
+      return false;
+    }
+
+    m_name = std::filesystem::path(filepath).stem().string();
+
+    std::string s_line;
+    int n_line = 0;
+    while (std::getline(f_path, s_line))
+    {
+      n_line++;
+      s_line = s_line.substr(0, s_line.find('#'));
+      if (s_line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+      std::istringstream ss(s_line);
+      double time;
+      glm::vec3 eye, center, up;
+      if (!(ss >> time >> eye.x >> eye.y >> eye.z >> center.x >> center.y >> center.z >> up.x >> up.y >> up.z))
+      {
+        std::cout << "Error: Invalid keyframe at line " << n_line << " of camera path " << filepath << "." << std::endl;
+        Clear();
+        return false;
+      }
+      if (!m_keyframes.empty() && time - m_time_offset < m_keyframes.back().time)
+      {
+        std::cout << "Error: Decreasing keyframe time at line " << n_line << " of camera path " << filepath << "." << std::endl;
+        Clear();
+        return false;
+      }
+      AddKeyframe(time, eye, center, up);
+    }
+    f_path.close();
+
+    printf("Camera path %s: %d keyframes, %.2f s\n", m_name.c_str(), GetNumberOfKeyframes(), GetDuration());
+    return !m_keyframes.empty();
+  }
+
+  bool CameraPath::Write (std::string filepath)
+  {
+    std::ofstream f_path(filepath, std::ios_base::out);
+    if (!f_path.is_open())
+    {
+      std::cout << "Error: Unable to write camera path " << filepath << "." << std::endl;
+      return false;
+    }
+
+    f_path << "# time(s) eye.x eye.y eye.z center.x center.y center.z up.x up.y up.z" << std::endl;
+    // Enough digits to read back the exact same values
+    for (int i = 0; i < m_keyframes.size(); i++)
+    {
+      Keyframe& k = m_keyframes[i];
+      f_path << std::setprecision(std::numeric_limits<double>::max_digits10) << k.time << " "
+             << std::setprecision(std::numeric_limits<float>::max_digits10)
+             << k.eye.x << " " << k.eye.y << " " << k.eye.z << " "
+             << k.center.x << " " << k.center.y << " " << k.center.z << " "
+             << k.up.x << " " << k.up.y << " " << k.up.z << std::endl;
+    }
+    f_path.close();
+
+    return true;
+  }
+}
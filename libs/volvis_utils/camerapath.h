@@ -0,0 +1,80 @@
+/**
+ * Recorded camera path: time-stamped camera keyframes, played back by
+ *   interpolation (see renderingmanager and benchmark/benchmarkrunner).
+ *
+ * Between two keyframes, the center is interpolated linearly, the direction
+ *   from the center to the eye and the up vector are interpolated spherically,
+ *   and the distance to the center linearly, so orbits and zooms recorded with
+ *   the arcball camera are played back without shortcuts through the volume.
+ *
+ * File format (.cpath), one keyframe per line, '#' starts a comment:
+ *
+ * # time(s) eye.x eye.y eye.z center.x center.y center.z up.x up.y up.z
+ * 0.000 0 0 300   0 0 0   0 1 0
+ * 2.000 300 0 0   0 0 0   0 1 0
+ *
+ * Keyframe times must not decrease. The first keyframe is moved to time 0.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef VOL_VIS_UTILS_CAMERA_PATH_H
+#define VOL_VIS_UTILS_CAMERA_PATH_H
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <vis_utils/camera.h>
+
+namespace vis
+{
+  class CameraPath
+  {
+  public:
+    class Keyframe
+    {
+    public:
+      double time;
+      glm::vec3 eye, center, up;
+    };
+
+    CameraPath ();
+    ~CameraPath ();
+
+    void Clear ();
+
+    void SetName (std::string name);
+    std::string GetName ();
+
+    // Keyframes must be added in time order (e.g. seconds of a steady clock),
+    //   they are stored relative to the time of the first keyframe
+    void AddKeyframe (double time, glm::vec3 eye, glm::vec3 center, glm::vec3 up);
+
+    int GetNumberOfKeyframes ();
+    Keyframe* GetKeyframe (int i);
+
+    // Time of the last keyframe, in seconds
+    double GetDuration ();
+
+    // Camera at time t (seconds), clamped to [0, duration]
+    CameraData Evaluate (double t);
+    // Time of frame i when the path is played in n_frames frames,
+    //   the first and the last frames being the first and last keyframes
+    double GetFrameTime (int i, int n_frames);
+
+    bool Read (std::string filepath);
+    bool Write (std::string filepath);
+
+  protected:
+    std::string m_name;
+    std::vector<Keyframe> m_keyframes;
+    // time of the first keyframe, as given to AddKeyframe
+    double m_time_offset;
+
+  private:
+  };
+}
+
+#endif
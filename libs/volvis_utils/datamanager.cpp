@@ -7,7 +7,10 @@
 #include <volvis_utils/datamanager.h>
 
 #include <fstream>
+#include <cstring>
 #include <gl_utils/computeshader.h>
+#include <gl_utils/gpumemoryregistry.h>
+#include <gl_utils/tracer.h>
 #include <vis_utils/defines.h>
 #include <volvis_utils/utils.h>
 
@@ -19,14 +22,19 @@ namespace vis
   DataManager::DataManager ()
     : curr_vol_data_type(vis::GRID_VOLUME_DATA_TYPE::STRUCTURED)
     , use_specific_lookup_data_shader(false)
+    , m_data_version(0)
     , curr_vr_volume(nullptr)
+    , curr_gl_tex_structured_volume(nullptr)
     , curr_uns_grid_volume(nullptr)
     , curr_vr_transferfunction(nullptr)
     , curr_volume_index(0)
     , curr_transferfunction_index(0)
     , curr_gradient_comp_model(DataManager::STRUCTURED_GRADIENT_TYPE::NONE_GRADIENT)
-    , curr_gl_tex_structured_volume(nullptr)
     , curr_gl_tex_structured_gradient(nullptr)
+    , m_packed_volume_users(0)
+    , m_gradient_texture_users(0)
+    , m_gradient_pending(false)
+    , m_volume_load_pending(false)
   {
     // structured, unstructured and transfer function list...
     stored_structured_datasets.clear();
@@ -37,10 +45,14 @@ namespace vis
 
     ui_dataset_names.clear();
     ui_transferf_names.clear();
+
+    gl::GPUMemoryRegistry::Instance()->AddEvictionCallback(DataManager::EvictDerivedResource, this);
   }
 
   DataManager::~DataManager ()
   {
+    gl::GPUMemoryRegistry::Instance()->RemoveEvictionCallback(DataManager::EvictDerivedResource, this);
+
     DeleteVolumeData();
     DeleteTransferFunctionData();
   }
@@ -66,6 +78,7 @@ namespace vis
 
   void DataManager::ReadData ()
   {
+    TRACE_SCOPE("ReadDataLists", "io");
     stored_structured_datasets.clear();
     stored_transfer_functions.clear();
 
@@ -77,9 +90,11 @@ namespace vis
 
     ReadTransferFunctionsFromRes();
 
+    // Reading and uploading a large volume takes a while: the caller loads it
+    //   once the window and the ui are up (LoadPendingVolume)
     if (curr_vol_data_type == vis::GRID_VOLUME_DATA_TYPE::STRUCTURED)
     {
-      GenerateStructuredVolumeTexture();
+      m_volume_load_pending = !stored_structured_datasets.empty();
     }
     
     vis::TransferFunctionReader tfr;
@@ -87,6 +102,22 @@ namespace vis
     curr_vr_transferfunction->SetName(stored_transfer_functions[GetCurrentTransferFunctionIndex()].name);
   }
 
+  bool DataManager::IsVolumeLoadPending ()
+  {
+    return m_volume_load_pending;
+  }
+
+  bool DataManager::LoadPendingVolume ()
+  {
+    if (!m_volume_load_pending) return false;
+    m_volume_load_pending = false;
+
+    bool loaded = GenerateStructuredVolumeTexture();
+    // Renderers built before have no volume
+    m_data_version++;
+    return loaded;
+  }
+
   int DataManager::GetNumberOfStructuredDatasets ()
   {
     return stored_structured_datasets.size();
@@ -169,9 +200,127 @@ namespace vis
 
   gl::Texture3D* DataManager::GetCurrentGradientTexture ()
   {
+    if (m_gradient_pending && IsGradientTextureNeeded())
+    {
+      m_gradient_pending = false;
+      // Renderers built meanwhile have no gradient texture
+      if (GenerateStructuredGradientTexture()) m_data_version++;
+    }
     return curr_gl_tex_structured_gradient;
   }
+
+  void DataManager::AddGradientTextureUser ()
+  {
+    m_gradient_texture_users++;
+  }
+
+  void DataManager::RemoveGradientTextureUser ()
+  {
+    if (m_gradient_texture_users > 0) m_gradient_texture_users--;
+  }
+
+  bool DataManager::IsGradientComputedInShader ()
+  {
+    return curr_vol_data_type == vis::GRID_VOLUME_DATA_TYPE::STRUCTURED
+      && curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::SHADER_ON_THE_FLY;
+  }
+
+  gl::Texture3D* DataManager::AcquirePackedVolumeTexture (bool use_16_bits)
+  {
+    if (curr_vr_volume == nullptr || curr_gl_tex_structured_volume == nullptr) return nullptr;
+
+    unsigned int bits = use_16_bits ? 16 : 8;
+    vis::ContentHash128 packed_key = GetDerivedDataKey("packed_volume", &bits, sizeof(bits));
+
+    gl::Texture3D* tex_packed = m_derived_resources.Acquire(packed_key);
+    if (tex_packed)
+    {
+      m_packed_volume_users++;
+      return tex_packed;
+    }
+
+    // Unread gradient texture: dropped before the reservation, so that its memory is available
+    if (curr_gl_tex_structured_gradient && m_gradient_texture_users == 0)
+    {
+      DeleteGradientData();
+      m_gradient_pending = true;
+    }
+
+    size_t packed_bytesize = curr_vr_volume->GetNumberOfVoxels()
+      * gl::GPUMemoryRegistry::GetTexelByteSize(use_16_bits ? GL_RGBA16 : GL_RGBA8);
+    if (!gl::GPUMemoryRegistry::Instance()->Reserve(packed_bytesize))
+    {
+      printf("Warning: the packed volume texture does not fit in the gpu memory budget\n");
+      return nullptr;
+    }
+
+    tex_packed = GeneratePackedVolumeWithComputeShader(use_16_bits);
+    m_packed_volume_users++;
+    return m_derived_resources.Add(packed_key, tex_packed, packed_bytesize,
+      vis::DERIVED_RESOURCE_DEPENDENCY::DEPENDS_ON_VOLUME);
+  }
+
+  void DataManager::ReleasePackedVolumeTexture (gl::Texture3D* tex_packed)
+  {
+    if (tex_packed == nullptr) return;
+    m_derived_resources.Release(tex_packed);
+    m_packed_volume_users--;
+  }
   
+  vis::ContentHash128 DataManager::GetCurrentVolumeContentHash ()
+  {
+    if (curr_vr_volume == nullptr)
+      return vis::ContentHash128();
+    return curr_vr_volume->GetContentHash();
+  }
+
+  vis::ContentHash128 DataManager::GetDerivedDataKey (const char* tag, const void* params, size_t params_bytesize,
+                                                      bool depends_on_transfer_function)
+  {
+    vis::ContentHash128 hashes[4];
+    hashes[0] = GetCurrentVolumeContentHash();
+    hashes[1] = vis::HashBytes128(tag, strlen(tag));
+    if (params != nullptr)
+      hashes[2] = vis::HashBytes128(params, params_bytesize);
+    if (!depends_on_transfer_function)
+      return vis::CombineHashes(hashes, 3);
+
+    hashes[3] = GetCurrentTransferFunctionHash();
+    return vis::CombineHashes(hashes, 4);
+  }
+
+  vis::ContentHash128 DataManager::GetCurrentTransferFunctionHash ()
+  {
+    if (curr_vr_transferfunction == nullptr || curr_transferfunction_index >= stored_transfer_functions.size())
+      return vis::ContentHash128();
+
+    // Transfer functions are read from files that do not change while running
+    std::string tf_path = stored_transfer_functions[curr_transferfunction_index].path;
+    return vis::HashBytes128(tf_path.data(), tf_path.size());
+  }
+
+  vis::DerivedResourceRegistry* DataManager::GetDerivedResources ()
+  {
+    return &m_derived_resources;
+  }
+
+  unsigned int DataManager::GetDataVersion ()
+  {
+    return m_data_version;
+  }
+
+  vis::DatasetCatalog* DataManager::GetDatasetCatalog ()
+  {
+    return &m_dataset_catalog;
+  }
+
+  vis::DatasetInfo* DataManager::GetDatasetInfo (int id)
+  {
+    if (id < 0 || id >= stored_structured_datasets.size())
+      return nullptr;
+    return m_dataset_catalog.GetDatasetInfo(stored_structured_datasets[id].path);
+  }
+
   std::vector<std::string>* DataManager::GetUINameDatasetListPtr ()
   {
     return &ui_dataset_names;
@@ -193,19 +342,34 @@ namespace vis
     if (curr_gl_tex_structured_volume) delete curr_gl_tex_structured_volume;
     curr_gl_tex_structured_volume = nullptr;
 
+    m_derived_resources.Invalidate(DERIVED_RESOURCE_DEPENDENCY::DEPENDS_ON_VOLUME);
+    // The callers load another volume
+    m_volume_load_pending = false;
+
     DeleteGradientData();
   }
 
+  bool DataManager::IsGradientTextureNeeded ()
+  {
+    return m_packed_volume_users == 0 || m_gradient_texture_users > 0;
+  }
+
   void DataManager::DeleteGradientData ()
   {
     if (curr_gl_tex_structured_gradient) delete curr_gl_tex_structured_gradient;
     curr_gl_tex_structured_gradient = nullptr;
+    curr_gradient_key = vis::ContentHash128();
+    m_gradient_pending = false;
+    m_data_version++;
   }
 
   void DataManager::DeleteTransferFunctionData ()
   {
     if (curr_vr_transferfunction) delete curr_vr_transferfunction;
     curr_vr_transferfunction = nullptr;
+
+    m_derived_resources.Invalidate(DERIVED_RESOURCE_DEPENDENCY::DEPENDS_ON_TRANSFER_FUNCTION);
+    m_data_version++;
   }
 
   void DataManager::ReadStructuredDatasetsFromRes ()
@@ -246,6 +410,18 @@ namespace vis
       std::cout << i << ": " << stored_structured_datasets[i].name << std::endl;
       ui_dataset_names.push_back(stored_structured_datasets[i].name);
     }
+
+    // Fill the dataset catalog from cache and header probes
+    std::vector<std::string> dataset_paths;
+    for (int i = 0; i < stored_structured_datasets.size(); i++)
+      dataset_paths.push_back(stored_structured_datasets[i].path);
+
+    std::string catalog_filename = m_path_to_data;
+    catalog_filename.append("/#cache_structured_datasets");
+    m_dataset_catalog.SetCacheFilePath(catalog_filename);
+    m_dataset_catalog.ReadCacheFile();
+    m_dataset_catalog.ProbeDatasets(dataset_paths);
+    m_dataset_catalog.WriteCacheFile();
    
     curr_volume_index = 0;
   }
@@ -289,14 +465,44 @@ namespace vis
 
   bool DataManager::GenerateStructuredVolumeTexture ()
   {
+    TRACE_SCOPE_DETAIL("LoadStructuredVolume", "io", stored_structured_datasets[GetCurrentVolumeIndex()].name);
+
     // Read Volume
     vis::VolumeReader vr;
+    // Volumes are only read through their normalized samples: .pvmold files
+    //   keep their 1-2 bytes per voxel instead of a float copy
+    vr.SetPvmOldNativeStorage(true);
     curr_vr_volume = vr.ReadStructuredVolume(stored_structured_datasets[GetCurrentVolumeIndex()].path);
     curr_vr_volume->SetName(stored_structured_datasets[GetCurrentVolumeIndex()].name);
 
+    // Hashed once here, then used as the key of the derived data
+    vis::ContentHash128 content_hash;
+    {
+      TRACE_SCOPE("ComputeContentHash", "preprocess");
+      content_hash = curr_vr_volume->GetContentHash();
+    }
+    printf("Volume content hash: %s\n", content_hash.ToString().c_str());
+
+    // Statistics are only computed once per file version
+    vis::DatasetInfo* dinfo = m_dataset_catalog.GetDatasetInfo(stored_structured_datasets[GetCurrentVolumeIndex()].path);
+    if (dinfo == nullptr || !dinfo->statistics_available)
+    {
+      TRACE_SCOPE("UpdateDatasetStatistics", "preprocess");
+      m_dataset_catalog.UpdateStatistics(stored_structured_datasets[GetCurrentVolumeIndex()].path, curr_vr_volume);
+      m_dataset_catalog.WriteCacheFile();
+    }
+
     // Generate Volume Texture
+#ifdef USE_16F_INTERNAL_FORMAT
+    size_t volume_bytesize = curr_vr_volume->GetNumberOfVoxels() * gl::GPUMemoryRegistry::GetTexelByteSize(GL_R16F);
+#else
+    size_t volume_bytesize = curr_vr_volume->GetNumberOfVoxels() * gl::GPUMemoryRegistry::GetTexelByteSize(GL_R32F);
+#endif
+    if (!gl::GPUMemoryRegistry::Instance()->Reserve(volume_bytesize))
+      printf("Warning: the volume texture exceeds the gpu memory budget\n");
     curr_gl_tex_structured_volume = vis::GenerateRTexture(curr_vr_volume, 0, 0, 0, curr_vr_volume->GetWidth(),
       curr_vr_volume->GetHeight(), curr_vr_volume->GetDepth());
+    gl::GPUMemoryRegistry::Instance()->SetOwner(curr_gl_tex_structured_volume, "volume");
 
     // Generate gradient, if enabled
     GenerateStructuredGradientTexture();
@@ -304,26 +510,79 @@ namespace vis
     return true;
   }
 
+  vis::ContentHash128 DataManager::GetGradientKey ()
+  {
+    unsigned int gradient_type = (unsigned int)curr_gradient_comp_model;
+    return GetDerivedDataKey("gradient", &gradient_type, sizeof(gradient_type));
+  }
+
   bool DataManager::GenerateStructuredGradientTexture ()
   {
+    TRACE_SCOPE("GenerateStructuredGradientTexture", "preprocess");
+    curr_gradient_key = GetGradientKey();
+    curr_gl_tex_structured_gradient = nullptr;
+
+    // No texture to build: none, or computed by the ray marching shaders
+    if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::NONE_GRADIENT
+     || curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::SHADER_ON_THE_FLY)
+      return false;
+
+    // Not kept while only packed volume textures hold the gradients
+    if (!IsGradientTextureNeeded())
+    {
+      m_gradient_pending = true;
+      return false;
+    }
+
+    int downsampling = ReserveGradientMemory();
+    if (downsampling == 0)
+      return false;
+
     if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::SOBEL_FELDMAN_FILTER)
     {
-      curr_gl_tex_structured_gradient = vis::GenerateSobelFeldmanGradientTexture(curr_vr_volume);
+      curr_gl_tex_structured_gradient = vis::GenerateSobelFeldmanGradientTexture(curr_vr_volume, downsampling);
     }
     else if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::FINITE_DIFERENCES)
     {
-      curr_gl_tex_structured_gradient = vis::GenerateGradientTexture(curr_vr_volume);
+      curr_gl_tex_structured_gradient = vis::GenerateGradientTexture(curr_vr_volume, 1, 0, true, -1, -1, -1, -1, -1, -1, downsampling);
     }
     else if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::COMPUTE_SHADER_SOBEL)
     {
-      curr_gl_tex_structured_gradient = GenerateGradientWithComputeShader();
+      curr_gl_tex_structured_gradient = GenerateGradientWithComputeShader(downsampling);
     }
-    else
+    gl::GPUMemoryRegistry::Instance()->SetOwner(curr_gl_tex_structured_gradient, "gradient");
+    return true;
+  }
+
+  int DataManager::ReserveGradientMemory ()
+  {
+#ifdef USE_16F_INTERNAL_FORMAT
+    size_t texel_bytesize = gl::GPUMemoryRegistry::GetTexelByteSize(GL_RGB16F);
+#else
+    size_t texel_bytesize = gl::GPUMemoryRegistry::GetTexelByteSize(GL_RGB32F);
+#endif
+    if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::COMPUTE_SHADER_SOBEL)
+      texel_bytesize = gl::GPUMemoryRegistry::GetTexelByteSize(GL_RGBA16F);
+    // Cache memory is evicted first, then the resolution is halved
+    for (int downsampling = 1; downsampling <= GRADIENT_MAX_DOWNSAMPLING; downsampling *= 2)
     {
-      curr_gl_tex_structured_gradient = nullptr;
-      return false;
+      size_t bytesize = (size_t)((curr_vr_volume->GetWidth() + downsampling - 1) / downsampling)
+                      * (size_t)((curr_vr_volume->GetHeight() + downsampling - 1) / downsampling)
+                      * (size_t)((curr_vr_volume->GetDepth() + downsampling - 1) / downsampling) * texel_bytesize;
+      if (gl::GPUMemoryRegistry::Instance()->Reserve(bytesize))
+      {
+        if (downsampling > 1)
+          printf("Warning: gradient texture downsampled by %d to fit in the gpu memory budget\n", downsampling);
+        return downsampling;
+      }
     }
-    return true;
+    printf("Warning: the gradient texture does not fit in the gpu memory budget\n");
+    return 0;
+  }
+
+  bool DataManager::EvictDerivedResource (void* data)
+  {
+    return ((DataManager*)data)->GetDerivedResources()->EvictLeastRecentlyUsed();
   }
 
   bool DataManager::PreviousVolume ()
@@ -464,6 +723,14 @@ namespace vis
   
   bool DataManager::UpdateStructuredGradientTexture ()
   {
+    // Built with the volume, if not loaded yet
+    if (curr_vr_volume == nullptr)
+      return false;
+
+    // Same volume content and gradient type: keep the current texture
+    if (curr_gl_tex_structured_gradient != nullptr && curr_gradient_key == GetGradientKey())
+      return true;
+
     DeleteGradientData();
     return GenerateStructuredGradientTexture();
   }
@@ -484,10 +751,14 @@ namespace vis
       {
         return 2;
       }
-      else if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::NONE_GRADIENT)
+      else if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::SHADER_ON_THE_FLY)
       {
         return 3;
       }
+      else if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::NONE_GRADIENT)
+      {
+        return 4;
+      }
     }
     return -1;
   }
@@ -502,8 +773,10 @@ namespace vis
         return 1;
       else if (sgt == STRUCTURED_GRADIENT_TYPE::COMPUTE_SHADER_SOBEL)
         return 2;
-      else
+      else if (sgt == STRUCTURED_GRADIENT_TYPE::SHADER_ON_THE_FLY)
         return 3;
+      else
+        return 4;
     }
     return -1;
   }
@@ -519,6 +792,8 @@ namespace vis
         sgt = STRUCTURED_GRADIENT_TYPE::FINITE_DIFERENCES;
       else if (idx == 2)
         sgt = STRUCTURED_GRADIENT_TYPE::COMPUTE_SHADER_SOBEL;
+      else if (idx == 3)
+        sgt = STRUCTURED_GRADIENT_TYPE::SHADER_ON_THE_FLY;
     }
 
     bool ret = !(sgt == curr_gradient_comp_model);
@@ -543,6 +818,10 @@ namespace vis
       {
         return "Sobel-Feldman (Compute Shader)";
       }
+      else if (sgt == STRUCTURED_GRADIENT_TYPE::SHADER_ON_THE_FLY)
+      {
+        return "On the Fly (Ray Marching Shader)";
+      }
     }
     return "None";
   }
@@ -563,6 +842,10 @@ namespace vis
       {
         return "Sobel-Feldman (Compute Shader)";
       }
+      else if (curr_gradient_comp_model == STRUCTURED_GRADIENT_TYPE::SHADER_ON_THE_FLY)
+      {
+        return "On the Fly (Ray Marching Shader)";
+      }
     }
     return "NULL";
   }
@@ -573,12 +856,14 @@ namespace vis
     vlist.push_back(GetGradientName(STRUCTURED_GRADIENT_TYPE::SOBEL_FELDMAN_FILTER));
     vlist.push_back(GetGradientName(STRUCTURED_GRADIENT_TYPE::FINITE_DIFERENCES));
     vlist.push_back(GetGradientName(STRUCTURED_GRADIENT_TYPE::COMPUTE_SHADER_SOBEL));
+    vlist.push_back(GetGradientName(STRUCTURED_GRADIENT_TYPE::SHADER_ON_THE_FLY));
     vlist.push_back(GetGradientName(STRUCTURED_GRADIENT_TYPE::NONE_GRADIENT));
     return vlist;
   }
 
-  gl::Texture3D* DataManager::GenerateGradientWithComputeShader ()
+  gl::Texture3D* DataManager::GenerateGradientWithComputeShader (int downsampling)
   {
+    TRACE_SCOPE("GenerateGradientWithComputeShader", "preprocess");
     // Get Current Volume
     vis::StructuredGridVolume* vol = GetCurrentStructuredVolume();
 
@@ -588,88 +873,79 @@ namespace vis
     cpshader->LoadAndLink();
     cpshader->Bind();
     
-    // Initialize 1-channel textures
-    gl::Texture3D* tex3d[3];
-    for (int i = 0; i < 3; i++)
-    {
-      tex3d[i] = new gl::Texture3D(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
-      tex3d[i]->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-      tex3d[i]->SetData(NULL, GL_R16F, GL_RED, GL_FLOAT);
-    
-      glActiveTexture(GL_TEXTURE0 + i);
-      glBindTexture(GL_TEXTURE_3D, tex3d[i]->GetTextureID());
-    }
-    
-    // Bind 1-channel textures
-    for (int i = 0; i < 3; i++)
-      glBindImageTexture(i, tex3d[i]->GetTextureID(), 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_R16F);
+    // The gradient is written by the shader in its final texture, without read back
+    glm::ivec3 vol_dim = glm::ivec3(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
+    glm::ivec3 grad_dim = (vol_dim + downsampling - 1) / downsampling;
+
+    gl::Texture3D* tex3d_gradient = new gl::Texture3D(grad_dim);
+    tex3d_gradient->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+    tex3d_gradient->SetData(NULL, GL_RGBA16F, GL_RGBA, GL_FLOAT);
+    cpshader->BindImageTexture(tex3d_gradient, 0, 0, GL_WRITE_ONLY, GL_RGBA16F);
     
     // Bind volume and volume dimensions
     cpshader->SetUniformTexture3D("TexVolume", GetCurrentVolumeTexture()->GetTextureID(), 3);
     cpshader->BindUniform("TexVolume");
     
-    cpshader->SetUniform("VolumeDimensions", glm::vec3(vol->GetWidth(), vol->GetHeight(), vol->GetDepth()));
+    cpshader->SetUniform("VolumeDimensions", glm::vec3(vol_dim));
     cpshader->BindUniform("VolumeDimensions");
+
+    cpshader->SetUniform("GradientDimensions", glm::vec3(grad_dim));
+    cpshader->BindUniform("GradientDimensions");
+
+    cpshader->SetUniform("Downsampling", downsampling);
+    cpshader->BindUniform("Downsampling");
     
     // Compute the number of groups and dispatch
-    cpshader->RecomputeNumberOfGroups(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
+    cpshader->RecomputeNumberOfGroups(grad_dim.x, grad_dim.y, grad_dim.z);
     cpshader->Dispatch();
+
+    // The renderers sample the texture written as an image
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    glBindImageTexture(0, 0, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    glBindTexture(GL_TEXTURE_3D, 0);
     
     // Delete compute shader
     cpshader->Unbind();
     delete cpshader;
-    
-    // Initialize Red Data
-    GLfloat* red_data = new GLfloat[vol->GetWidth() * vol->GetHeight() * vol->GetDepth()];
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_3D, tex3d[0]->GetTextureID());
-    glGetTexImage(GL_TEXTURE_3D, 0, GL_RED, GL_FLOAT, red_data);
-    glBindTexture(GL_TEXTURE_3D, 0);
-    
-    // Initialize Green Data
-    GLfloat* green_data = new GLfloat[vol->GetWidth() * vol->GetHeight() * vol->GetDepth()];
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_3D, tex3d[1]->GetTextureID());
-    glGetTexImage(GL_TEXTURE_3D, 0, GL_RED, GL_FLOAT, green_data);
-    glBindTexture(GL_TEXTURE_3D, 0);
-    
-    // Initialize Blue Data
-    GLfloat* blue_data = new GLfloat[vol->GetWidth() * vol->GetHeight() * vol->GetDepth()];
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_3D, tex3d[2]->GetTextureID());
-    glGetTexImage(GL_TEXTURE_3D, 0, GL_RED, GL_FLOAT, blue_data);
-    glBindTexture(GL_TEXTURE_3D, 0);
-    
-    // Delete 1-channel textures
-    for (int i = 0; i < 3; i++)
-      delete tex3d[i];
-    
-    // Initialize RGB Gradient Values Array
-    GLfloat* gradient_values = new GLfloat[vol->GetWidth() * vol->GetHeight() * vol->GetDepth() * 3];
-    for (int i = 0; i < vol->GetWidth() * vol->GetHeight() * vol->GetDepth(); i++)
-    {
-      gradient_values[i * 3 + 0] = red_data[i];
-      gradient_values[i * 3 + 1] = green_data[i];
-      gradient_values[i * 3 + 2] = blue_data[i];
-    }
-    
-    // Delete Red Data
-    delete[] red_data;
-    
-    // Delete Green Data
-    delete[] green_data;
-    
-    // Delete Blue Data
-    delete[] blue_data;
-    
-    // Generate a new terxture and set the gradient values [red, green, blue]
-    gl::Texture3D* tex3d_gradient = new gl::Texture3D(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
-    tex3d_gradient->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-    tex3d_gradient->SetData((GLvoid*)gradient_values, GL_RGB16F, GL_RGB, GL_FLOAT);
-    
-    // Delete RGB Gradient Values Array
-    delete[] gradient_values;
   
     return tex3d_gradient;
   }
+
+  gl::Texture3D* DataManager::GeneratePackedVolumeWithComputeShader (bool use_16_bits)
+  {
+    TRACE_SCOPE("GeneratePackedVolumeWithComputeShader", "preprocess");
+    vis::StructuredGridVolume* vol = GetCurrentStructuredVolume();
+    GLint internalformat = use_16_bits ? GL_RGBA16 : GL_RGBA8;
+
+    gl::ComputeShader* cpshader = new gl::ComputeShader();
+    cpshader->SetShaderFile(MAKE_STR(CMAKE_VOLVIS_UTILS_PATH_TO_SHADER)"/_gradient_shading/packed_volume_generator.comp");
+    cpshader->SetDefineFlag("PACKED_VOLUME_RGBA8", !use_16_bits);
+    cpshader->LoadAndLink();
+    cpshader->Bind();
+
+    glm::ivec3 vol_dim = glm::ivec3(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
+
+    gl::Texture3D* tex3d_packed = new gl::Texture3D(vol_dim);
+    tex3d_packed->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+    tex3d_packed->SetData(NULL, internalformat, GL_RGBA, GL_UNSIGNED_BYTE);
+    cpshader->BindImageTexture(tex3d_packed, 0, 0, GL_WRITE_ONLY, internalformat);
+
+    cpshader->SetUniformTexture3D("TexVolume", GetCurrentVolumeTexture()->GetTextureID(), 3);
+    cpshader->BindUniform("TexVolume");
+
+    cpshader->SetUniform("VolumeDimensions", glm::vec3(vol_dim));
+    cpshader->BindUniform("VolumeDimensions");
+
+    cpshader->RecomputeNumberOfGroups(vol_dim.x, vol_dim.y, vol_dim.z);
+    cpshader->Dispatch();
+
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    glBindImageTexture(0, 0, 0, GL_TRUE, 0, GL_WRITE_ONLY, internalformat);
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    cpshader->Unbind();
+    delete cpshader;
+
+    return tex3d_packed;
+  }
 }
\ No newline at end of file
@@ -30,6 +30,11 @@
 #include <volvis_utils/unstructuredgridvolume.h>
 #include <volvis_utils/transferfunction.h>
 #include <volvis_utils/reader.h>
+#include <volvis_utils/datasetcatalog.h>
+#include <volvis_utils/derivedresourceregistry.h>
+
+// Lowest resolution of the gradient texture (1/n per axis) before it is not built at all
+#define GRADIENT_MAX_DOWNSAMPLING 4
 
 #include <gl_utils/texture3d.h>
 #include <gl_utils/texture1d.h>
@@ -62,7 +67,8 @@ namespace vis
       SOBEL_FELDMAN_FILTER = 0,
       FINITE_DIFERENCES    = 1,
       COMPUTE_SHADER_SOBEL = 2,
-      NONE_GRADIENT        = 3
+      SHADER_ON_THE_FLY    = 3,
+      NONE_GRADIENT        = 4
     };
 
     DataManager ();
@@ -73,7 +79,12 @@ namespace vis
     vis::GRID_VOLUME_DATA_TYPE GetInputVolumeDataType ();
     const char* GetStrVolumeDataType ();
 
+    // Reads the dataset and transfer function lists. The first volume is not
+    //   loaded here: until LoadPendingVolume, the dataset catalog describes it
     void ReadData ();
+    bool IsVolumeLoadPending ();
+    // Loads the volume selected by ReadData, if not loaded yet
+    bool LoadPendingVolume ();
 
     // Read data
     int GetNumberOfStructuredDatasets ();
@@ -93,7 +104,27 @@ namespace vis
     // Processed data
     gl::Texture3D* GetCurrentVolumeTexture ();
 
+    // Built here if it was put off while a packed volume texture was in use
     gl::Texture3D* GetCurrentGradientTexture ();
+    // Renderers that read the gradient texture, counted while they are built
+    //   (current or warm standby). The gradient texture is always kept while
+    //   there is one, packed volume textures or not.
+    void AddGradientTextureUser ();
+    void RemoveGradientTextureUser ();
+    // SHADER_ON_THE_FLY: no gradient texture, the renderers compute
+    //   the gradients from the volume texture at each shaded sample
+    bool IsGradientComputedInShader ();
+
+    // Gradient direction and density of the current volume in one filterable
+    //   rgba texture (PACKED_VOLUME path of the ray marching shaders): one
+    //   fetch per shaded sample instead of two. Shared through the derived
+    //   resources, the caller releases it with ReleasePackedVolumeTexture.
+    //   nullptr if it does not fit in the gpu memory budget.
+    // The gradient texture is not kept while a packed volume is in use and no
+    //   renderer reads it: it is built again by GetCurrentGradientTexture when
+    //   a gradient texture user is added, or after the last release.
+    gl::Texture3D* AcquirePackedVolumeTexture (bool use_16_bits = false);
+    void ReleasePackedVolumeTexture (gl::Texture3D* tex_packed);
 
     bool PreviousVolume ();
     bool NextVolume ();
@@ -113,12 +144,33 @@ namespace vis
     std::string CurrentGradientName ();
     std::vector<std::string> GetGradientGenerationTypeStrList ();
  
+    // Content hash of the current structured volume, computed once at load
+    vis::ContentHash128 GetCurrentVolumeContentHash ();
+    // Key of data derived from the current volume: combines its content
+    //   hash with a tag and the parameters used to build the derived data,
+    //   and with the current transfer function if the data depends on it
+    vis::ContentHash128 GetDerivedDataKey (const char* tag, const void* params = nullptr, size_t params_bytesize = 0,
+                                           bool depends_on_transfer_function = false);
+    vis::ContentHash128 GetCurrentTransferFunctionHash ();
+
+    // Textures derived from the current volume and transfer function, shared by the renderers
+    vis::DerivedResourceRegistry* GetDerivedResources ();
+    // Incremented at each change of volume, transfer function or gradient:
+    //   a renderer built with another version must be built again
+    unsigned int GetDataVersion ();
+
+    // Metadata of the listed datasets, available before they are loaded
+    vis::DatasetCatalog* GetDatasetCatalog ();
+    vis::DatasetInfo* GetDatasetInfo (int id);
+
     std::vector<std::string>* GetUINameDatasetListPtr ();
     std::vector<std::string>* GetUINameTransferFunctionListPtr ();
 
     void DeleteVolumeData ();
     void DeleteTransferFunctionData ();
     void DeleteGradientData ();
+    // False while only packed volume textures hold the gradients
+    bool IsGradientTextureNeeded ();
   protected:
 
     void ReadStructuredDatasetsFromRes ();
@@ -126,12 +178,22 @@ namespace vis
 
     bool GenerateStructuredVolumeTexture ();
     bool GenerateStructuredGradientTexture ();
+    // Downsampling of the gradient texture that fits in the gpu memory budget, 0 if none
+    int ReserveGradientMemory ();
+
+    // Compute Shaders doesn't support rgb images, so the
+    //  shader writes a rgba16f texture (rgb: gradient,
+    //  a: magnitude) that is used as is: no read back and
+    //  no upload, the volume texture never leaves the gpu
+    gl::Texture3D* GenerateGradientWithComputeShader (int downsampling = 1);
+
+    // rgb: gradient direction * 0.5 + 0.5, a: density
+    gl::Texture3D* GeneratePackedVolumeWithComputeShader (bool use_16_bits);
 
-    // Compute Shaders doesn't support rgb textures, so
-    //  we bind 3 r textures, set the data in the shader,
-    //  then we group into a single array and set into a
-    //  new rgb texture using glTexImage3D 
-    gl::Texture3D* GenerateGradientWithComputeShader ();
+    // gl::GPUMemoryRegistry eviction callback: unreferenced derived textures
+    static bool EvictDerivedResource (void* data);
+
+    vis::ContentHash128 GetGradientKey ();
     
     vis::GRID_VOLUME_DATA_TYPE curr_vol_data_type;
     bool use_specific_lookup_data_shader;
@@ -140,6 +202,11 @@ namespace vis
     std::vector<DataReference> stored_structured_datasets;
     std::vector<DataReference> stored_transfer_functions;
 
+    vis::DatasetCatalog m_dataset_catalog;
+
+    vis::DerivedResourceRegistry m_derived_resources;
+    unsigned int m_data_version;
+
     // structured datasets
     vis::StructuredGridVolume* curr_vr_volume;
     gl::Texture3D* curr_gl_tex_structured_volume;
@@ -155,6 +222,15 @@ namespace vis
 
     STRUCTURED_GRADIENT_TYPE curr_gradient_comp_model;
     gl::Texture3D* curr_gl_tex_structured_gradient;
+    vis::ContentHash128 curr_gradient_key;
+    // Packed volume textures acquired and not released yet
+    int m_packed_volume_users;
+    // Renderers that read the gradient texture
+    int m_gradient_texture_users;
+    // Gradient texture not built because of the packed volume textures
+    bool m_gradient_pending;
+    // Current volume selected by ReadData and not loaded yet
+    bool m_volume_load_pending;
 
     std::string m_path_to_data;
 
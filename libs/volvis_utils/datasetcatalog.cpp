@@ -0,0 +1,364 @@
+/**
+ * datasetcatalog.cpp
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#include <volvis_utils/datasetcatalog.h>
+#include <volvis_utils/proceduralvolume.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+
+#include <gl_utils/tracer.h>
+
+namespace vis
+{
+  DatasetInfo::DatasetInfo ()
+    : path("")
+    , file_size(0)
+    , file_mtime(0)
+    , header_available(false)
+    , width(0), height(0), depth(0)
+    , bytes_per_voxel(0)
+    , scalex(1.0), scaley(1.0), scalez(1.0)
+    , statistics_available(false)
+    , min_value(0.0), max_value(0.0)
+  {}
+
+  DatasetInfo::~DatasetInfo ()
+  {}
+
+  size_t DatasetInfo::GetNumberOfVoxels ()
+  {
+    return (size_t)width * (size_t)height * (size_t)depth;
+  }
+
+  size_t DatasetInfo::GetSizeInBytes ()
+  {
+    return GetNumberOfVoxels() * (size_t)bytes_per_voxel;
+  }
+
+  DatasetCatalog::DatasetCatalog ()
+    : m_cache_filepath("")
+  {}
+
+  DatasetCatalog::~DatasetCatalog ()
+  {
+    m_datasets.clear();
+  }
+
+  void DatasetCatalog::SetCacheFilePath (std::string filepath)
+  {
+    m_cache_filepath = filepath;
+  }
+
+  bool DatasetCatalog::ReadCacheFile ()
+  {
+    std::ifstream f_cache(m_cache_filepath);
+    if (!f_cache.is_open())
+      return false;
+
+    // Entries written by another version of the catalog are probed again
+    std::string line;
+    if (!std::getline(f_cache, line) || line != DATASET_CATALOG_CACHE_VERSION)
+    {
+      f_cache.close();
+      return false;
+    }
+
+    while (std::getline(f_cache, line))
+    {
+      size_t start_path = line.find_first_of('<');
+      size_t end_path = line.find_first_of('>');
+      if (start_path == std::string::npos || end_path == std::string::npos)
+        continue;
+
+      DatasetInfo info;
+      info.path = line.substr(start_path + 1, end_path - start_path - 1);
+
+      std::istringstream s_values(line.substr(end_path + 1));
+      int header_available, statistics_available;
+      std::string content_hash;
+      size_t n_bins;
+      s_values >> info.file_size >> info.file_mtime
+               >> header_available >> info.width >> info.height >> info.depth
+               >> info.bytes_per_voxel >> info.scalex >> info.scaley >> info.scalez
+               >> statistics_available >> info.min_value >> info.max_value
+               >> content_hash >> n_bins;
+      if (s_values.fail())
+        continue;
+
+      info.content_hash = ContentHash128::FromString(content_hash);
+      info.header_available = header_available == 1;
+      info.statistics_available = statistics_available == 1;
+      info.histogram.resize(n_bins);
+      for (size_t i = 0; i < n_bins; i++)
+        s_values >> info.histogram[i];
+      if (s_values.fail())
+        continue;
+
+      m_datasets[info.path] = info;
+    }
+    f_cache.close();
+
+    return true;
+  }
+
+  bool DatasetCatalog::WriteCacheFile ()
+  {
+    std::ofstream f_cache(m_cache_filepath);
+    if (!f_cache.is_open())
+    {
+      std::cout << "Error: Unable to write dataset catalog cache." << std::endl;
+      return false;
+    }
+
+    f_cache.precision(17);
+    f_cache << DATASET_CATALOG_CACHE_VERSION << "\n";
+    for (std::map<std::string, DatasetInfo>::iterator it = m_datasets.begin(); it != m_datasets.end(); ++it)
+    {
+      DatasetInfo& info = it->second;
+      f_cache << "<" << info.path << "> "
+              << info.file_size << " " << info.file_mtime << " "
+              << (info.header_available ? 1 : 0) << " "
+              << info.width << " " << info.height << " " << info.depth << " "
+              << info.bytes_per_voxel << " "
+              << info.scalex << " " << info.scaley << " " << info.scalez << " "
+              << (info.statistics_available ? 1 : 0) << " "
+              << info.min_value << " " << info.max_value << " "
+              << info.content_hash.ToString() << " " << info.histogram.size();
+      for (size_t i = 0; i < info.histogram.size(); i++)
+        f_cache << " " << info.histogram[i];
+      f_cache << "\n";
+    }
+    f_cache.close();
+
+    return true;
+  }
+
+  void DatasetCatalog::ProbeDatasets (const std::vector<std::string>& filepaths)
+  {
+    std::vector<DatasetInfo> probed(filepaths.size());
+    std::vector<char> reuse_cache(filepaths.size(), 0);
+
+    for (size_t i = 0; i < filepaths.size(); i++)
+    {
+      probed[i].path = filepaths[i];
+      GetFileStamp(filepaths[i], &probed[i].file_size, &probed[i].file_mtime);
+
+      std::map<std::string, DatasetInfo>::iterator it = m_datasets.find(filepaths[i]);
+      if (it != m_datasets.end()
+       && it->second.file_size == probed[i].file_size
+       && it->second.file_mtime == probed[i].file_mtime)
+      {
+        reuse_cache[i] = 1;
+      }
+    }
+
+    // Each probe only reads a file name or a few header bytes
+#pragma omp parallel for schedule(dynamic)
+    for (long long i = 0; i < (long long)filepaths.size(); i++)
+    {
+      if (!reuse_cache[i])
+        ProbeHeader(&probed[i]);
+    }
+
+    int n_probed = 0;
+    for (size_t i = 0; i < filepaths.size(); i++)
+    {
+      if (reuse_cache[i]) continue;
+      m_datasets[filepaths[i]] = probed[i];
+      n_probed++;
+    }
+
+    printf("  - Dataset catalog: %d cached, %d probed\n", (int)filepaths.size() - n_probed, n_probed);
+  }
+
+  template<typename T>
+  static void ComputeVoxelStatistics (T* voxels, size_t n_voxels, double max_density,
+                                      double* min_value, double* max_value,
+                                      std::vector<unsigned long long>& histogram)
+  {
+    int n_bins = (int)histogram.size();
+    double v_min = max_density, v_max = 0.0;
+
+#pragma omp parallel
+    {
+      TRACE_SCOPE("ComputeVoxelStatistics", "worker");
+      std::vector<unsigned long long> t_histogram(n_bins, 0);
+      double t_min = max_density, t_max = 0.0;
+
+#pragma omp for
+      for (long long i = 0; i < (long long)n_voxels; i++)
+      {
+        double v = (double)voxels[i] / max_density;
+        t_min = glm::min(t_min, v);
+        t_max = glm::max(t_max, v);
+        t_histogram[glm::clamp((int)(v * (double)n_bins), 0, n_bins - 1)]++;
+      }
+
+#pragma omp critical
+      {
+        v_min = glm::min(v_min, t_min);
+        v_max = glm::max(v_max, t_max);
+        for (int b = 0; b < n_bins; b++)
+          histogram[b] += t_histogram[b];
+      }
+    }
+
+    *min_value = v_min;
+    *max_value = v_max;
+  }
+
+  void DatasetCatalog::UpdateStatistics (std::string filepath, StructuredGridVolume* vol)
+  {
+    if (vol == nullptr || vol->GetArrayData() == nullptr)
+      return;
+
+    DatasetInfo& info = m_datasets[filepath];
+    info.path = filepath;
+    GetFileStamp(filepath, &info.file_size, &info.file_mtime);
+
+    DataStorageSize dss = vol->GetDataStorageSize();
+
+    info.header_available = true;
+    info.width  = vol->GetWidth();
+    info.height = vol->GetHeight();
+    info.depth  = vol->GetDepth();
+    info.bytes_per_voxel = dss == DataStorageSize::_8_BITS       ? 1
+                         : dss == DataStorageSize::_16_BITS      ? 2
+                         : dss == DataStorageSize::_NORMALIZED_F ? 4 : 8;
+    info.scalex = vol->GetScaleX();
+    info.scaley = vol->GetScaleY();
+    info.scalez = vol->GetScaleZ();
+
+    info.histogram.assign(DATASET_CATALOG_HISTOGRAM_BINS, 0);
+    size_t n_voxels = vol->GetNumberOfVoxels();
+    if (dss == DataStorageSize::_8_BITS)
+      ComputeVoxelStatistics(static_cast<unsigned char*>(vol->GetArrayData()), n_voxels, 255.0, &info.min_value, &info.max_value, info.histogram);
+    else if (dss == DataStorageSize::_16_BITS)
+      ComputeVoxelStatistics(static_cast<unsigned short*>(vol->GetArrayData()), n_voxels, 65535.0, &info.min_value, &info.max_value, info.histogram);
+    else if (dss == DataStorageSize::_NORMALIZED_F)
+      ComputeVoxelStatistics(static_cast<float*>(vol->GetArrayData()), n_voxels, 1.0, &info.min_value, &info.max_value, info.histogram);
+    else if (dss == DataStorageSize::_NORMALIZED_D)
+      ComputeVoxelStatistics(static_cast<double*>(vol->GetArrayData()), n_voxels, 1.0, &info.min_value, &info.max_value, info.histogram);
+
+    info.content_hash = vol->GetContentHash();
+    info.statistics_available = true;
+  }
+
+  DatasetInfo* DatasetCatalog::GetDatasetInfo (std::string filepath)
+  {
+    std::map<std::string, DatasetInfo>::iterator it = m_datasets.find(filepath);
+    if (it == m_datasets.end())
+      return nullptr;
+    return &it->second;
+  }
+
+  bool DatasetCatalog::GetFileStamp (std::string filepath, unsigned long long* file_size, long long* file_mtime)
+  {
+    std::error_code ec;
+    std::filesystem::path fpath(filepath);
+
+    *file_size = 0;
+    *file_mtime = 0;
+
+    if (!std::filesystem::is_regular_file(fpath, ec))
+      return false;
+
+    *file_size = (unsigned long long)std::filesystem::file_size(fpath, ec);
+    if (ec) return false;
+
+    *file_mtime = (long long)std::filesystem::last_write_time(fpath, ec).time_since_epoch().count();
+    return !ec;
+  }
+
+  ////////////////////////////////////////////////////////////////////////
+  // Protected Methods
+  ////////////////////////////////////////////////////////////////////////
+  bool DatasetCatalog::ProbeHeader (DatasetInfo* info)
+  {
+    std::string extension = info->path.substr(info->path.find_last_of('.') + 1);
+
+    if (extension.compare("raw") == 0)
+      info->header_available = ProbeRawFileName(info);
+    else if (extension.compare("proc") == 0)
+      info->header_available = ProbeProceduralFileName(info);
+    else if (extension.compare("pvm") == 0 || extension.compare("pvmold") == 0)
+      info->header_available = ProbePvmHeader(info);
+    else
+      info->header_available = false;
+
+    // A new probe means the file changed, older statistics are not valid
+    info->statistics_available = false;
+    info->histogram.clear();
+
+    return info->header_available;
+  }
+
+  // <name>.<bytes>.<width>x<height>x<depth>.raw, same as VolumeReader::readraw
+  bool DatasetCatalog::ProbeRawFileName (DatasetInfo* info)
+  {
+    std::string filename = info->path.substr(info->path.find_last_of("/\\") + 1);
+    filename = filename.substr(0, filename.find_last_of('.'));
+
+    size_t foundsizes = filename.find_last_of('.');
+    if (foundsizes == std::string::npos) return false;
+    std::string t_filesizes = filename.substr(foundsizes + 1);
+
+    filename = filename.substr(0, foundsizes);
+    size_t foundbytesize = filename.find_last_of('.');
+    if (foundbytesize == std::string::npos) return false;
+
+    size_t foundw = t_filesizes.find_first_of('x');
+    size_t foundd = t_filesizes.find_last_of('x');
+    if (foundw == std::string::npos || foundd == foundw) return false;
+
+    info->width  = atoi(t_filesizes.substr(0, foundw).c_str());
+    info->height = atoi(t_filesizes.substr(foundw + 1, foundd - foundw - 1).c_str());
+    info->depth  = atoi(t_filesizes.substr(foundd + 1).c_str());
+    info->bytes_per_voxel = atoi(filename.substr(foundbytesize + 1).c_str());
+    info->scalex = info->scaley = info->scalez = 1.0;
+
+    return info->GetSizeInBytes() > 0;
+  }
+
+  bool DatasetCatalog::ProbeProceduralFileName (DatasetInfo* info)
+  {
+    ProceduralVolumeParameters params;
+    if (!params.ParseFileName(info->path))
+      return false;
+
+    info->width  = params.width;
+    info->height = params.height;
+    info->depth  = params.depth;
+    info->bytes_per_voxel = params.bytes_per_voxel;
+    info->scalex = info->scaley = info->scalez = 1.0;
+
+    return true;
+  }
+
+  // Only uncompressed files can be probed, "DDS v3d" files must be
+  //   decoded entirely, so they get their metadata on the first load
+  bool DatasetCatalog::ProbePvmHeader (DatasetInfo* info)
+  {
+    std::ifstream f_pvm(info->path, std::ios::binary);
+    if (!f_pvm.is_open())
+      return false;
+
+    std::string magic;
+    std::getline(f_pvm, magic);
+    if (magic.compare("PVM") != 0 && magic.compare("PVM2") != 0 && magic.compare("PVM3") != 0)
+      return false;
+
+    f_pvm >> info->width >> info->height >> info->depth;
+    if (magic.compare("PVM") != 0)
+      f_pvm >> info->scalex >> info->scaley >> info->scalez;
+    f_pvm >> info->bytes_per_voxel;
+
+    return !f_pvm.fail() && info->GetSizeInBytes() > 0;
+  }
+}
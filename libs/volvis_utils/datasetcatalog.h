@@ -0,0 +1,96 @@
+/**
+ * datasetcatalog.h
+ *
+ * Metadata of the structured datasets listed in "#list_structured_datasets",
+ *   available without reading the voxel data:
+ * . dimensions, bytes per voxel and scale come from header-only probes
+ *   (.raw and .proc file names, uncompressed .pvm headers), run in
+ *   parallel when the dataset list is read
+ * . histogram, min/max and content hash are filled the first time a
+ *   dataset is loaded
+ *
+ * Everything is persisted in a sidecar cache file next to the dataset list
+ *   ("#cache_structured_datasets"). Each entry is keyed by the file path,
+ *   size and modification time, so a changed file is probed again.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef VOL_VIS_UTILS_DATASET_CATALOG_H
+#define VOL_VIS_UTILS_DATASET_CATALOG_H
+
+#include <volvis_utils/structuredgridvolume.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#define DATASET_CATALOG_HISTOGRAM_BINS 256
+#define DATASET_CATALOG_CACHE_VERSION "#dataset_catalog 2"
+
+namespace vis
+{
+  class DatasetInfo
+  {
+  public:
+    DatasetInfo ();
+    ~DatasetInfo ();
+
+    size_t GetNumberOfVoxels ();
+    size_t GetSizeInBytes ();
+
+    std::string path;
+
+    // Cache key, along with the path
+    unsigned long long file_size;
+    long long file_mtime;
+
+    // Header probe
+    bool header_available;
+    unsigned int width, height, depth;
+    unsigned int bytes_per_voxel;
+    double scalex, scaley, scalez;
+
+    // Filled from the voxel data
+    bool statistics_available;
+    double min_value, max_value;
+    ContentHash128 content_hash;
+    std::vector<unsigned long long> histogram;
+  };
+
+  class DatasetCatalog
+  {
+  public:
+    DatasetCatalog ();
+    ~DatasetCatalog ();
+
+    void SetCacheFilePath (std::string filepath);
+
+    bool ReadCacheFile ();
+    bool WriteCacheFile ();
+
+    // Reuse cached entries with matching size and mtime and probe the
+    //   headers of all the remaining paths in parallel
+    void ProbeDatasets (const std::vector<std::string>& filepaths);
+
+    // Fill histogram, min/max and content hash of an already loaded volume
+    void UpdateStatistics (std::string filepath, StructuredGridVolume* vol);
+
+    DatasetInfo* GetDatasetInfo (std::string filepath);
+
+    static bool GetFileStamp (std::string filepath, unsigned long long* file_size, long long* file_mtime);
+
+  protected:
+    static bool ProbeHeader (DatasetInfo* info);
+    static bool ProbeRawFileName (DatasetInfo* info);
+    static bool ProbeProceduralFileName (DatasetInfo* info);
+    static bool ProbePvmHeader (DatasetInfo* info);
+
+    std::string m_cache_filepath;
+    std::map<std::string, DatasetInfo> m_datasets;
+
+  private:
+  };
+}
+
+#endif
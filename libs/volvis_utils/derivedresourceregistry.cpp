@@ -0,0 +1,231 @@
+/**
+ * derivedresourceregistry.cpp
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#include <volvis_utils/derivedresourceregistry.h>
+
+#include <gl_utils/gpumemoryregistry.h>
+
+#include <cstdio>
+#include <iterator>
+
+namespace vis
+{
+  DerivedResourceRegistry::DerivedResourceRegistry ()
+    : m_warm_standby(false)
+    , m_budget_bytes(DERIVED_RESOURCES_DEFAULT_BUDGET_BYTES)
+    , m_use_counter(0)
+    , m_hits(0)
+    , m_misses(0)
+  {
+  }
+
+  DerivedResourceRegistry::~DerivedResourceRegistry ()
+  {
+    Clear();
+  }
+
+  gl::Texture3D* DerivedResourceRegistry::Acquire (const vis::ContentHash128& key)
+  {
+    std::map<vis::ContentHash128, Entry>::iterator it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+      m_misses++;
+      return nullptr;
+    }
+
+    m_hits++;
+    it->second.references++;
+    it->second.last_use = ++m_use_counter;
+    return it->second.texture;
+  }
+
+  gl::Texture3D* DerivedResourceRegistry::Add (const vis::ContentHash128& key, gl::Texture3D* tex, size_t bytesize, unsigned int dependencies)
+  {
+    if (tex == nullptr) return nullptr;
+
+    // Built twice (e.g. without an Acquire first): the registered texture is kept
+    std::map<vis::ContentHash128, Entry>::iterator it = m_entries.find(key);
+    if (it != m_entries.end() && it->second.texture != tex)
+    {
+      printf("Warning: derived resource %s was built again, the registered texture is used\n", key.ToString().c_str());
+      delete tex;
+      it->second.references++;
+      it->second.last_use = ++m_use_counter;
+      return it->second.texture;
+    }
+
+    Entry entry;
+    entry.texture = tex;
+    entry.bytesize = bytesize;
+    entry.dependencies = dependencies;
+    entry.references = 1;
+    entry.last_use = ++m_use_counter;
+    m_entries[key] = entry;
+    gl::GPUMemoryRegistry::Instance()->SetOwner(tex, "derived resources", gl::GPU_MEMORY_CACHE);
+
+    Trim();
+    return tex;
+  }
+
+  void DerivedResourceRegistry::Release (gl::Texture3D* tex)
+  {
+    if (tex == nullptr) return;
+
+    for (std::map<vis::ContentHash128, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+      if (it->second.texture != tex) continue;
+
+      it->second.references--;
+      if (it->second.references <= 0)
+      {
+        it->second.references = 0;
+        if (!m_warm_standby)
+          Erase(it);
+        else
+          Trim();
+      }
+      return;
+    }
+
+    for (int i = 0; i < m_stale_entries.size(); i++)
+    {
+      if (m_stale_entries[i].texture != tex) continue;
+
+      m_stale_entries[i].references--;
+      if (m_stale_entries[i].references <= 0)
+      {
+        delete m_stale_entries[i].texture;
+        m_stale_entries.erase(m_stale_entries.begin() + i);
+      }
+      return;
+    }
+  }
+
+  void DerivedResourceRegistry::Invalidate (unsigned int dependencies)
+  {
+    std::map<vis::ContentHash128, Entry>::iterator it = m_entries.begin();
+    while (it != m_entries.end())
+    {
+      std::map<vis::ContentHash128, Entry>::iterator next = std::next(it);
+      if (it->second.dependencies & dependencies)
+      {
+        if (it->second.references > 0)
+        {
+          m_stale_entries.push_back(it->second);
+          m_entries.erase(it);
+        }
+        else
+          Erase(it);
+      }
+      it = next;
+    }
+  }
+
+  void DerivedResourceRegistry::SetWarmStandby (bool enabled)
+  {
+    m_warm_standby = enabled;
+    if (m_warm_standby) return;
+
+    // Nothing is kept without references anymore
+    std::map<vis::ContentHash128, Entry>::iterator it = m_entries.begin();
+    while (it != m_entries.end())
+    {
+      std::map<vis::ContentHash128, Entry>::iterator next = std::next(it);
+      if (it->second.references == 0) Erase(it);
+      it = next;
+    }
+  }
+
+  bool DerivedResourceRegistry::IsWarmStandbyEnabled ()
+  {
+    return m_warm_standby;
+  }
+
+  void DerivedResourceRegistry::SetMemoryBudget (size_t bytesize)
+  {
+    m_budget_bytes = bytesize;
+    Trim();
+  }
+
+  size_t DerivedResourceRegistry::GetMemoryBudget ()
+  {
+    return m_budget_bytes;
+  }
+
+  bool DerivedResourceRegistry::Trim ()
+  {
+    while (GetTotalBytes() > m_budget_bytes)
+    {
+      if (!EvictLeastRecentlyUsed()) return false;
+    }
+    return true;
+  }
+
+  bool DerivedResourceRegistry::EvictLeastRecentlyUsed ()
+  {
+    std::map<vis::ContentHash128, Entry>::iterator lru = m_entries.end();
+    for (std::map<vis::ContentHash128, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+      if (it->second.references == 0 && (lru == m_entries.end() || it->second.last_use < lru->second.last_use))
+        lru = it;
+    }
+    if (lru == m_entries.end()) return false;
+
+    Erase(lru);
+    return true;
+  }
+
+  int DerivedResourceRegistry::GetNumberOfResources ()
+  {
+    return (int)m_entries.size();
+  }
+
+  size_t DerivedResourceRegistry::GetTotalBytes ()
+  {
+    size_t total = 0;
+    for (std::map<vis::ContentHash128, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+      total += it->second.bytesize;
+    for (int i = 0; i < m_stale_entries.size(); i++)
+      total += m_stale_entries[i].bytesize;
+    return total;
+  }
+
+  size_t DerivedResourceRegistry::GetUnreferencedBytes ()
+  {
+    size_t total = 0;
+    for (std::map<vis::ContentHash128, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+      if (it->second.references == 0)
+        total += it->second.bytesize;
+    return total;
+  }
+
+  int DerivedResourceRegistry::GetNumberOfHits ()
+  {
+    return m_hits;
+  }
+
+  int DerivedResourceRegistry::GetNumberOfMisses ()
+  {
+    return m_misses;
+  }
+
+  void DerivedResourceRegistry::Clear ()
+  {
+    for (std::map<vis::ContentHash128, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+      delete it->second.texture;
+    m_entries.clear();
+
+    for (int i = 0; i < m_stale_entries.size(); i++)
+      delete m_stale_entries[i].texture;
+    m_stale_entries.clear();
+  }
+
+  void DerivedResourceRegistry::Erase (std::map<vis::ContentHash128, Entry>::iterator it)
+  {
+    delete it->second.texture;
+    m_entries.erase(it);
+  }
+}
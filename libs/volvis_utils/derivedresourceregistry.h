@@ -0,0 +1,110 @@
+/**
+ * derivedresourceregistry.h
+ *
+ * Textures derived from the current volume and transfer function (summed
+ *   area tables, extinction coefficient volumes...), shared by the volume
+ *   renderers through the DataManager instead of being built by each one.
+ *
+ * Each texture is keyed by DataManager::GetDerivedDataKey (volume content,
+ *   transfer function, tag and build parameters) and reference counted:
+ *   a renderer acquires it in Init and releases it in Clean.
+ * . A change of volume or transfer function invalidates the textures that
+ *   depend on it: unreferenced ones are deleted at once, referenced ones at
+ *   their last release, and none of them is returned again.
+ * . Without warm standby, a texture is deleted at its last release. With
+ *   warm standby, unreferenced textures are kept for the next acquire while
+ *   the total size fits in the memory budget, least recently used ones are
+ *   deleted first.
+ * . The textures are accounted as cache memory in gl::GPUMemoryRegistry:
+ *   EvictLeastRecentlyUsed frees them when the gpu memory budget is exceeded.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef VOL_VIS_UTILS_DERIVED_RESOURCE_REGISTRY_H
+#define VOL_VIS_UTILS_DERIVED_RESOURCE_REGISTRY_H
+
+#include <vis_utils/contenthash.h>
+#include <gl_utils/texture3d.h>
+
+#include <map>
+#include <vector>
+
+// 1 GiB of derived textures
+#define DERIVED_RESOURCES_DEFAULT_BUDGET_BYTES ((size_t)1 << 30)
+
+namespace vis
+{
+  // Data a derived texture was built from
+  enum DERIVED_RESOURCE_DEPENDENCY : unsigned int {
+    DEPENDS_ON_VOLUME            = 1,
+    DEPENDS_ON_TRANSFER_FUNCTION = 2,
+  };
+
+  class DerivedResourceRegistry
+  {
+  public:
+    DerivedResourceRegistry ();
+    ~DerivedResourceRegistry ();
+
+    // Returns the texture of the key with one more reference, or nullptr if there is none
+    gl::Texture3D* Acquire (const vis::ContentHash128& key);
+    // Registers a texture built by the caller, who holds its first reference. The
+    //   registry owns the texture from now on. dependencies: DERIVED_RESOURCE_DEPENDENCY bits.
+    //   If the key is already registered, tex is deleted and the registered texture is returned.
+    gl::Texture3D* Add (const vis::ContentHash128& key, gl::Texture3D* tex, size_t bytesize, unsigned int dependencies);
+    // Drops a reference to a texture returned by Acquire or Add
+    void Release (gl::Texture3D* tex);
+
+    // The textures built from the given data are not returned anymore
+    void Invalidate (unsigned int dependencies);
+
+    void SetWarmStandby (bool enabled);
+    bool IsWarmStandbyEnabled ();
+    void SetMemoryBudget (size_t bytesize);
+    size_t GetMemoryBudget ();
+
+    // Deletes unreferenced textures, least recently used first, until the total
+    //   size fits in the budget. Returns false if the referenced ones alone exceed it.
+    bool Trim ();
+    // Deletes the least recently used unreferenced texture. Returns false if there is none.
+    bool EvictLeastRecentlyUsed ();
+
+    int GetNumberOfResources ();
+    size_t GetTotalBytes ();
+    size_t GetUnreferencedBytes ();
+    int GetNumberOfHits ();
+    int GetNumberOfMisses ();
+
+    // Deletes all the textures, referenced or not
+    void Clear ();
+
+  protected:
+
+  private:
+    class Entry
+    {
+    public:
+      gl::Texture3D* texture;
+      size_t bytesize;
+      unsigned int dependencies;
+      int references;
+      unsigned long long last_use;
+    };
+
+    void Erase (std::map<vis::ContentHash128, Entry>::iterator it);
+
+    std::map<vis::ContentHash128, Entry> m_entries;
+    // Invalidated while referenced: deleted at their last release
+    std::vector<Entry> m_stale_entries;
+
+    bool m_warm_standby;
+    size_t m_budget_bytes;
+
+    unsigned long long m_use_counter;
+    int m_hits;
+    int m_misses;
+  };
+}
+
+#endif
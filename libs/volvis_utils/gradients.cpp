@@ -0,0 +1,141 @@
+#include "gradients.h"
+
+#include <cmath>
+
+namespace vis
+{
+  glm::dvec3* ComputeGradients (StructuredGridVolume* vol, int gradient_sample_size,
+    int filter_nxnxn, bool normalized_gradient)
+  {
+    int width = vol->GetWidth();
+    int height = vol->GetHeight();
+    int depth = vol->GetDepth();
+
+    //1
+    //Generation of gradients
+    int n = gradient_sample_size;
+    glm::dvec3* gradients = AllocateVoxelArray<glm::dvec3>(width, height, depth);
+    glm::dvec3 s1, s2;
+    size_t index = 0;
+    for (int z = 0; z < depth; z++)
+    {
+      for (int y = 0; y < height; y++)
+      {
+        for (int x = 0; x < width; x++)
+        {
+          s1.x = vol->GetNormalizedSample(x - n, y, z);
+          s2.x = vol->GetNormalizedSample(x + n, y, z);
+          s1.y = vol->GetNormalizedSample(x, y - n, z);
+          s2.y = vol->GetNormalizedSample(x, y + n, z);
+          s1.z = vol->GetNormalizedSample(x, y, z - n);
+          s2.z = vol->GetNormalizedSample(x, y, z + n);
+
+          glm::dvec3 s2s1 = (s2 - s1);
+
+          if (normalized_gradient)
+          {
+            s2s1 = glm::normalize<double>(s2s1);
+          }
+          else
+          {
+            s2s1.x = s2s1.x / 2.0f * (float)gradient_sample_size;
+            s2s1.y = s2s1.y / 2.0f * (float)gradient_sample_size;
+            s2s1.z = s2s1.z / 2.0f * (float)gradient_sample_size;
+          }
+
+          gradients[index] = s2s1;
+
+          if (gradients[index].x != gradients[index].x) //lm.IsNaN
+            gradients[index] = glm::dvec3(0);
+
+          index++;
+        }
+      }
+    }
+
+    //2
+    //Filtering
+    n = filter_nxnxn;
+    index = 0;
+    if (n > 0)
+    {
+      for (int z = 0; z < depth; z++)
+      {
+        for (int y = 0; y < height; y++)
+        {
+          for (int x = 0; x < width; x++)
+          {
+            int fn = (n - 1) / 2;
+
+            glm::dvec3 average = glm::dvec3(0);
+            int num = 0;
+            for (int k = z - fn; k <= z + fn; k++)
+            {
+              for (int j = y - fn; j <= y + fn; j++)
+              {
+                for (int i = x - fn; i <= x + fn; i++)
+                {
+                  if (!vol->IsOutOfBoundary(i, j, k))
+                  {
+                    average += gradients[vol->GetVoxelIndex(x, y, z)];
+                    num++;
+                  }
+                }
+              }
+            }
+
+            average = average / (double)num;
+            if (average.x != 0.0f && average.y != 0.0f && average.z != 0.0f)
+              average = glm::normalize<double>(average);
+
+            gradients[index++] = average;
+          }
+        }
+      }
+    }
+
+    return gradients;
+  }
+
+  glm::dvec3* ComputeSobelFeldmanGradients (StructuredGridVolume* vol)
+  {
+    int width = vol->GetWidth();
+    int height = vol->GetHeight();
+    int depth = vol->GetDepth();
+
+    glm::dvec3* gradients = AllocateVoxelArray<glm::dvec3>(width, height, depth);
+    for (int z = 0; z < depth; z++)
+    {
+      for (int y = 0; y < height; y++)
+      {
+        for (int x = 0; x < width; x++)
+        {
+          // not normalized (for tests...)
+          gradients[vol->GetVoxelIndex(x, y, z)] = ComputeSobelFeldmanGradient(vol, x, y, z);
+        }
+      }
+    }
+
+    return gradients;
+  }
+
+  glm::dvec3 ComputeSobelFeldmanGradient (StructuredGridVolume* vol, int x, int y, int z)
+  {
+    glm::dvec3 sg(0.0);
+    for (int v1 = -1; v1 <= 1; v1++)
+    {
+      for (int v2 = -1; v2 <= 1; v2++)
+      {
+        sg.z += ((double)vol->GetNormalizedSample(x + v1, y + v2, z - 1)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
+          + ((double)vol->GetNormalizedSample(x + v1, y + v2, z + 1)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
+
+        sg.y += ((double)vol->GetNormalizedSample(x + v1, y - 1, z + v2)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
+          + ((double)vol->GetNormalizedSample(x + v1, y + 1, z + v2)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
+
+        sg.x += ((double)vol->GetNormalizedSample(x - 1, y + v2, z + v1)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
+          + ((double)vol->GetNormalizedSample(x + 1, y + v2, z + v1)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
+      }
+    }
+    return sg;
+  }
+}
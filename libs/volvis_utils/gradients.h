@@ -0,0 +1,35 @@
+/**
+ * Cpu gradient generators of structured volumes.
+ *
+ * Both functions return one gradient per voxel, indexed like the volume
+ *   (StructuredGridVolume::GetVoxelIndex). The caller owns the returned array.
+ *   They are kept apart from the texture generators in utils.h, so they can
+ *   be used (and benchmarked) without an OpenGL context.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef VOL_VIS_UTILS_GRADIENTS_H
+#define VOL_VIS_UTILS_GRADIENTS_H
+
+#include <volvis_utils/structuredgridvolume.h>
+
+#include <glm/glm.hpp>
+
+namespace vis
+{
+  // Central differences with a distance of gradient_sample_size voxels. If
+  //   filter_nxnxn > 0, gradients are then averaged in a nxnxn neighborhood.
+  glm::dvec3* ComputeGradients (StructuredGridVolume* vol,
+    int gradient_sample_size = 1,
+    int filter_nxnxn = 0,
+    bool normalized_gradient = true);
+
+  // https://en.wikipedia.org/wiki/Sobel_operator
+  //   Not normalized
+  glm::dvec3* ComputeSobelFeldmanGradients (StructuredGridVolume* vol);
+  // Same gradient, of a single voxel (e.g. for the slabs of a streamed upload)
+  glm::dvec3 ComputeSobelFeldmanGradient (StructuredGridVolume* vol, int x, int y, int z);
+}
+
+#endif
@@ -0,0 +1,404 @@
+/**
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#include "proceduralvolume.h"
+
+#include <fstream>
+#include <random>
+#include <cstdlib>
+#include <cstdio>
+#include <type_traits>
+#include <chrono>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <gl_utils/tracer.h>
+
+namespace vis
+{
+  // Integer hash of a lattice point, so noise values do not depend on the
+  //   order in which voxels are evaluated
+  static unsigned int HashCoordinates (int x, int y, int z, unsigned int seed)
+  {
+    unsigned int h = seed * 0x9E3779B9u;
+    h ^= (unsigned int)x * 0x85EBCA6Bu; h = (h ^ (h >> 15)) * 0x2C1B3C6Du;
+    h ^= (unsigned int)y * 0xC2B2AE35u; h = (h ^ (h >> 13)) * 0x297A2D39u;
+    h ^= (unsigned int)z * 0x27D4EB2Fu; h = (h ^ (h >> 16)) * 0x85EBCA6Bu;
+    return h ^ (h >> 16);
+  }
+
+  static double LatticeValue (int x, int y, int z, unsigned int seed)
+  {
+    return (double)HashCoordinates(x, y, z, seed) / 4294967295.0;
+  }
+
+  // Trilinear value noise with smoothstep weights, p given in lattice units
+  static double ValueNoise (glm::dvec3 p, unsigned int seed)
+  {
+    glm::dvec3 p0 = glm::floor(p);
+    glm::dvec3 t = p - p0;
+    t = t * t * (3.0 - 2.0 * t);
+
+    int x0 = (int)p0.x, y0 = (int)p0.y, z0 = (int)p0.z;
+
+    double c00 = glm::mix(LatticeValue(x0, y0    , z0    , seed), LatticeValue(x0 + 1, y0    , z0    , seed), t.x);
+    double c10 = glm::mix(LatticeValue(x0, y0 + 1, z0    , seed), LatticeValue(x0 + 1, y0 + 1, z0    , seed), t.x);
+    double c01 = glm::mix(LatticeValue(x0, y0    , z0 + 1, seed), LatticeValue(x0 + 1, y0    , z0 + 1, seed), t.x);
+    double c11 = glm::mix(LatticeValue(x0, y0 + 1, z0 + 1, seed), LatticeValue(x0 + 1, y0 + 1, z0 + 1, seed), t.x);
+
+    return glm::mix(glm::mix(c00, c10, t.y), glm::mix(c01, c11, t.y), t.z);
+  }
+
+  static double DistanceToSegment (glm::dvec3 p, glm::dvec3 a, glm::dvec3 b)
+  {
+    glm::dvec3 ab = b - a;
+    double l2 = glm::dot(ab, ab);
+    double t = l2 > 0.0 ? glm::clamp(glm::dot(p - a, ab) / l2, 0.0, 1.0) : 0.0;
+    return glm::length(p - (a + ab * t));
+  }
+
+  ProceduralVolumeParameters::ProceduralVolumeParameters ()
+    : shape(PROCEDURAL_VOLUME_SHAPE::GAUSSIAN_BLOBS)
+    , width(128)
+    , height(128)
+    , depth(128)
+    , bytes_per_voxel(1)
+    , seed(0)
+    , sparsity(0.0)
+    , features(-1)
+  {}
+
+  ProceduralVolumeParameters::~ProceduralVolumeParameters ()
+  {}
+
+  bool ProceduralVolumeParameters::ParseFileName (std::string filepath)
+  {
+    std::string filename = filepath.substr(filepath.find_last_of("/\\") + 1);
+
+    // <shape>.<bytes>.<width>x<height>x<depth>.proc
+    filename = filename.substr(0, filename.find_last_of('.'));
+
+    size_t found_shape = filename.find_first_of('.');
+    size_t found_sizes = filename.find_last_of('.');
+    if (found_shape == std::string::npos || found_sizes == found_shape)
+      return false;
+
+    std::string s_shape = filename.substr(0, found_shape);
+    std::string s_bytes = filename.substr(found_shape + 1, found_sizes - found_shape - 1);
+    std::string s_sizes = filename.substr(found_sizes + 1);
+
+    if      (s_shape.compare("blobs")   == 0) shape = PROCEDURAL_VOLUME_SHAPE::GAUSSIAN_BLOBS;
+    else if (s_shape.compare("noise")   == 0) shape = PROCEDURAL_VOLUME_SHAPE::VALUE_NOISE;
+    else if (s_shape.compare("shells")  == 0) shape = PROCEDURAL_VOLUME_SHAPE::SPHERE_SHELLS;
+    else if (s_shape.compare("vessels") == 0) shape = PROCEDURAL_VOLUME_SHAPE::VESSEL_TREE;
+    else return false;
+
+    bytes_per_voxel = atoi(s_bytes.c_str());
+
+    size_t foundw = s_sizes.find_first_of('x');
+    size_t foundd = s_sizes.find_last_of('x');
+    if (foundw == std::string::npos || foundd == foundw)
+      return false;
+
+    width  = atoi(s_sizes.substr(0, foundw).c_str());
+    height = atoi(s_sizes.substr(foundw + 1, foundd - foundw - 1).c_str());
+    depth  = atoi(s_sizes.substr(foundd + 1).c_str());
+
+    return width > 0 && height > 0 && depth > 0;
+  }
+
+  bool ProceduralVolumeParameters::ReadOptionsFile (std::string filepath)
+  {
+    std::ifstream f_options(filepath);
+    if (!f_options.is_open())
+      return false;
+
+    std::string key;
+    while (f_options >> key)
+    {
+      if      (key.compare("seed")     == 0) f_options >> seed;
+      else if (key.compare("sparsity") == 0) f_options >> sparsity;
+      else if (key.compare("features") == 0) f_options >> features;
+      else
+      {
+        std::string s_line;
+        std::getline(f_options, s_line);
+        printf("  - Unknown .proc option: %s\n", key.c_str());
+      }
+    }
+    f_options.close();
+
+    return true;
+  }
+
+  std::string ProceduralVolumeParameters::GetShapeName (PROCEDURAL_VOLUME_SHAPE shape)
+  {
+    if (shape == PROCEDURAL_VOLUME_SHAPE::GAUSSIAN_BLOBS) return "blobs";
+    if (shape == PROCEDURAL_VOLUME_SHAPE::VALUE_NOISE)    return "noise";
+    if (shape == PROCEDURAL_VOLUME_SHAPE::SPHERE_SHELLS)  return "shells";
+    if (shape == PROCEDURAL_VOLUME_SHAPE::VESSEL_TREE)    return "vessels";
+    return "unknown";
+  }
+
+  ProceduralVolumeGenerator::ProceduralVolumeGenerator ()
+  {}
+
+  ProceduralVolumeGenerator::~ProceduralVolumeGenerator ()
+  {
+    m_capsules.clear();
+  }
+
+  StructuredGridVolume* ProceduralVolumeGenerator::Generate (const ProceduralVolumeParameters& params)
+  {
+    std::string shape_name = ProceduralVolumeParameters::GetShapeName(params.shape);
+
+    printf("Started  -> Generate Procedural Volume\n");
+    printf("  - Shape           : %s\n", shape_name.c_str());
+    printf("  - Volume Size     : [%d, %d, %d]\n", params.width, params.height, params.depth);
+    printf("  - Volume Byte Size: %d\n", params.bytes_per_voxel);
+    printf("  - Seed            : %u\n", params.seed);
+    printf("  - Sparsity        : %.3lf\n", params.sparsity);
+
+    DataStorageSize data_tp = GetStorageSizeType(params.bytes_per_voxel);
+    if (params.width == 0 || params.height == 0 || params.depth == 0
+     || data_tp == DataStorageSize::UNKNOWN || data_tp == DataStorageSize::_NORMALIZED_D)
+    {
+      printf("Finished -> Error on procedural volume parameters\n");
+      return nullptr;
+    }
+
+    std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+
+    m_capsules.clear();
+    if (params.shape == PROCEDURAL_VOLUME_SHAPE::GAUSSIAN_BLOBS)
+      BuildGaussianBlobs(params);
+    else if (params.shape == PROCEDURAL_VOLUME_SHAPE::VESSEL_TREE)
+      BuildVesselTree(params);
+
+    void* scalar_values = nullptr;
+    if (data_tp == DataStorageSize::_8_BITS)
+    {
+      unsigned char* u_sv = AllocateVoxelArray<unsigned char>(params.width, params.height, params.depth);
+      FillVoxelArray(params, u_sv, 255.0);
+      scalar_values = u_sv;
+    }
+    else if (data_tp == DataStorageSize::_16_BITS)
+    {
+      unsigned short* u_sv = AllocateVoxelArray<unsigned short>(params.width, params.height, params.depth);
+      FillVoxelArray(params, u_sv, 65535.0);
+      scalar_values = u_sv;
+    }
+    else if (data_tp == DataStorageSize::_NORMALIZED_F)
+    {
+      float* f_sv = AllocateVoxelArray<float>(params.width, params.height, params.depth);
+      FillVoxelArray(params, f_sv, 1.0);
+      scalar_values = f_sv;
+    }
+
+    StructuredGridVolume* sg_ret = new StructuredGridVolume(shape_name, params.width, params.height, params.depth);
+    sg_ret->SetScale(1.0, 1.0, 1.0);
+
+    // We won't delete the scalar_values, because it will be stored at
+    //   structured grid volume...
+    sg_ret->SetArrayData(scalar_values, data_tp);
+
+#ifdef _OPENMP
+    printf("  - Threads         : %d\n", omp_get_max_threads());
+#endif
+    printf("  - Time            : %.3lf s\n",
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count());
+    printf("Finished -> Generate Procedural Volume\n");
+
+    return sg_ret;
+  }
+
+  void ProceduralVolumeGenerator::BuildGaussianBlobs (const ProceduralVolumeParameters& params)
+  {
+    std::mt19937 generator(params.seed);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+    int n_blobs = params.features > 0 ? params.features : 16;
+    glm::dvec3 dims((double)params.width, (double)params.height, (double)params.depth);
+    double min_dim = glm::min(dims.x, glm::min(dims.y, dims.z));
+
+    for (int i = 0; i < n_blobs; i++)
+    {
+      glm::dvec3 c;
+      c.x = (0.1 + 0.8 * distribution(generator)) * dims.x;
+      c.y = (0.1 + 0.8 * distribution(generator)) * dims.y;
+      c.z = (0.1 + 0.8 * distribution(generator)) * dims.z;
+      double radius    = (0.03 + 0.09 * distribution(generator)) * min_dim;
+      double amplitude = 0.4 + 0.6 * distribution(generator);
+      m_capsules.push_back(Capsule(c, c, radius, amplitude));
+    }
+  }
+
+  void ProceduralVolumeGenerator::BuildVesselTree (const ProceduralVolumeParameters& params)
+  {
+    std::mt19937 generator(params.seed);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+
+    int n_levels = params.features > 0 ? params.features : 6;
+    glm::dvec3 dims((double)params.width, (double)params.height, (double)params.depth);
+    double min_dim = glm::min(dims.x, glm::min(dims.y, dims.z));
+
+    class Branch
+    {
+    public:
+      Branch (glm::dvec3 _origin, glm::dvec3 _dir, double _length, double _radius, int _level)
+        : origin(_origin), dir(_dir), length(_length), radius(_radius), level(_level)
+      {}
+      glm::dvec3 origin, dir;
+      double length, radius;
+      int level;
+    };
+
+    // Root starts at the bottom of the volume growing along +z
+    std::vector<Branch> stack_branches;
+    stack_branches.push_back(Branch(glm::dvec3(dims.x * 0.5, dims.y * 0.5, dims.z * 0.05),
+                                    glm::dvec3(0.0, 0.0, 1.0), dims.z * 0.3, min_dim * 0.025, 0));
+
+    while (!stack_branches.empty())
+    {
+      Branch br = stack_branches.back();
+      stack_branches.pop_back();
+
+      glm::dvec3 end = br.origin + br.dir * br.length;
+      m_capsules.push_back(Capsule(br.origin, end, glm::max(br.radius, 0.75), 1.0));
+
+      if (br.level + 1 >= n_levels) continue;
+
+      // Two children, each one deviated from the parent direction
+      for (int c = 0; c < 2; c++)
+      {
+        glm::dvec3 axis(distribution(generator) - 0.5, distribution(generator) - 0.5, distribution(generator) - 0.5);
+        axis = glm::cross(br.dir, axis);
+        if (glm::length(axis) < 1e-6) axis = glm::dvec3(1.0, 0.0, 0.0);
+        axis = glm::normalize(axis);
+
+        double angle = glm::radians(20.0 + 25.0 * distribution(generator));
+        // Rodrigues rotation of the parent direction around axis
+        glm::dvec3 ndir = br.dir * glm::cos(angle)
+                        + glm::cross(axis, br.dir) * glm::sin(angle)
+                        + axis * glm::dot(axis, br.dir) * (1.0 - glm::cos(angle));
+
+        stack_branches.push_back(Branch(end, glm::normalize(ndir), br.length * 0.75, br.radius * 0.7, br.level + 1));
+      }
+    }
+  }
+
+  void ProceduralVolumeGenerator::EvaluateSlice (const ProceduralVolumeParameters& params, int z, float* slice_values)
+  {
+    int w = params.width;
+    int h = params.height;
+    size_t slice_size = (size_t)w * (size_t)h;
+
+    for (size_t i = 0; i < slice_size; i++)
+      slice_values[i] = 0.0f;
+
+    double pz = (double)z + 0.5;
+
+    if (params.shape == PROCEDURAL_VOLUME_SHAPE::GAUSSIAN_BLOBS
+     || params.shape == PROCEDURAL_VOLUME_SHAPE::VESSEL_TREE)
+    {
+      // Only rasterize the 3-sigma bounding box of each capsule that crosses this slice
+      for (size_t c = 0; c < m_capsules.size(); c++)
+      {
+        const Capsule& cp = m_capsules[c];
+        double cut = cp.radius * 3.0;
+        glm::dvec3 bbmin = glm::min(cp.a, cp.b) - cut;
+        glm::dvec3 bbmax = glm::max(cp.a, cp.b) + cut;
+        if (pz < bbmin.z || pz > bbmax.z) continue;
+
+        int x0 = glm::max(0, (int)bbmin.x), x1 = glm::min(w - 1, (int)bbmax.x);
+        int y0 = glm::max(0, (int)bbmin.y), y1 = glm::min(h - 1, (int)bbmax.y);
+        for (int y = y0; y <= y1; y++)
+        {
+          for (int x = x0; x <= x1; x++)
+          {
+            double dist = DistanceToSegment(glm::dvec3((double)x + 0.5, (double)y + 0.5, pz), cp.a, cp.b);
+            if (dist > cut) continue;
+
+            float v = (float)(cp.amplitude * glm::exp(-(dist * dist) / (2.0 * cp.radius * cp.radius)));
+            size_t id = (size_t)x + (size_t)y * (size_t)w;
+            slice_values[id] = glm::max(slice_values[id], v);
+          }
+        }
+      }
+    }
+    else if (params.shape == PROCEDURAL_VOLUME_SHAPE::VALUE_NOISE)
+    {
+      int n_octaves = params.features > 0 ? params.features : 4;
+      double cell_size = (double)glm::max(params.width, glm::max(params.height, params.depth)) / 8.0;
+      for (int y = 0; y < h; y++)
+      {
+        for (int x = 0; x < w; x++)
+        {
+          glm::dvec3 p = glm::dvec3((double)x + 0.5, (double)y + 0.5, pz) / cell_size;
+          double v = 0.0, amp = 1.0, amp_sum = 0.0;
+          for (int o = 0; o < n_octaves; o++)
+          {
+            v += ValueNoise(p, params.seed + (unsigned int)o) * amp;
+            amp_sum += amp;
+            amp *= 0.5;
+            p *= 2.0;
+          }
+          slice_values[(size_t)x + (size_t)y * (size_t)w] = (float)(v / amp_sum);
+        }
+      }
+    }
+    else if (params.shape == PROCEDURAL_VOLUME_SHAPE::SPHERE_SHELLS)
+    {
+      int n_shells = params.features > 0 ? params.features : 4;
+      glm::dvec3 center = glm::dvec3((double)params.width, (double)params.height, (double)params.depth) * 0.5;
+      double max_radius = glm::min(center.x, glm::min(center.y, center.z));
+      double sigma = 0.25 / (double)(n_shells + 1);
+      for (int y = 0; y < h; y++)
+      {
+        for (int x = 0; x < w; x++)
+        {
+          double r = glm::length(glm::dvec3((double)x + 0.5, (double)y + 0.5, pz) - center) / max_radius;
+          double v = 0.0;
+          for (int s = 1; s <= n_shells; s++)
+          {
+            double dr = r - (double)s / (double)(n_shells + 1);
+            v = glm::max(v, glm::exp(-(dr * dr) / (2.0 * sigma * sigma)) * (double)s / (double)n_shells);
+          }
+          slice_values[(size_t)x + (size_t)y * (size_t)w] = (float)v;
+        }
+      }
+    }
+  }
+
+  template<typename T>
+  void ProceduralVolumeGenerator::FillVoxelArray (const ProceduralVolumeParameters& params, T* voxels, double max_value)
+  {
+    size_t slice_size = (size_t)params.width * (size_t)params.height;
+    double sparsity = glm::clamp(params.sparsity, 0.0, 0.999);
+    double rounding = std::is_floating_point<T>::value ? 0.0 : 0.5;
+
+#pragma omp parallel
+    {
+      TRACE_SCOPE("FillVoxelArray", "worker");
+      std::vector<float> slice_values(slice_size);
+
+#pragma omp for schedule(dynamic)
+      for (long long z = 0; z < (long long)params.depth; z++)
+      {
+        EvaluateSlice(params, (int)z, slice_values.data());
+
+        T* dst = voxels + (size_t)z * slice_size;
+        for (size_t i = 0; i < slice_size; i++)
+        {
+          // Values below the sparsity threshold become empty space
+          double v = glm::clamp((double)slice_values[i], 0.0, 1.0);
+          v = v < sparsity ? 0.0 : (v - sparsity) / (1.0 - sparsity);
+          dst[i] = (T)(v * max_value + rounding);
+        }
+      }
+    }
+  }
+}
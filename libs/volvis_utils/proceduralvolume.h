@@ -0,0 +1,105 @@
+/**
+ * In-memory procedural structured volumes.
+ *
+ * Volumes are generated directly into the final voxel array, slice by
+ *   slice in parallel (OpenMP). Every random decision is taken from the
+ *   seed (feature placement) or from a hash of the voxel coordinates
+ *   (noise), so the same parameters always produce the same volume
+ *   independently of the number of threads.
+ *
+ * Procedural datasets can be registered in "#list_structured_datasets"
+ *   like any other file, following the same naming used by .raw files:
+ * . <shape>.<bytes per voxel>.<width>x<height>x<depth>.proc
+ * . shape: blobs, noise, shells or vessels
+ * . bytes per voxel: 1 (_8_BITS), 2 (_16_BITS) or 4 (_NORMALIZED_F)
+ *
+ * The .proc file does not need to exist. If it does, each line may
+ *   override one parameter as "<key> <value>":
+ * . seed      <unsigned int>
+ * . sparsity  <[0, 1)>, normalized values below it are set to zero
+ * . features  <int>, number of blobs/octaves/shells/vessel branch levels
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef VOL_VIS_UTILS_PROCEDURAL_VOLUME_H
+#define VOL_VIS_UTILS_PROCEDURAL_VOLUME_H
+
+#include <volvis_utils/structuredgridvolume.h>
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace vis
+{
+  enum PROCEDURAL_VOLUME_SHAPE : unsigned int
+  {
+    GAUSSIAN_BLOBS = 0,
+    VALUE_NOISE    = 1,
+    SPHERE_SHELLS  = 2,
+    VESSEL_TREE    = 3,
+  };
+
+  class ProceduralVolumeParameters
+  {
+  public:
+    ProceduralVolumeParameters ();
+    ~ProceduralVolumeParameters ();
+
+    // Fill shape, bytes per voxel and dimensions from a file name written
+    //   as "<shape>.<bytes>.<width>x<height>x<depth>.proc"
+    bool ParseFileName (std::string filepath);
+    // Read optional "<key> <value>" overrides, if the file exists
+    bool ReadOptionsFile (std::string filepath);
+
+    static std::string GetShapeName (PROCEDURAL_VOLUME_SHAPE shape);
+
+    PROCEDURAL_VOLUME_SHAPE shape;
+    unsigned int width, height, depth;
+    unsigned int bytes_per_voxel;
+    unsigned int seed;
+    double sparsity;
+    int features;
+  };
+
+  class ProceduralVolumeGenerator
+  {
+  public:
+    ProceduralVolumeGenerator ();
+    ~ProceduralVolumeGenerator ();
+
+    StructuredGridVolume* Generate (const ProceduralVolumeParameters& params);
+
+  protected:
+    // Gaussian falloff around the segment [a, b], used for both blobs
+    //   (a == b) and vessel branches
+    class Capsule
+    {
+    public:
+      Capsule (glm::dvec3 _a, glm::dvec3 _b, double _radius, double _amplitude)
+        : a(_a), b(_b), radius(_radius), amplitude(_amplitude)
+      {}
+
+      glm::dvec3 a, b;
+      double radius;
+      double amplitude;
+    };
+
+    void BuildGaussianBlobs (const ProceduralVolumeParameters& params);
+    void BuildVesselTree (const ProceduralVolumeParameters& params);
+
+    // Evaluate one z slice [0, 1] into slice_values (width * height)
+    void EvaluateSlice (const ProceduralVolumeParameters& params, int z, float* slice_values);
+
+    template<typename T>
+    void FillVoxelArray (const ProceduralVolumeParameters& params, T* voxels, double max_value);
+
+    std::vector<Capsule> m_capsules;
+
+  private:
+  };
+}
+
+#endif
@@ -8,13 +8,18 @@
 #include <file_utils/pvm_old.h>
 #include <file_utils/rawloader.h>
 
+#include <volvis_utils/proceduralvolume.h>
+
 #include <fstream>
 
+#include <gl_utils/tracer.h>
+
 #include <volvis_utils/transferfunction1d.h>
 
 namespace vis
 {
   VolumeReader::VolumeReader ()
+    : m_pvmold_native_storage(false)
   {
 
   }
@@ -26,6 +31,7 @@ namespace vis
 
   StructuredGridVolume* VolumeReader::ReadStructuredVolume (std::string filepath)
   {
+    TRACE_SCOPE_DETAIL("ReadStructuredVolume", "io", filepath);
     StructuredGridVolume* ret = nullptr;
 
     int found = filepath.find_last_of('.');
@@ -44,11 +50,19 @@ namespace vis
     else if (extension.compare("syn") == 0) {
       ret = readsyn(filepath);
     }
+    else if (extension.compare("proc") == 0) {
+      ret = readproc(filepath);
+    }
     printf("DONE\n");
 
     return ret;
   }
 
+  void VolumeReader::SetPvmOldNativeStorage (bool native_storage)
+  {
+    m_pvmold_native_storage = native_storage;
+  }
+
   StructuredGridVolume* VolumeReader::readpvm (std::string filename)
   {
     StructuredGridVolume* ret = nullptr;
@@ -67,6 +81,8 @@ namespace vis
 
     assert(components > 0);
 
+    size_t n_voxels = GetCheckedNumberOfVoxels(width, height, depth, components);
+
     vis::DataStorageSize data_tp;
     void* scalar_values = nullptr;
 
@@ -75,11 +91,11 @@ namespace vis
     {
       data_tp = vis::DataStorageSize::_8_BITS;
     
-      scalar_values = new unsigned char[width * height * depth];
+      scalar_values = AllocateVoxelArray<unsigned char>(width, height, depth);
       unsigned char* u_sv = static_cast<unsigned char*>(scalar_values);
 
       unsigned char* vol_data = static_cast<unsigned char*>(fpvm.GetData());
-      for (int i = 0; i < width * height * depth; i++)
+      for (size_t i = 0; i < n_voxels; i++)
         u_sv[i] = (unsigned char)vol_data[i];
     }
     // GLushort - 16 bits
@@ -87,11 +103,11 @@ namespace vis
     {
       data_tp = vis::DataStorageSize::_16_BITS;
       
-      scalar_values = new unsigned short[width * height * depth];
+      scalar_values = AllocateVoxelArray<unsigned short>(width, height, depth);
       unsigned short* u_sv = static_cast<unsigned short*>(scalar_values);
 
       unsigned short* vol_data = static_cast<unsigned short*>(fpvm.GetData());
-      for (int i = 0; i < width * height * depth; i++)
+      for (size_t i = 0; i < n_voxels; i++)
         u_sv[i] = (unsigned short)vol_data[i];
     }
 
@@ -156,34 +172,28 @@ namespace vis
       // Byte Size
       bytes_per_value = atoi(t_filebytesize.c_str());
 
-      IRAWLoader rawLoader = IRAWLoader(filepath, bytes_per_value, fw * fh * fd, bytes_per_value);
+      size_t n_voxels = GetCheckedNumberOfVoxels(fw, fh, fd, bytes_per_value);
 
       vis::DataStorageSize data_tp;
 
       void* scalar_values = nullptr;
-      // GLushort - 16 bits - converting to float
+      // GLushort - 16 bits
       if (bytes_per_value == sizeof(unsigned short))
       {
         data_tp = vis::DataStorageSize::_16_BITS;
-        scalar_values = new unsigned short[fw * fh * fd];
-  
-        unsigned short* us_scalar_values = static_cast<unsigned short*>(scalar_values);
-        unsigned short* b = static_cast<unsigned short*>(rawLoader.GetData());
-
-        for (int i = 0; i < fw * fh * fd; i++)
-          us_scalar_values[i] = b[i];
+        scalar_values = AllocateVoxelArray<unsigned short>(fw, fh, fd);
       }
-      // GLubyte - 8 bits - converting to float
+      // GLubyte - 8 bits
       else if (bytes_per_value == sizeof(unsigned char))
       {
         data_tp = vis::DataStorageSize::_8_BITS;
-        scalar_values = new unsigned char[fw * fh * fd];
-
-        unsigned char* uc_scalar_values = static_cast<unsigned char*>(scalar_values);
-        unsigned char* b = static_cast<unsigned char*>(rawLoader.GetData());
+        scalar_values = AllocateVoxelArray<unsigned char>(fw, fh, fd);
+      }
 
-        for (int i = 0; i < fw * fh * fd; i++)
-          uc_scalar_values[i] = b[i];
+      // The file has the layout of the voxel array, read in place
+      if (scalar_values)
+      {
+        IRAWLoader rawLoader(filepath, bytes_per_value, n_voxels, bytes_per_value, scalar_values);
       }
 
       sg_ret = new StructuredGridVolume(filename, fw, fh, fd);
@@ -218,43 +228,48 @@ namespace vis
     unsigned int width, height, depth, components;
     double scalex, scaley, scalez;
 
-    PvmOld fpvm(filename.c_str());
+    // Only keep the decoded file bytes, the float copy is not needed
+    PvmOld fpvm(filename.c_str(), false);
     fpvm.GetDimensions(&width, &height, &depth);
     components = fpvm.GetComponents();
     fpvm.GetScale(&scalex, &scaley, &scalez);
 
-    // Get Volume Data
-    float* vol_data = 
-      //fpvm.GetData()
-      fpvm.GenerateReescaledMinMaxData()
-    ;
-
-    double max_density = 1.0;
-    if (components == 1)
-      max_density = (256.0 - 1.0);
-    else if (components == 2)
-      max_density = (65536.0 - 1.0);
-
-    double* aux_output_data = new double[width * height * depth];
-    for (int i = 0; i < width * height * depth; i++)
-      aux_output_data[i] = (double)vol_data[i];
-
-    GLfloat* scalar_values = new GLfloat[width * height * depth];
-    for (int i = 0; i < width * height * depth; i++)
-      scalar_values[i] = ((GLfloat)((int)aux_output_data[i]) / max_density);
-
     assert(components > 0);
 
-    delete[] vol_data;
-    delete[] aux_output_data;
+    vis::DataStorageSize data_tp = vis::DataStorageSize::_NORMALIZED_F;
+    void* scalar_values = nullptr;
+    if (m_pvmold_native_storage && components == 1)
+    {
+      data_tp = vis::DataStorageSize::_8_BITS;
+      scalar_values = AllocateVoxelArray<unsigned char>(width, height, depth);
+    }
+    else if (m_pvmold_native_storage && components == 2)
+    {
+      data_tp = vis::DataStorageSize::_16_BITS;
+      scalar_values = AllocateVoxelArray<unsigned short>(width, height, depth);
+    }
+    else
+    {
+      scalar_values = AllocateVoxelArray<GLfloat>(width, height, depth);
+    }
+
+    // Decode, rescale by min/max and store in a single pass
+    if (!fpvm.DecodeReescaledMinMaxData(scalar_values, data_tp == vis::DataStorageSize::_NORMALIZED_F ? sizeof(GLfloat) : components))
+    {
+      printf("Finished -> Error on decoding .pvmold file\n");
+      if (data_tp == vis::DataStorageSize::_8_BITS) delete[] static_cast<unsigned char*>(scalar_values);
+      else if (data_tp == vis::DataStorageSize::_16_BITS) delete[] static_cast<unsigned short*>(scalar_values);
+      else delete[] static_cast<GLfloat*>(scalar_values);
+      return nullptr;
+    }
 
     ret = new StructuredGridVolume(filename, width, height, depth);
     ret->SetScale(scalex, scaley, scalez);
     ret->SetName(filename);
 
-    // We won't delete the vol_data, because it will be stored at 
+    // We won't delete the scalar_values, because it will be stored at 
     //   structured grid volume...
-    ret->SetArrayData(scalar_values, vis::DataStorageSize::_NORMALIZED_F);
+    ret->SetArrayData(scalar_values, data_tp);
 
     printf("  - Volume Name     : %s\n", filename.c_str());
     printf("  - Volume Size     : [%d, %d, %d]\n", width, height, depth);
@@ -282,7 +297,7 @@ namespace vis
       sg_ret->SetScale(1.0, 1.0, 1.0);
       sg_ret->SetName(filepath);
       
-      unsigned char* syn_data = new unsigned char[width*height*depth];
+      unsigned char* syn_data = AllocateVoxelArray<unsigned char>(width, height, depth);
 
       
       int new_data = 0;
@@ -298,7 +313,7 @@ namespace vis
             {
               for (int z = z0; z < z1; z++)
               {
-                syn_data[x + (width * y) + (width * height * z)] = unsigned char(v);
+                syn_data[sg_ret->GetVoxelIndex(x, y, z)] = (unsigned char)v;
               }
             }
           }
@@ -333,7 +348,7 @@ namespace vis
         {
           int xt, yt, zt, v;
           iffile >> xt >> yt >> zt >> v;
-          syn_data[xt + (width * yt) + (width * height * zt)] = unsigned char(v);
+          syn_data[sg_ret->GetVoxelIndex(xt, yt, zt)] = (unsigned char)v;
         }
       }
       
@@ -354,6 +369,33 @@ namespace vis
     return sg_ret;
   }
 
+  StructuredGridVolume* VolumeReader::readproc (std::string filepath)
+  {
+    StructuredGridVolume* sg_ret = nullptr;
+
+    printf("Started  -> Read Volume From .proc File\n");
+    printf("  - File .proc Path: %s\n", filepath.c_str());
+
+    // The file name holds shape, byte size and dimensions, the file
+    //   itself is optional and only overrides the generator parameters
+    ProceduralVolumeParameters params;
+    if (params.ParseFileName(filepath))
+    {
+      params.ReadOptionsFile(filepath);
+
+      ProceduralVolumeGenerator pgen;
+      sg_ret = pgen.Generate(params);
+      if (sg_ret) sg_ret->SetName(filepath);
+
+      printf("Finished -> Read Volume From .proc File\n");
+    }
+    else {
+      printf("Finished -> Error on parsing .proc file name\n");
+    }
+
+    return sg_ret;
+  }
+
   UnstructuredGridVolume* VolumeReader::readunsvol (std::string filepath)
   {
     UnstructuredGridVolume* sg_ret = nullptr;
@@ -3,6 +3,7 @@
  * - VolumeReader:
  *  .pvm
  *  .raw
+ *  .proc (procedural, see proceduralvolume.h)
  *
  * - TransferFunctionReader:
  *  .tf1d
@@ -28,15 +29,23 @@ namespace vis
     ~VolumeReader ();
 
     StructuredGridVolume* ReadStructuredVolume (std::string filepath);
+
+    // .pvmold volumes are stored as _NORMALIZED_F by default. If enabled,
+    //   they keep the native _8_BITS/_16_BITS storage (same normalized
+    //   samples, 2-4x less memory).
+    void SetPvmOldNativeStorage (bool native_storage);
   
   protected:
     StructuredGridVolume* readpvm (std::string filename);
     StructuredGridVolume* readpvmold (std::string filename);
     StructuredGridVolume* readraw (std::string filepath);
     StructuredGridVolume* readsyn (std::string filepath);
+    StructuredGridVolume* readproc (std::string filepath);
 
     UnstructuredGridVolume* readunsvol (std::string filepath);
 
+    bool m_pvmold_native_storage;
+
   private:
 
   };
@@ -21,6 +21,7 @@ namespace vis
     , m_grid_center(glm::dvec3(0.0))
     , m_data_storage_size(DataStorageSize::UNKNOWN)
     , m_voxel_values(nullptr)
+    , m_content_hash_computed(false)
   {}
   
   StructuredGridVolume::~StructuredGridVolume ()
@@ -42,6 +43,16 @@ namespace vis
   {
     return m_depth;
   }
+
+  size_t StructuredGridVolume::GetNumberOfVoxels ()
+  {
+    return (size_t)m_width * (size_t)m_height * (size_t)m_depth;
+  }
+
+  size_t StructuredGridVolume::GetVoxelIndex (int x, int y, int z)
+  {
+    return (size_t)x + ((size_t)y * (size_t)m_width) + ((size_t)z * (size_t)m_width * (size_t)m_height);
+  }
   
   double StructuredGridVolume::GetScaleX ()
   {
@@ -111,6 +122,7 @@ namespace vis
   {
     m_data_storage_size = dss;
     m_voxel_values = input_vol_data;
+    m_content_hash_computed = false;
   }
 
   void* StructuredGridVolume::GetArrayData ()
@@ -118,6 +130,21 @@ namespace vis
     return m_voxel_values;
   }
 
+  DataStorageSize StructuredGridVolume::GetDataStorageSize ()
+  {
+    return m_data_storage_size;
+  }
+
+  size_t StructuredGridVolume::GetArrayDataSizeInBytes ()
+  {
+    size_t bytes_per_voxel = 0;
+    if (m_data_storage_size == DataStorageSize::_8_BITS)            bytes_per_voxel = sizeof(unsigned char);
+    else if (m_data_storage_size == DataStorageSize::_16_BITS)      bytes_per_voxel = sizeof(unsigned short);
+    else if (m_data_storage_size == DataStorageSize::_NORMALIZED_F) bytes_per_voxel = sizeof(float);
+    else if (m_data_storage_size == DataStorageSize::_NORMALIZED_D) bytes_per_voxel = sizeof(double);
+    return GetNumberOfVoxels() * bytes_per_voxel;
+  }
+
   double StructuredGridVolume::GetNormalizedSample (int x, int y, int z)
   {
     if (m_voxel_values == nullptr
@@ -127,25 +154,26 @@ namespace vis
         return 0.0;
     }
     
+    size_t id = GetVoxelIndex(x, y, z);
     if(m_data_storage_size == DataStorageSize::_8_BITS)
     {
       unsigned char* array_vls = static_cast<unsigned char*>(m_voxel_values);
-      return (double)array_vls[x + (y * GetWidth()) + (z * GetWidth() * GetHeight())] / (256.0 - 1.0);
+      return (double)array_vls[id] / (256.0 - 1.0);
     }
     else if(m_data_storage_size == DataStorageSize::_16_BITS)
     {
       unsigned short* array_vls = static_cast<unsigned short*>(m_voxel_values);
-      return (double)array_vls[x + (y * GetWidth()) + (z * GetWidth() * GetHeight())] / (65536.0 - 1.0);
+      return (double)array_vls[id] / (65536.0 - 1.0);
     }
     else if (m_data_storage_size == DataStorageSize::_NORMALIZED_F)
     {
       float* array_vls = static_cast<float*>(m_voxel_values);
-      return (double)array_vls[x + (y * GetWidth()) + (z * GetWidth() * GetHeight())] / (1.0);
+      return (double)array_vls[id] / (1.0);
     }
     else if (m_data_storage_size == DataStorageSize::_NORMALIZED_D)
     {
       double* array_vls = static_cast<double*>(m_voxel_values);
-      return (double)array_vls[x + (y * GetWidth()) + (z * GetWidth() * GetHeight())] / (1.0);
+      return (double)array_vls[id] / (1.0);
     }
     return 0.0;
   }
@@ -203,31 +231,67 @@ namespace vis
 
   unsigned long long StructuredGridVolume::CheckSum ()
   {
-    unsigned long long csum = 0;
-    for (int i = 0; i < m_width * m_height * m_depth; i++)
+    return GetContentHash().low;
+  }
+
+  ContentHash128 StructuredGridVolume::GetContentHash ()
+  {
+    if (!m_content_hash_computed)
     {
-      if (m_data_storage_size == DataStorageSize::_8_BITS)
-      {
-        unsigned char* array_vls = static_cast<unsigned char*>(m_voxel_values);
-        csum += (unsigned long long)array_vls[i];
-      }
-      else if (m_data_storage_size == DataStorageSize::_16_BITS)
-      {
-        unsigned short* array_vls = static_cast<unsigned short*>(m_voxel_values);
-        csum += (unsigned long long)array_vls[i];
-      }
-      else if (m_data_storage_size == DataStorageSize::_NORMALIZED_F)
-      {
-        float* array_vls = static_cast<float*>(m_voxel_values);
-        csum += (unsigned long long)array_vls[i];
-      }
-      else if (m_data_storage_size == DataStorageSize::_NORMALIZED_D)
-      {
-        double* array_vls = static_cast<double*>(m_voxel_values);
-        csum += (unsigned long long)array_vls[i];
-      }
+      if (m_voxel_values == nullptr || m_data_storage_size == DataStorageSize::UNKNOWN)
+        return ContentHash128();
+
+      ContentHash128 hashes[2];
+      hashes[0] = ComputeContentHash(m_voxel_values, GetArrayDataSizeInBytes());
+
+      // Same bytes with another storage type or dimensions are another volume
+      unsigned long long desc[4] = { (unsigned long long)m_data_storage_size,
+                                     m_width, m_height, m_depth };
+      hashes[1] = HashBytes128(desc, sizeof(desc));
+
+      m_content_hash = CombineHashes(hashes, 2);
+      m_content_hash_computed = true;
+    }
+    return m_content_hash;
+  }
+
+  std::vector<unsigned long long> StructuredGridVolume::ComputeBrickHashes (int brick_size)
+  {
+    std::vector<unsigned long long> brick_hashes;
+    // Empty volumes have no bricks (and no bytes per voxel to divide by)
+    if (m_voxel_values == nullptr || brick_size <= 0 || GetNumberOfVoxels() == 0)
+      return brick_hashes;
+
+    size_t bytes_per_voxel = GetArrayDataSizeInBytes() / GetNumberOfVoxels();
+    const unsigned char* voxel_bytes = static_cast<const unsigned char*>(m_voxel_values);
+
+    int bw = (m_width  + brick_size - 1) / brick_size;
+    int bh = (m_height + brick_size - 1) / brick_size;
+    int bd = (m_depth  + brick_size - 1) / brick_size;
+    long long n_bricks = (long long)bw * (long long)bh * (long long)bd;
+    brick_hashes.resize(n_bricks);
+
+#pragma omp parallel for schedule(dynamic)
+    for (long long b = 0; b < n_bricks; b++)
+    {
+      int x0 = (int)(b % bw) * brick_size;
+      int y0 = (int)((b / bw) % bh) * brick_size;
+      int z0 = (int)(b / ((long long)bw * bh)) * brick_size;
+      int x1 = glm::min(x0 + brick_size, (int)m_width);
+      int y1 = glm::min(y0 + brick_size, (int)m_height);
+      int z1 = glm::min(z0 + brick_size, (int)m_depth);
+
+      // Chain the hashes of the brick rows
+      unsigned long long h = (unsigned long long)b;
+      for (int z = z0; z < z1; z++)
+        for (int y = y0; y < y1; y++)
+          h = HashBytes64(voxel_bytes + GetVoxelIndex(x0, y, z) * bytes_per_voxel,
+                          (size_t)(x1 - x0) * bytes_per_voxel, h);
+
+      brick_hashes[b] = h;
     }
-    return csum;
+
+    return brick_hashes;
   }
 
   double StructuredGridVolume::GetMaxDensity ()
@@ -8,8 +8,13 @@
 #define VOL_VIS_UTILS_STRUCTURED_GRID_VOLUME_H
 
 #include <volvis_utils/gridvolume.h>
+#include <vis_utils/contenthash.h>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cstdlib>
+#include <limits>
+#include <new>
 
 #include <glm/glm.hpp>
 
@@ -36,6 +41,39 @@ namespace vis
       return DataStorageSize::_NORMALIZED_D;
     return DataStorageSize::UNKNOWN;
   }
+
+  // Number of voxels of a [w, h, d] grid, computed with 64-bit arithmetic.
+  //   Exits if w * h * d * bytesize cannot be represented by a size_t.
+  static size_t GetCheckedNumberOfVoxels (size_t w, size_t h, size_t d, size_t bytesize = 1)
+  {
+    const size_t max_size = std::numeric_limits<size_t>::max();
+    if ((w > 0 && h > max_size / w)
+     || (w * h > 0 && d > max_size / (w * h))
+     || (w * h * d > 0 && bytesize > max_size / (w * h * d)))
+    {
+      std::cout << "Error: Volume size [" << w << ", " << h << ", " << d << "] with "
+                << bytesize << " bytes per voxel overflows size_t." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    return w * h * d;
+  }
+
+  // Allocates one T per voxel of a [w, h, d] grid. The element count is
+  //   overflow-checked and a failed allocation stops the application
+  //   instead of silently returning a smaller buffer.
+  template<typename T>
+  static T* AllocateVoxelArray (size_t w, size_t h, size_t d)
+  {
+    size_t n_voxels = GetCheckedNumberOfVoxels(w, h, d, sizeof(T));
+    T* ret = new (std::nothrow) T[n_voxels];
+    if (ret == nullptr)
+    {
+      std::cout << "Error: Unable to allocate " << n_voxels * sizeof(T)
+                << " bytes for a [" << w << ", " << h << ", " << d << "] volume." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    return ret;
+  }
   
   class StructuredGridVolume : public GridVolume
   {
@@ -49,6 +87,8 @@ namespace vis
     unsigned int GetWidth ();
     unsigned int GetHeight ();
     unsigned int GetDepth ();
+    size_t GetNumberOfVoxels ();
+    size_t GetVoxelIndex (int x, int y, int z);
   
     double GetScaleX ();
     double GetScaleY ();
@@ -65,12 +105,25 @@ namespace vis
   
     void SetArrayData (void* input_vol_data, DataStorageSize dss);
     void* GetArrayData ();
+    DataStorageSize GetDataStorageSize ();
+    size_t GetArrayDataSizeInBytes ();
 
     double GetNormalizedSample (int x, int y, int z);
     double GetNormalizedInterpolatedSample (double x, double y, double z);
 
+    // 64-bit identity of the voxel data, kept for compatibility: it is
+    //   the low word of GetContentHash
     unsigned long long CheckSum ();
 
+    // 128-bit hash of the raw voxel bytes and storage type, computed in
+    //   parallel on the first call and cached until SetArrayData. Use it
+    //   as the key of any data derived from this volume.
+    ContentHash128 GetContentHash ();
+
+    // One hash per brick of brick_size^3 voxels (x fastest, then y, z),
+    //   to detect which bricks changed between two volumes
+    std::vector<unsigned long long> ComputeBrickHashes (int brick_size);
+
     double GetMaxDensity ();
 
   protected:
@@ -85,6 +138,9 @@ namespace vis
   
     DataStorageSize m_data_storage_size;
     void* m_voxel_values;
+
+    bool m_content_hash_computed;
+    ContentHash128 m_content_hash;
   };
 }
 
@@ -0,0 +1,104 @@
+#include "textureslabs.h"
+#include "gradients.h"
+
+#include <gl_utils/halffloat.h>
+#include <algorithm>
+#include <cstring>
+
+namespace vis
+{
+  void ProduceScalarSlab (void* data, int first_slice, int n_slices, GLvoid* slab)
+  {
+    ScalarSlab* s = (ScalarSlab*)data;
+    int size_x = s->size_x, size_y = s->size_y;
+
+#pragma omp parallel
+    {
+      GLfloat* row = new GLfloat[size_x];
+#pragma omp for collapse(2)
+      for (int k = 0; k < n_slices; k++)
+      {
+        for (int j = 0; j < size_y; j++)
+        {
+          size_t first = ((size_t)j * size_x) + ((size_t)k * size_x * size_y);
+          int y = j + s->init_y, z = first_slice + k + s->init_z;
+          if (s->type == GL_UNSIGNED_BYTE)
+          {
+            for (int i = 0; i < size_x; i++)
+              ((GLubyte*)slab)[first + i] = (GLubyte)((s->vol->GetNormalizedSample(i + s->init_x, y, z)) * 255.0);
+          }
+          else if (s->type == GL_UNSIGNED_SHORT)
+          {
+            for (int i = 0; i < size_x; i++)
+              ((GLushort*)slab)[first + i] = (GLushort)((s->vol->GetNormalizedSample(i + s->init_x, y, z)) * 65535.0);
+          }
+          else
+          {
+            GLfloat* dst = s->type == GL_FLOAT ? (GLfloat*)slab + first : row;
+            for (int i = 0; i < size_x; i++)
+              dst[i] = (GLfloat)s->vol->GetNormalizedSample(i + s->init_x, y, z);
+            if (s->type == GL_HALF_FLOAT)
+              gl::FloatToHalf(row, (GLhalf*)slab + first, size_x);
+          }
+        }
+      }
+      delete[] row;
+    }
+  }
+
+  void ProduceGradientSlab (void* data, int first_slice, int n_slices, GLvoid* slab)
+  {
+    GradientSlab* s = (GradientSlab*)data;
+    int w = s->w, h = s->h, d = s->d, ds = s->downsampling;
+    int tex_w = s->tex_w, tex_h = s->tex_h;
+
+#pragma omp parallel
+    {
+      glm::vec3* row = new glm::vec3[tex_w];
+#pragma omp for collapse(2)
+      for (int k = 0; k < n_slices; k++)
+      {
+        for (int j = 0; j < tex_h; j++)
+        {
+          int tk = first_slice + k;
+          for (int i = 0; i < tex_w; i++)
+          {
+            glm::vec3 sum(0.0f);
+            int n = 0;
+            for (int z = tk * ds; z < std::min((tk + 1) * ds, d); z++)
+              for (int y = j * ds; y < std::min((j + 1) * ds, h); y++)
+                for (int x = i * ds; x < std::min((i + 1) * ds, w); x++, n++)
+                  sum += s->values ? s->values[(size_t)x + ((size_t)y * w) + ((size_t)z * w * h)]
+                                   : glm::vec3(ComputeSobelFeldmanGradient(s->vol, x, y, z));
+            row[i] = ds > 1 ? sum / float(n) : sum;
+          }
+
+          size_t first = (((size_t)j * tex_w) + ((size_t)k * tex_w * tex_h)) * 3;
+          if (s->type == GL_HALF_FLOAT)
+            gl::FloatToHalf((GLfloat*)row, (GLhalf*)slab + first, (size_t)tex_w * 3);
+          else
+            memcpy((GLfloat*)slab + first, row, (size_t)tex_w * sizeof(glm::vec3));
+        }
+      }
+      delete[] row;
+    }
+  }
+
+  void ProduceDoubleSlab (void* data, int first_slice, int n_slices, GLvoid* slab)
+  {
+    DoubleSlab* s = (DoubleSlab*)data;
+    size_t first = (size_t)first_slice * s->w * s->h;
+    long long n_values = (long long)n_slices * s->w * s->h;
+
+    if (s->type == GL_HALF_FLOAT)
+    {
+      gl::DoubleToHalf(s->values + first, (GLhalf*)slab, (size_t)n_values);
+    }
+    else
+    {
+#pragma omp parallel for
+      for (long long i = 0; i < n_values; i++)
+        ((GLfloat*)slab)[i] = (GLfloat)s->values[first + i];
+    }
+  }
+}
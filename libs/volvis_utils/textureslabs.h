@@ -0,0 +1,56 @@
+/**
+ * Slab producers of the streamed textures generated in utils.h (see
+ *   gl::SlabUploader): scalar samples, gradients and double values.
+ *
+ * They only fill host slabs, so they are kept apart from the texture
+ *   generators and can be tested without an OpenGL context.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef VOL_VIS_UTILS_TEXTURE_SLABS_H
+#define VOL_VIS_UTILS_TEXTURE_SLABS_H
+
+#include <volvis_utils/structuredgridvolume.h>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+namespace vis
+{
+  struct ScalarSlab {
+    StructuredGridVolume* vol;
+    int init_x, init_y, init_z;
+    int size_x, size_y;
+    GLenum type;
+  };
+
+  // Normalized samples of the slices: half floats, floats, or scaled to the
+  //   range of unsigned bytes/shorts
+  void ProduceScalarSlab (void* data, int first_slice, int n_slices, GLvoid* slab);
+
+  struct GradientSlab {
+    // w x h x d gradients, or nullptr to compute the Sobel-Feldman gradients of vol
+    glm::vec3* values;
+    StructuredGridVolume* vol;
+    int w, h, d;
+    int downsampling;
+    int tex_w, tex_h;
+    GLenum type;
+  };
+
+  // Mean of the (at most) downsampling^3 gradients of each texel, as rgb
+  //   half floats or floats
+  void ProduceGradientSlab (void* data, int first_slice, int n_slices, GLvoid* slab);
+
+  struct DoubleSlab {
+    const double* values;
+    int w, h;
+    GLenum type;
+  };
+
+  // Double values (e.g. summed area tables) converted to half floats or floats
+  void ProduceDoubleSlab (void* data, int first_slice, int n_slices, GLvoid* slab);
+}
+
+#endif
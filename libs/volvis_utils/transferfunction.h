@@ -48,7 +48,7 @@ namespace vis
   {
   public:
     TransferFunction () {}
-    ~TransferFunction () {}
+    virtual ~TransferFunction () {}
 
     virtual const char* GetNameClass () = 0;
 
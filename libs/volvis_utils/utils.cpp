@@ -1,6 +1,13 @@
 #include "utils.h"
+#include "gradients.h"
+#include "textureslabs.h"
 
 #include <vis_utils/summedareatable.h>
+#include <gl_utils/tracer.h>
+#include <gl_utils/halffloat.h>
+#include <gl_utils/slabuploader.h>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <random>
 #include <fstream>
@@ -17,127 +24,105 @@ namespace vis
     GLfloat a;
   };
 
+  // Texture with immutable storage, filled slab by slab by the producer, so
+  //   the generators never allocate a full volume staging array
+  static gl::Texture3D* GenerateStreamedTexture (int w, int h, int d, GLint filter,
+    GLint internalformat, GLenum format, GLenum type, gl::SlabProducer producer, void* data)
+  {
+    gl::Texture3D* tex3d = new gl::Texture3D(w, h, d);
+    tex3d->GenerateTexture(filter, filter, TEXTURE_WRAP, TEXTURE_WRAP, TEXTURE_WRAP);
+    tex3d->AllocateStorage(internalformat);
+
+    gl::SlabUploader uploader(tex3d, format, type);
+    uploader.Upload(producer, data);
+
+    return tex3d;
+  }
+
+  // Gradient texture of the values (or of the Sobel-Feldman gradients of vol),
+  //   downsampled and converted slab by slab
+  static gl::Texture3D* GenerateStreamedGradientTexture (glm::vec3* values, StructuredGridVolume* vol,
+    int w, int h, int d, int downsampling)
+  {
+    GradientSlab slab;
+    slab.values = values;
+    slab.vol = vol;
+    slab.w = w; slab.h = h; slab.d = d;
+    slab.downsampling = std::max(downsampling, 1);
+    slab.tex_w = (w + slab.downsampling - 1) / slab.downsampling;
+    slab.tex_h = (h + slab.downsampling - 1) / slab.downsampling;
+    int tex_d = (d + slab.downsampling - 1) / slab.downsampling;
+
+#ifdef USE_16F_INTERNAL_FORMAT
+    slab.type = GL_HALF_FLOAT;
+    return GenerateStreamedTexture(slab.tex_w, slab.tex_h, tex_d, TEXTURE_FILTER,
+      GL_RGB16F, GL_RGB, GL_HALF_FLOAT, ProduceGradientSlab, &slab);
+#else
+    slab.type = GL_FLOAT;
+    return GenerateStreamedTexture(slab.tex_w, slab.tex_h, tex_d, TEXTURE_FILTER,
+      GL_RGB32F, GL_RGB, GL_FLOAT, ProduceGradientSlab, &slab);
+#endif
+  }
+
   gl::Texture3D* GenerateRTexture(StructuredGridVolume* vol, int init_x, int init_y, int init_z,
     int last_x, int last_y, int last_z)
   {
+    TRACE_SCOPE("GenerateRTexture", "preprocess");
     if (!vol) return NULL;
 
     int size_x = abs(last_x - init_x);
     int size_y = abs(last_y - init_y);
     int size_z = abs(last_z - init_z);
 
-    GLfloat* scalar_values = new GLfloat[size_x*size_y*size_z];
-
-    for (int k = 0; k < size_z; k++)
-    {
-      for (int j = 0; j < size_y; j++)
-      {
-        for (int i = 0; i < size_x; i++)
-        {
-          scalar_values[i + (j * size_x) + (k * size_x * size_y)] = (GLfloat)vol->GetNormalizedSample((i + init_x), (j + init_y), (k + init_z));
-        }
-      }
-    }
-
-    gl::Texture3D* tex3d_r = new gl::Texture3D(size_x, size_y, size_z);
-
-    tex3d_r->GenerateTexture(TEXTURE_FILTER, TEXTURE_FILTER, TEXTURE_WRAP, TEXTURE_WRAP, TEXTURE_WRAP);
-
 #ifdef USE_16F_INTERNAL_FORMAT
-    tex3d_r->SetData(scalar_values, GL_R16F, GL_RED, GL_FLOAT);
+    ScalarSlab slab = { vol, init_x, init_y, init_z, size_x, size_y, GL_HALF_FLOAT };
+    gl::Texture3D* tex3d_r = GenerateStreamedTexture(size_x, size_y, size_z, TEXTURE_FILTER,
+      GL_R16F, GL_RED, GL_HALF_FLOAT, ProduceScalarSlab, &slab);
 #else
-    tex3d_r->SetData(scalar_values, GL_R32F, GL_RED, GL_FLOAT);
+    ScalarSlab slab = { vol, init_x, init_y, init_z, size_x, size_y, GL_FLOAT };
+    gl::Texture3D* tex3d_r = GenerateStreamedTexture(size_x, size_y, size_z, TEXTURE_FILTER,
+      GL_R32F, GL_RED, GL_FLOAT, ProduceScalarSlab, &slab);
 #endif
     gl::ExitOnGLError("ERROR: After SetData");
 
-    delete[] scalar_values;
-
     return tex3d_r;
   }
 
   gl::Texture3D* GenerateRTexture (StructuredGridVolume* vol, VIS_UTILS_DATA_TYPE vdatatype)
   {
+    TRACE_SCOPE("GenerateRTexture", "preprocess");
     if (!vol) return NULL;
 
     int size_x = vol->GetWidth();
     int size_y = vol->GetHeight();
     int size_z = vol->GetDepth();
-    
-    gl::Texture3D* tex3d_r = new gl::Texture3D(size_x, size_y, size_z);
 
-    if (vdatatype == VIS_UTILS_DATA_TYPE::UNSIGNED_BYTE)
-    {
-      GLubyte* scalar_values = new GLubyte[size_x*size_y*size_z];
-      
-      for (int k = 0; k < size_z; k++)
-      {
-        for (int j = 0; j < size_y; j++)
-        {
-          for (int i = 0; i < size_x; i++)
-          {
-            scalar_values[i + (j * size_x) + (k * size_x * size_y)] = (GLubyte)((vol->GetNormalizedSample(i, j, k)) * 255.0);
-          }
-        }
-      }
-      tex3d_r->GenerateTexture(GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-      tex3d_r->SetData(scalar_values, GL_R8UI, GL_RED_INTEGER, GL_UNSIGNED_BYTE);
-      delete[] scalar_values;
-    }
-    else if (vdatatype == VIS_UTILS_DATA_TYPE::UNSIGNED_SHORT)
+    GLint filter = GL_NEAREST, internalformat = GL_R8UI;
+    GLenum format = GL_RED_INTEGER, type = GL_UNSIGNED_BYTE;
+    if (vdatatype == VIS_UTILS_DATA_TYPE::UNSIGNED_SHORT)
     {
-      GLushort* scalar_values = new GLushort[size_x*size_y*size_z];
-
-      for (int k = 0; k < size_z; k++)
-      {
-        for (int j = 0; j < size_y; j++)
-        {
-          for (int i = 0; i < size_x; i++)
-          {
-            scalar_values[i + (j * size_x) + (k * size_x * size_y)] = (GLushort)((vol->GetNormalizedSample(i, j, k)) * 65535.0);
-          }
-        }
-      }
-      tex3d_r->GenerateTexture(GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-      tex3d_r->SetData(scalar_values, GL_R16UI, GL_RED_INTEGER, GL_UNSIGNED_SHORT);
-      delete[] scalar_values;
+      internalformat = GL_R16UI;
+      type = GL_UNSIGNED_SHORT;
     }
     else if (vdatatype == VIS_UTILS_DATA_TYPE::HALF_FLOAT)
     {
-      GLfloat* scalar_values = new GLfloat[size_x*size_y*size_z];
-
-      for (int k = 0; k < size_z; k++)
-      {
-        for (int j = 0; j < size_y; j++)
-        {
-          for (int i = 0; i < size_x; i++)
-          {
-            scalar_values[i + (j * size_x) + (k * size_x * size_y)] = (GLfloat)(vol->GetNormalizedSample(i, j, k));
-          }
-        }
-      }
-      tex3d_r->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-      tex3d_r->SetData(scalar_values, GL_R16F, GL_RED, GL_FLOAT);
-      delete[] scalar_values;
+      filter = GL_LINEAR;
+      internalformat = GL_R16F;
+      format = GL_RED;
+      type = GL_HALF_FLOAT;
     }
     else if (vdatatype == VIS_UTILS_DATA_TYPE::FLOAT)
     {
-      GLfloat* scalar_values = new GLfloat[size_x*size_y*size_z];
-
-      for (int k = 0; k < size_z; k++)
-      {
-        for (int j = 0; j < size_y; j++)
-        {
-          for (int i = 0; i < size_x; i++)
-          {
-            scalar_values[i + (j * size_x) + (k * size_x * size_y)] = (GLfloat)(vol->GetNormalizedSample(i, j, k));
-          }
-        }
-      }
-      tex3d_r->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-      tex3d_r->SetData(scalar_values, GL_R32F, GL_RED, GL_FLOAT);
-      delete[] scalar_values;
+      filter = GL_LINEAR;
+      internalformat = GL_R32F;
+      format = GL_RED;
+      type = GL_FLOAT;
     }
 
+    ScalarSlab slab = { vol, 0, 0, 0, size_x, size_y, type };
+    gl::Texture3D* tex3d_r = GenerateStreamedTexture(size_x, size_y, size_z, filter,
+      internalformat, format, type, ProduceScalarSlab, &slab);
+
     gl::ExitOnGLError("ERROR: After SetData");
 
     return tex3d_r;
@@ -146,94 +131,11 @@ namespace vis
   gl::Texture3D* GenerateGradientTexture(StructuredGridVolume* vol, int gradient_sample_size,
     int filter_nxnxn, bool normalized_gradient,
     int init_x, int init_y, int init_z,
-    int last_x, int last_y, int last_z)
+    int last_x, int last_y, int last_z,
+    int downsampling)
   {
-    int width = vol->GetWidth();
-    int height = vol->GetHeight();
-    int depth = vol->GetDepth();
-
-    //1
-    //Generation of gradients
-    int n = gradient_sample_size;
-    glm::dvec3* gradients = new glm::dvec3[width * height * depth];
-    glm::dvec3 s1, s2;
-    int index = 0;
-    for (int z = 0; z < depth; z++)
-    {
-      for (int y = 0; y < height; y++)
-      {
-        for (int x = 0; x < width; x++)
-        {
-          s1.x = vol->GetNormalizedSample(x - n, y, z);
-          s2.x = vol->GetNormalizedSample(x + n, y, z);
-          s1.y = vol->GetNormalizedSample(x, y - n, z);
-          s2.y = vol->GetNormalizedSample(x, y + n, z);
-          s1.z = vol->GetNormalizedSample(x, y, z - n);
-          s2.z = vol->GetNormalizedSample(x, y, z + n);
-
-          glm::dvec3 s2s1 = (s2 - s1);
-
-          if (normalized_gradient)
-          {
-            s2s1 = glm::normalize<double>(s2s1);
-          }
-          else
-          {
-            s2s1.x = s2s1.x / 2.0f * (float)gradient_sample_size;
-            s2s1.y = s2s1.y / 2.0f * (float)gradient_sample_size;
-            s2s1.z = s2s1.z / 2.0f * (float)gradient_sample_size;
-          }
-
-          gradients[index] = s2s1;
-
-          if (gradients[index].x != gradients[index].x) //lm.IsNaN
-            gradients[index] = glm::dvec3(0);
-
-          index++;
-        }
-      }
-    }
-
-    //2
-    //Filtering
-    n = filter_nxnxn;
-    index = 0;
-    if (n > 0)
-    {
-      for (int z = 0; z < depth; z++)
-      {
-        for (int y = 0; y < height; y++)
-        {
-          for (int x = 0; x < width; x++)
-          {
-            int fn = (n - 1) / 2;
-
-            glm::dvec3 average = glm::dvec3(0);
-            int num = 0;
-            for (int k = z - fn; k <= z + fn; k++)
-            {
-              for (int j = y - fn; j <= y + fn; j++)
-              {
-                for (int i = x - fn; i <= x + fn; i++)
-                {
-                  if (!vol->IsOutOfBoundary(i, j, k))
-                  {
-                    average += gradients[x + (y * width) + (z * width * height)];
-                    num++;
-                  }
-                }
-              }
-            }
-
-            average = average / (double)num;
-            if (average.x != 0.0f && average.y != 0.0f && average.z != 0.0f)
-              average = glm::normalize<double>(average);
-
-            gradients[index++] = average;
-          }
-        }
-      }
-    }
+    TRACE_SCOPE("GenerateGradientTexture", "preprocess");
+    glm::dvec3* gradients = ComputeGradients(vol, gradient_sample_size, filter_nxnxn, normalized_gradient);
 
     //3
     //Set the content of the gradient texture
@@ -253,7 +155,7 @@ namespace vis
     int size_x = abs(last_x - init_x);
     int size_y = abs(last_y - init_y);
     int size_z = abs(last_z - init_z);
-    glm::vec3* gradients_values = new glm::vec3[size_x*size_y*size_z];
+    glm::vec3* gradients_values = AllocateVoxelArray<glm::vec3>(size_x, size_y, size_z);
 
     for (int k = 0; k < size_z; k++)
     {
@@ -261,21 +163,14 @@ namespace vis
       {
         for (int i = 0; i < size_x; i++)
         {
-          gradients_values[i + (j * size_x) + (k * size_x * size_y)] = gradients[(i + init_x) + ((j + init_y) * width) + ((k + init_z) * width * height)];
+          gradients_values[(size_t)i + ((size_t)j * size_x) + ((size_t)k * size_x * size_y)] = gradients[vol->GetVoxelIndex(i + init_x, j + init_y, k + init_z)];
         }
       }
     }
 
     //4
     //Creating Texture
-    gl::Texture3D* tex3d_gradient = new gl::Texture3D(size_x, size_y, size_z);
-    tex3d_gradient->GenerateTexture(TEXTURE_FILTER, TEXTURE_FILTER, TEXTURE_WRAP, TEXTURE_WRAP, TEXTURE_WRAP);
-
-#ifdef USE_16F_INTERNAL_FORMAT
-    tex3d_gradient->SetData((GLvoid*)gradients_values, GL_RGB16F, GL_RGB, GL_FLOAT);
-#else
-    tex3d_gradient->SetData((GLvoid*)gradients_values, GL_RGB32F, GL_RGB, GL_FLOAT);
-#endif
+    gl::Texture3D* tex3d_gradient = CreateGradientTexture(gradients_values, size_x, size_y, size_z, downsampling);
 
     delete[] gradients_values;
     delete[] gradients;
@@ -284,69 +179,26 @@ namespace vis
   }
 
   // https://en.wikipedia.org/wiki/Sobel_operator  
-  gl::Texture3D* GenerateSobelFeldmanGradientTexture(StructuredGridVolume* vol)
+  gl::Texture3D* GenerateSobelFeldmanGradientTexture(StructuredGridVolume* vol, int downsampling)
   {
+    TRACE_SCOPE("GenerateSobelFeldmanGradientTexture", "preprocess");
     int width = vol->GetWidth();
     int height = vol->GetHeight();
     int depth = vol->GetDepth();
 
-    int n = 1;
-    glm::dvec3* gradients = new glm::dvec3[width * height * depth];
-    for (int z = 0; z < depth; z++)
-    {
-      for (int y = 0; y < height; y++)
-      {
-        for (int x = 0; x < width; x++)
-        {
-          glm::dvec3 sg(0.0);
-          for (int v1 = -1; v1 <= 1; v1++)
-          {
-            for (int v2 = -1; v2 <= 1; v2++)
-            {
-              sg.z += ((double)vol->GetNormalizedSample(x + v1, y + v2, z - 1)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
-                + ((double)vol->GetNormalizedSample(x + v1, y + v2, z + 1)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
-
-              sg.y += ((double)vol->GetNormalizedSample(x + v1, y - 1, z + v2)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
-                + ((double)vol->GetNormalizedSample(x + v1, y + 1, z + v2)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
-
-              sg.x += ((double)vol->GetNormalizedSample(x - 1, y + v2, z + v1)) * (4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)))
-                + ((double)vol->GetNormalizedSample(x + 1, y + v2, z + v1)) * (-4.0 / pow(2.0, glm::abs(v1) + glm::abs(v2)));
-            }
-          }
-
-          // not normalized (for tests...)
-          gradients[x + (y * width) + (z * width * height)] = sg;
-        }
-      }
-    }
-
-    glm::vec3* gradients_values = new glm::vec3[width * height * depth];
-    for (int k = 0; k < depth; k++)
-    {
-      for (int j = 0; j < height; j++)
-      {
-        for (int i = 0; i < width; i++)
-        {
-          gradients_values[i + (j * width) + (k * width * height)] = gradients[i + (j * width) + (k * width * height)];
-        }
-      }
-    }
-
-    //4
-    //Creating Texture
-    gl::Texture3D* tex3d_gradient = new gl::Texture3D(width, height, depth);
-    tex3d_gradient->GenerateTexture(TEXTURE_FILTER, TEXTURE_FILTER, TEXTURE_WRAP, TEXTURE_WRAP, TEXTURE_WRAP);
-
-#ifdef USE_16F_INTERNAL_FORMAT
-    tex3d_gradient->SetData((GLvoid*)gradients_values, GL_RGB16F, GL_RGB, GL_FLOAT);
-#else
-    tex3d_gradient->SetData((GLvoid*)gradients_values, GL_RGB32F, GL_RGB, GL_FLOAT);
-#endif
+    // The gradients are computed by the slab producer, for each slab uploaded
+    return GenerateStreamedGradientTexture(nullptr, vol, width, height, depth, downsampling);
+  }
 
-    delete[] gradients_values;
-    delete[] gradients;
+  gl::Texture3D* CreateGradientTexture (glm::vec3* gradient_values, int w, int h, int d, int downsampling)
+  {
+    return GenerateStreamedGradientTexture(gradient_values, nullptr, w, h, d, downsampling);
+  }
 
-    return tex3d_gradient;
+  gl::Texture3D* CreateScalarTexture (const double* values, int w, int h, int d, GLint internalformat)
+  {
+    DoubleSlab slab = { values, w, h, internalformat == GL_R16F ? (GLenum)GL_HALF_FLOAT : (GLenum)GL_FLOAT };
+    return GenerateStreamedTexture(w, h, d, GL_LINEAR, internalformat, GL_RED, slab.type, ProduceDoubleSlab, &slab);
   }
 
   gl::Texture2D* GenerateNoiseTexture(float maxvalue, int w, int h)
@@ -354,19 +206,27 @@ namespace vis
     std::default_random_engine generator;
     std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
 
+    // Written directly in the uploaded type, no float copy of the half floats
+#ifdef USE_16F_INTERNAL_FORMAT
+    GLhalf* disturb_points = new GLhalf[w * h];
+    for (int i = 0; i < w * h; i++)
+      disturb_points[i] = gl::FloatToHalf(distribution(generator) * maxvalue);
+#else
     GLfloat* disturb_points = new GLfloat[w * h];
     for (int i = 0; i < w * h; i++) {
       float number = distribution(generator) * maxvalue;
       disturb_points[i] = number;
     }
+#endif
 
     gl::Texture2D* tex2d = new gl::Texture2D(w, h);
     tex2d->GenerateTexture(GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
 #ifdef USE_16F_INTERNAL_FORMAT
-    tex2d->SetData(disturb_points, GL_R16F, GL_RED, GL_FLOAT);
+    tex2d->SetData(disturb_points, GL_R16F, GL_RED);
 #else
     tex2d->SetData(disturb_points, GL_R32F, GL_RED, GL_FLOAT);
 #endif
+    delete[] disturb_points;
     return tex2d;
   }
 
@@ -397,6 +257,7 @@ namespace vis
 
   gl::Texture3D* GenerateExtinctionSAT3DTex(StructuredGridVolume* vol, TransferFunction* tf)
   {
+    TRACE_SCOPE("GenerateExtinctionSAT3DTex", "preprocess");
     // 1
     // First, sample the initial "grid" and build SAT
     vis::SummedAreaTable3D<double> sat3d(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
@@ -414,15 +275,9 @@ namespace vis
     sat3d.BuildSAT();
 
     // 2
-    // Then, we must create and generate the 3D texture
-    GLfloat* diff_mat = new GLfloat[vol->GetWidth() * vol->GetHeight() * vol->GetDepth()];
+    // Then, we must create and generate the 3D texture, converted slab by slab
     double* sat_data = sat3d.GetData();
 
-    //*
-    for (int i = 0; i < vol->GetWidth() * vol->GetHeight() * vol->GetDepth(); i++)
-      diff_mat[i] = (GLfloat)sat_data[i];
-    // */
-
     /*
     for (int x = 0; x < vol->GetWidth(); x++)
     {
@@ -438,23 +293,19 @@ namespace vis
     }
     // */
 
-    gl::Texture3D* tex3d_sat = new gl::Texture3D(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
-    tex3d_sat->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-
 #ifdef USE_16F_INTERNAL_FORMAT
-    tex3d_sat->SetData((GLvoid*)diff_mat, GL_R16F, GL_RED, GL_FLOAT);
+    gl::Texture3D* tex3d_sat = CreateScalarTexture(sat_data, vol->GetWidth(), vol->GetHeight(), vol->GetDepth(), GL_R16F);
 #else
-    tex3d_sat->SetData((GLvoid*)diff_mat, GL_R32F, GL_RED, GL_FLOAT);
+    gl::Texture3D* tex3d_sat = CreateScalarTexture(sat_data, vol->GetWidth(), vol->GetHeight(), vol->GetDepth(), GL_R32F);
 #endif
 
-    delete[] diff_mat;
-
     gl::ExitOnGLError("volrend/utils.cpp - GenerateExtinctionSAT3DTex()");
     return tex3d_sat;
   }
 
   gl::Texture3D* GenerateScalarFieldSAT3DTex (StructuredGridVolume* vol)
   {
+    TRACE_SCOPE("GenerateScalarFieldSAT3DTex", "preprocess");
     // 1
     // First, sample the initial "grid" and build SAT
     vis::SummedAreaTable3D<double> sat3d(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
@@ -473,17 +324,8 @@ namespace vis
 
     // 2
     // Then, we must create and generate the 3D texture
-    GLfloat* diff_mat = new GLfloat[vol->GetWidth() * vol->GetHeight() * vol->GetDepth()];
     double* sat_data = sat3d.GetData();
-    for (int i = 0; i < vol->GetWidth() * vol->GetHeight() * vol->GetDepth(); i++)
-      diff_mat[i] = (GLfloat)sat_data[i];
-
-    gl::Texture3D* tex3d_sat = new gl::Texture3D(vol->GetWidth(), vol->GetHeight(), vol->GetDepth());
-    tex3d_sat->GenerateTexture(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
-
-    tex3d_sat->SetData((GLvoid*)diff_mat, GL_R32F, GL_RED, GL_FLOAT);
-
-    delete[] diff_mat;
+    gl::Texture3D* tex3d_sat = CreateScalarTexture(sat_data, vol->GetWidth(), vol->GetHeight(), vol->GetDepth(), GL_R32F);
 
     gl::ExitOnGLError("volrend/utils.cpp - GenerateScalarFieldSAT3DTex()");
     return tex3d_sat;
@@ -56,16 +56,27 @@ namespace vis
     int init_z = -1,
     int last_x = -1,
     int last_y = -1,
-    int last_z = -1);
+    int last_z = -1,
+    int downsampling = 1);
 
   // https://en.wikipedia.org/wiki/Sobel_operator  
-  gl::Texture3D* GenerateSobelFeldmanGradientTexture (StructuredGridVolume* vol);
+  gl::Texture3D* GenerateSobelFeldmanGradientTexture (StructuredGridVolume* vol, int downsampling = 1);
+
+  // Gradient texture of w x h x d gradient values. With downsampling > 1, each
+  //   texel is the mean of (at most) downsampling^3 values.
+  gl::Texture3D* CreateGradientTexture (glm::vec3* gradient_values, int w, int h, int d, int downsampling = 1);
+
+  // Single channel texture (GL_R16F or GL_R32F) of w x h x d double values,
+  //   e.g. summed area tables, converted slab by slab while it is uploaded
+  gl::Texture3D* CreateScalarTexture (const double* values, int w, int h, int d, GLint internalformat = GL_R32F);
 
   //https://stackoverflow.com/questions/1972172/interpolating-a-scalar-field-in-a-3d-space
   //https://www.ncbi.nlm.nih.gov/pmc/articles/PMC3719212/
 
   gl::Texture2D* GenerateNoiseTexture (float maxvalue, int w, int h);
 
+  // Writes a .syn text file with one line per voxel. For large volumes, use
+  //   the in-memory generator from proceduralvolume.h ("blobs.*.proc").
   void GenerateSyntheticVolumetricModels (int d = 120, float s = 30.0f);
 
   gl::Texture3D* GenerateExtinctionSAT3DTex (StructuredGridVolume* vol, TransferFunction* tf);
@@ -0,0 +1,383 @@
+/**
+ * Large volume test: indexing beyond 2^31 voxels
+ *
+ * Usage: cppvolrend_largevolume_test
+ *
+ * Reads a sparse 2048x2048x600 8 bit procedural volume (2.5 GB, 2^31 voxels
+ *   are reached at z = 512) with vis::VolumeReader (.proc), and compares the
+ *   voxel indexing, sampling, Sobel-Feldman gradient, texture slab, brick
+ *   hash, reader (.raw, .pvm) and summed area table paths against references
+ *   computed with 64 bit indices on the raw voxel array. Any index computed
+ *   in 32 bits wraps and reads or writes another voxel.
+ * . The volume is written to a 2.5 GB .raw file, read again, and streamed
+ *   into an 8 bit summed area table of 2048x2048x520 elements (2.2 GB). Its
+ *   sums wrap, but box sums taken from it are still exact modulo 256. A
+ *   double table or a gradient array of the whole volume would take 20 GB
+ *   or 60 GB.
+ * . At most one volume or table is alive at a time: about 2.5 GB of memory
+ *   and 2.5 GB of disk in the working directory.
+ * . The .pvm format stores sizes in 32 bits and is read through two full
+ *   copies, so it is checked on a crop around z = 512.
+ *
+ * Registered as a CTest test (microbench/CMakeLists.txt), disabled unless
+ *   CPPVOLREND_LARGE_VOLUME_TESTS is enabled.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#include <volvis_utils/structuredgridvolume.h>
+#include <volvis_utils/proceduralvolume.h>
+#include <volvis_utils/gradients.h>
+#include <volvis_utils/reader.h>
+#include <volvis_utils/textureslabs.h>
+#include <vis_utils/summedareatable.h>
+#include <gl_utils/halffloat.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define LARGE_VOLUME_FILE "vessels.1.2048x2048x600.proc"
+#define LARGE_VOLUME_RAW_FILE "vessels.1.2048x2048x600.raw"
+#define LARGE_VOLUME_PVM_FILE "vessels_crop.pvm"
+#define LARGE_VOLUME_WIDTH 2048ULL
+#define LARGE_VOLUME_HEIGHT 2048ULL
+#define LARGE_VOLUME_DEPTH 600ULL
+// First slice whose voxel indices do not fit in an int
+#define LARGE_VOLUME_FIRST_WIDE_SLICE 512
+// Slices of the summed area table, from z = 0: 2048x2048x520 elements
+#define LARGE_VOLUME_SAT_DEPTH 520
+// Slices of the box sums checked in the summed area table
+#define LARGE_VOLUME_SAT_BOX_FIRST_SLICE 500
+#define LARGE_VOLUME_BRICK_SIZE 256
+// Crop read from the .pvm file, centered at z = 512
+#define LARGE_VOLUME_PVM_SIZE 64
+
+namespace
+{
+  int s_failures = 0;
+
+  void Check (bool passed, const char* name)
+  {
+    printf("  - %-48s: %s\n", name, passed ? "ok" : "FAILED");
+    if (!passed) s_failures++;
+  }
+
+  unsigned long long RawIndex (int x, int y, int z)
+  {
+    return (unsigned long long)x + LARGE_VOLUME_WIDTH * (unsigned long long)y
+      + LARGE_VOLUME_WIDTH * LARGE_VOLUME_HEIGHT * (unsigned long long)z;
+  }
+
+  double RawSample (const unsigned char* raw, int x, int y, int z)
+  {
+    if (x < 0 || y < 0 || z < 0 || x >= (int)LARGE_VOLUME_WIDTH
+     || y >= (int)LARGE_VOLUME_HEIGHT || z >= (int)LARGE_VOLUME_DEPTH)
+      return 0.0;
+    return (double)raw[RawIndex(x, y, z)] / 255.0;
+  }
+
+  // Same filter as vis::ComputeSobelFeldmanGradient, written out per axis
+  glm::dvec3 RawSobelFeldman (const unsigned char* raw, int x, int y, int z)
+  {
+    glm::dvec3 sg(0.0);
+    for (int a = -1; a <= 1; a++)
+    {
+      for (int b = -1; b <= 1; b++)
+      {
+        double w = 4.0 / (double)(1 << (std::abs(a) + std::abs(b)));
+        sg.x += w * (RawSample(raw, x - 1, y + b, z + a) - RawSample(raw, x + 1, y + b, z + a));
+        sg.y += w * (RawSample(raw, x + a, y - 1, z + b) - RawSample(raw, x + a, y + 1, z + b));
+        sg.z += w * (RawSample(raw, x + a, y + b, z - 1) - RawSample(raw, x + a, y + b, z + 1));
+      }
+    }
+    return sg;
+  }
+
+  // Slices evaluated by the generator itself, to check where each one was written
+  class SliceReference : public vis::ProceduralVolumeGenerator
+  {
+  public:
+    SliceReference (const vis::ProceduralVolumeParameters& params)
+      : m_params(params)
+    {
+      if (m_params.shape == vis::PROCEDURAL_VOLUME_SHAPE::GAUSSIAN_BLOBS)
+        BuildGaussianBlobs(m_params);
+      else if (m_params.shape == vis::PROCEDURAL_VOLUME_SHAPE::VESSEL_TREE)
+        BuildVesselTree(m_params);
+    }
+
+    // Same quantization as FillVoxelArray for 8 bit volumes
+    void GetSlice (int z, std::vector<unsigned char>& slice)
+    {
+      std::vector<float> values((size_t)m_params.width * (size_t)m_params.height);
+      EvaluateSlice(m_params, z, values.data());
+
+      double sparsity = glm::clamp(m_params.sparsity, 0.0, 0.999);
+      slice.resize(values.size());
+      for (size_t i = 0; i < values.size(); i++)
+      {
+        double v = glm::clamp((double)values[i], 0.0, 1.0);
+        v = v < sparsity ? 0.0 : (v - sparsity) / (1.0 - sparsity);
+        slice[i] = (unsigned char)(v * 255.0 + 0.5);
+      }
+    }
+
+    // Compares the slices around 2^31 and the last one
+    bool EqualSlices (const unsigned char* raw)
+    {
+      std::vector<unsigned char> slice;
+      int slices[4] = { 0, LARGE_VOLUME_FIRST_WIDE_SLICE - 1, LARGE_VOLUME_FIRST_WIDE_SLICE, (int)LARGE_VOLUME_DEPTH - 1 };
+      bool equal = true;
+      for (int i = 0; i < 4; i++)
+      {
+        GetSlice(slices[i], slice);
+        for (size_t v = 0; v < slice.size() && equal; v++)
+          equal = raw[RawIndex(0, 0, slices[i]) + v] == slice[v];
+      }
+      return equal;
+    }
+
+  private:
+    vis::ProceduralVolumeParameters m_params;
+  };
+
+  // Sum of the box [x0, x1] x [y0, y1] x [z0, z1] from the table, modulo 256:
+  //   the 8 bit table wraps, but the differences of its sums do not change
+  unsigned char BoxSum (vis::SummedAreaTable3D<unsigned char>* sat, int x0, int y0, int z0, int x1, int y1, int z1)
+  {
+    int sum = sat->GetValue(x1, y1, z1)
+            - sat->GetValue(x0 - 1, y1, z1) - sat->GetValue(x1, y0 - 1, z1) - sat->GetValue(x1, y1, z0 - 1)
+            + sat->GetValue(x0 - 1, y0 - 1, z1) + sat->GetValue(x0 - 1, y1, z0 - 1) + sat->GetValue(x1, y0 - 1, z0 - 1)
+            - sat->GetValue(x0 - 1, y0 - 1, z0 - 1);
+    return (unsigned char)sum;
+  }
+}
+
+int main (int argc, char **argv)
+{
+  // The reader only needs the file name, the file overrides the sparsity
+  {
+    std::ofstream options(LARGE_VOLUME_FILE);
+    options << "sparsity 0.25" << std::endl;
+    options << "seed 7" << std::endl;
+  }
+
+  // Parameters of the reference slices
+  vis::ProceduralVolumeParameters params;
+  if (!params.ParseFileName(LARGE_VOLUME_FILE) || !params.ReadOptionsFile(LARGE_VOLUME_FILE))
+  {
+    printf("Error: could not read %s\n", LARGE_VOLUME_FILE);
+    return EXIT_FAILURE;
+  }
+  SliceReference reference(params);
+
+  vis::VolumeReader reader;
+  vis::StructuredGridVolume* vol = reader.ReadStructuredVolume(LARGE_VOLUME_FILE);
+  std::remove(LARGE_VOLUME_FILE);
+  if (vol == nullptr)
+  {
+    printf("Error: could not generate %s\n", LARGE_VOLUME_FILE);
+    return EXIT_FAILURE;
+  }
+  unsigned char* raw = static_cast<unsigned char*>(vol->GetArrayData());
+  const unsigned long long n_voxels = LARGE_VOLUME_WIDTH * LARGE_VOLUME_HEIGHT * LARGE_VOLUME_DEPTH;
+  const unsigned long long slice_size = LARGE_VOLUME_WIDTH * LARGE_VOLUME_HEIGHT;
+
+  printf("Started  -> Large Volume Test\n");
+
+  // Indexing
+  Check(vol->GetNumberOfVoxels() == n_voxels, "GetNumberOfVoxels");
+  Check(vol->GetArrayDataSizeInBytes() == n_voxels, "GetArrayDataSizeInBytes");
+  Check(vol->GetVoxelIndex(2047, 2047, 599) == n_voxels - 1, "GetVoxelIndex of the last voxel");
+  Check(vol->GetVoxelIndex(0, 0, LARGE_VOLUME_FIRST_WIDE_SLICE) == RawIndex(0, 0, LARGE_VOLUME_FIRST_WIDE_SLICE),
+    "GetVoxelIndex of the first voxel past 2^31");
+
+  // Generation: each slice written where the generator evaluated it
+  Check(reference.EqualSlices(raw), "Generated slices around 2^31 (.proc)");
+
+  // Non empty voxels past 2^31, away from the borders
+  std::vector<glm::ivec3> samples;
+  for (int z = (int)LARGE_VOLUME_DEPTH - 2; z > LARGE_VOLUME_FIRST_WIDE_SLICE && samples.size() < 64; z -= 7)
+    for (int y = 1; y < (int)LARGE_VOLUME_HEIGHT - 1 && samples.size() < 64; y += 3)
+      for (int x = 1; x < (int)LARGE_VOLUME_WIDTH - 1 && samples.size() < 64; x += 5)
+        if (raw[RawIndex(x, y, z)] != 0) samples.push_back(glm::ivec3(x, y, z));
+  Check(!samples.empty(), "Non empty voxels past 2^31");
+  samples.push_back(glm::ivec3(2047, 2047, 599));
+  samples.push_back(glm::ivec3(0, 0, LARGE_VOLUME_FIRST_WIDE_SLICE));
+
+  // Sampling and gradients
+  {
+    bool samples_equal = true;
+    bool gradients_equal = true;
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+      glm::ivec3 p = samples[i];
+      samples_equal = samples_equal && vol->GetNormalizedSample(p.x, p.y, p.z) == RawSample(raw, p.x, p.y, p.z);
+
+      glm::dvec3 g = vis::ComputeSobelFeldmanGradient(vol, p.x, p.y, p.z);
+      glm::dvec3 g_ref = RawSobelFeldman(raw, p.x, p.y, p.z);
+      gradients_equal = gradients_equal && glm::length(g - g_ref) < 1e-9;
+    }
+    Check(samples_equal, "GetNormalizedSample past 2^31");
+    Check(gradients_equal, "ComputeSobelFeldmanGradient past 2^31");
+  }
+
+  // Texture slabs: cpu stage of GenerateRTexture, slices 511 and 512 of a
+  //   texture starting at z = 500
+  {
+    std::vector<GLhalf> slab(2 * slice_size);
+    vis::ScalarSlab scalars = { vol, 0, 0, 500, (int)LARGE_VOLUME_WIDTH, (int)LARGE_VOLUME_HEIGHT, GL_HALF_FLOAT };
+    vis::ProduceScalarSlab(&scalars, LARGE_VOLUME_FIRST_WIDE_SLICE - 1 - 500, 2, slab.data());
+
+    bool equal = true;
+    for (unsigned long long v = 0; v < slab.size() && equal; v++)
+      equal = slab[v] == gl::FloatToHalf((float)raw[RawIndex(0, 0, LARGE_VOLUME_FIRST_WIDE_SLICE - 1) + v] / 255.0f);
+    Check(equal, "ProduceScalarSlab around 2^31");
+  }
+
+  // Texture slabs: cpu stage of GenerateSobelFeldmanGradientTexture, full
+  //   resolution at z = 599 and downsampled by 2 at z = 512 and 513
+  {
+    vis::GradientSlab gradients = { nullptr, vol, (int)LARGE_VOLUME_WIDTH, (int)LARGE_VOLUME_HEIGHT, (int)LARGE_VOLUME_DEPTH,
+      1, (int)LARGE_VOLUME_WIDTH, (int)LARGE_VOLUME_HEIGHT, GL_FLOAT };
+    std::vector<glm::vec3> slab(slice_size);
+    vis::ProduceGradientSlab(&gradients, (int)LARGE_VOLUME_DEPTH - 1, 1, slab.data());
+
+    bool equal = true;
+    for (int y = 0; y < (int)LARGE_VOLUME_HEIGHT && equal; y += 31)
+      for (int x = 0; x < (int)LARGE_VOLUME_WIDTH && equal; x += 29)
+        equal = glm::length(slab[x + LARGE_VOLUME_WIDTH * y] - glm::vec3(RawSobelFeldman(raw, x, y, (int)LARGE_VOLUME_DEPTH - 1))) < 1e-5f;
+    Check(equal, "ProduceGradientSlab of the last slice");
+
+    gradients.downsampling = 2;
+    gradients.tex_w = (int)LARGE_VOLUME_WIDTH / 2;
+    gradients.tex_h = (int)LARGE_VOLUME_HEIGHT / 2;
+    vis::ProduceGradientSlab(&gradients, LARGE_VOLUME_FIRST_WIDE_SLICE / 2, 1, slab.data());
+
+    equal = true;
+    for (int j = 0; j < gradients.tex_h && equal; j += 17)
+    {
+      for (int i = 0; i < gradients.tex_w && equal; i += 13)
+      {
+        glm::dvec3 mean(0.0);
+        for (int z = LARGE_VOLUME_FIRST_WIDE_SLICE; z < LARGE_VOLUME_FIRST_WIDE_SLICE + 2; z++)
+          for (int y = 2 * j; y < 2 * j + 2; y++)
+            for (int x = 2 * i; x < 2 * i + 2; x++)
+              mean += RawSobelFeldman(raw, x, y, z) / 8.0;
+        equal = glm::length(slab[i + (size_t)gradients.tex_w * j] - glm::vec3(mean)) < 1e-5f;
+      }
+    }
+    Check(equal, "ProduceGradientSlab downsampled past 2^31");
+  }
+
+  // Brick hashes: changing the last voxel changes only the last brick
+  std::vector<unsigned long long> hashes = vol->ComputeBrickHashes(LARGE_VOLUME_BRICK_SIZE);
+  {
+    size_t n_bricks = (size_t)(8 * 8 * 3);
+    Check(hashes.size() == n_bricks, "ComputeBrickHashes brick count");
+
+    raw[n_voxels - 1] ^= 0xFF;
+    std::vector<unsigned long long> changed = vol->ComputeBrickHashes(LARGE_VOLUME_BRICK_SIZE);
+    raw[n_voxels - 1] ^= 0xFF;
+
+    bool only_last = changed.size() == n_bricks && changed.back() != hashes.back();
+    for (size_t b = 0; b + 1 < changed.size() && only_last; b++)
+      only_last = changed[b] == hashes[b];
+    Check(only_last, "ComputeBrickHashes of the last brick");
+  }
+
+  // .pvm: crop around z = 512, through the uncompressed PVM header
+  {
+    const int n = LARGE_VOLUME_PVM_SIZE;
+    const int x0 = 1000, y0 = 1000, z0 = LARGE_VOLUME_FIRST_WIDE_SLICE - n / 2;
+    std::vector<unsigned char> crop((size_t)n * n * n);
+    for (int z = 0; z < n; z++)
+      for (int y = 0; y < n; y++)
+        for (int x = 0; x < n; x++)
+          crop[x + (size_t)n * y + (size_t)n * n * z] = raw[RawIndex(x0 + x, y0 + y, z0 + z)];
+    {
+      std::ofstream pvm(LARGE_VOLUME_PVM_FILE, std::ios::binary);
+      pvm << "PVM\n" << n << " " << n << " " << n << "\n1\n";
+      pvm.write((const char*)crop.data(), crop.size());
+    }
+
+    vis::StructuredGridVolume* pvm_vol = reader.ReadStructuredVolume(LARGE_VOLUME_PVM_FILE);
+    std::remove(LARGE_VOLUME_PVM_FILE);
+
+    bool equal = pvm_vol != nullptr && pvm_vol->GetWidth() == n && pvm_vol->GetHeight() == n && pvm_vol->GetDepth() == n;
+    for (int z = 0; z < n && equal; z++)
+      for (int y = 0; y < n && equal; y++)
+        for (int x = 0; x < n && equal; x++)
+          equal = pvm_vol->GetNormalizedSample(x, y, z) == RawSample(raw, x0 + x, y0 + y, z0 + z);
+    Check(equal, "VolumeReader .pvm of a crop around 2^31");
+    delete pvm_vol;
+  }
+
+  // .raw: the whole volume, read again after the generated one is released
+  {
+    FILE* file = fopen(LARGE_VOLUME_RAW_FILE, "wb");
+    bool written = file != nullptr && fwrite(raw, 1, n_voxels, file) == n_voxels;
+    if (file) fclose(file);
+    Check(written, "Write the .raw file");
+
+    delete vol;
+    vol = nullptr;
+    raw = nullptr;
+
+    vis::StructuredGridVolume* raw_vol = written ? reader.ReadStructuredVolume(LARGE_VOLUME_RAW_FILE) : nullptr;
+    bool equal = raw_vol != nullptr && raw_vol->GetNumberOfVoxels() == n_voxels
+      && raw_vol->ComputeBrickHashes(LARGE_VOLUME_BRICK_SIZE) == hashes
+      && reference.EqualSlices(static_cast<unsigned char*>(raw_vol->GetArrayData()));
+    Check(equal, "VolumeReader .raw past 2^31");
+    delete raw_vol;
+  }
+
+  // Summed area table above 2^31 elements, streamed from the .raw file
+  {
+    vis::SummedAreaTable3D<unsigned char> sat((unsigned int)LARGE_VOLUME_WIDTH, (unsigned int)LARGE_VOLUME_HEIGHT, LARGE_VOLUME_SAT_DEPTH);
+    // Slices of the checked boxes, and the sum of all the slices modulo 256
+    const int box_depth = LARGE_VOLUME_SAT_DEPTH - LARGE_VOLUME_SAT_BOX_FIRST_SLICE;
+    std::vector<unsigned char> box_slices(box_depth * slice_size);
+    unsigned char total = 0;
+
+    FILE* file = fopen(LARGE_VOLUME_RAW_FILE, "rb");
+    bool read = file != nullptr;
+    for (int z = 0; z < LARGE_VOLUME_SAT_DEPTH && read; z++)
+    {
+      unsigned char* slice = sat.GetData() + sat.GetDataIndex(0, 0, z);
+      read = fread(slice, 1, slice_size, file) == slice_size;
+      for (unsigned long long v = 0; v < slice_size; v++)
+        total += slice[v];
+      if (z >= LARGE_VOLUME_SAT_BOX_FIRST_SLICE)
+        std::copy(slice, slice + slice_size, box_slices.begin() + (z - LARGE_VOLUME_SAT_BOX_FIRST_SLICE) * slice_size);
+    }
+    if (file) fclose(file);
+    std::remove(LARGE_VOLUME_RAW_FILE);
+    Check(read, "Read the .raw file slices");
+
+    sat.BuildSAT();
+
+    bool sums_equal = read && BoxSum(&sat, 0, 0, 0, 2047, 2047, LARGE_VOLUME_SAT_DEPTH - 1) == total;
+    samples.push_back(glm::ivec3(2047, 2047, 0));
+    for (size_t i = 0; i < samples.size() && sums_equal; i++)
+    {
+      glm::ivec3 p = samples[i];
+      int x0 = glm::max(p.x - 8, 0), x1 = glm::min(p.x + 8, 2047);
+      int y0 = glm::max(p.y - 8, 0), y1 = glm::min(p.y + 8, 2047);
+      unsigned char box = 0;
+      for (int z = 0; z < box_depth; z++)
+        for (int y = y0; y <= y1; y++)
+          for (int x = x0; x <= x1; x++)
+            box += box_slices[x + LARGE_VOLUME_WIDTH * y + slice_size * z];
+      sums_equal = BoxSum(&sat, x0, y0, LARGE_VOLUME_SAT_BOX_FIRST_SLICE, x1, y1, LARGE_VOLUME_SAT_DEPTH - 1) == box;
+    }
+    Check(sums_equal, "SummedAreaTable3D above 2^31 elements");
+  }
+
+  printf("Finished -> Large Volume Test: %d failures\n", s_failures);
+  return s_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,82 @@
+/**
+ * C++ Volume Rendering CPU Microbenchmarks
+ *
+ * Usage: cppvolrend_microbench [-s <sizes>] [-b <bits>] [-t <threads>] [-k <kernel filter>]
+ *                              [-r <min runs>] [-m <min time ms>] [-o <results file>] [-l]
+ *
+ * Lists are comma separated, e.g. "-s 64,128,256 -b 8,16 -t 1,4,8". By default,
+ *   sizes 64, 128 and 256, bit depths 8, 16 and 32, and 1 and all threads are
+ *   measured. "-k" runs only the kernels whose name contains the filter, "-l"
+ *   lists the kernels. See microbenchmark.h.
+ *
+ * Does not create any window or OpenGL context.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "microbenchmark.h"
+#include "volumekernels.h"
+
+std::vector<int> ParseIntList (std::string list)
+{
+  std::vector<int> values;
+  std::stringstream ss(list);
+  std::string item;
+  while (std::getline(ss, item, ','))
+  {
+    int v = atoi(item.c_str());
+    if (v > 0) values.push_back(v);
+  }
+  return values;
+}
+
+int main (int argc, char **argv)
+{
+  Microbenchmark microbenchmark;
+  AddVolumeKernels(&microbenchmark);
+
+  std::string output_filepath = "";
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    if (arg == "-l")
+    {
+      microbenchmark.ListKernels();
+      return EXIT_SUCCESS;
+    }
+    else if (arg == "-s" && i + 1 < argc)
+      microbenchmark.SetSizes(ParseIntList(argv[++i]));
+    else if (arg == "-b" && i + 1 < argc)
+      microbenchmark.SetBitDepths(ParseIntList(argv[++i]));
+    else if (arg == "-t" && i + 1 < argc)
+      microbenchmark.SetThreadCounts(ParseIntList(argv[++i]));
+    else if (arg == "-k" && i + 1 < argc)
+      microbenchmark.SetFilter(argv[++i]);
+    else if (arg == "-r" && i + 1 < argc)
+      microbenchmark.SetMinimumRuns(atoi(argv[++i]));
+    else if (arg == "-m" && i + 1 < argc)
+      microbenchmark.SetMinimumTime(atof(argv[++i]));
+    else if (arg == "-o" && i + 1 < argc)
+      output_filepath = argv[++i];
+    else
+    {
+      printf("Usage: cppvolrend_microbench [-s <sizes>] [-b <bits>] [-t <threads>] [-k <kernel filter>]\n");
+      printf("                             [-r <min runs>] [-m <min time ms>] [-o <results file>] [-l]\n");
+      return EXIT_FAILURE;
+    }
+  }
+
+  bool success = microbenchmark.Run();
+  DestroyVolumeKernelsData();
+
+  if (!output_filepath.empty() && !microbenchmark.WriteCsv(output_filepath))
+    success = false;
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,199 @@
+#include "microbenchmark.h"
+
+#include <utils/framestatistics.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include <omp.h>
+
+MicrobenchmarkKernel::MicrobenchmarkKernel (std::string name, bool uses_bit_depth)
+  : m_name(name)
+  , m_uses_bit_depth(uses_bit_depth)
+  , m_voxels_per_run(0.0)
+  , m_bytes_per_run(0.0)
+{}
+
+MicrobenchmarkKernel::~MicrobenchmarkKernel ()
+{}
+
+std::string MicrobenchmarkKernel::GetName ()
+{
+  return m_name;
+}
+
+bool MicrobenchmarkKernel::UsesBitDepth ()
+{
+  return m_uses_bit_depth;
+}
+
+double MicrobenchmarkKernel::GetVoxelsPerRun ()
+{
+  return m_voxels_per_run;
+}
+
+double MicrobenchmarkKernel::GetBytesPerRun ()
+{
+  return m_bytes_per_run;
+}
+
+Microbenchmark::Microbenchmark ()
+  : m_min_runs(5)
+  , m_min_time_ms(200.0)
+  , m_filter("")
+{
+  m_sizes = { 64, 128, 256 };
+  m_bits = { 8, 16, 32 };
+  m_threads = { 1, omp_get_max_threads() };
+  if (m_threads[1] == 1) m_threads.pop_back();
+}
+
+Microbenchmark::~Microbenchmark ()
+{
+  for (int i = 0; i < m_kernels.size(); i++)
+    delete m_kernels[i];
+  m_kernels.clear();
+}
+
+void Microbenchmark::AddKernel (MicrobenchmarkKernel* kernel)
+{
+  m_kernels.push_back(kernel);
+}
+
+void Microbenchmark::SetSizes (std::vector<int> sizes)
+{
+  m_sizes = sizes;
+}
+
+void Microbenchmark::SetBitDepths (std::vector<int> bits)
+{
+  m_bits = bits;
+}
+
+void Microbenchmark::SetThreadCounts (std::vector<int> threads)
+{
+  m_threads = threads;
+}
+
+void Microbenchmark::SetMinimumRuns (int min_runs)
+{
+  m_min_runs = min_runs;
+}
+
+void Microbenchmark::SetMinimumTime (double min_time_ms)
+{
+  m_min_time_ms = min_time_ms;
+}
+
+void Microbenchmark::SetFilter (std::string filter)
+{
+  m_filter = filter;
+}
+
+void Microbenchmark::ListKernels ()
+{
+  for (int i = 0; i < m_kernels.size(); i++)
+    printf("%s%s\n", m_kernels[i]->GetName().c_str(), m_kernels[i]->UsesBitDepth() ? "" : " (32 bits only)");
+}
+
+bool Microbenchmark::Run ()
+{
+  results.clear();
+
+  printf("%-62s %5s %4s %7s %5s %12s %12s %10s\n", "Kernel", "Size", "Bits", "Threads", "Runs",
+    "Median (ms)", "MVoxels/s", "GB/s");
+
+  bool success = true;
+  for (int k = 0; k < m_kernels.size(); k++)
+  {
+    MicrobenchmarkKernel* kernel = m_kernels[k];
+    if (!m_filter.empty() && kernel->GetName().find(m_filter) == std::string::npos) continue;
+
+    for (int s = 0; s < m_sizes.size(); s++)
+    {
+      for (int b = 0; b < m_bits.size(); b++)
+      {
+        if (!kernel->UsesBitDepth() && m_bits[b] != 32) continue;
+
+        if (!kernel->Setup(m_sizes[s], m_bits[b]))
+        {
+          std::cout << "Error: Unable to set up " << kernel->GetName() << " (size " << m_sizes[s]
+                    << ", " << m_bits[b] << " bits)." << std::endl;
+          success = false;
+          continue;
+        }
+        for (int t = 0; t < m_threads.size(); t++)
+          Measure(kernel, m_sizes[s], m_bits[b], m_threads[t]);
+        kernel->Cleanup();
+      }
+    }
+  }
+
+  return success;
+}
+
+bool Microbenchmark::WriteCsv (std::string filepath)
+{
+  std::ofstream f_csv(filepath, std::ios_base::out);
+  if (!f_csv.is_open())
+  {
+    std::cout << "Error: Unable to write results file " << filepath << "." << std::endl;
+    return false;
+  }
+
+  f_csv << "Kernel,Size,Bits,Threads,Runs,MedianTime (ms),MinTime (ms),StdDevTime (ms),Voxels/s,GB/s" << std::endl;
+  for (int i = 0; i < results.size(); i++)
+  {
+    Result& r = results[i];
+    f_csv << r.kernel << "," << r.size << "," << r.bits << "," << r.threads << "," << r.runs << ","
+          << r.median_ms << "," << r.min_ms << "," << r.stddev_ms << ","
+          << r.voxels_per_second << "," << r.gigabytes_per_second << std::endl;
+  }
+  f_csv.close();
+
+  printf("Results written to %s\n", filepath.c_str());
+  return true;
+}
+
+void Microbenchmark::Measure (MicrobenchmarkKernel* kernel, int size, int bits, int threads)
+{
+  omp_set_num_threads(threads);
+
+  kernel->Prepare();
+  kernel->Run();
+
+  std::vector<double> run_times;
+  double total_ms = 0.0;
+  while (run_times.size() < m_min_runs || total_ms < m_min_time_ms)
+  {
+    kernel->Prepare();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    kernel->Run();
+    double run_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+    run_times.push_back(run_ms);
+    total_ms += run_ms;
+  }
+
+  FrameStatistics stats;
+  stats.Compute(run_times);
+
+  Result r;
+  r.kernel = kernel->GetName();
+  r.size = size;
+  r.bits = bits;
+  r.threads = threads;
+  r.runs = stats.n_frames;
+  r.median_ms = stats.median;
+  r.min_ms = stats.min;
+  r.stddev_ms = stats.stddev;
+  r.voxels_per_second = stats.median > 0.0 ? kernel->GetVoxelsPerRun() / (stats.median / 1000.0) : 0.0;
+  r.gigabytes_per_second = stats.median > 0.0 ? kernel->GetBytesPerRun() / (stats.median / 1000.0) / 1.0e9 : 0.0;
+  results.push_back(r);
+
+  printf("%-62s %5d %4d %7d %5d %12.3f %12.1f %10.2f\n", r.kernel.c_str(), r.size, r.bits, r.threads, r.runs,
+    r.median_ms, r.voxels_per_second / 1.0e6, r.gigabytes_per_second);
+  fflush(stdout);
+}
@@ -0,0 +1,116 @@
+/**
+ * CPU microbenchmarks of the volume kernels in libs/ (cppvolrend_microbench).
+ *
+ * Each kernel is measured for every volume size (size^3 voxels), bit depth
+ *   (8, 16 or 32 bits per voxel, 32 being normalized floats) and OpenMP
+ *   thread count. A kernel that does not depend on the bit depth runs only
+ *   for 32 bits. Serial kernels are also run for every thread count, and
+ *   show flat scaling.
+ *
+ * A measurement runs the kernel once as warmup, then repeats it until both
+ *   a minimum number of runs and a minimum time are reached. The median run
+ *   time is reported, together with:
+ * . Voxels/s: voxels (or samples) processed per second
+ * . GB/s: bytes that the kernel must at least read and write, per second
+ *     (each voxel counted once, cache reuse is not counted)
+ *
+ * No OpenGL context is created: only cpu code is compiled in, see
+ *   microbench/CMakeLists.txt.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef CPPVOLREND_MICROBENCHMARK_H
+#define CPPVOLREND_MICROBENCHMARK_H
+
+#include <string>
+#include <vector>
+
+class MicrobenchmarkKernel
+{
+public:
+  MicrobenchmarkKernel (std::string name, bool uses_bit_depth);
+  virtual ~MicrobenchmarkKernel ();
+
+  std::string GetName ();
+  bool UsesBitDepth ();
+
+  // Allocates the inputs for a size^3 volume with bits per voxel, and sets
+  //   the number of voxels and bytes processed by one run. Not timed.
+  virtual bool Setup (int size, int bits) = 0;
+  // Called before each run, not timed (e.g. to restore in-place data)
+  virtual void Prepare () {}
+  // One timed run
+  virtual void Run () = 0;
+  virtual void Cleanup () = 0;
+
+  double GetVoxelsPerRun ();
+  double GetBytesPerRun ();
+
+protected:
+  std::string m_name;
+  bool m_uses_bit_depth;
+
+  double m_voxels_per_run;
+  double m_bytes_per_run;
+
+private:
+};
+
+class Microbenchmark
+{
+public:
+  class Result
+  {
+  public:
+    std::string kernel;
+    int size;
+    int bits;
+    int threads;
+    int runs;
+    double median_ms;
+    double min_ms;
+    double stddev_ms;
+    double voxels_per_second;
+    double gigabytes_per_second;
+  };
+
+  Microbenchmark ();
+  ~Microbenchmark ();
+
+  // Takes ownership of the kernel
+  void AddKernel (MicrobenchmarkKernel* kernel);
+
+  void SetSizes (std::vector<int> sizes);
+  void SetBitDepths (std::vector<int> bits);
+  void SetThreadCounts (std::vector<int> threads);
+  void SetMinimumRuns (int min_runs);
+  void SetMinimumTime (double min_time_ms);
+  // Only kernels whose name contains filter are run
+  void SetFilter (std::string filter);
+
+  void ListKernels ();
+
+  // Returns false if any kernel setup failed
+  bool Run ();
+
+  bool WriteCsv (std::string filepath);
+
+  std::vector<Result> results;
+
+protected:
+  void Measure (MicrobenchmarkKernel* kernel, int size, int bits, int threads);
+
+  std::vector<MicrobenchmarkKernel*> m_kernels;
+
+  std::vector<int> m_sizes;
+  std::vector<int> m_bits;
+  std::vector<int> m_threads;
+  int m_min_runs;
+  double m_min_time_ms;
+  std::string m_filter;
+
+private:
+};
+
+#endif
@@ -0,0 +1,482 @@
+#include "volumekernels.h"
+
+#include <volvis_utils/structuredgridvolume.h>
+#include <volvis_utils/proceduralvolume.h>
+#include <volvis_utils/transferfunction1d.h>
+#include <volvis_utils/gradients.h>
+#include <volvis_utils/generalizedsampling.h>
+#include <vis_utils/summedareatable.h>
+#include <file_utils/pvm_old.h>
+#include <gl_utils/halffloat.h>
+
+#include <vis_utils/filters/box.hpp>
+#include <vis_utils/filters/hat.hpp>
+#include <vis_utils/filters/catmullrom.hpp>
+#include <vis_utils/filters/mitchellnetravali.hpp>
+#include <vis_utils/filters/bspline3.hpp>
+#include <vis_utils/filters/omoms3.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <utility>
+
+#include <omp.h>
+
+#define VOLUME_KERNELS_PVM_FILE "cppvolrend_microbench.pvm"
+
+namespace
+{
+  std::map<std::pair<int, int>, vis::StructuredGridVolume*> s_volumes;
+
+  vis::StructuredGridVolume* GetVolume (int size, int bits)
+  {
+    std::pair<int, int> key(size, bits);
+    if (s_volumes.find(key) == s_volumes.end())
+    {
+      vis::ProceduralVolumeParameters params;
+      params.shape = vis::PROCEDURAL_VOLUME_SHAPE::GAUSSIAN_BLOBS;
+      params.width = params.height = params.depth = size;
+      params.bytes_per_voxel = bits / 8;
+
+      vis::ProceduralVolumeGenerator generator;
+      s_volumes[key] = generator.Generate(params);
+    }
+    return s_volumes[key];
+  }
+
+  double GetBytesPerVoxel (int bits)
+  {
+    return double(bits / 8);
+  }
+
+  /////////////////////////////////////////////////////////////////////////////
+  // StructuredGridVolume sampling
+  class NormalizedSampleKernel : public MicrobenchmarkKernel
+  {
+  public:
+    NormalizedSampleKernel ()
+      : MicrobenchmarkKernel("StructuredGridVolume::GetNormalizedSample", true)
+      , m_volume(nullptr), m_sum(0.0)
+    {}
+
+    virtual bool Setup (int size, int bits)
+    {
+      m_volume = GetVolume(size, bits);
+      if (!m_volume) return false;
+
+      m_voxels_per_run = double(m_volume->GetNumberOfVoxels());
+      m_bytes_per_run = m_voxels_per_run * GetBytesPerVoxel(bits);
+      return true;
+    }
+
+    virtual void Run ()
+    {
+      int w = m_volume->GetWidth(), h = m_volume->GetHeight(), d = m_volume->GetDepth();
+      double sum = 0.0;
+#pragma omp parallel for reduction(+:sum)
+      for (int z = 0; z < d; z++)
+        for (int y = 0; y < h; y++)
+          for (int x = 0; x < w; x++)
+            sum += m_volume->GetNormalizedSample(x, y, z);
+      m_sum = sum;
+    }
+
+    virtual void Cleanup ()
+    {
+      m_volume = nullptr;
+    }
+
+  protected:
+    vis::StructuredGridVolume* m_volume;
+    double m_sum;
+  };
+
+  class NormalizedInterpolatedSampleKernel : public NormalizedSampleKernel
+  {
+  public:
+    NormalizedInterpolatedSampleKernel ()
+    {
+      m_name = "StructuredGridVolume::GetNormalizedInterpolatedSample";
+    }
+
+    // One sample per voxel, shifted by half a voxel
+    virtual void Run ()
+    {
+      int w = m_volume->GetWidth(), h = m_volume->GetHeight(), d = m_volume->GetDepth();
+      glm::dvec3 bbmin = m_volume->GetGridBBoxMin();
+      glm::dvec3 step = (m_volume->GetGridBBoxMax() - bbmin) / glm::dvec3(w, h, d);
+      double sum = 0.0;
+#pragma omp parallel for reduction(+:sum)
+      for (int z = 0; z < d; z++)
+        for (int y = 0; y < h; y++)
+          for (int x = 0; x < w; x++)
+            sum += m_volume->GetNormalizedInterpolatedSample(bbmin.x + (x + 0.5) * step.x,
+                                                             bbmin.y + (y + 0.5) * step.y,
+                                                             bbmin.z + (z + 0.5) * step.z);
+      m_sum = sum;
+    }
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  // TransferFunction1D, evaluated at each normalized voxel value
+  class TransferFunctionKernel : public MicrobenchmarkKernel
+  {
+  public:
+    TransferFunctionKernel ()
+      : MicrobenchmarkKernel("TransferFunction1D::Get", true)
+      , m_tf(nullptr), m_values(nullptr), m_colors(nullptr), m_n_values(0)
+    {}
+
+    // The transfer function has as many entries as the data values (65536
+    //   for 16 bits, 256 otherwise)
+    virtual bool Setup (int size, int bits)
+    {
+      vis::StructuredGridVolume* vol = GetVolume(size, bits);
+      if (!vol) return false;
+
+      int max_value = bits == 16 ? 65535 : 255;
+      m_tf = new vis::TransferFunction1D(max_value);
+      m_tf->AddRGBControlPoint(vis::TransferControlPoint(0.0, 0.0, 1.0, 0));
+      m_tf->AddRGBControlPoint(vis::TransferControlPoint(1.0, 1.0, 1.0, max_value / 2));
+      m_tf->AddRGBControlPoint(vis::TransferControlPoint(1.0, 0.0, 0.0, max_value));
+      m_tf->AddAlphaControlPoint(vis::TransferControlPoint(0.0, 0));
+      m_tf->AddAlphaControlPoint(vis::TransferControlPoint(0.0, max_value / 10));
+      m_tf->AddAlphaControlPoint(vis::TransferControlPoint(0.5, max_value / 2));
+      m_tf->AddAlphaControlPoint(vis::TransferControlPoint(1.0, max_value));
+      m_tf->Build();
+
+      m_n_values = vol->GetNumberOfVoxels();
+      m_values = new double[m_n_values];
+      m_colors = new glm::vec4[m_n_values];
+      for (size_t i = 0; i < m_n_values; i++)
+        m_values[i] = vol->GetNormalizedSample(int(i % size), int((i / size) % size), int(i / ((size_t)size * size)));
+
+      m_voxels_per_run = double(m_n_values);
+      m_bytes_per_run = m_voxels_per_run * double(sizeof(double) + sizeof(glm::vec4));
+      return true;
+    }
+
+    virtual void Run ()
+    {
+      long long n = (long long)m_n_values;
+#pragma omp parallel for
+      for (long long i = 0; i < n; i++)
+        m_colors[i] = m_tf->Get(m_values[i], 1.0);
+    }
+
+    virtual void Cleanup ()
+    {
+      delete m_tf;
+      delete[] m_values;
+      delete[] m_colors;
+      m_tf = nullptr;
+      m_values = nullptr;
+      m_colors = nullptr;
+    }
+
+  protected:
+    vis::TransferFunction1D* m_tf;
+    double* m_values;
+    glm::vec4* m_colors;
+    size_t m_n_values;
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  // SummedAreaTable3D<double>, as in GenerateExtinctionSAT3DTex
+  class SummedAreaTableKernel : public MicrobenchmarkKernel
+  {
+  public:
+    SummedAreaTableKernel ()
+      : MicrobenchmarkKernel("SummedAreaTable3D::BuildSAT", false)
+      , m_sat(nullptr), m_values(nullptr)
+    {}
+
+    virtual bool Setup (int size, int bits)
+    {
+      vis::StructuredGridVolume* vol = GetVolume(size, bits);
+      if (!vol) return false;
+
+      m_sat = new vis::SummedAreaTable3D<double>(size, size, size);
+      m_values = new double[vol->GetNumberOfVoxels()];
+      for (int z = 0; z < size; z++)
+        for (int y = 0; y < size; y++)
+          for (int x = 0; x < size; x++)
+            m_values[m_sat->GetDataIndex(x, y, z)] = vol->GetNormalizedSample(x, y, z);
+
+      m_voxels_per_run = double(vol->GetNumberOfVoxels());
+      m_bytes_per_run = m_voxels_per_run * double(sizeof(double)) * 2.0;
+      return true;
+    }
+
+    // The table is built in place
+    virtual void Prepare ()
+    {
+      memcpy(m_sat->GetData(), m_values, size_t(m_voxels_per_run) * sizeof(double));
+    }
+
+    virtual void Run ()
+    {
+      m_sat->BuildSAT();
+    }
+
+    virtual void Cleanup ()
+    {
+      delete m_sat;
+      delete[] m_values;
+      m_sat = nullptr;
+      m_values = nullptr;
+    }
+
+  protected:
+    vis::SummedAreaTable3D<double>* m_sat;
+    double* m_values;
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Gradient generators, without the texture upload
+  class GradientKernel : public NormalizedSampleKernel
+  {
+  public:
+    GradientKernel (int filter_nxnxn)
+      : m_filter_nxnxn(filter_nxnxn)
+    {
+      m_name = "ComputeGradients";
+      if (m_filter_nxnxn > 0)
+        m_name += " (filter " + std::to_string(m_filter_nxnxn) + "^3)";
+    }
+
+    virtual bool Setup (int size, int bits)
+    {
+      if (!NormalizedSampleKernel::Setup(size, bits)) return false;
+      m_bytes_per_run += m_voxels_per_run * double(sizeof(glm::dvec3));
+      return true;
+    }
+
+    virtual void Run ()
+    {
+      glm::dvec3* gradients = vis::ComputeGradients(m_volume, 1, m_filter_nxnxn, true);
+      delete[] gradients;
+    }
+
+  protected:
+    int m_filter_nxnxn;
+  };
+
+  class SobelFeldmanGradientKernel : public GradientKernel
+  {
+  public:
+    SobelFeldmanGradientKernel ()
+      : GradientKernel(0)
+    {
+      m_name = "ComputeSobelFeldmanGradients";
+    }
+
+    virtual void Run ()
+    {
+      glm::dvec3* gradients = vis::ComputeSobelFeldmanGradients(m_volume);
+      delete[] gradients;
+    }
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  // GeneralizedSampling, 2x upsampling of a size^2 image (as the scaling
+  //   filter of the rendered frame)
+  template<typename Kernel>
+  class GeneralizedSamplingKernel : public MicrobenchmarkKernel
+  {
+  public:
+    GeneralizedSamplingKernel (std::string filter_name)
+      : MicrobenchmarkKernel("GeneralizedSampling::ApplyFiltering2D<" + filter_name + "> (2x)", false)
+      , m_size(0)
+    {}
+
+    virtual bool Setup (int size, int bits)
+    {
+      vis::StructuredGridVolume* vol = GetVolume(size, bits);
+      if (!vol) return false;
+
+      m_size = size;
+      m_image = std::vector<std::vector<float>>(size, std::vector<float>(size));
+      for (int y = 0; y < size; y++)
+        for (int x = 0; x < size; x++)
+          m_image[y][x] = float(vol->GetNormalizedSample(x, y, size / 2));
+
+      m_voxels_per_run = double(4 * size * size);
+      m_bytes_per_run = double(5 * size * size) * double(sizeof(float));
+      return true;
+    }
+
+    virtual void Run ()
+    {
+      m_output = m_sampling.ApplyFiltering2D<Kernel, float>(m_image, 2 * m_size, 2 * m_size);
+    }
+
+    virtual void Cleanup ()
+    {
+      m_image.clear();
+      m_output.clear();
+    }
+
+  protected:
+    vis::GeneralizedSampling m_sampling;
+    std::vector<std::vector<float>> m_image;
+    std::vector<std::vector<float>> m_output;
+    int m_size;
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  // PvmOld::DecodeReescaledMinMaxData, from an uncompressed .pvm file with
+  //   1 (8 bits) or 2 (16 and 32 bits) bytes per voxel. 32 bits decodes
+  //   into normalized floats.
+  class PvmDecodeKernel : public MicrobenchmarkKernel
+  {
+  public:
+    PvmDecodeKernel ()
+      : MicrobenchmarkKernel("PvmOld::DecodeReescaledMinMaxData", true)
+      , m_pvm(nullptr), m_dst(nullptr), m_dst_bytes_per_voxel(0)
+    {}
+
+    virtual bool Setup (int size, int bits)
+    {
+      unsigned int components = bits == 8 ? 1 : 2;
+      vis::StructuredGridVolume* vol = GetVolume(size, components * 8);
+      if (!vol) return false;
+
+      FILE* f_pvm = fopen(VOLUME_KERNELS_PVM_FILE, "wb");
+      if (!f_pvm) return false;
+      fprintf(f_pvm, "PVM\n%d %d %d\n%u\n", size, size, size, components);
+      size_t n_voxels = vol->GetNumberOfVoxels();
+      if (components == 1)
+        fwrite(vol->GetArrayData(), 1, n_voxels, f_pvm);
+      else
+      {
+        // 16 bit pvm values are big endian
+        unsigned short* values = static_cast<unsigned short*>(vol->GetArrayData());
+        unsigned char* bytes = new unsigned char[n_voxels * 2];
+        for (size_t i = 0; i < n_voxels; i++)
+        {
+          bytes[i * 2] = (unsigned char)(values[i] >> 8);
+          bytes[i * 2 + 1] = (unsigned char)(values[i] & 0xFF);
+        }
+        fwrite(bytes, 1, n_voxels * 2, f_pvm);
+        delete[] bytes;
+      }
+      fclose(f_pvm);
+
+      m_pvm = new PvmOld(VOLUME_KERNELS_PVM_FILE, false);
+      m_dst_bytes_per_voxel = bits == 32 ? sizeof(float) : components;
+      m_dst = new unsigned char[n_voxels * m_dst_bytes_per_voxel];
+
+      m_voxels_per_run = double(n_voxels);
+      m_bytes_per_run = m_voxels_per_run * double(components + m_dst_bytes_per_voxel);
+      return true;
+    }
+
+    virtual void Run ()
+    {
+      m_pvm->DecodeReescaledMinMaxData(m_dst, m_dst_bytes_per_voxel);
+    }
+
+    virtual void Cleanup ()
+    {
+      delete m_pvm;
+      delete[] m_dst;
+      m_pvm = nullptr;
+      m_dst = nullptr;
+      remove(VOLUME_KERNELS_PVM_FILE);
+    }
+
+  protected:
+    PvmOld* m_pvm;
+    unsigned char* m_dst;
+    unsigned int m_dst_bytes_per_voxel;
+  };
+
+  /////////////////////////////////////////////////////////////////////////////
+  // Float to half conversion of the normalized samples, as in the GL_R16F uploads
+  class HalfFloatConversionKernel : public MicrobenchmarkKernel
+  {
+  public:
+    HalfFloatConversionKernel (bool vectorized)
+      : MicrobenchmarkKernel(vectorized ? std::string("gl::FloatToHalf (") + gl::GetHalfFloatConversionPath() + ")"
+                                        : std::string("gl::FloatToHalf (single values)"), false)
+      , m_vectorized(vectorized), m_values(nullptr), m_half_values(nullptr), m_n_values(0)
+    {}
+
+    virtual bool Setup (int size, int bits)
+    {
+      vis::StructuredGridVolume* vol = GetVolume(size, bits);
+      if (!vol) return false;
+
+      m_n_values = vol->GetNumberOfVoxels();
+      m_values = new float[m_n_values];
+      m_half_values = new GLhalf[m_n_values];
+      for (int z = 0; z < size; z++)
+        for (int y = 0; y < size; y++)
+          for (int x = 0; x < size; x++)
+            m_values[vol->GetVoxelIndex(x, y, z)] = (float)vol->GetNormalizedSample(x, y, z);
+
+      m_voxels_per_run = double(m_n_values);
+      m_bytes_per_run = m_voxels_per_run * double(sizeof(float) + sizeof(GLhalf));
+      return true;
+    }
+
+    virtual void Run ()
+    {
+      if (m_vectorized)
+      {
+        gl::FloatToHalf(m_values, m_half_values, m_n_values);
+      }
+      else
+      {
+        long long n = (long long)m_n_values;
+#pragma omp parallel for
+        for (long long i = 0; i < n; i++)
+          m_half_values[i] = gl::FloatToHalf(m_values[i]);
+      }
+    }
+
+    virtual void Cleanup ()
+    {
+      delete[] m_values;
+      delete[] m_half_values;
+      m_values = nullptr;
+      m_half_values = nullptr;
+    }
+
+  protected:
+    bool m_vectorized;
+    float* m_values;
+    GLhalf* m_half_values;
+    size_t m_n_values;
+  };
+}
+
+void AddVolumeKernels (Microbenchmark* microbenchmark)
+{
+  microbenchmark->AddKernel(new NormalizedSampleKernel());
+  microbenchmark->AddKernel(new NormalizedInterpolatedSampleKernel());
+  microbenchmark->AddKernel(new TransferFunctionKernel());
+  microbenchmark->AddKernel(new SummedAreaTableKernel());
+  microbenchmark->AddKernel(new GradientKernel(0));
+  microbenchmark->AddKernel(new GradientKernel(3));
+  microbenchmark->AddKernel(new SobelFeldmanGradientKernel());
+  microbenchmark->AddKernel(new GeneralizedSamplingKernel<vis::Box>("Box"));
+  microbenchmark->AddKernel(new GeneralizedSamplingKernel<vis::Hat>("Hat"));
+  microbenchmark->AddKernel(new GeneralizedSamplingKernel<vis::CatmullRom>("CatmullRom"));
+  microbenchmark->AddKernel(new GeneralizedSamplingKernel<vis::MitchellNetravali>("MitchellNetravali"));
+  microbenchmark->AddKernel(new GeneralizedSamplingKernel<vis::CardinalBspline3>("CardinalBspline3"));
+  microbenchmark->AddKernel(new GeneralizedSamplingKernel<vis::CardinalOMOMS3>("CardinalOMOMS3"));
+  microbenchmark->AddKernel(new PvmDecodeKernel());
+  microbenchmark->AddKernel(new HalfFloatConversionKernel(false));
+  microbenchmark->AddKernel(new HalfFloatConversionKernel(true));
+}
+
+void DestroyVolumeKernelsData ()
+{
+  for (std::map<std::pair<int, int>, vis::StructuredGridVolume*>::iterator it = s_volumes.begin(); it != s_volumes.end(); ++it)
+    delete it->second;
+  s_volumes.clear();
+}
@@ -0,0 +1,20 @@
+/**
+ * Kernels measured by cppvolrend_microbench.
+ *
+ * Input volumes are procedural gaussian blobs (volvis_utils/proceduralvolume.h),
+ *   generated once per size and bit depth and shared by all kernels.
+ *
+ * Leonardo Quatrin Campagnolo
+ * . campagnolo.lq@gmail.com
+**/
+#ifndef CPPVOLREND_MICROBENCH_VOLUME_KERNELS_H
+#define CPPVOLREND_MICROBENCH_VOLUME_KERNELS_H
+
+#include "microbenchmark.h"
+
+void AddVolumeKernels (Microbenchmark* microbenchmark);
+
+// Deletes the volumes generated for the kernels
+void DestroyVolumeKernelsData ();
+
+#endif